@@ -24,10 +24,16 @@ tests.CONFIG = recursive
 tests.recurse = tests
 tests.depends = geometry
 
-QMAKE_EXTRA_TARGETS += src plugins tests
+cli.target = cli
+cli.CONFIG = recursive
+cli.recurse = cli
+cli.depends = src
+
+QMAKE_EXTRA_TARGETS += src plugins tests cli
 SUBDIRS = geometry \
 		fields \
 		src \
           plugins \
-          tests
+          tests \
+          cli
             
\ No newline at end of file
@@ -0,0 +1,806 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QTime>
+#include <QtConcurrentMap>
+
+#include <Inventor/SoDB.h>
+#include <Inventor/SoInteraction.h>
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/nodekits/SoNodeKit.h>
+#include <Inventor/nodes/SoSeparator.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include "Document.h"
+#include "FluxAnalysis.h"
+#include "gc.h"
+#include "InstanceNode.h"
+#include "PhotonMapExport.h"
+#include "PhotonMapExportFactory.h"
+#include "PluginManager.h"
+#include "RandomDeviate.h"
+#include "RandomDeviateFactory.h"
+#include "RayTracer.h"
+#include "RayTracerNoTr.h"
+#include "RayTracingScheduler.h"
+#include "SceneModel.h"
+#include "ScheduledRayTracer.h"
+#include "ShadingBlockingAnalysis.h"
+#include "SunPositionSweep.h"
+#include "TCube.h"
+#include "TDefaultMaterial.h"
+#include "TDefaultSunShape.h"
+#include "TDefaultTracker.h"
+#include "TDefaultTransmissivity.h"
+#include "TLightKit.h"
+#include "TLightShape.h"
+#include "TPhotonMap.h"
+#include "TraceScene.h"
+#include "TSceneKit.h"
+#include "TSceneTracker.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "TSquare.h"
+#include "TTrackerForAiming.h"
+#include "TTransmissivity.h"
+#include "tgf.h"
+#include "trf.h"
+#include "UserMField.h"
+#include "UserSField.h"
+
+/*!
+ * Options given in the command line to the batch ray tracer.
+ */
+struct CommandLineOptions
+{
+	CommandLineOptions()
+	:sceneFile( QLatin1String( "" ) ),
+	 pluginsDirectory( QLatin1String( "" ) ),
+	 numberOfRays( 10000 ),
+	 sunWidthDivisions( 200 ),
+	 sunHeightDivisions( 200 ),
+	 bufferPhotons( 5000000 ),
+	 exportBuffers( 2 ),
+	 rayPacketMode( false ),
+	 randomDeviateName( QLatin1String( "" ) ),
+	 randomSeed( 0 ),
+	 isRandomSeedDefined( false ),
+	 exportModeName( QLatin1String( "Binary_file" ) ),
+	 exportCoordinates( true ),
+	 exportInGlobalCoordinates( true ),
+	 exportPreviousNextPhotonID( false ),
+	 exportIntersectionSurfaceSide( false ),
+	 exportSurfaceID( true ),
+	 fluxSurfaceURL( QLatin1String( "" ) ),
+	 fluxSurfaceSide( QLatin1String( "FRONT" ) ),
+	 fluxWidthDivisions( 20 ),
+	 fluxHeightDivisions( 20 ),
+	 fluxDirectory( QLatin1String( "." ) ),
+	 fluxFileName( QLatin1String( "flux" ) ),
+	 fluxSaveCoordinates( false ),
+	 sweepFile( QLatin1String( "" ) ),
+	 sweepYear( 0 ),
+	 sweepLatitude( 0.0 ),
+	 sweepLongitude( 0.0 ),
+	 sweepResultsFile( QLatin1String( "" ) ),
+	 shadingBlocking( false ),
+	 shadingBlockingResultsFile( QLatin1String( "" ) )
+	{
+	}
+
+	QString sceneFile;
+	QString pluginsDirectory;
+	unsigned long numberOfRays;
+	int sunWidthDivisions;
+	int sunHeightDivisions;
+	unsigned long bufferPhotons;
+	unsigned long exportBuffers;
+	bool rayPacketMode;
+	QString randomDeviateName;
+	unsigned long randomSeed;
+	bool isRandomSeedDefined;
+
+	QString exportModeName;
+	QMap< QString, QString > exportParameters;
+	QStringList exportSurfaceURLList;
+	bool exportCoordinates;
+	bool exportInGlobalCoordinates;
+	bool exportPreviousNextPhotonID;
+	bool exportIntersectionSurfaceSide;
+	bool exportSurfaceID;
+
+	QString fluxSurfaceURL;
+	QString fluxSurfaceSide;
+	int fluxWidthDivisions;
+	int fluxHeightDivisions;
+	QString fluxDirectory;
+	QString fluxFileName;
+	bool fluxSaveCoordinates;
+
+	QString sweepFile;
+	int sweepYear;
+	double sweepLatitude;
+	double sweepLongitude;
+	QString sweepResultsFile;
+
+	bool shadingBlocking;
+	QString shadingBlockingResultsFile;
+};
+
+/*!
+ * Prints the command line help.
+ */
+static void PrintUsage()
+{
+	std::cout<<"Usage: tonatiuh-cli [options] scene.tnh\n"
+			"\n"
+			"General options:\n"
+			"  --rays <n>                   Number of rays to trace (default 10000).\n"
+			"  --sun-divisions <w>x<h>      Divisions of the sun plane to find the valid light areas (default 200x200).\n"
+			"  --buffer <n>                 Photons stored in memory before they are exported (default 5000000).\n"
+			"  --export-buffers <n>         Buffers of photons kept while a buffer is exported, at least 2 (default 2).\n"
+			"  --packet                     Trace the first stage of the rays as packets.\n"
+			"  --plugins <dir>              Plugins directory (default: the 'plugins' directory next to the program).\n"
+			"  --random <name>              Random generator plugin name (default: the first generator plugin).\n"
+			"  --seed <n>                   Seed of the random generator, the same seed traces the same rays\n"
+			"                               (default: a seed taken from the clock).\n"
+			"\n"
+			"Photon map options:\n"
+			"  --export <mode>              Photon map export plugin name (default 'Binary_file').\n"
+			"  --parameter <name>=<value>   Parameter of the export plugin, e.g. ExportDirectory=/tmp. Can be repeated.\n"
+			"  --surface <url>              Export only the photons of this surface. Can be repeated.\n"
+			"  --local-coordinates          Save the coordinates in the surface local system.\n"
+			"  --no-coordinates             Do not save the photon coordinates.\n"
+			"  --no-surface-id              Do not save the surface identifiers.\n"
+			"  --side                       Save the side of the surface of each photon.\n"
+			"  --previous-next              Save the previous and next photon identifiers.\n"
+			"\n"
+			"Flux map options (a flux map is computed instead of the photon map when --flux is given):\n"
+			"  --flux <url>                 Surface where the flux distribution is computed.\n"
+			"  --flux-side <side>           FRONT, BACK or INSIDE (default FRONT).\n"
+			"  --flux-grid <w>x<h>          Cells of the flux map (default 20x20).\n"
+			"  --flux-directory <dir>       Output directory (default '.').\n"
+			"  --flux-file <name>           Output file name (default 'flux').\n"
+			"  --flux-coordinates           Save the coordinates of the cells.\n"
+			"\n"
+			"Sun position sweep options (the power of the --surface surfaces is computed for each sun position):\n"
+			"  --sweep <file>               File with a sun position in each line, as 'azimuth elevation' in degrees\n"
+			"                               or as 'year month day hours minutes seconds latitude longitude' in ut time.\n"
+			"  --sweep-annual <y>:<lat>:<lon>  Each hour with sun of the year y at latitude lat and longitude lon.\n"
+			"  --sweep-results <file>       Results file (default: standard output).\n"
+			"\n"
+			"Shading and blocking options (the heliostats are the nodes with a tracker, --surface are the receivers):\n"
+			"  --shading-blocking           Compute the shading and blocking fractions of each heliostat with --rays\n"
+			"                               sun rays per heliostat, for the sweep sun positions or the scene sun.\n"
+			"  --shading-results <file>     Results file (default: standard output).\n"
+			<<std::endl;
+}
+
+/*!
+ * Reads the \a value as width x height divisions. Returns \a false if the value is not valid.
+ */
+static bool ReadDivisions( QString value, int* width, int* height )
+{
+	QStringList divisions = value.split( QLatin1Char( 'x' ) );
+	if( divisions.count() != 2 )	return false;
+
+	bool okWidth = false;
+	bool okHeight = false;
+	*width = divisions[0].toInt( &okWidth );
+	*height = divisions[1].toInt( &okHeight );
+	return ( okWidth && okHeight && *width > 0 && *height > 0 );
+}
+
+/*!
+ * Reads the command line \a arguments into \a options. Returns \a false and prints the reason if an argument is not valid.
+ */
+static bool ReadArguments( QStringList arguments, CommandLineOptions* options )
+{
+	for( int a = 1; a < arguments.count(); ++a )
+	{
+		QString argument = arguments[a];
+		bool hasValue = ( a + 1 < arguments.count() );
+		bool ok = true;
+
+		if( argument == QLatin1String( "--packet" ) )	options->rayPacketMode = true;
+		else if( argument == QLatin1String( "--local-coordinates" ) )	options->exportInGlobalCoordinates = false;
+		else if( argument == QLatin1String( "--no-coordinates" ) )	options->exportCoordinates = false;
+		else if( argument == QLatin1String( "--no-surface-id" ) )	options->exportSurfaceID = false;
+		else if( argument == QLatin1String( "--side" ) )	options->exportIntersectionSurfaceSide = true;
+		else if( argument == QLatin1String( "--previous-next" ) )	options->exportPreviousNextPhotonID = true;
+		else if( argument == QLatin1String( "--flux-coordinates" ) )	options->fluxSaveCoordinates = true;
+		else if( argument == QLatin1String( "--shading-blocking" ) )	options->shadingBlocking = true;
+		else if( argument.startsWith( QLatin1String( "--" ) ) )
+		{
+			if( !hasValue )
+			{
+				std::cerr<<"Missing value for option "<<argument.toStdString()<<std::endl;
+				return false;
+			}
+			QString value = arguments[++a];
+
+			if( argument == QLatin1String( "--rays" ) )	options->numberOfRays = value.toULong( &ok );
+			else if( argument == QLatin1String( "--sun-divisions" ) )	ok = ReadDivisions( value, &options->sunWidthDivisions, &options->sunHeightDivisions );
+			else if( argument == QLatin1String( "--buffer" ) )	options->bufferPhotons = value.toULong( &ok );
+			else if( argument == QLatin1String( "--export-buffers" ) )	options->exportBuffers = value.toULong( &ok );
+			else if( argument == QLatin1String( "--plugins" ) )	options->pluginsDirectory = value;
+			else if( argument == QLatin1String( "--random" ) )	options->randomDeviateName = value;
+			else if( argument == QLatin1String( "--seed" ) )
+			{
+				options->randomSeed = value.toULong( &ok );
+				options->isRandomSeedDefined = true;
+			}
+			else if( argument == QLatin1String( "--export" ) )	options->exportModeName = value;
+			else if( argument == QLatin1String( "--parameter" ) )
+			{
+				int separator = value.indexOf( QLatin1Char( '=' ) );
+				ok = ( separator > 0 );
+				if( ok )	options->exportParameters.insert( value.left( separator ), value.mid( separator + 1 ) );
+			}
+			else if( argument == QLatin1String( "--surface" ) )	options->exportSurfaceURLList<<value;
+			else if( argument == QLatin1String( "--flux" ) )	options->fluxSurfaceURL = value;
+			else if( argument == QLatin1String( "--flux-side" ) )	options->fluxSurfaceSide = value;
+			else if( argument == QLatin1String( "--flux-grid" ) )	ok = ReadDivisions( value, &options->fluxWidthDivisions, &options->fluxHeightDivisions );
+			else if( argument == QLatin1String( "--flux-directory" ) )	options->fluxDirectory = value;
+			else if( argument == QLatin1String( "--flux-file" ) )	options->fluxFileName = value;
+			else if( argument == QLatin1String( "--sweep" ) )	options->sweepFile = value;
+			else if( argument == QLatin1String( "--sweep-annual" ) )
+			{
+				QStringList location = value.split( QLatin1Char( ':' ) );
+				bool okLatitude = false;
+				bool okLongitude = false;
+				if( location.count() == 3 )
+				{
+					options->sweepYear = location[0].toInt( &ok );
+					options->sweepLatitude = location[1].toDouble( &okLatitude );
+					options->sweepLongitude = location[2].toDouble( &okLongitude );
+				}
+				ok = ok && okLatitude && okLongitude && ( location.count() == 3 ) &&
+						( fabs( options->sweepLatitude ) <= 90. ) && ( fabs( options->sweepLongitude ) <= 180. );
+			}
+			else if( argument == QLatin1String( "--sweep-results" ) )	options->sweepResultsFile = value;
+			else if( argument == QLatin1String( "--shading-results" ) )	options->shadingBlockingResultsFile = value;
+			else
+			{
+				std::cerr<<"Unknown option "<<argument.toStdString()<<std::endl;
+				return false;
+			}
+
+			if( !ok )
+			{
+				std::cerr<<"Invalid value '"<<value.toStdString()<<"' for option "<<argument.toStdString()<<std::endl;
+				return false;
+			}
+		}
+		else if( options->sceneFile.isEmpty() )	options->sceneFile = argument;
+		else
+		{
+			std::cerr<<"Only one scene file can be traced"<<std::endl;
+			return false;
+		}
+	}
+
+	if( options->sceneFile.isEmpty() )
+	{
+		std::cerr<<"No scene file given"<<std::endl;
+		return false;
+	}
+	if( options->numberOfRays < 1 )
+	{
+		std::cerr<<"The number of rays must be greater than zero"<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Creates the export mode \a options->exportModeName for the photon map and configures it with the command line options.
+ *
+ * Returns null if the plugin is not available.
+ */
+static PhotonMapExport* CreatePhotonMapExport( const PluginManager& pluginManager, SceneModel& sceneModel, const CommandLineOptions& options )
+{
+	QVector< PhotonMapExportFactory* > factoryList = pluginManager.GetExportPMModeFactories();
+
+	PhotonMapExportFactory* pExportModeFactory = 0;
+	for( int i = 0; i < factoryList.size() && !pExportModeFactory; i++ )
+		if( factoryList[i]->GetName() == options.exportModeName )	pExportModeFactory = factoryList[i];
+	if( !pExportModeFactory )	return 0;
+
+	PhotonMapExport* pExportMode = pExportModeFactory->GetExportPhotonMapMode();
+	if( !pExportMode )	return 0;
+
+	pExportMode->SetSaveCoordinatesEnabled( options.exportCoordinates );
+	pExportMode->SetSaveCoordinatesInGlobalSystemEnabled( options.exportInGlobalCoordinates );
+	pExportMode->SetSavePreviousNextPhotonsID( options.exportPreviousNextPhotonID );
+	pExportMode->SetSaveSideEnabled( options.exportIntersectionSurfaceSide );
+	pExportMode->SetSaveSurfacesIDEnabled( options.exportSurfaceID );
+
+	if( options.exportSurfaceURLList.count() < 1 )
+		pExportMode->SetSaveAllPhotonsEnabled();
+	else
+		pExportMode->SetSaveSurfacesURLList( options.exportSurfaceURLList );
+
+	QMap< QString, QString >::const_iterator i = options.exportParameters.constBegin();
+	while( i != options.exportParameters.constEnd() )
+	{
+		pExportMode->SetSaveParameterValue( i.key(), i.value() );
+		++i;
+	}
+
+	pExportMode->SetSceneModel( sceneModel );
+
+	return pExportMode;
+}
+
+/*!
+ * Updates the light of the \a coinScene to cover the concentrator bounding box.
+ */
+static void UpdateLightSize( TSceneKit* coinScene )
+{
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	if( !lightKit )	return;
+
+	TSeparatorKit* concentratorRoot = static_cast< TSeparatorKit* >( coinScene->getPart( "childList[0]", false ) );
+	if( !concentratorRoot )	return;
+
+	SoGetBoundingBoxAction* bbAction = new SoGetBoundingBoxAction( SbViewportRegion() ) ;
+	concentratorRoot->getBoundingBox( bbAction );
+
+	SbBox3f box = bbAction->getXfBoundingBox().project();
+	delete bbAction;
+
+	if( !box.isEmpty() )
+	{
+		BBox sceneBox;
+		sceneBox.pMin = Point3D( box.getMin()[0], box.getMin()[1], box.getMin()[2] );
+		sceneBox.pMax = Point3D( box.getMax()[0], box.getMax()[1], box.getMax()[2] );
+		lightKit->Update( sceneBox );
+	}
+}
+
+/*!
+ * Traces the \a coinScene rays and saves the photon map with the export mode given in \a options.
+ *
+ * This is the same ray tracing that MainWindow::Run does, without the progress dialog and the 3D view.
+ * Returns \a false if the scene is not ready for ray tracing.
+ */
+static bool RunRayTracing( TSceneKit* coinScene, SceneModel& sceneModel, InstanceNode* rootSeparatorInstance,
+		RandomDeviate& rand, const PluginManager& pluginManager, const CommandLineOptions& options )
+{
+	TTransmissivity* transmissivity = static_cast< TTransmissivity* > ( coinScene->getPart( "transmissivity", false ) );
+
+	InstanceNode* sceneInstance = rootSeparatorInstance->GetParent();
+	if( !sceneInstance || sceneInstance->children.count() < 1 )	return false;
+	InstanceNode* lightInstance = sceneInstance->children[0];
+
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	if( !lightKit )
+	{
+		std::cerr<<"The scene has no light"<<std::endl;
+		return false;
+	}
+	TSunShape* sunShape = static_cast< TSunShape * >( lightKit->getPart( "tsunshape", false ) );
+	TLightShape* raycastingSurface = static_cast< TLightShape * >( lightKit->getPart( "icon", false ) );
+	SoTransform* lightTransform = static_cast< SoTransform * >( lightKit->getPart( "transform" ,false ) );
+	if( !sunShape || !raycastingSurface || !lightTransform )	return false;
+
+	PhotonMapExport* pExportMode = CreatePhotonMapExport( pluginManager, sceneModel, options );
+	if( !pExportMode )
+	{
+		std::cerr<<"Export mode "<<options.exportModeName.toStdString()<<" is not available"<<std::endl;
+		return false;
+	}
+
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( options.bufferPhotons );
+	photonMap.SetNumberOfBuffers( options.exportBuffers );
+
+	QVector< InstanceNode* > exportSuraceList;
+	for( int s = 0; s < options.exportSurfaceURLList.count(); s++ )
+	{
+		QModelIndex surfaceIndex = sceneModel.IndexFromNodeUrl( options.exportSurfaceURLList[s] );
+		if( !surfaceIndex.isValid() )
+		{
+			std::cerr<<"Surface "<<options.exportSurfaceURLList[s].toStdString()<<" not found"<<std::endl;
+			delete pExportMode;
+			return false;
+		}
+		exportSuraceList.push_back( sceneModel.NodeFromIndex( surfaceIndex ) );
+	}
+
+	UpdateLightSize( coinScene );
+
+	//Compute bounding boxes and world to object transforms
+	trf::ComputeSceneTreeMap( rootSeparatorInstance, Transform( new Matrix4x4 ), true );
+
+	photonMap.SetConcentratorToWorld( rootSeparatorInstance->GetIntersectionTransform() );
+	if( !photonMap.SetExportMode( pExportMode ) )
+	{
+		std::cerr<<"The photon map export could not be started"<<std::endl;
+		delete pExportMode;
+		return false;
+	}
+
+	TraceScene traceScene;
+	traceScene.Compile( rootSeparatorInstance );
+
+	QStringList disabledNodes = QString( lightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
+	QVector< QPair< TShapeKit*, Transform > > surfacesList;
+	trf::ComputeFistStageSurfaceList( rootSeparatorInstance, disabledNodes, &surfacesList );
+	lightKit->ComputeLightSourceArea( options.sunWidthDivisions, options.sunHeightDivisions, surfacesList );
+	if( surfacesList.count() < 1 )
+	{
+		std::cerr<<"There are no surfaces defined for ray tracing"<<std::endl;
+		delete pExportMode;
+		return false;
+	}
+
+	RayTracingScheduler scheduler( options.numberOfRays, 0, QThread::idealThreadCount() );
+	QVector< int > workers = scheduler.Workers();
+
+	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
+	lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
+
+	QMutex mutex;
+	photonMap.StartStore();
+	QFuture< void > tracing;
+	if( transmissivity )
+		tracing = QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracer >( &scheduler, RayTracer( &traceScene,
+						lightInstance, raycastingSurface, sunShape, lightToWorld,
+						transmissivity,
+						rand,
+						&mutex, &photonMap,
+						exportSuraceList,
+						options.rayPacketMode ) ) );
+	else
+		tracing = QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracerNoTr >( &scheduler, RayTracerNoTr( &traceScene,
+						lightInstance, raycastingSurface, sunShape, lightToWorld,
+						rand,
+						&mutex, &photonMap,
+						exportSuraceList,
+						options.rayPacketMode ) ) );
+	tracing.waitForFinished();
+	photonMap.FinishStore();
+
+	double irradiance = sunShape->GetIrradiance();
+	double inputAperture = raycastingSurface->GetValidArea();
+	double wPhoton = ( inputAperture * irradiance ) / options.numberOfRays;
+
+	photonMap.EndStore( wPhoton );
+	delete pExportMode;
+
+	std::cout<<"Power per photon: "<<wPhoton<<" W"<<std::endl;
+	return true;
+}
+
+/*!
+ * Computes the flux distribution of the surface given in \a options and saves it in the flux directory.
+ *
+ * Returns \a false if the surface is not valid for the flux analysis.
+ */
+static bool RunFluxAnalysis( TSceneKit* coinScene, SceneModel& sceneModel, InstanceNode* rootSeparatorInstance,
+		RandomDeviate& rand, const CommandLineOptions& options )
+{
+	unsigned long usedRandomStreams = 0;
+	FluxAnalysis fluxAnalysis( coinScene, sceneModel, rootSeparatorInstance,
+			options.sunWidthDivisions, options.sunHeightDivisions, &rand, &usedRandomStreams );
+
+	fluxAnalysis.RunFluxAnalysis( options.fluxSurfaceURL, options.fluxSurfaceSide, options.numberOfRays, false,
+			options.fluxHeightDivisions, options.fluxWidthDivisions );
+	if( !fluxAnalysis.photonCountsValue() )
+	{
+		std::cerr<<"The flux of surface "<<options.fluxSurfaceURL.toStdString()<<" could not be computed"<<std::endl;
+		return false;
+	}
+
+	fluxAnalysis.ExportAnalysis( options.fluxDirectory, options.fluxFileName, options.fluxSaveCoordinates );
+
+	std::cout<<"Total power: "<<fluxAnalysis.totalPowerValue()<<" W"<<std::endl;
+	std::cout<<"Maximum flux photons: "<<fluxAnalysis.maximumPhotonsValue()<<std::endl;
+	return true;
+}
+
+/*!
+ * Traces the scene for each sun position of the sweep given in \a options and writes the power of the
+ * --surface surfaces for each position to the results file, or to the standard output.
+ *
+ * Returns \a false if the sun positions or the surfaces are not valid.
+ */
+static bool RunSunPositionSweep( TSceneKit* coinScene, SceneModel& sceneModel, InstanceNode* rootSeparatorInstance,
+		RandomDeviate& rand, const CommandLineOptions& options )
+{
+	QVector< QPair< double, double > > sunPositions;
+	if( options.sweepFile.isEmpty() )
+		sunPositions = SunPositionSweep::HourlySunPositions( options.sweepYear, options.sweepLatitude, options.sweepLongitude );
+	else if( !SunPositionSweep::ReadSunPositions( options.sweepFile, &sunPositions ) )
+	{
+		std::cerr<<"Cannot read the sun positions file "<<options.sweepFile.toStdString()<<std::endl;
+		return false;
+	}
+
+	QVector< InstanceNode* > surfaces;
+	for( int s = 0; s < options.exportSurfaceURLList.count(); s++ )
+	{
+		QModelIndex surfaceIndex = sceneModel.IndexFromNodeUrl( options.exportSurfaceURLList[s] );
+		if( !surfaceIndex.isValid() )
+		{
+			std::cerr<<"Surface "<<options.exportSurfaceURLList[s].toStdString()<<" not found"<<std::endl;
+			return false;
+		}
+		surfaces.push_back( sceneModel.NodeFromIndex( surfaceIndex ) );
+	}
+	if( surfaces.count() < 1 )
+	{
+		std::cerr<<"The sun position sweep needs at least one --surface"<<std::endl;
+		return false;
+	}
+
+	QFile resultsFile( options.sweepResultsFile );
+	if( options.sweepResultsFile.isEmpty() )
+		resultsFile.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+	else if( !resultsFile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		std::cerr<<"Cannot open the results file "<<options.sweepResultsFile.toStdString()<<std::endl;
+		return false;
+	}
+	QTextStream results( &resultsFile );
+
+	SunPositionSweep sweep( coinScene, rootSeparatorInstance, rand, surfaces, options.sunWidthDivisions, options.sunHeightDivisions );
+	sweep.SetRayPacketMode( options.rayPacketMode );
+	if( !sweep.Run( sunPositions, options.numberOfRays, results ) )
+	{
+		std::cerr<<"The scene is not ready for ray tracing"<<std::endl;
+		return false;
+	}
+
+	std::cout<<"Traced "<<sunPositions.count()<<" sun positions"<<std::endl;
+	return true;
+}
+
+/*!
+ * Computes the shading and blocking fractions of each heliostat for the sweep sun positions given in \a options, or
+ * for the scene sun position if there is no sweep, and writes them to the results file, or to the standard output.
+ * The --surface surfaces are the receivers of the reflected rays.
+ *
+ * Returns \a false if the sun positions or the surfaces are not valid or the scene has no heliostats.
+ */
+static bool RunShadingBlocking( TSceneKit* coinScene, SceneModel& sceneModel, InstanceNode* rootSeparatorInstance,
+		RandomDeviate& rand, const CommandLineOptions& options )
+{
+	QVector< QPair< double, double > > sunPositions;
+	if( !options.sweepFile.isEmpty() )
+	{
+		if( !SunPositionSweep::ReadSunPositions( options.sweepFile, &sunPositions ) )
+		{
+			std::cerr<<"Cannot read the sun positions file "<<options.sweepFile.toStdString()<<std::endl;
+			return false;
+		}
+	}
+	else if( options.sweepYear > 0 )
+		sunPositions = SunPositionSweep::HourlySunPositions( options.sweepYear, options.sweepLatitude, options.sweepLongitude );
+	else
+	{
+		TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+		if( !lightKit )
+		{
+			std::cerr<<"The scene has no sun"<<std::endl;
+			return false;
+		}
+		sunPositions.push_back( QPair< double, double >( lightKit->azimuth.getValue() / gc::Degree,
+				90 - lightKit->zenith.getValue() / gc::Degree ) );
+	}
+
+	QVector< InstanceNode* > receivers;
+	for( int s = 0; s < options.exportSurfaceURLList.count(); s++ )
+	{
+		QModelIndex surfaceIndex = sceneModel.IndexFromNodeUrl( options.exportSurfaceURLList[s] );
+		if( !surfaceIndex.isValid() )
+		{
+			std::cerr<<"Surface "<<options.exportSurfaceURLList[s].toStdString()<<" not found"<<std::endl;
+			return false;
+		}
+		receivers.push_back( sceneModel.NodeFromIndex( surfaceIndex ) );
+	}
+
+	QFile resultsFile( options.shadingBlockingResultsFile );
+	if( options.shadingBlockingResultsFile.isEmpty() )
+		resultsFile.open( stdout, QIODevice::WriteOnly | QIODevice::Text );
+	else if( !resultsFile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		std::cerr<<"Cannot open the results file "<<options.shadingBlockingResultsFile.toStdString()<<std::endl;
+		return false;
+	}
+	QTextStream results( &resultsFile );
+
+	ShadingBlockingAnalysis analysis( coinScene, rootSeparatorInstance, rand, receivers );
+	if( !analysis.Run( sunPositions, options.numberOfRays, results ) )
+	{
+		std::cerr<<"The scene has no heliostats or no sun"<<std::endl;
+		return false;
+	}
+
+	std::cout<<"Computed "<<analysis.GetNumberOfHeliostats()<<" heliostats for "<<sunPositions.count()<<" sun positions"<<std::endl;
+	return true;
+}
+
+
+//!  Batch ray tracer entry point.
+/*!
+  tonatiuh-cli main() function. It traces a Tonatiuh scene without a graphical user interface: it only starts
+  Coin3D and the application Coin3D extension subclasses, so it runs without a display. The warnings that the
+  application shows in message boxes are written to the standard error (see tgf::ShowWarning).
+*/
+int main( int argc, char ** argv )
+{
+	QTime startTime;
+	startTime.start();
+
+	QCoreApplication a( argc, argv );
+	a.setApplicationVersion( APP_VERSION );
+
+	CommandLineOptions options;
+	if( !ReadArguments( a.arguments(), &options ) )
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	SoDB::init();
+	SoNodeKit::init();
+	SoInteraction::init();
+
+	UserMField::initClass();
+	UserSField::initClass();
+	TSceneKit::initClass();
+	TMaterial::initClass();
+	TDefaultMaterial::initClass();
+	TSeparatorKit::initClass();
+	TShape::initClass();
+	TCube::initClass();
+	TLightShape::initClass();
+	TShapeKit::initClass();
+	TSquare::initClass();
+	TLightKit::initClass();
+	TSunShape::initClass();
+	TDefaultSunShape::initClass();
+	TTracker::initClass();
+	TTrackerForAiming::initClass();
+	TDefaultTracker::initClass();
+	TSceneTracker::initClass();
+	TTransmissivity::initClass();
+	TDefaultTransmissivity::initClass();
+
+	QDir pluginsDirectory( a.applicationDirPath() );
+	if( options.pluginsDirectory.isEmpty() )	pluginsDirectory.cd( "plugins" );
+	else	pluginsDirectory = QDir( options.pluginsDirectory );
+	PluginManager pluginManager;
+	pluginManager.LoadAvailablePlugins( pluginsDirectory );
+
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = pluginManager.GetRandomDeviateFactories();
+	if( randomDeviateFactoryList.size() < 1 )
+	{
+		std::cerr<<"There is no random generator plugin in "<<pluginsDirectory.absolutePath().toStdString()<<std::endl;
+		return -1;
+	}
+
+	Document document;
+	if( !document.ReadFile( options.sceneFile ) )
+	{
+		std::cerr<<"Cannot read the scene file "<<options.sceneFile.toStdString()<<std::endl;
+		return -1;
+	}
+	TSceneKit* coinScene = document.GetSceneKit();
+
+	SoSeparator* coinRoot = new SoSeparator;
+	coinRoot->ref();
+	coinRoot->addChild( coinScene );
+
+	SceneModel sceneModel;
+	sceneModel.SetCoinRoot( *coinRoot );
+	sceneModel.SetCoinScene( *coinScene );
+
+	InstanceNode* rootSeparatorInstance = sceneModel.NodeFromIndex( sceneModel.IndexFromNodeUrl( QString( "//SunNode" ) ) );
+	if( !rootSeparatorInstance || rootSeparatorInstance == sceneModel.NodeFromIndex( QModelIndex() ) )
+	{
+		std::cerr<<"The scene has no concentrator"<<std::endl;
+		coinRoot->unref();
+		return -1;
+	}
+
+	RandomDeviateFactory* randomDeviateFactory = randomDeviateFactoryList[0];
+	if( !options.randomDeviateName.isEmpty() )
+	{
+		randomDeviateFactory = 0;
+		for( int r = 0; r < randomDeviateFactoryList.size(); ++r )
+			if( randomDeviateFactoryList[r]->RandomDeviateName() == options.randomDeviateName )
+				randomDeviateFactory = randomDeviateFactoryList[r];
+
+		if( !randomDeviateFactory )
+		{
+			std::cerr<<"Random generator "<<options.randomDeviateName.toStdString()<<" is not available. Available generators:"<<std::endl;
+			for( int r = 0; r < randomDeviateFactoryList.size(); ++r )
+				std::cerr<<"  "<<randomDeviateFactoryList[r]->RandomDeviateName().toStdString()<<std::endl;
+			coinRoot->unref();
+			return -1;
+		}
+	}
+
+	RandomDeviate* rand = options.isRandomSeedDefined ?
+			randomDeviateFactory->CreateRandomDeviate( options.randomSeed ) :
+			randomDeviateFactory->CreateRandomDeviate();
+	std::cout<<"Random generator: "<<randomDeviateFactory->RandomDeviateName().toStdString()<<std::endl;
+
+	std::cout<<"Scene loaded in "<<startTime.elapsed()<<" ms"<<std::endl;
+
+	QTime traceTime;
+	traceTime.start();
+
+	bool traced = false;
+	if( options.shadingBlocking )
+		traced = RunShadingBlocking( coinScene, sceneModel, rootSeparatorInstance, *rand, options );
+	else if( !options.sweepFile.isEmpty() || options.sweepYear > 0 )
+		traced = RunSunPositionSweep( coinScene, sceneModel, rootSeparatorInstance, *rand, options );
+	else if( options.fluxSurfaceURL.isEmpty() )
+		traced = RunRayTracing( coinScene, sceneModel, rootSeparatorInstance, *rand, pluginManager, options );
+	else
+		traced = RunFluxAnalysis( coinScene, sceneModel, rootSeparatorInstance, *rand, options );
+
+	if( traced )
+		std::cout<<"Traced "<<options.numberOfRays<<" rays per run using "<<QThread::idealThreadCount()<<" thread(s) in "
+			<<traceTime.elapsed()<<" ms"<<std::endl;
+
+	delete rand;
+	coinRoot->unref();
+
+	return traced ? 0 : -1;
+}
@@ -122,6 +122,16 @@ else{
 }
 
 
+# Packet ray tracing kernels. Build with "qmake CONFIG+=avx2" to use AVX2 instructions.
+avx2 {
+	win32-msvc*{
+		QMAKE_CXXFLAGS += /arch:AVX2
+	}
+	else{
+		QMAKE_CXXFLAGS += -mavx2
+	}
+}
+
 QMAKE_CLEAN += *.rc *.aps object_script*    
 QMAKE_DISTCLEAN += -r   $$(TONATIUH_ROOT)/bin/debug/
 QMAKE_DISTCLEAN += -r   $$(TONATIUH_ROOT)/bin/release/
\ No newline at end of file
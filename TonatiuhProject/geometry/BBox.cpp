@@ -39,8 +39,13 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <cmath>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "BBox.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "gc.h"
 #include "Vector3D.h"
 #include "Point3D.h"
@@ -101,6 +106,12 @@ double BBox::Volume() const
    return diagonal.x * diagonal.y * diagonal.z;
 }
 
+double BBox::SurfaceArea() const
+{
+   Vector3D diagonal = pMax - pMin;
+   return 2.0 * ( diagonal.x * diagonal.y + diagonal.x * diagonal.z + diagonal.y * diagonal.z );
+}
+
 int BBox::MaximumExtent() const
 {
    Vector3D diagonal = pMax - pMin;
@@ -177,6 +188,108 @@ bool BBox::IntersectP( const Ray& ray, double* hitt0, double* hitt1 ) const
 	else return false;
 }
 
+/*!
+ * Tests the rays of \a rays against the box. Returns a mask with the bit of each ray that intersects the box
+ * between its mint and maxt set. The result for each ray is the same as IntersectP( const Ray& ).
+ */
+int BBox::IntersectP( const RayPacket& rays ) const
+{
+	int hitMask = 0;
+
+#ifdef __AVX2__
+	for( int i = 0; i < RayPacket::Size; i += 4 )
+	{
+		__m256d zero = _mm256_setzero_pd();
+
+		__m256d origin = _mm256_loadu_pd( rays.originX + i );
+		__m256d invDirection = _mm256_loadu_pd( rays.invDirectionX + i );
+		__m256d positive = _mm256_cmp_pd( invDirection, zero, _CMP_GE_OQ );
+		__m256d t0 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMin.x ), origin ), invDirection );
+		__m256d t1 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMax.x ), origin ), invDirection );
+		__m256d tmin = _mm256_blendv_pd( t1, t0, positive );
+		__m256d tmax = _mm256_blendv_pd( t0, t1, positive );
+
+		origin = _mm256_loadu_pd( rays.originY + i );
+		invDirection = _mm256_loadu_pd( rays.invDirectionY + i );
+		positive = _mm256_cmp_pd( invDirection, zero, _CMP_GE_OQ );
+		t0 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMin.y ), origin ), invDirection );
+		t1 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMax.y ), origin ), invDirection );
+		__m256d tymin = _mm256_blendv_pd( t1, t0, positive );
+		__m256d tymax = _mm256_blendv_pd( t0, t1, positive );
+
+		__m256d miss = _mm256_or_pd( _mm256_cmp_pd( tmin, tymax, _CMP_GT_OQ ), _mm256_cmp_pd( tymin, tmax, _CMP_GT_OQ ) );
+		tmin = _mm256_blendv_pd( tmin, tymin, _mm256_cmp_pd( tymin, tmin, _CMP_GT_OQ ) );
+		tmax = _mm256_blendv_pd( tmax, tymax, _mm256_cmp_pd( tymax, tmax, _CMP_LT_OQ ) );
+
+		origin = _mm256_loadu_pd( rays.originZ + i );
+		invDirection = _mm256_loadu_pd( rays.invDirectionZ + i );
+		positive = _mm256_cmp_pd( invDirection, zero, _CMP_GE_OQ );
+		t0 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMin.z ), origin ), invDirection );
+		t1 = _mm256_mul_pd( _mm256_sub_pd( _mm256_set1_pd( pMax.z ), origin ), invDirection );
+		__m256d tzmin = _mm256_blendv_pd( t1, t0, positive );
+		__m256d tzmax = _mm256_blendv_pd( t0, t1, positive );
+
+		miss = _mm256_or_pd( miss, _mm256_cmp_pd( tmin, tzmax, _CMP_GT_OQ ) );
+		miss = _mm256_or_pd( miss, _mm256_cmp_pd( tzmin, tmax, _CMP_GT_OQ ) );
+		tmin = _mm256_blendv_pd( tmin, tzmin, _mm256_cmp_pd( tzmin, tmin, _CMP_GT_OQ ) );
+		tmax = _mm256_blendv_pd( tmax, tzmax, _mm256_cmp_pd( tzmax, tmax, _CMP_LT_OQ ) );
+
+		__m256d hit = _mm256_and_pd( _mm256_cmp_pd( tmin, _mm256_loadu_pd( rays.maxt + i ), _CMP_LT_OQ ),
+				_mm256_cmp_pd( tmax, _mm256_loadu_pd( rays.mint + i ), _CMP_GT_OQ ) );
+		hitMask |= _mm256_movemask_pd( _mm256_andnot_pd( miss, hit ) ) << i;
+	}
+#else
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		double tmin, tmax, tymin, tymax, tzmin, tzmax;
+		if( rays.invDirectionX[i] >= 0.0 )
+		{
+			tmin = ( pMin.x - rays.originX[i] ) * rays.invDirectionX[i];
+			tmax = ( pMax.x - rays.originX[i] ) * rays.invDirectionX[i];
+		}
+		else
+		{
+			tmin = ( pMax.x - rays.originX[i] ) * rays.invDirectionX[i];
+			tmax = ( pMin.x - rays.originX[i] ) * rays.invDirectionX[i];
+		}
+
+		if( rays.invDirectionY[i] >= 0.0 )
+		{
+			tymin = ( pMin.y - rays.originY[i] ) * rays.invDirectionY[i];
+			tymax = ( pMax.y - rays.originY[i] ) * rays.invDirectionY[i];
+		}
+		else
+		{
+			tymin = ( pMax.y - rays.originY[i] ) * rays.invDirectionY[i];
+			tymax = ( pMin.y - rays.originY[i] ) * rays.invDirectionY[i];
+		}
+
+		if ( ( tmin > tymax ) || ( tymin > tmax ) ) continue;
+		if ( tymin > tmin ) tmin = tymin;
+		if ( tymax < tmax ) tmax = tymax;
+
+		if( rays.invDirectionZ[i] >= 0.0 )
+		{
+			tzmin = ( pMin.z - rays.originZ[i] ) * rays.invDirectionZ[i];
+			tzmax = ( pMax.z - rays.originZ[i] ) * rays.invDirectionZ[i];
+		}
+		else
+		{
+			tzmin = ( pMax.z - rays.originZ[i] ) * rays.invDirectionZ[i];
+			tzmax = ( pMin.z - rays.originZ[i] ) * rays.invDirectionZ[i];
+		}
+
+		if ( ( tmin > tzmax ) || ( tzmin > tmax ) ) continue;
+		if ( tzmin > tmin ) tmin = tzmin;
+		if ( tzmax < tmax ) tmax = tzmax;
+
+		if ( ( tmin < rays.maxt[i] ) && ( tmax > rays.mint[i] ) )	hitMask |= ( 1 << i );
+	}
+#endif
+
+	return hitMask;
+}
+
 BBox Union( const BBox& bbox, const Point3D& point )
 {
    BBox unionBox;
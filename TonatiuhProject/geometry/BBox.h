@@ -43,6 +43,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "Point3D.h"
 
 class Ray;
+struct RayPacket;
 
 struct BBox
 {
@@ -53,9 +54,11 @@ struct BBox
 	bool Inside( const Point3D& point ) const;
 	void Expand( double delta );
 	double Volume( ) const;
+	double SurfaceArea( ) const;
 	int MaximumExtent( ) const;
 	void BoundingSphere( Point3D& center, double& radius ) const;
 	bool IntersectP( const Ray& ray, double* hitt0 = NULL, double* hitt1 = NULL ) const;
+	int IntersectP( const RayPacket& rays ) const;
 
 	Point3D pMin;
 	Point3D pMax;
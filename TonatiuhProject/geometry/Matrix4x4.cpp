@@ -54,7 +54,7 @@ Matrix4x4::Matrix4x4( )
 		}
 }
 
-Matrix4x4::Matrix4x4( double array[4][4] )
+Matrix4x4::Matrix4x4( const double array[4][4] )
 : RefCount()
 {
 	memcpy( m, array, 16*sizeof( double ) );
@@ -115,6 +115,36 @@ Ptr<Matrix4x4> Matrix4x4::Transpose( ) const
 }
 
 Ptr<Matrix4x4> Matrix4x4::Inverse( ) const
+{
+	double inverse[4][4];
+	::Inverse( m, inverse );
+	return new Matrix4x4( inverse );
+}
+
+Ptr<Matrix4x4> Mul( const Ptr<Matrix4x4>& m1, const Ptr<Matrix4x4>& m2 )
+{
+	double r[4][4];
+	Mul( m1->m, m2->m, r );
+	return new Matrix4x4(r);
+}
+
+/*!
+ * Stores in \a result the product of \a m1 and \a m2. \a result can not be \a m1 or \a m2.
+ */
+void Mul( const double m1[4][4], const double m2[4][4], double result[4][4] )
+{
+	for( int i = 0; i < 4; ++i )
+		for( int j = 0; j < 4; ++j )
+			result[i][j] = m1[i][0] * m2[0][j] +
+			               m1[i][1] * m2[1][j] +
+			               m1[i][2] * m2[2][j] +
+			               m1[i][3] * m2[3][j];
+}
+
+/*!
+ * Stores in \a inverse the inverse of the matrix \a m. \a inverse can be \a m.
+ */
+void Inverse( const double m[4][4], double inverse[4][4] )
 {
 	double det = m[0][1]*m[1][3]*m[2][2]*m[3][0] - m[0][1]*m[1][2]*m[2][3]*m[3][0] - m[0][0]*m[1][3]*m[2][2]*m[3][1] + m[0][0]*m[1][2]*m[2][3]*m[3][1]
                 -m[0][1]*m[1][3]*m[2][0]*m[3][2] + m[0][0]*m[1][3]*m[2][1]*m[3][2] + m[0][1]*m[1][0]*m[2][3]*m[3][2] - m[0][0]*m[1][1]*m[2][3]*m[3][2]
@@ -142,19 +172,10 @@ Ptr<Matrix4x4> Matrix4x4::Inverse( ) const
 	double inv32 = (  m[0][2]*m[1][1]*m[3][0] - m[0][1]*m[1][2]*m[3][0] - m[0][2]*m[1][0]*m[3][1] + m[0][0]*m[1][2]*m[3][1] + m[0][1]*m[1][0]*m[3][2] - m[0][0]*m[1][1]*m[3][2] )*alpha;
 	double inv33 = ( -m[0][2]*m[1][1]*m[2][0] + m[0][1]*m[1][2]*m[2][0] + m[0][2]*m[1][0]*m[2][1] - m[0][0]*m[1][2]*m[2][1] - m[0][1]*m[1][0]*m[2][2] + m[0][0]*m[1][1]*m[2][2] )*alpha;
 
-	return new Matrix4x4( inv00, inv01, inv02, inv03, inv10, inv11, inv12, inv13, inv20, inv21, inv22, inv23, inv30, inv31, inv32, inv33 );
-}
-
-Ptr<Matrix4x4> Mul( const Ptr<Matrix4x4>& m1, const Ptr<Matrix4x4>& m2 )
-{
-	double r[4][4];
-	for( int i = 0; i < 4; ++i )
-		for( int j = 0; j < 4; ++j )
-			r[i][j] = m1->m[i][0] * m2->m[0][j] +
-			          m1->m[i][1] * m2->m[1][j] +
-			          m1->m[i][2] * m2->m[2][j] +
-			          m1->m[i][3] * m2->m[3][j];
-	return new Matrix4x4(r);
+	inverse[0][0] = inv00; inverse[0][1] = inv01; inverse[0][2] = inv02; inverse[0][3] = inv03;
+	inverse[1][0] = inv10; inverse[1][1] = inv11; inverse[1][2] = inv12; inverse[1][3] = inv13;
+	inverse[2][0] = inv20; inverse[2][1] = inv21; inverse[2][2] = inv22; inverse[2][3] = inv23;
+	inverse[3][0] = inv30; inverse[3][1] = inv31; inverse[3][2] = inv32; inverse[3][3] = inv33;
 }
 
 std::ostream& operator<<( std::ostream& os, const Matrix4x4& matrix )
@@ -48,7 +48,7 @@ class Matrix4x4 : public RefCount
 {
 public:
 	Matrix4x4( );
-	Matrix4x4( double array[4][4] );
+	Matrix4x4( const double array[4][4] );
 	Matrix4x4( double t00, double t01, double t02, double t03,
 	           double t10, double t11, double t12, double t13,
 	           double t20, double t21, double t22, double t23,
@@ -65,6 +65,8 @@ public:
 };
 
 Ptr<Matrix4x4> Mul( const Ptr<Matrix4x4>& m1, const Ptr<Matrix4x4>& m2 );
+void Mul( const double m1[4][4], const double m2[4][4], double result[4][4] );
+void Inverse( const double m[4][4], double inverse[4][4] );
 std::ostream& operator<<( std::ostream& os, const Matrix4x4& matrix );
 
 
@@ -0,0 +1,120 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef RAYPACKET_H_
+#define RAYPACKET_H_
+
+#include "gc.h"
+#include "Ray.h"
+
+//!  RayPacket struct stores a group of rays traced together.
+/*!
+  The rays are stored as structure of arrays, so the packet kernels of BBox, Transform and the shapes
+  process four rays with each AVX2 instruction. The lanes that do not hold a ray have their maxt lower
+  than their mint, so they never intersect anything.
+*/
+
+struct RayPacket
+{
+	enum { Size = 8 };
+
+	RayPacket() : nRays( 0 )
+	{
+		for( int i = 0; i < Size; ++i )	Deactivate( i );
+	}
+
+	void SetRay( int index, const Ray& ray )
+	{
+		originX[index] = ray.origin.x;
+		originY[index] = ray.origin.y;
+		originZ[index] = ray.origin.z;
+		directionX[index] = ray.direction().x;
+		directionY[index] = ray.direction().y;
+		directionZ[index] = ray.direction().z;
+		invDirectionX[index] = ray.invDirection().x;
+		invDirectionY[index] = ray.invDirection().y;
+		invDirectionZ[index] = ray.invDirection().z;
+		mint[index] = ray.mint;
+		maxt[index] = ray.maxt;
+	}
+
+	Ray GetRay( int index ) const
+	{
+		return Ray( Point3D( originX[index], originY[index], originZ[index] ),
+				Vector3D( directionX[index], directionY[index], directionZ[index] ),
+				mint[index], maxt[index] );
+	}
+
+	void Deactivate( int index )
+	{
+		originX[index] = originY[index] = originZ[index] = 0.0;
+		directionX[index] = directionY[index] = directionZ[index] = 1.0;
+		invDirectionX[index] = invDirectionY[index] = invDirectionZ[index] = 1.0;
+		mint[index] = gc::Infinity;
+		maxt[index] = -gc::Infinity;
+	}
+
+	bool IsActive( int index ) const
+	{
+		return ( mint[index] <= maxt[index] );
+	}
+
+	int ActiveMask() const
+	{
+		int mask = 0;
+		for( int i = 0; i < Size; ++i )
+			if( IsActive( i ) )	mask |= ( 1 << i );
+		return mask;
+	}
+
+	double originX[Size];
+	double originY[Size];
+	double originZ[Size];
+	double directionX[Size];
+	double directionY[Size];
+	double directionZ[Size];
+	double invDirectionX[Size];
+	double invDirectionY[Size];
+	double invDirectionZ[Size];
+	mutable double mint[Size];
+	mutable double maxt[Size];
+	int nRays;
+};
+
+#endif /* RAYPACKET_H_ */
@@ -36,38 +36,55 @@ Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimen
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include <cstring>
+
 #include "gc.h"
 
 #include "BBox.h"
 #include "NormalVector.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "Transform.h"
 
+/*!
+ * Creates the identity transform.
+ */
 Transform::Transform()
-: m_mdir(0), m_minv(0)
 {
+	for( int i = 0; i < 4; ++i )
+		for( int j = 0; j < 4; ++j )
+		{
+			if( i == j ) m_mdir[i][j] = 1.0;
+			else m_mdir[i][j] = 0.0;
+			m_minv[i][j] = m_mdir[i][j];
+		}
+}
 
+Transform::Transform( const double mat[4][4] )
+{
+	memcpy( m_mdir, mat, 16*sizeof( double ) );
+	Inverse( m_mdir, m_minv );
 }
 
-Transform::Transform( double mat[4][4] )
+/*!
+ * Creates a transform with matrix \a mdir and inverse matrix \a minv. \a minv must be the inverse of \a mdir.
+ */
+Transform::Transform( const double mdir[4][4], const double minv[4][4] )
 {
-	m_mdir = new Matrix4x4( mat[0][0],mat[0][1],mat[0][2],mat[0][3],
-	               	        mat[1][0],mat[1][1],mat[1][2],mat[1][3],
-	               	        mat[2][0],mat[2][1],mat[2][2],mat[2][3],
-	               	        mat[3][0],mat[3][1],mat[3][2],mat[3][3] );
-	m_minv = m_mdir->Inverse();
+	memcpy( m_mdir, mdir, 16*sizeof( double ) );
+	memcpy( m_minv, minv, 16*sizeof( double ) );
 }
 
 Transform::Transform( const Ptr<Matrix4x4>& mdir )
-: m_mdir(mdir)
 {
-	m_minv = m_mdir->Inverse();
+	memcpy( m_mdir, mdir->m, 16*sizeof( double ) );
+	Inverse( m_mdir, m_minv );
 }
 
 Transform::Transform( const Ptr<Matrix4x4>& mdir, const Ptr<Matrix4x4>& minv )
-: m_mdir(mdir), m_minv(minv)
 {
-
+	memcpy( m_mdir, mdir->m, 16*sizeof( double ) );
+	memcpy( m_minv, minv->m, 16*sizeof( double ) );
 }
 
 Transform::Transform( double t00, double t01, double t02, double t03,
@@ -75,20 +92,20 @@ Transform::Transform( double t00, double t01, double t02, double t03,
 	                  double t20, double t21, double t22, double t23,
 	                  double t30, double t31, double t32, double t33 )
 {
-	m_mdir = new Matrix4x4( t00, t01, t02, t03,
-	                        t10, t11, t12, t13,
-	                        t20, t21, t22, t23,
-	                        t30, t31, t32, t33 );
-	m_minv = m_mdir->Inverse();
+	m_mdir[0][0] = t00; m_mdir[0][1] = t01; m_mdir[0][2] = t02; m_mdir[0][3] = t03;
+	m_mdir[1][0] = t10; m_mdir[1][1] = t11; m_mdir[1][2] = t12; m_mdir[1][3] = t13;
+	m_mdir[2][0] = t20; m_mdir[2][1] = t21; m_mdir[2][2] = t22; m_mdir[2][3] = t23;
+	m_mdir[3][0] = t30; m_mdir[3][1] = t31; m_mdir[3][2] = t32; m_mdir[3][3] = t33;
+	Inverse( m_mdir, m_minv );
 
 }
 
 Point3D Transform::operator()( const Point3D& point ) const
 {
-	double xp = m_mdir->m[0][0]*point.x + m_mdir->m[0][1]*point.y + m_mdir->m[0][2]*point.z + m_mdir->m[0][3];
-	double yp = m_mdir->m[1][0]*point.x + m_mdir->m[1][1]*point.y + m_mdir->m[1][2]*point.z + m_mdir->m[1][3];
-	double zp = m_mdir->m[2][0]*point.x + m_mdir->m[2][1]*point.y + m_mdir->m[2][2]*point.z + m_mdir->m[2][3];
-	double wp = m_mdir->m[3][0]*point.x + m_mdir->m[3][1]*point.y + m_mdir->m[3][2]*point.z + m_mdir->m[3][3];
+	double xp = m_mdir[0][0]*point.x + m_mdir[0][1]*point.y + m_mdir[0][2]*point.z + m_mdir[0][3];
+	double yp = m_mdir[1][0]*point.x + m_mdir[1][1]*point.y + m_mdir[1][2]*point.z + m_mdir[1][3];
+	double zp = m_mdir[2][0]*point.x + m_mdir[2][1]*point.y + m_mdir[2][2]*point.z + m_mdir[2][3];
+	double wp = m_mdir[3][0]*point.x + m_mdir[3][1]*point.y + m_mdir[3][2]*point.z + m_mdir[3][3];
 
 	if( wp == 1.0 ) return Point3D( xp, yp, zp );
 	else return Point3D( xp, yp, zp )/wp;
@@ -97,40 +114,40 @@ Point3D Transform::operator()( const Point3D& point ) const
 
 void Transform::operator()( const Point3D& point, Point3D& transformedPoint ) const
 {
-	transformedPoint.x = m_mdir->m[0][0]*point.x + m_mdir->m[0][1]*point.y + m_mdir->m[0][2]*point.z + m_mdir->m[0][3];
-	transformedPoint.y = m_mdir->m[1][0]*point.x + m_mdir->m[1][1]*point.y + m_mdir->m[1][2]*point.z + m_mdir->m[1][3];
-	transformedPoint.z = m_mdir->m[2][0]*point.x + m_mdir->m[2][1]*point.y + m_mdir->m[2][2]*point.z + m_mdir->m[2][3];
-	double transformedW = m_mdir->m[3][0]*point.x + m_mdir->m[3][1]*point.y + m_mdir->m[3][2]*point.z + m_mdir->m[3][3];
+	transformedPoint.x = m_mdir[0][0]*point.x + m_mdir[0][1]*point.y + m_mdir[0][2]*point.z + m_mdir[0][3];
+	transformedPoint.y = m_mdir[1][0]*point.x + m_mdir[1][1]*point.y + m_mdir[1][2]*point.z + m_mdir[1][3];
+	transformedPoint.z = m_mdir[2][0]*point.x + m_mdir[2][1]*point.y + m_mdir[2][2]*point.z + m_mdir[2][3];
+	double transformedW = m_mdir[3][0]*point.x + m_mdir[3][1]*point.y + m_mdir[3][2]*point.z + m_mdir[3][3];
 
 	if( transformedW != 1.0 ) transformedPoint /= transformedW;
 }
 
 Vector3D Transform::operator()( const Vector3D& vector ) const
 {
-	return Vector3D( m_mdir->m[0][0]*vector.x + m_mdir->m[0][1]*vector.y + m_mdir->m[0][2]*vector.z,
-			         m_mdir->m[1][0]*vector.x + m_mdir->m[1][1]*vector.y + m_mdir->m[1][2]*vector.z,
-			         m_mdir->m[2][0]*vector.x + m_mdir->m[2][1]*vector.y + m_mdir->m[2][2]*vector.z );
+	return Vector3D( m_mdir[0][0]*vector.x + m_mdir[0][1]*vector.y + m_mdir[0][2]*vector.z,
+			         m_mdir[1][0]*vector.x + m_mdir[1][1]*vector.y + m_mdir[1][2]*vector.z,
+			         m_mdir[2][0]*vector.x + m_mdir[2][1]*vector.y + m_mdir[2][2]*vector.z );
 }
 
 void Transform::operator()( const Vector3D& vector, Vector3D& transformedVector ) const
 {
-	transformedVector.x = m_mdir->m[0][0]*vector.x + m_mdir->m[0][1]*vector.y + m_mdir->m[0][2]*vector.z;
-	transformedVector.y = m_mdir->m[1][0]*vector.x + m_mdir->m[1][1]*vector.y + m_mdir->m[1][2]*vector.z;
-	transformedVector.z = m_mdir->m[2][0]*vector.x + m_mdir->m[2][1]*vector.y + m_mdir->m[2][2]*vector.z;
+	transformedVector.x = m_mdir[0][0]*vector.x + m_mdir[0][1]*vector.y + m_mdir[0][2]*vector.z;
+	transformedVector.y = m_mdir[1][0]*vector.x + m_mdir[1][1]*vector.y + m_mdir[1][2]*vector.z;
+	transformedVector.z = m_mdir[2][0]*vector.x + m_mdir[2][1]*vector.y + m_mdir[2][2]*vector.z;
 }
 
 NormalVector Transform::operator()( const NormalVector& normal ) const
 {
-	return NormalVector( m_minv->m[0][0]*normal.x + m_minv->m[1][0]*normal.y + m_minv->m[2][0]*normal.z,
-                         m_minv->m[0][1]*normal.x + m_minv->m[1][1]*normal.y + m_minv->m[2][1]*normal.z,
-                         m_minv->m[0][2]*normal.x + m_minv->m[1][2]*normal.y + m_minv->m[2][2]*normal.z );
+	return NormalVector( m_minv[0][0]*normal.x + m_minv[1][0]*normal.y + m_minv[2][0]*normal.z,
+                         m_minv[0][1]*normal.x + m_minv[1][1]*normal.y + m_minv[2][1]*normal.z,
+                         m_minv[0][2]*normal.x + m_minv[1][2]*normal.y + m_minv[2][2]*normal.z );
 }
 
 void Transform::operator()( const NormalVector& normal, NormalVector& transformedNormal ) const
 {
-	transformedNormal.x = m_minv->m[0][0]*normal.x + m_minv->m[1][0]*normal.y + m_minv->m[2][0]*normal.z;
-	transformedNormal.y = m_minv->m[0][1]*normal.x + m_minv->m[1][1]*normal.y + m_minv->m[2][1]*normal.z;
-	transformedNormal.z = m_minv->m[0][2]*normal.x + m_minv->m[1][2]*normal.y + m_minv->m[2][2]*normal.z;
+	transformedNormal.x = m_minv[0][0]*normal.x + m_minv[1][0]*normal.y + m_minv[2][0]*normal.z;
+	transformedNormal.y = m_minv[0][1]*normal.x + m_minv[1][1]*normal.y + m_minv[2][1]*normal.z;
+	transformedNormal.z = m_minv[0][2]*normal.x + m_minv[1][2]*normal.y + m_minv[2][2]*normal.z;
 }
 
 Ray Transform::operator()( const Ray& ray ) const
@@ -155,6 +172,49 @@ void Transform::operator()( const Ray& ray, Ray& transformedRay ) const
 	transformedRay.maxt = ray.maxt;
 }
 
+/*!
+ * Transforms the rays of \a rays to \a transformedRays. Each ray is transformed as Transform::operator()( const Ray& ).
+ *
+ * The loops have no dependencies between rays, so the compiler vectorizes them.
+ */
+void Transform::operator()( const RayPacket& rays, RayPacket& transformedRays ) const
+{
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		double x = rays.originX[i];
+		double y = rays.originY[i];
+		double z = rays.originZ[i];
+		transformedRays.originX[i] = m_mdir[0][0]*x + m_mdir[0][1]*y + m_mdir[0][2]*z + m_mdir[0][3];
+		transformedRays.originY[i] = m_mdir[1][0]*x + m_mdir[1][1]*y + m_mdir[1][2]*z + m_mdir[1][3];
+		transformedRays.originZ[i] = m_mdir[2][0]*x + m_mdir[2][1]*y + m_mdir[2][2]*z + m_mdir[2][3];
+		double w = m_mdir[3][0]*x + m_mdir[3][1]*y + m_mdir[3][2]*z + m_mdir[3][3];
+		if( w != 1.0 )
+		{
+			double invW = 1.0/w;
+			transformedRays.originX[i] *= invW;
+			transformedRays.originY[i] *= invW;
+			transformedRays.originZ[i] *= invW;
+		}
+	}
+
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		double x = rays.directionX[i];
+		double y = rays.directionY[i];
+		double z = rays.directionZ[i];
+		transformedRays.directionX[i] = m_mdir[0][0]*x + m_mdir[0][1]*y + m_mdir[0][2]*z;
+		transformedRays.directionY[i] = m_mdir[1][0]*x + m_mdir[1][1]*y + m_mdir[1][2]*z;
+		transformedRays.directionZ[i] = m_mdir[2][0]*x + m_mdir[2][1]*y + m_mdir[2][2]*z;
+		transformedRays.invDirectionX[i] = 1.0/transformedRays.directionX[i];
+		transformedRays.invDirectionY[i] = 1.0/transformedRays.directionY[i];
+		transformedRays.invDirectionZ[i] = 1.0/transformedRays.directionZ[i];
+		transformedRays.mint[i] = rays.mint[i];
+		transformedRays.maxt[i] = rays.maxt[i];
+	}
+
+	transformedRays.nRays = rays.nRays;
+}
+
 BBox Transform::operator()( const BBox& bbox  ) const
 {
 	const Transform& M = *this;
@@ -184,30 +244,32 @@ void Transform::operator()( const BBox& bbox, BBox& transformedBbox  ) const
 
 Transform Transform::operator*( const Transform& rhs ) const
 {
-	Ptr<Matrix4x4> mdir = Mul( m_mdir, rhs.m_mdir );
-	Ptr<Matrix4x4> minv = Mul( rhs.m_minv, m_minv );
+	double mdir[4][4];
+	double minv[4][4];
+	Mul( m_mdir, rhs.m_mdir, mdir );
+	Mul( rhs.m_minv, m_minv, minv );
 	return Transform( mdir, minv );
 }
 
 bool Transform::operator==( const Transform& tran ) const
 {
 	if( this == &tran ) return true;
-    else return( ( fabs(m_mdir->m[0][0] - tran.m_mdir->m[0][0]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[0][1] - tran.m_mdir->m[0][1]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[0][2] - tran.m_mdir->m[0][2]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[0][3] - tran.m_mdir->m[0][3]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[1][0] - tran.m_mdir->m[1][0]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[1][1] - tran.m_mdir->m[1][1]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[1][2] - tran.m_mdir->m[1][2]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[1][3] - tran.m_mdir->m[1][3]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[2][0] - tran.m_mdir->m[2][0]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[2][1] - tran.m_mdir->m[2][1]) < gc::Epsilon ) &&
-			     ( fabs(m_mdir->m[2][2] - tran.m_mdir->m[2][2]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[2][3] - tran.m_mdir->m[2][3]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[3][0] - tran.m_mdir->m[3][0]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[3][1] - tran.m_mdir->m[3][1]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[3][2] - tran.m_mdir->m[3][2]) < gc::Epsilon ) &&
-				 ( fabs(m_mdir->m[3][3] - tran.m_mdir->m[3][3]) < gc::Epsilon ) );
+    else return( ( fabs(m_mdir[0][0] - tran.m_mdir[0][0]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[0][1] - tran.m_mdir[0][1]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[0][2] - tran.m_mdir[0][2]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[0][3] - tran.m_mdir[0][3]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[1][0] - tran.m_mdir[1][0]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[1][1] - tran.m_mdir[1][1]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[1][2] - tran.m_mdir[1][2]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[1][3] - tran.m_mdir[1][3]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[2][0] - tran.m_mdir[2][0]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[2][1] - tran.m_mdir[2][1]) < gc::Epsilon ) &&
+			     ( fabs(m_mdir[2][2] - tran.m_mdir[2][2]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[2][3] - tran.m_mdir[2][3]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[3][0] - tran.m_mdir[3][0]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[3][1] - tran.m_mdir[3][1]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[3][2] - tran.m_mdir[3][2]) < gc::Epsilon ) &&
+				 ( fabs(m_mdir[3][3] - tran.m_mdir[3][3]) < gc::Epsilon ) );
 }
 
 Transform Transform::GetInverse() const
@@ -217,7 +279,14 @@ Transform Transform::GetInverse() const
 
 Transform Transform::Transpose() const
 {
-	return Transform( m_mdir->Transpose(), m_mdir->Transpose()->Inverse() );
+	double mdir[4][4];
+	for( int i = 0; i < 4; ++i )
+		for( int j = 0; j < 4; ++j )
+			mdir[i][j] = m_mdir[j][i];
+
+	double minv[4][4];
+	Inverse( mdir, minv );
+	return Transform( mdir, minv );
 }
 
 
@@ -228,10 +297,10 @@ Vector3D Transform::multVecMatrix(const Vector3D & src) const
   // also code comments at the start of SbMatrix::multRight().
   //if (SbMatrixP::isIdentity(this->matrix)) { dst = src; return dst; }
 
-  const double * t0 = (m_mdir->m)[0];
-  const double * t1 = (m_mdir->m)[1];
-  const double * t2 = (m_mdir->m)[2];
-  const double * t3 = (m_mdir->m)[3];
+  const double * t0 = m_mdir[0];
+  const double * t1 = m_mdir[1];
+  const double * t2 = m_mdir[2];
+  const double * t3 = m_mdir[3];
 
   double W = src[0]*t3[0] + src[1]*t3[1] + src[2]*t3[2] + t3[3];
 
@@ -252,9 +321,9 @@ Vector3D Transform::multDirMatrix(const Vector3D & src) const
   //if (SbMatrixP::isIdentity(this->matrix)) { dst = src; return dst; }
 
 
-  const double * t0 = (m_mdir->m)[0];
-  const double * t1 = (m_mdir->m)[1];
-  const double * t2 = (m_mdir->m)[2];
+  const double * t0 = m_mdir[0];
+  const double * t1 = m_mdir[1];
+  const double * t2 = m_mdir[2];
   // Copy the src vector, just in case src and dst is the same vector.
   dst[0] = src[0]*t0[0] + src[1]*t0[1] + src[2]*t0[2];
   dst[1] = src[0]*t1[0] + src[1]*t1[1] + src[2]*t1[2];
@@ -264,60 +333,60 @@ Vector3D Transform::multDirMatrix(const Vector3D & src) const
 }
 bool Transform::SwapsHandedness( ) const
 {
-	double det = ( ( m_mdir->m[0][0] *
-	                   ( m_mdir->m[1][1] * m_mdir->m[2][2] -
-	                     m_mdir->m[1][2] * m_mdir->m[2][1] ) ) -
-                   ( m_mdir->m[0][1] *
-                       ( m_mdir->m[1][0] * m_mdir->m[2][2] -
-                         m_mdir->m[1][2] * m_mdir->m[2][0] ) ) +
-                   ( m_mdir->m[0][2] *
-                       ( m_mdir->m[1][0] * m_mdir->m[2][1] -
-                         m_mdir->m[1][1] * m_mdir->m[2][0] ) ) );
+	double det = ( ( m_mdir[0][0] *
+	                   ( m_mdir[1][1] * m_mdir[2][2] -
+	                     m_mdir[1][2] * m_mdir[2][1] ) ) -
+                   ( m_mdir[0][1] *
+                       ( m_mdir[1][0] * m_mdir[2][2] -
+                         m_mdir[1][2] * m_mdir[2][0] ) ) +
+                   ( m_mdir[0][2] *
+                       ( m_mdir[1][0] * m_mdir[2][1] -
+                         m_mdir[1][1] * m_mdir[2][0] ) ) );
 	return det < 0.0;
 }
 
 
 Transform Translate( const Vector3D& delta )
 {
-	Ptr<Matrix4x4> mdir = new Matrix4x4(   1.0,   0.0,   0.0,  delta.x,
-                                           0.0,   1.0,   0.0,  delta.y,
-                                           0.0,   0.0,   1.0,  delta.z,
-                                           0.0,   0.0,   0.0,      1.0  );
+	double mdir[4][4] = { { 1.0,   0.0,   0.0,  delta.x },
+	                      { 0.0,   1.0,   0.0,  delta.y },
+	                      { 0.0,   0.0,   1.0,  delta.z },
+	                      { 0.0,   0.0,   0.0,      1.0 } };
 
-	Ptr<Matrix4x4> minv = new Matrix4x4(   1.0,   0.0,   0.0, -delta.x,
-                                           0.0,   1.0,   0.0, -delta.y,
-                                           0.0,   0.0,   1.0, -delta.z,
-                                           0.0,   0.0,   0.0,      1.0  );
+	double minv[4][4] = { { 1.0,   0.0,   0.0, -delta.x },
+	                      { 0.0,   1.0,   0.0, -delta.y },
+	                      { 0.0,   0.0,   1.0, -delta.z },
+	                      { 0.0,   0.0,   0.0,      1.0 } };
 
 	return Transform( mdir, minv );
 }
 
 Transform Translate( double x, double y, double z)
 {
-	Ptr<Matrix4x4> mdir = new Matrix4x4(   1.0,   0.0,   0.0,   x,
-                                           0.0,   1.0,   0.0,   y,
-                                           0.0,   0.0,   1.0,   z,
-                                           0.0,   0.0,   0.0, 1.0 );
+	double mdir[4][4] = { { 1.0,   0.0,   0.0,   x },
+	                      { 0.0,   1.0,   0.0,   y },
+	                      { 0.0,   0.0,   1.0,   z },
+	                      { 0.0,   0.0,   0.0, 1.0 } };
 
-	Ptr<Matrix4x4> minv = new Matrix4x4(   1.0,   0.0,   0.0,   -x,
-                                           0.0,   1.0,   0.0,   -y,
-                                           0.0,   0.0,   1.0,   -z,
-                                           0.0,   0.0,   0.0,  1.0 );
+	double minv[4][4] = { { 1.0,   0.0,   0.0,  -x },
+	                      { 0.0,   1.0,   0.0,  -y },
+	                      { 0.0,   0.0,   1.0,  -z },
+	                      { 0.0,   0.0,   0.0, 1.0 } };
 
 	return Transform( mdir, minv );
 }
 
 Transform Scale( double sx, double sy, double sz )
 {
-	Ptr<Matrix4x4> mdir = new Matrix4x4(    sx,     0.0,    0.0,  0.0,
-                                           0.0,      sy,    0.0,  0.0,
-                                           0.0,     0.0,     sz,  0.0,
-                                           0.0,     0.0,    0.0,  1.0 );
+	double mdir[4][4] = { {  sx,     0.0,    0.0,  0.0 },
+	                      { 0.0,      sy,    0.0,  0.0 },
+	                      { 0.0,     0.0,     sz,  0.0 },
+	                      { 0.0,     0.0,    0.0,  1.0 } };
 
-	Ptr<Matrix4x4> minv = new Matrix4x4( 1.0/sx,    0.0,    0.0,  0.0,
-                                            0.0, 1.0/sy,    0.0,  0.0,
-                                            0.0,    0.0, 1.0/sz,  0.0,
-                                            0.0,    0.0,    0.0,  1.0 );
+	double minv[4][4] = { { 1.0/sx,    0.0,    0.0,  0.0 },
+	                      {    0.0, 1.0/sy,    0.0,  0.0 },
+	                      {    0.0,    0.0, 1.0/sz,  0.0 },
+	                      {    0.0,    0.0,    0.0,  1.0 } };
 
 	return Transform( mdir, minv );
 }
@@ -328,12 +397,17 @@ Transform RotateX( double angle )
 	double sinAngle = sin( angle );
 	double cosAngle = cos( angle );
 
-	Ptr<Matrix4x4> mdir = new Matrix4x4( 1.0,      0.0,       0.0, 0.0,
-                                         0.0, cosAngle, -sinAngle, 0.0,
-                                         0.0, sinAngle,  cosAngle, 0.0,
-                                         0.0,      0.0,       0.0, 1.0  );
+	double mdir[4][4] = { { 1.0,      0.0,       0.0, 0.0 },
+	                      { 0.0, cosAngle, -sinAngle, 0.0 },
+	                      { 0.0, sinAngle,  cosAngle, 0.0 },
+	                      { 0.0,      0.0,       0.0, 1.0 } };
 
-	return Transform( mdir, mdir->Transpose() );
+	double minv[4][4] = { { 1.0,       0.0,      0.0, 0.0 },
+	                      { 0.0,  cosAngle, sinAngle, 0.0 },
+	                      { 0.0, -sinAngle, cosAngle, 0.0 },
+	                      { 0.0,       0.0,      0.0, 1.0 } };
+
+	return Transform( mdir, minv );
 }
 
 Transform RotateY(double angle)
@@ -342,12 +416,17 @@ Transform RotateY(double angle)
 	double sinAngle = sin( angle );
 	double cosAngle = cos( angle );
 
-	Ptr<Matrix4x4> mdir = new Matrix4x4( cosAngle, 0.0, sinAngle, 0.0,
-                                              0.0, 1.0,      0.0, 0.0,
-                                        -sinAngle, 0.0, cosAngle, 0.0,
-                                              0.0, 0.0,      0.0, 1.0  );
+	double mdir[4][4] = { {  cosAngle, 0.0, sinAngle, 0.0 },
+	                      {       0.0, 1.0,      0.0, 0.0 },
+	                      { -sinAngle, 0.0, cosAngle, 0.0 },
+	                      {       0.0, 0.0,      0.0, 1.0 } };
 
-	return Transform( mdir, mdir->Transpose() );
+	double minv[4][4] = { { cosAngle, 0.0, -sinAngle, 0.0 },
+	                      {      0.0, 1.0,       0.0, 0.0 },
+	                      { sinAngle, 0.0,  cosAngle, 0.0 },
+	                      {      0.0, 0.0,       0.0, 1.0 } };
+
+	return Transform( mdir, minv );
 }
 
 
@@ -357,12 +436,17 @@ Transform RotateZ( double angle )
 	double sinAngle = sin( angle );
 	double cosAngle = cos( angle );
 
-	Ptr<Matrix4x4> mdir = new Matrix4x4( cosAngle, -sinAngle, 0.0, 0.0,
-                                         sinAngle,  cosAngle, 0.0, 0.0,
-                                              0.0,       0.0, 1.0, 0.0,
-                                              0.0,       0.0, 0.0, 1.0 );
+	double mdir[4][4] = { { cosAngle, -sinAngle, 0.0, 0.0 },
+	                      { sinAngle,  cosAngle, 0.0, 0.0 },
+	                      {      0.0,       0.0, 1.0, 0.0 },
+	                      {      0.0,       0.0, 0.0, 1.0 } };
+
+	double minv[4][4] = { {  cosAngle, sinAngle, 0.0, 0.0 },
+	                      { -sinAngle, cosAngle, 0.0, 0.0 },
+	                      {       0.0,      0.0, 1.0, 0.0 },
+	                      {       0.0,      0.0, 0.0, 1.0 } };
 
-	return Transform( mdir, mdir->Transpose() );
+	return Transform( mdir, minv );
 }
 
 Transform Rotate( double angle, const Vector3D& axis )
@@ -393,8 +477,12 @@ Transform Rotate( double angle, const Vector3D& axis )
 	m[3][2] = 0.0;
 	m[3][3] = 1.0;
 
-	Ptr<Matrix4x4> mdir = new Matrix4x4( m );
-	return Transform( mdir, mdir->Transpose() );
+	double mt[4][4];
+	for( int i = 0; i < 4; ++i )
+		for( int j = 0; j < 4; ++j )
+			mt[i][j] = m[j][i];
+
+	return Transform( m, mt );
 }
 
 Transform LookAt( const Point3D& pos, const Point3D& look, const Vector3D& up )
@@ -424,8 +512,30 @@ Transform LookAt( const Point3D& pos, const Point3D& look, const Vector3D& up )
 	m[2][2] = newUp.z;
 	m[3][2] = 0.0;
 
-	Ptr<Matrix4x4> camToWorld = new Matrix4x4( m );
-	return Transform( camToWorld->Inverse(), camToWorld );
+	double worldToCam[4][4];
+	Inverse( m, worldToCam );
+	return Transform( worldToCam, m );
+}
+
+/*!
+ * Returns the transform from world coordinates to the coordinates of the orthonormal basis with axes \a s, \a r and \a t.
+ *
+ * The inverse of the basis matrix is its transpose, so no matrix is inverted. For the normals, the transform and its inverse
+ * only use the basis matrix, so the axes do not need to be exactly orthogonal to transform normal vectors.
+ */
+Transform OrthonormalBasis( const Vector3D& s, const Vector3D& r, const Vector3D& t )
+{
+	double mdir[4][4] = { { s.x, s.y, s.z, 0.0 },
+	                      { r.x, r.y, r.z, 0.0 },
+	                      { t.x, t.y, t.z, 0.0 },
+	                      { 0.0, 0.0, 0.0, 1.0 } };
+
+	double minv[4][4] = { { s.x, r.x, t.x, 0.0 },
+	                      { s.y, r.y, t.y, 0.0 },
+	                      { s.z, r.z, t.z, 0.0 },
+	                      { 0.0, 0.0, 0.0, 1.0 } };
+
+	return Transform( mdir, minv );
 }
 
 std::ostream& operator<<( std::ostream& os, const Transform& tran )
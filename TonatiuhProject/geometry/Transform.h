@@ -49,13 +49,20 @@ struct Point3D;
 struct Vector3D;
 struct NormalVector;
 class Ray;
+struct RayPacket;
 struct BBox;
 
+//!  Transform class represents an affine transformation and its inverse.
+/*!
+  The matrices are stored in the transform, so transforms are created and copied without allocating memory
+  and can be shared between the ray tracing threads.
+*/
 class Transform
 {
 public:
 	Transform( );
-	Transform( double mat[4][4] );
+	Transform( const double mat[4][4] );
+	Transform( const double mdir[4][4], const double minv[4][4] );
 	Transform( const Ptr<Matrix4x4>& mdir );
 	Transform( const Ptr<Matrix4x4>& mdir,  const Ptr<Matrix4x4>& minv );
 	Transform( double t00, double t01, double t02, double t03,
@@ -71,13 +78,15 @@ public:
 	void operator()( const NormalVector& normal, NormalVector& transformedNormal ) const;
 	Ray operator()( const Ray& ray ) const;
 	void operator()( const Ray& ray, Ray& transformedRay ) const;
+	void operator()( const RayPacket& rays, RayPacket& transformedRays ) const;
 	BBox operator()( const BBox& bbox  ) const;
 	void operator()( const BBox& bbox, BBox& transformedBbox  ) const;
 	Transform operator*( const Transform& rhs ) const;
 
 	bool operator==( const Transform& mat ) const;
 
-	Ptr<Matrix4x4> GetMatrix() const {return m_mdir;}
+	Ptr<Matrix4x4> GetMatrix() const {return new Matrix4x4( m_mdir );}
+	double GetMatrixValue( int row, int column ) const {return m_mdir[row][column];}
 	Transform Transpose() const;
 	Transform GetInverse() const ;
 	bool SwapsHandedness( ) const;
@@ -85,8 +94,8 @@ public:
 	Vector3D multDirMatrix(const Vector3D & src) const;
 
 private:
-	Ptr<Matrix4x4> m_mdir;
-	Ptr<Matrix4x4> m_minv;
+	double m_mdir[4][4];
+	double m_minv[4][4];
 };
 
 Transform Translate( const Vector3D& delta );
@@ -97,6 +106,7 @@ Transform RotateY( double angle );
 Transform RotateZ( double angle );
 Transform Rotate( double angle, const Vector3D& axis );
 Transform LookAt( const Point3D& pos, const Point3D& look, const Vector3D& up );
+Transform OrthonormalBasis( const Vector3D& s, const Vector3D& r, const Vector3D& t );
 
 std::ostream& operator<<( std::ostream& os, const Transform& tran );
 
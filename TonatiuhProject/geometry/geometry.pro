@@ -19,6 +19,15 @@ else {
 
 TARGET = geometry   
 
+avx2 {
+	win32-msvc*{
+		QMAKE_CXXFLAGS += /arch:AVX2
+	}
+	else{
+		QMAKE_CXXFLAGS += -mavx2
+	}
+}
+
 DEPENDPATH += . \
                 $$(TONATIUH_ROOT)
 
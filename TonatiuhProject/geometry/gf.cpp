@@ -40,6 +40,10 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <iostream>
 #include <stdlib.h>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "gc.h"
 #include "gf.h"
 
@@ -76,3 +80,45 @@ bool gf::Quadratic( double A, double B, double C, double *t0, double *t1)
 	if(*t0 > *t1) std::swap( *t0, *t1 );
 	return true;
 }
+
+/*!
+ * Solves the \a nEquations quadratic equations A[i]*t*t + B[i]*t + C[i] = 0 as Quadratic( double, double, double, double*, double* ).
+ *
+ * Returns a mask with the bit of each equation with real roots set. The roots are stored in \a t0[i] and \a t1[i].
+ * \a nEquations must not be greater than 32.
+ */
+int gf::Quadratic( const double* A, const double* B, const double* C, int nEquations, double* t0, double* t1 )
+{
+	int solvedMask = 0;
+	int i = 0;
+
+#ifdef __AVX2__
+	for( ; i + 4 <= nEquations; i += 4 )
+	{
+		__m256d a = _mm256_loadu_pd( A + i );
+		__m256d b = _mm256_loadu_pd( B + i );
+		__m256d c = _mm256_loadu_pd( C + i );
+
+		__m256d discrim = _mm256_sub_pd( _mm256_mul_pd( b, b ), _mm256_mul_pd( _mm256_mul_pd( _mm256_set1_pd( 4.0 ), a ), c ) );
+		__m256d noRoots = _mm256_cmp_pd( discrim, _mm256_setzero_pd(), _CMP_LT_OQ );
+		__m256d rootDiscrim = _mm256_sqrt_pd( discrim );
+
+		__m256d negativeB = _mm256_cmp_pd( b, _mm256_setzero_pd(), _CMP_LT_OQ );
+		__m256d q = _mm256_mul_pd( _mm256_set1_pd( -0.5 ),
+				_mm256_blendv_pd( _mm256_add_pd( b, rootDiscrim ), _mm256_sub_pd( b, rootDiscrim ), negativeB ) );
+		__m256d root0 = _mm256_div_pd( q, a );
+		__m256d root1 = _mm256_div_pd( c, q );
+
+		__m256d swap = _mm256_cmp_pd( root0, root1, _CMP_GT_OQ );
+		_mm256_storeu_pd( t0 + i, _mm256_blendv_pd( root0, root1, swap ) );
+		_mm256_storeu_pd( t1 + i, _mm256_blendv_pd( root1, root0, swap ) );
+
+		solvedMask |= ( ~_mm256_movemask_pd( noRoots ) & 0xF ) << i;
+	}
+#endif
+
+	for( ; i < nEquations; ++i )
+		if( Quadratic( A[i], B[i], C[i], t0 + i, t1 + i ) )	solvedMask |= ( 1 << i );
+
+	return solvedMask;
+}
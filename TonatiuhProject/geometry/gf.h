@@ -47,6 +47,7 @@ namespace gf
     void Warning( std::string warningMessage );
     bool IsOdd( int number );
     bool Quadratic( double A, double B, double C, double* t0, double* t1);
+    int Quadratic( const double* A, const double* B, const double* C, int nEquations, double* t0, double* t1 );
 }
 
 #endif /*GF_H_*/
@@ -300,8 +300,18 @@ TSeparatorKit* ComponentHeliostatField::CreateField()
 	heliostatsNodeSeparator->setName( "Heliostatos" );
 	heliostatsNodeSeparator->ref();
 
-	CreateHeliostatZones( hCenterList, heliostatsNodeSeparator, heliostatTrackerFactory, shapeFactory, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
+	//The heliostats share the same shape node, unless its radius depends on the heliostat aiming point
+	TShape* heliostatShape = 0;
+	if( ( heliostat == 2 ) &&
+			!( ( shapeFactory->TShapeName() == QString( "Spherical_rectangle" ) ) && ( heliostatRadius < 0.0 ) ) )
+	{
+		heliostatShape = CreateHeliostatShape( shapeFactory, heliostatWidth, heliostatHeight, heliostatRadius );
+		heliostatShape->ref();
+	}
+
+	CreateHeliostatZones( hCenterList, heliostatsNodeSeparator, heliostatTrackerFactory, shapeFactory, heliostatShape, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
 			materialNode, aimingPointList, 1 );
+	if( heliostatShape ) heliostatShape->unref();
 
 	return heliostatsNodeSeparator;
 
@@ -580,8 +590,18 @@ TSeparatorKit* ComponentHeliostatField::CreateField(QVector< QVariant >  argumen
 	heliostatsNodeSeparator->setName( "Heliostats" );
 	heliostatsNodeSeparator->ref();
 
-	CreateHeliostatZones( hCenterList, heliostatsNodeSeparator, heliostatTrackerFactory, shapeFactory, heliostat, heliostatComponentNode, heliostatWidth, heliostatHeight, heliostatRadius,
+	//The heliostats share the same shape node, unless its radius depends on the heliostat aiming point
+	TShape* heliostatShape = 0;
+	if( ( heliostat == 2 ) &&
+			!( ( shapeFactory->TShapeName() == QString( "Spherical_rectangle" ) ) && ( heliostatRadius < 0.0 ) ) )
+	{
+		heliostatShape = CreateHeliostatShape( shapeFactory, heliostatWidth, heliostatHeight, heliostatRadius );
+		heliostatShape->ref();
+	}
+
+	CreateHeliostatZones( hCenterList, heliostatsNodeSeparator, heliostatTrackerFactory, shapeFactory, heliostatShape, heliostat, heliostatComponentNode, heliostatWidth, heliostatHeight, heliostatRadius,
 			materialNode, aimingPointList, 1 );
+	if( heliostatShape ) heliostatShape->unref();
 
 	return heliostatsNodeSeparator;
 }
@@ -590,6 +610,7 @@ TSeparatorKit* ComponentHeliostatField::CreateField(QVector< QVariant >  argumen
 void ComponentHeliostatField::CreateHeliostatZones( std::vector< Point3D >  heliostatCenterList, TSeparatorKit* parentNode,
 		TTrackerFactory* heliostatTrackerFactory,
 		TShapeFactory* heliostatShapeFactory,
+		TShape* heliostatShape,
 		int heliostat,
 		TSeparatorKit* heliostatComponent,
 		double heliostatWidth,
@@ -648,31 +669,10 @@ void ComponentHeliostatField::CreateHeliostatZones( std::vector< Point3D >  heli
 				TShapeKit* heliostatSurface = static_cast< TShapeKit* > ( shapeKitType.createInstance() );
 				heliostaTrackerNodetPartList->addChild(heliostatSurface);
 
-				TShape* shape = heliostatShapeFactory->CreateTShape();
-
-				if( heliostatShapeFactory->TShapeName() == QString( "Spherical_rectangle" ) )
-				{
-					trt::TONATIUH_REAL* hRadiusField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "radius" ) );
-
-					if( heliostatRadius < 0.0 )
-						hRadiusField->setValue(  2* Distance( aimingPointList[nHeliostat], hCenter ) );
-					else
-						hRadiusField->setValue(  heliostatRadius );
-
-					trt::TONATIUH_REAL* widthXField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "widthX" ) );
-					widthXField->setValue(  heliostatWidth );
-
-					trt::TONATIUH_REAL* widthZField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "widthZ" ) );
-					widthZField->setValue(  heliostatHeight );
-				}
-				else if( heliostatShapeFactory->TShapeName() == QString( "Flat_Rectangle" ) )
-				{
-					trt::TONATIUH_REAL* widthXField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "width" ) );
-					widthXField->setValue(  heliostatWidth );
-
-					trt::TONATIUH_REAL* widthZField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "height" ) );
-					widthZField->setValue(  heliostatHeight );
-				}
+				TShape* shape = heliostatShape;
+				if( !shape )
+					shape = CreateHeliostatShape( heliostatShapeFactory, heliostatWidth, heliostatHeight,
+							2* Distance( aimingPointList[nHeliostat], hCenter ) );
 
 				heliostatSurface->setPart("shape", shape);
 				heliostatSurface->setPart("material", materialNode );
@@ -728,9 +728,9 @@ void ComponentHeliostatField::CreateHeliostatZones( std::vector< Point3D >  heli
 				aimingPointListPart2.push_back( coordsAndAimingPoint[position].second );
 				position++;
 			}
-			CreateHeliostatZones( hCenterListPart1, heliostatSeparator1, heliostatTrackerFactory, heliostatShapeFactory, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
+			CreateHeliostatZones( hCenterListPart1, heliostatSeparator1, heliostatTrackerFactory, heliostatShapeFactory, heliostatShape, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
 					materialNode, aimingPointListPart1, 1 );
-			CreateHeliostatZones( hCenterListPart2, heliostatSeparator2, heliostatTrackerFactory, heliostatShapeFactory, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
+			CreateHeliostatZones( hCenterListPart2, heliostatSeparator2, heliostatTrackerFactory, heliostatShapeFactory, heliostatShape, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
 					materialNode, aimingPointListPart2, 1 );
 		}
 		else
@@ -765,14 +765,48 @@ void ComponentHeliostatField::CreateHeliostatZones( std::vector< Point3D >  heli
 				aimingPointListPart2.push_back( coordsAndAimingPoint[position].second );
 				position++;
 			}
-			CreateHeliostatZones( hCenterListPart1, heliostatSeparator1, heliostatTrackerFactory, heliostatShapeFactory, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
+			CreateHeliostatZones( hCenterListPart1, heliostatSeparator1, heliostatTrackerFactory, heliostatShapeFactory, heliostatShape, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
 					materialNode, aimingPointListPart1, 3 );
-			CreateHeliostatZones( hCenterListPart2, heliostatSeparator2, heliostatTrackerFactory, heliostatShapeFactory, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
+			CreateHeliostatZones( hCenterListPart2, heliostatSeparator2, heliostatTrackerFactory, heliostatShapeFactory, heliostatShape, heliostat, heliostatComponent, heliostatWidth, heliostatHeight, heliostatRadius,
 					materialNode, aimingPointListPart2, 3 );
 		}
 	}
 }
 
+/*!
+ * Creates a new heliostat shape node with \a heliostatShapeFactory and
+ * sets its dimensions to \a heliostatWidth, \a heliostatHeight and \a heliostatRadius.
+ */
+TShape* ComponentHeliostatField::CreateHeliostatShape( TShapeFactory* heliostatShapeFactory,
+		double heliostatWidth,
+		double heliostatHeight,
+		double heliostatRadius )
+{
+	TShape* shape = heliostatShapeFactory->CreateTShape();
+
+	if( heliostatShapeFactory->TShapeName() == QString( "Spherical_rectangle" ) )
+	{
+		trt::TONATIUH_REAL* hRadiusField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "radius" ) );
+		hRadiusField->setValue(  heliostatRadius );
+
+		trt::TONATIUH_REAL* widthXField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "widthX" ) );
+		widthXField->setValue(  heliostatWidth );
+
+		trt::TONATIUH_REAL* widthZField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "widthZ" ) );
+		widthZField->setValue(  heliostatHeight );
+	}
+	else if( heliostatShapeFactory->TShapeName() == QString( "Flat_Rectangle" ) )
+	{
+		trt::TONATIUH_REAL* widthXField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "width" ) );
+		widthXField->setValue(  heliostatWidth );
+
+		trt::TONATIUH_REAL* widthZField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "height" ) );
+		widthZField->setValue(  heliostatHeight );
+	}
+
+	return shape;
+}
+
 TSeparatorKit* ComponentHeliostatField::OpenHeliostatComponent( QString fileName )
 {
 	if ( fileName.isEmpty() ) return 0;
@@ -47,6 +47,7 @@ class Point3D;
 class QString;
 class SoNode;
 class TSeparatorKit;
+class TShape;
 class TShapeFactory;
 class TMaterial;
 class TTrackerFactory;
@@ -66,6 +67,7 @@ private:
 			TSeparatorKit* parentNode,
 			TTrackerFactory* heliostatTrackerFactory,
 			TShapeFactory* heliostatShaperFactory,
+			TShape* heliostatShape,
 			int heliostat,
 			TSeparatorKit* heliostatComponent,
 			double heliostatWidth,
@@ -75,6 +77,10 @@ private:
 			std::vector< Point3D > aimingPointList,
 			int eje );
 
+	TShape* CreateHeliostatShape( TShapeFactory* heliostatShapeFactory,
+			double heliostatWidth,
+			double heliostatHeight,
+			double heliostatRadius );
 	TSeparatorKit* OpenHeliostatComponent( QString fileName );
 
 	PluginManager* m_pPluginManager;
@@ -315,10 +315,7 @@ Ray MaterialAngleDependentRefractive::ReflectedRay( const Ray& incident, Differe
 		Vector3D r = dgNormal;
 		Vector3D s = Normalize( dg->dpdu );
 		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
+		Transform trasform = OrthonormalBasis( s, r, t );
 
 		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
 		normalVector = Normalize( normalDirection );
@@ -170,10 +170,7 @@ bool MaterialStandardRoughSpecular::OutputRay( const Ray& incident, Differential
 		Vector3D r = dg->normal;
 		Vector3D s = Normalize( dg->dpdu );
 		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-							r.x, r.y, r.z, 0.0,
-							t.x, t.y, t.z, 0.0,
-							0.0, 0.0, 0.0, 1.0);
+		Transform trasform = OrthonormalBasis( s, r, t );
 
 		normalVector = trasform.GetInverse()( errorNormal );
 	}
@@ -198,10 +195,7 @@ bool MaterialStandardRoughSpecular::OutputRay( const Ray& incident, Differential
 		Vector3D r = outputRay->direction();
 		Vector3D s = Normalize( CrossProduct( outputRay->direction(), dg->normal ) );
 		Vector3D t = Normalize( CrossProduct( outputRay->direction(), s ) );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
+		Transform trasform = OrthonormalBasis( s, r, t );
 
 		Vector3D errorReflectedRayDirection = trasform.GetInverse()( errorReflectedRay );
 		outputRay->setDirection( errorReflectedRayDirection );
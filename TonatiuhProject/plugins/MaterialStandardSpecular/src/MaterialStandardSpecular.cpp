@@ -191,10 +191,7 @@ bool MaterialStandardSpecular::OutputRay( const Ray& incident, DifferentialGeome
 		Vector3D r = dg->normal;
 		Vector3D s = Normalize( dg->dpdu );
 		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
+		Transform trasform = OrthonormalBasis( s, r, t );
 
 		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
 		normalVector = Normalize( normalDirection );
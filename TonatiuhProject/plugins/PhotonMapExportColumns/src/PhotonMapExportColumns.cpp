@@ -0,0 +1,281 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <iostream>
+
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include "InstanceNode.h"
+#include "PhotonMapColumnsWriter.h"
+#include "PhotonMapExportColumns.h"
+#include "tgf.h"
+
+/*!
+ * Creates export object to export photon map photons to a columnar file.
+ */
+PhotonMapExportColumns::PhotonMapExportColumns()
+:PhotonMapExport(),
+ m_exportDirectoryName( QLatin1String( "" ) ),
+ m_photonsFilename( QLatin1String( "PhotonMap" ) ),
+ m_chunkSize( 262144 ),
+ m_compress( true ),
+ m_floatCoordinates( false ),
+ m_powerPerPhoton( 0.0 ),
+ m_exportedPhotons( 0 ),
+ m_pExportFile( 0 ),
+ m_pWriter( 0 )
+{
+
+}
+
+/*!
+ * Destroys export object
+ */
+PhotonMapExportColumns::~PhotonMapExportColumns()
+{
+	CloseFile();
+}
+
+/*!
+ * Returns the plugin parameters names.
+ */
+QStringList PhotonMapExportColumns::GetParameterNames()
+{
+	QStringList parametersNames;
+	parametersNames<<QLatin1String( "ExportDirectory" );
+	parametersNames<<QLatin1String( "ExportFile" );
+	parametersNames<<QLatin1String( "ChunkSize" );
+	parametersNames<<QLatin1String( "Compression" );
+	parametersNames<<QLatin1String( "CoordinatesPrecision" );
+
+	return parametersNames;
+}
+
+/*!
+ * Writes the photons pending to complete a chunk and saves the parameters file.
+ */
+void PhotonMapExportColumns::EndExport()
+{
+	if( m_pWriter )	m_pWriter->Flush();
+	CloseFile();
+
+	WriteParametersFile();
+}
+
+/*!
+ * Saves \a raysLists photons to file.
+ */
+void PhotonMapExportColumns::SavePhotonMap( const std::vector< Photon >& raysLists )
+{
+	if( !OpenFile() ) return;
+
+	double values[PhotonMapColumns::NumberOfColumns];
+	values[PhotonMapColumns::PreviousId] = 0.0;
+
+	unsigned long nPhotons = raysLists.size();
+	for( unsigned long i = 0; i < nPhotons; ++i )
+	{
+		const Photon& photon = raysLists[i];
+		unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+
+		values[PhotonMapColumns::Id] = double( ++m_exportedPhotons );
+		if( photon.id < 1 )	values[PhotonMapColumns::PreviousId] = 0.0;
+
+		Point3D pos = m_saveCoordinatesInGlobal ? m_concentratorToWorld( photon.pos ) :
+				m_surfaceIdentifier.GetWorldToObject( urlId )( photon.pos );
+		values[PhotonMapColumns::X] = pos.x;
+		values[PhotonMapColumns::Y] = pos.y;
+		values[PhotonMapColumns::Z] = pos.z;
+
+		values[PhotonMapColumns::Side] = double( photon.side );
+
+		if( ( i < nPhotons - 1 ) && ( raysLists[i+1].id > 0 ) )
+			values[PhotonMapColumns::NextId] = double( m_exportedPhotons + 1 );
+		else
+			values[PhotonMapColumns::NextId] = 0.0;
+
+		values[PhotonMapColumns::SurfaceId] = double( urlId );
+
+		m_pWriter->AddPhoton( values );
+		values[PhotonMapColumns::PreviousId] = double( m_exportedPhotons );
+	}
+}
+
+/*!
+ *	Sets the current power per photon.
+ */
+void PhotonMapExportColumns::SetPowerPerPhoton( double wPhoton )
+{
+	m_powerPerPhoton = wPhoton;
+}
+
+/*!
+ * Sets to parameter \a parameterName the value \a parameterValue.
+ */
+void PhotonMapExportColumns::SetSaveParameterValue( QString parameterName, QString parameterValue )
+{
+	QStringList parameters = GetParameterNames();
+
+	//Directory name
+	if( parameterName == parameters[0] )
+		m_exportDirectoryName = parameterValue;
+
+	//File name
+	else if( parameterName == parameters[1] )
+		m_photonsFilename = parameterValue;
+
+	//Number of photons of each chunk
+	else if( parameterName == parameters[2] )
+	{
+		if( parameterValue.toDouble() >= 1 )	m_chunkSize = ( unsigned long ) parameterValue.toDouble();
+	}
+
+	//Compression of the column blocks: "zlib" or "None"
+	else if( parameterName == parameters[3] )
+		m_compress = ( parameterValue != QLatin1String( "None" ) );
+
+	//Coordinates precision: "Double" or "Float"
+	else if( parameterName == parameters[4] )
+		m_floatCoordinates = ( parameterValue == QLatin1String( "Float" ) );
+}
+
+/*!
+ * Deletes the files that can be used to export and the surface identifiers of a previous export.
+ */
+bool PhotonMapExportColumns::StartExport()
+{
+	if( m_exportedPhotons < 1  )
+	{
+		RemoveExistingFiles();
+		m_surfaceIdentifier.Clear();
+	}
+	return 1;
+}
+
+/*!
+ * Closes the photons file.
+ */
+void PhotonMapExportColumns::CloseFile()
+{
+	delete m_pWriter;
+	m_pWriter = 0;
+
+	if( !m_pExportFile ) return;
+	m_pExportFile->close();
+	delete m_pExportFile;
+	m_pExportFile = 0;
+}
+
+/*!
+ * Opens the photons file and creates the writer for the selected columns.
+ * The file is kept open until the export ends.
+ *
+ * Returns false if the file cannot be opened.
+ */
+bool PhotonMapExportColumns::OpenFile()
+{
+	if( m_pWriter ) return true;
+
+	QDir exportDirectory( m_exportDirectoryName );
+	QString exportFilename = exportDirectory.absoluteFilePath( QString( QLatin1String( "%1.tpmc" ) ).arg( m_photonsFilename ) );
+
+	m_pExportFile = new QFile( exportFilename );
+	if( !m_pExportFile->open( QIODevice::Append ) )
+	{
+		std::cerr<<"Error opening "<<exportFilename.toStdString()<<std::endl;
+		delete m_pExportFile;
+		m_pExportFile = 0;
+		return false;
+	}
+
+	unsigned int columnsMask = 1 << PhotonMapColumns::Id;
+	if( m_saveCoordinates )
+		columnsMask |= ( 1 << PhotonMapColumns::X ) | ( 1 << PhotonMapColumns::Y ) | ( 1 << PhotonMapColumns::Z );
+	if( m_saveSide )	columnsMask |= 1 << PhotonMapColumns::Side;
+	if( m_savePrevNexID )	columnsMask |= ( 1 << PhotonMapColumns::PreviousId ) | ( 1 << PhotonMapColumns::NextId );
+	if( m_saveSurfaceID )	columnsMask |= 1 << PhotonMapColumns::SurfaceId;
+
+	m_pWriter = new PhotonMapColumnsWriter( m_pExportFile, columnsMask, m_chunkSize, m_floatCoordinates, m_compress );
+	if( m_pExportFile->size() == 0 )	m_pWriter->WriteHeader();
+	return true;
+}
+
+/*!
+ * Removes the photons file of a previous export.
+ */
+void PhotonMapExportColumns::RemoveExistingFiles()
+{
+	QDir exportDirectory( m_exportDirectoryName );
+	QString exportFilename = exportDirectory.absoluteFilePath( QString( QLatin1String( "%1.tpmc" ) ).arg( m_photonsFilename ) );
+
+	QFile exportFile( exportFilename );
+	if( exportFile.exists() && !exportFile.remove() )
+	{
+		QString message= QString( "Error deleting %1.\nThe file is in use. Please, close it before continuing. \n" ).arg( exportFilename );
+		tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
+		RemoveExistingFiles();
+	}
+}
+
+/*!
+ * Writes the parameters file with the exported surfaces and the power per photon.
+ */
+void PhotonMapExportColumns::WriteParametersFile()
+{
+	QDir exportDirectory( m_exportDirectoryName );
+	QString parametersFilename = exportDirectory.absoluteFilePath( QString( QLatin1String( "%1_parameters.txt" ) ).arg( m_photonsFilename ) );
+
+	QFile parametersFile( parametersFilename );
+	if( !parametersFile.open( QIODevice::WriteOnly ) ) return;
+
+	QTextStream out( &parametersFile );
+	out<<QString( QLatin1String( "FORMAT columns\n" ) );
+
+	out<<QString( QLatin1String( "START SURFACES\n" ) );
+	for( int s = 1; s <= m_surfaceIdentifier.GetNumberOfSurfaces(); s++ )
+	{
+		QString surfaceURL = m_surfaceIdentifier.GetSurface( s )->GetNodeURL();
+		out<<QString( QLatin1String( "%1 %2\n" ) ).arg( QString::number( s ), surfaceURL );
+	}
+	out<<QString( QLatin1String( "END SURFACES\n" ) );
+
+	out<<double( m_powerPerPhoton );
+}
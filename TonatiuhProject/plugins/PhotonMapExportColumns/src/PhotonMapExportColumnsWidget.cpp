@@ -0,0 +1,139 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QSettings>
+
+#include "PhotonMapExportColumns.h"
+#include "PhotonMapExportColumnsWidget.h"
+
+/*!
+ * Creates a widget for the plugin parameters.
+ */
+PhotonMapExportColumnsWidget::PhotonMapExportColumnsWidget( QWidget* parent )
+:PhotonMapExportParametersWidget( parent)
+{
+	setupUi( this );
+	SetupTriggers();
+
+}
+
+/*!
+ * Destroys widget object.
+ */
+PhotonMapExportColumnsWidget::~PhotonMapExportColumnsWidget()
+{
+
+}
+
+/*!
+ * Returns the plugin parameters names.
+ */
+QStringList PhotonMapExportColumnsWidget::GetParameterNames() const
+{
+	return PhotonMapExportColumns::GetParameterNames();
+}
+
+/*!
+ * Returns the value of the parameter \a parameter.
+ */
+QString PhotonMapExportColumnsWidget::GetParameterValue( QString parameter ) const
+{
+	QStringList parametersName = GetParameterNames();
+
+	//Directory name
+	if( parameter == parametersName[0] )
+		return saveDirectoryLine->text();
+
+	//File name.
+	else if( parameter == parametersName[1] )
+		return filenameLine->text();
+
+	//Number of photons of each chunk.
+	else if( parameter == parametersName[2] )
+		return QString::number( chunkSizeSpin->value() );
+
+	//Compression of the column blocks.
+	else if( parameter == parametersName[3] )
+	{
+		if( compressionCheck->isChecked() )	return QLatin1String( "zlib" );
+		else	return QLatin1String( "None" );
+	}
+
+	//Coordinates precision.
+	else if( parameter == parametersName[4] )
+	{
+		if( floatCoordinatesCheck->isChecked() )	return QLatin1String( "Float" );
+		else	return QLatin1String( "Double" );
+	}
+
+	return QString();
+}
+
+/*!
+ * Select existing directory to save the data exported from the photon.
+ */
+void PhotonMapExportColumnsWidget::SelectSaveDirectory()
+{
+	QSettings settings( QLatin1String( "NREL UTB CENER" ), QLatin1String( "Tonatiuh" ) );
+	QString lastUsedDirectory = settings.value( QLatin1String( "PhotonMapExportColumnsWidget.directoryToExport" ),
+			QLatin1String( "." ) ).toString();
+
+	QString directoryToExport = QFileDialog::getExistingDirectory ( this, tr( "Save Directory" ), lastUsedDirectory );
+	if( directoryToExport.isEmpty() )	return;
+
+	QDir dirToExport( directoryToExport );
+	if( !dirToExport.exists() )
+	{
+		QMessageBox::information( this, QLatin1String( "Tonatiuh" ), tr( "Selected directory is not valid." ), 1 );
+		return;
+	}
+
+	settings.setValue( QLatin1String( "PhotonMapExportColumnsWidget.directoryToExport" ), directoryToExport );
+	saveDirectoryLine->setText( directoryToExport );
+}
+
+/*!
+ * Setups triggers for the buttons.
+ */
+void PhotonMapExportColumnsWidget::SetupTriggers()
+{
+	connect( selectDirectoryButton, SIGNAL( clicked() ), this, SLOT( SelectSaveDirectory() ) );
+}
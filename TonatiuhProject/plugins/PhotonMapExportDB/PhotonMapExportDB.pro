@@ -17,6 +17,7 @@ HEADERS = src/*.h  \
             $$(TONATIUH_ROOT)/src/source/gui/InstanceNode.h \
 			$$(TONATIUH_ROOT)/src/source/gui/PathWrapper.h \
             $$(TONATIUH_ROOT)/src/source/gui/PhotonMapExport.h \
+            $$(TONATIUH_ROOT)/src/source/gui/PhotonMapSurfaceIdentifier.h \
             $$(TONATIUH_ROOT)/src/source/gui/PhotonMapExportFactory.h \
             $$(TONATIUH_ROOT)/src/source/gui/PhotonMapExportParametersWidget.h\
 			$$(TONATIUH_ROOT)/src/source/gui/SceneModel.h \
@@ -47,6 +48,7 @@ SOURCES = src/*.cpp  \
             $$(TONATIUH_ROOT)/src/source/gui/InstanceNode.cpp \
 			$$(TONATIUH_ROOT)/src/source/gui/PathWrapper.cpp \
             $$(TONATIUH_ROOT)/src/source/gui/PhotonMapExport.cpp \
+            $$(TONATIUH_ROOT)/src/source/gui/PhotonMapSurfaceIdentifier.cpp \
             $$(TONATIUH_ROOT)/src/source/gui/PhotonMapExportParametersWidget.cpp \
 			$$(TONATIUH_ROOT)/src/source/gui/SceneModel.cpp \
             $$(TONATIUH_ROOT)/src/source/raytracing/Photon.cpp \
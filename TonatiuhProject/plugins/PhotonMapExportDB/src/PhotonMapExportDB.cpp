@@ -41,9 +41,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <string>
 #include <QDir>
 
-#include <QMessageBox>
-
 #include "PhotonMapExportDB.h"
+#include "tgf.h"
 
 /*!
  *Creates a photonmap export objcet to save the data into a SQL database
@@ -52,8 +51,13 @@ PhotonMapExportDB::PhotonMapExportDB()
 :PhotonMapExport(),
  m_exportedPhoton( 0 ),
  m_isDBOpened( false ),
+ m_isTransactionOpened( false ),
  m_isWPhoton( false ),
- m_pDB( 0 )
+ m_pDB( 0 ),
+ m_pInsertPhotonStmt( 0 ),
+ m_pInsertSurfaceStmt( 0 ),
+ m_photonsInTransaction( 0 ),
+ m_transactionSize( 1000000 )
 {
 
 }
@@ -76,11 +80,15 @@ void PhotonMapExportDB::EndExport()
 
 
 /*!
- * Opens database database.
+ * Opens database database. The files and the surface identifiers of a previous export are deleted first.
  */
 bool  PhotonMapExportDB::StartExport()
 {
-	if( m_exportedPhoton < 1  )	RemoveExistingFiles();
+	if( m_exportedPhoton < 1  )
+	{
+		RemoveExistingFiles();
+		m_surfaceIdentifier.Clear();
+	}
 	if( !m_isDBOpened )	return Open();
 
 	return 1;
@@ -91,23 +99,73 @@ QStringList PhotonMapExportDB::GetParameterNames()
 	QStringList parametersNames;
 	parametersNames<<QLatin1String( "ExportDirectory" );
 	parametersNames<<QLatin1String( "DBFilename" );
+	parametersNames<<QLatin1String( "TransactionSize" );
 
 	return parametersNames;
 }
 /*!
  * Saves \a rayLists data into the database.
+ *
+ * The photons are inserted with the statement prepared when the database was opened. A transaction
+ * is committed each time the transaction size is reached, the last one is committed when the database is closed.
  */
-void PhotonMapExportDB::SavePhotonMap( std::vector< Photon* > raysLists )
+void PhotonMapExportDB::SavePhotonMap( const std::vector< Photon >& raysLists )
 {
 
-	if( !m_isDBOpened )	Open();
+	if( !m_isDBOpened && !Open() )	return;
+	if( !m_isTransactionOpened && !BeginTransaction() )	return;
 
-	if( m_saveCoordinates && m_saveSide && m_savePrevNexID && m_saveSurfaceID )
-		SaveAllData( raysLists );
-	else if( m_saveCoordinates && m_saveSide && !m_savePrevNexID && m_saveSurfaceID )
-		SaveNotNextPrevID( raysLists );
-	else
-		SaveSelectedData( raysLists );
+	unsigned long nPhotonElements = raysLists.size();
+	sqlite3_int64 previousPhotonID = 0;
+
+	for( unsigned long i = 0; i < nPhotonElements; ++i )
+	{
+		const Photon& photon = raysLists[i];
+		if( photon.id < 1 )	previousPhotonID = 0;
+
+		unsigned long urlId = GetSurfaceID( photon.intersectedSurface );
+
+		int parameterIndex = 0;
+		sqlite3_bind_int64( m_pInsertPhotonStmt, ++parameterIndex, ++m_exportedPhoton );
+
+		if( m_saveCoordinates )
+		{
+			Point3D photonPos = m_saveCoordinatesInGlobal ?
+					m_concentratorToWorld( photon.pos ) :
+					m_surfaceIdentifier.GetWorldToObject( urlId )( photon.pos );
+			sqlite3_bind_double( m_pInsertPhotonStmt, ++parameterIndex, photonPos.x );
+			sqlite3_bind_double( m_pInsertPhotonStmt, ++parameterIndex, photonPos.y );
+			sqlite3_bind_double( m_pInsertPhotonStmt, ++parameterIndex, photonPos.z );
+		}
+
+		if( m_saveSide )
+			sqlite3_bind_int( m_pInsertPhotonStmt, ++parameterIndex, photon.side );
+
+		if( m_savePrevNexID )
+		{
+			sqlite3_int64 nextPhotonID = 0;
+			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1].id > 0  ) )
+				nextPhotonID = m_exportedPhoton + 1;
+			sqlite3_bind_int64( m_pInsertPhotonStmt, ++parameterIndex, previousPhotonID );
+			sqlite3_bind_int64( m_pInsertPhotonStmt, ++parameterIndex, nextPhotonID );
+		}
+
+		if( m_saveSurfaceID )
+			sqlite3_bind_int64( m_pInsertPhotonStmt, ++parameterIndex, urlId );
+
+		int rc = sqlite3_step( m_pInsertPhotonStmt );
+		sqlite3_reset( m_pInsertPhotonStmt );
+		if( rc != SQLITE_DONE )
+		{
+			std::cout<< "SQL error: "<<sqlite3_errmsg( m_pDB )<<"\n"<<std::endl;
+			return;
+		}
+
+		previousPhotonID = m_exportedPhoton;
+
+		if( ( m_transactionSize > 0 ) && ( ++m_photonsInTransaction >= m_transactionSize ) )
+			if( !CommitTransaction() || !BeginTransaction() )	return;
+	}
 
 }
 
@@ -135,7 +193,7 @@ void PhotonMapExportDB::SetPowerPerPhoton( double wPhoton )
 	{
 
 		QString message = QString( "SQL error: %1 .\n" ).arg( QString( zErrMsg ) );
-		QMessageBox::warning( 0, QLatin1String( "Tonatiuh" ), message );
+		tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 		sqlite3_free(zErrMsg);
 
 	}
@@ -151,10 +209,31 @@ void PhotonMapExportDB::SetSaveParameterValue( QString parameterName, QString pa
 				SetDBDirectory( parameterValue );
 	if( parameterName == QLatin1String( "DBFilename" ) )
 		SetDBFileName( parameterValue );
+	if( parameterName == QLatin1String( "TransactionSize" ) )
+		SetTransactionSize( parameterValue );
 
 
 }
 
+/*!
+ * Starts a new transaction.
+ */
+bool PhotonMapExportDB::BeginTransaction()
+{
+	char* sErrMsg = 0;
+	int rc = sqlite3_exec( m_pDB, "BEGIN TRANSACTION", 0, 0, &sErrMsg );
+	if( rc != SQLITE_OK )
+	{
+		std::cout<< "SQL error: "<<sErrMsg<<"\n"<<std::endl;
+		sqlite3_free( sErrMsg );
+		return 0;
+	}
+
+	m_isTransactionOpened = true;
+	m_photonsInTransaction = 0;
+	return 1;
+}
+
 /*!
  * Closes database.
  */
@@ -164,10 +243,13 @@ bool PhotonMapExportDB::Close()
     // Close the db
     try
     {
+    	if( m_isTransactionOpened )	CommitTransaction();
+    	FinalizeStatements();
+
     	if( sqlite3_close( m_pDB ) != SQLITE_OK )
     	{
         	QString message = QString( "Error closing database." );
-        	QMessageBox::warning( NULL, "Tonatiuh Action", message );
+        	tgf::ShowWarning( "Tonatiuh Action", message );
             return 0;
     	}
 
@@ -177,27 +259,61 @@ bool PhotonMapExportDB::Close()
     catch(std::exception&e)
     {
     	QString message = QString( "Error closing database:\n%1" ).arg( QString( e.what() ) );
-    	QMessageBox::warning( NULL, "Tonatiuh Action", message );
+    	tgf::ShowWarning( "Tonatiuh Action", message );
         return 0;
     }
     return 1;
 
 }
-void PhotonMapExportDB::InsertSurface( InstanceNode* instance )
+
+/*!
+ * Commits the current transaction.
+ */
+bool PhotonMapExportDB::CommitTransaction()
 {
-	m_surfaceIdentfier.push_back( instance );
-	m_surfaceWorldToObject.push_back( instance->GetIntersectionTransform() );
+	m_isTransactionOpened = false;
 
+	char* sErrMsg = 0;
+	int rc = sqlite3_exec( m_pDB, "END TRANSACTION", 0, 0, &sErrMsg );
+	if( rc != SQLITE_OK )
+	{
+		std::cout<< "SQL error: "<<sErrMsg<<"\n"<<std::endl;
+		sqlite3_free( sErrMsg );
+		return 0;
+	}
+	return 1;
+}
 
-	int surfaceID = m_surfaceIdentfier.size();
-	QString surfaceURL = QString(" ").append( instance->GetNodeURL() );
+/*!
+ * Finalizes the insert statements prepared by PrepareStatements.
+ */
+void PhotonMapExportDB::FinalizeStatements()
+{
+	sqlite3_finalize( m_pInsertPhotonStmt );
+	m_pInsertPhotonStmt = 0;
+	sqlite3_finalize( m_pInsertSurfaceStmt );
+	m_pInsertSurfaceStmt = 0;
+}
 
-	std::stringstream surfaces;
-	surfaces << "Insert into Surfaces values("
-			<< surfaceID << ",'"
-			<< surfaceURL.toStdString().c_str() <<"');";
-	char* sErrMsg = 0;
-	sqlite3_exec( m_pDB, surfaces.str().c_str(), 0, 0, &sErrMsg );
+/*!
+ * Returns the identifier of \a surface. The first time a surface is found it is inserted into the surfaces table.
+ */
+unsigned long PhotonMapExportDB::GetSurfaceID( InstanceNode* surface )
+{
+	bool isNewSurface = false;
+	unsigned long surfaceID = m_surfaceIdentifier.GetSurfaceID( surface, &isNewSurface );
+	if( isNewSurface )	InsertSurface( surfaceID, surface );
+	return surfaceID;
+}
+
+void PhotonMapExportDB::InsertSurface( unsigned long surfaceID, InstanceNode* instance )
+{
+	std::string surfaceURL = QString(" ").append( instance->GetNodeURL() ).toStdString();
+
+	sqlite3_bind_int64( m_pInsertSurfaceStmt, 1, surfaceID );
+	sqlite3_bind_text( m_pInsertSurfaceStmt, 2, surfaceURL.c_str(), -1, SQLITE_TRANSIENT );
+	sqlite3_step( m_pInsertSurfaceStmt );
+	sqlite3_reset( m_pInsertSurfaceStmt );
 
 }
 
@@ -219,7 +335,7 @@ bool PhotonMapExportDB::Open()
 		{
 			QString message = QString( "Error opening %1 file database.\n" ).arg( dbFilename );
 			message.append( QString( zErrMsg ) );
-			QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+			tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 			return 0;
 		}
 
@@ -247,7 +363,7 @@ bool PhotonMapExportDB::Open()
 			{
 				QString message( "Error creating photons table:\n " );
 				message.append( QString( zErrMsg ) );
-				QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+				tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 				sqlite3_free( zErrMsg );
 				return 0;
 			}
@@ -262,7 +378,7 @@ bool PhotonMapExportDB::Open()
 			{
 				QString message( "Error creating surfaces table:\n " );
 				message.append( QString( zErrMsg ) );
-				QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+				tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 				sqlite3_free( zErrMsg );
 				return 0;
 			}
@@ -276,17 +392,7 @@ bool PhotonMapExportDB::Open()
 			{
 				QString message( "Error creating wphoton table:\n " );
 				message.append( QString( zErrMsg ) );
-				QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
-				sqlite3_free( zErrMsg );
-				return 0;
-			}
-
-
-			rc = sqlite3_exec( m_pDB, "PRAGMA synchronous=OFF;", 0, 0, &zErrMsg );
-			if( rc != SQLITE_OK )
-			{
-				QString message = QString( "SQL error: %1\n%2" ).arg( QString( zErrMsg ) );
-				QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+				tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 				sqlite3_free( zErrMsg );
 				return 0;
 			}
@@ -294,369 +400,75 @@ bool PhotonMapExportDB::Open()
 		else
 			m_isWPhoton = true;
 
+		//The write ahead log keeps the commits of each transaction batch sequential. In this mode the normal
+		//synchronization only waits for the disk at the checkpoints, and a crash cannot corrupt the database.
+		rc = sqlite3_exec( m_pDB, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", 0, 0, &zErrMsg );
+		if( rc != SQLITE_OK )
+		{
+			QString message = QString( "SQL error: %1\n" ).arg( QString( zErrMsg ) );
+			tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
+			sqlite3_free( zErrMsg );
+			return 0;
+		}
+
+		if( !PrepareStatements() )	return 0;
+
 		m_isDBOpened = true;
 	}
 	catch( std::exception &e )
 	{
 		QString message = QString( "Error opening database:\n%2" ).arg( QString( e.what() ) );
-		QMessageBox::warning( NULL, "Tonatiuh Action", message );
+		tgf::ShowWarning( "Tonatiuh Action", message );
 		return 0;
 	}
 	return 1;
 }
 
-void PhotonMapExportDB::RemoveExistingFiles()
-{
-
-	QDir exportDirectory( m_dbDirectory );
-	QString filename = m_dbFileName;
-
-	QString exportFilename = exportDirectory.absoluteFilePath( filename.append( QLatin1String( ".db" ) ) );
-	QFile exportFile( exportFilename );
-
-	if(exportFile.exists() && !exportFile.remove() )
-	{
-		QString message= QString( "Error deleting database:%1.\n"
-				"The database is in use. Please, close it before continuing. \n" ).arg( exportFilename );
-		QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
-		RemoveExistingFiles();
-	}
-}
-
 /*!
- * Saves for each photon all the data.
+ * Prepares the statements to insert photons and surfaces. The photons statement has one parameter for each saved column.
  */
-void PhotonMapExportDB::SaveAllData( std::vector< Photon* > raysLists )
+bool PhotonMapExportDB::PrepareStatements()
 {
-
-	const char* tail = 0;
-	sqlite3_stmt* stmt;
-	char insertSQL[256] ="\0";
-	sprintf( insertSQL, "INSERT INTO Photons VALUES( @id, @x, @y, @z, @side, @prev, @next, @surfaceID )" );
-	sqlite3_prepare( m_pDB, insertSQL, 256, &stmt, &tail );
-
-	char* sErrMsg = 0;
-	sqlite3_exec( m_pDB, "BEGIN TRANSACTION", 0, 0, &sErrMsg );
-
-	unsigned long nPhotonElements = raysLists.size();
-	double previousPhotonID = 0;
-
-	if( m_saveCoordinatesInGlobal )
-	{
-		for( unsigned int i = 0; i < raysLists.size(); i++ )
-		{
-			Photon* photon = raysLists[i];
-			if( photon->id < 1 )	previousPhotonID = 0;
-
-			sqlite3_bind_text( stmt, 1, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveCoordinates
-			Point3D photonPos =  m_concentratorToWorld( photon->pos );
-			sqlite3_bind_text( stmt, 2, QString::number( photonPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 3, QString::number( photonPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 4, QString::number( photonPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSide
-			sqlite3_bind_text( stmt, 5, QString::number( photon->side ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_savePrevNexID
-			sqlite3_bind_text( stmt, 6, QString::number( previousPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			int nextPhotonID = 0;
-			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1]->id > 0  ) )
-				nextPhotonID = m_exportedPhoton +1;
-			sqlite3_bind_text( stmt, 7, QString::number( nextPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSurfaceID
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-					InsertSurface( photon->intersectedSurface );
-
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-
-			}
-			sqlite3_bind_text( stmt, 8, QString::number( urlId ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-
-			sqlite3_step( stmt );
-			sqlite3_clear_bindings( stmt );
-			sqlite3_reset( stmt );
-
-			previousPhotonID = m_exportedPhoton;
-		}
-	}
-	else
-	{
-		for( unsigned int i = 0; i < raysLists.size(); i++ )
-		{
-			std::stringstream ss;
-			Photon* photon = raysLists[i];
-			if( photon->id < 1 )	previousPhotonID = 0;
-
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-					0.0, 1.0, 0.0, 0.0,
-					0.0, 0.0, 1.0, 0.0,
-					0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
-
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-					InsertSurface( photon->intersectedSurface );
-
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-				worldToObject = m_surfaceWorldToObject[urlId];
-				urlId++;
-			}
-
-
-			sqlite3_bind_text( stmt, 1, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveCoordinates
-			Point3D photonPos = worldToObject(  photon->pos );
-			sqlite3_bind_text( stmt, 2, QString::number( photonPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 3, QString::number( photonPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 4, QString::number( photonPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSide
-			sqlite3_bind_text( stmt, 5, QString::number( photon->side ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_savePrevNexID
-			sqlite3_bind_text( stmt, 6, QString::number( previousPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			int nextPhotonID = 0;
-			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1]->id > 0  ) )
-				nextPhotonID = m_exportedPhoton +1;
-			sqlite3_bind_text( stmt, 7, QString::number( nextPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSurfaceID
-			sqlite3_bind_text( stmt, 8, QString::number( urlId ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-
-			sqlite3_step( stmt );
-			sqlite3_clear_bindings( stmt );
-			sqlite3_reset( stmt );
-			previousPhotonID = m_exportedPhoton;
-		}
-	}
-	int rc = sqlite3_exec( m_pDB, "END TRANSACTION", 0, 0, &sErrMsg );
-
-	sqlite3_finalize( stmt );
-	if( rc != SQLITE_OK )
-	{
-		std::cout<< "SQL error: "<<sErrMsg<<"\n"<<std::endl;
-		sqlite3_free( sErrMsg );
-	}
-}
-
-/*!
- * Saves for each photon all the data, except previous and next photon identifier.
- */
-void PhotonMapExportDB::SaveNotNextPrevID( std::vector< Photon* > raysLists )
-{
-
-	const char* tail = 0;
-	sqlite3_stmt* stmt;
-	char insertSQL[256] ="\0";
-	sprintf( insertSQL, "INSERT INTO Photons VALUES( @id, @x, @y, @z, @side, @surfaceID )" );
-	sqlite3_prepare( m_pDB, insertSQL, 256, &stmt, &tail );
-
-	char* sErrMsg = 0;
-	sqlite3_exec( m_pDB, "BEGIN TRANSACTION", 0, 0, &sErrMsg );
-
-	unsigned long nPhotonElements = raysLists.size();
-
-	if( m_saveCoordinatesInGlobal )
-	{
-
-		for( unsigned int i = 0; i < nPhotonElements; i++ )
-		{
-			Photon* photon = raysLists[i];
-
-
-			sqlite3_bind_text( stmt, 1, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveCoordinates
-			Point3D photonPos =  m_concentratorToWorld( photon->pos );
-			sqlite3_bind_text( stmt, 2, QString::number( photonPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 3, QString::number( photonPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 4, QString::number( photonPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSide
-			sqlite3_bind_text( stmt, 5, QString::number( photon->side ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSurfaceID
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-					InsertSurface( photon->intersectedSurface );
-
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-
-			}
-			sqlite3_bind_text( stmt, 6, QString::number( urlId ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-
-			sqlite3_step( stmt );
-			sqlite3_clear_bindings( stmt );
-			sqlite3_reset( stmt );
-		}
-	}
-	else
-	{
-		for( unsigned int i = 0; i < nPhotonElements; i++ )
-		{
-			std::stringstream ss;
-			Photon* photon = raysLists[i];
-
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-					0.0, 1.0, 0.0, 0.0,
-					0.0, 0.0, 1.0, 0.0,
-					0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
-
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-					InsertSurface( photon->intersectedSurface );
-
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-				worldToObject = m_surfaceWorldToObject[urlId];
-				urlId++;
-			}
-
-			sqlite3_bind_text( stmt, 1, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveCoordinates
-			Point3D localPos = worldToObject( photon->pos );
-			sqlite3_bind_text( stmt, 2, QString::number( localPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 3, QString::number( localPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, 4, QString::number( localPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSide
-			sqlite3_bind_text( stmt, 5, QString::number( photon->side ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			//m_saveSurfaceID
-			sqlite3_bind_text( stmt, 6, QString::number( urlId ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-
-			sqlite3_step( stmt );
-			sqlite3_clear_bindings( stmt );
-			sqlite3_reset( stmt );
-
-
-		}
-	}
-	int rc = sqlite3_exec( m_pDB, "END TRANSACTION", 0, 0, &sErrMsg );
-
-	sqlite3_finalize( stmt );
-	if( rc != SQLITE_OK )
-	{
-		std::cout<< "SQL error: "<<sErrMsg<<"\n"<<std::endl;
-		sqlite3_free( sErrMsg );
-	}
-}
-
-/*!
- * Saves for each photon the selected data.
- */
-void PhotonMapExportDB::SaveSelectedData( std::vector< Photon* > raysLists )
-{
-
-
-	const char* tail = 0;
-	sqlite3_stmt* stmt;
 	QString insertCommand( "INSERT INTO Photons VALUES( @id" );
 
 	if( m_saveCoordinates )	insertCommand.append( ", @x, @y, @z" );
 	if( m_saveSide )	insertCommand.append( ", @side" );
 	if( m_savePrevNexID )	insertCommand.append( ", @prev, @next" );
 	if( m_saveSurfaceID )	insertCommand.append( ", @surfaceID" );
-	insertCommand.append( ")" );
-
-	sqlite3_prepare( m_pDB, insertCommand.toStdString().c_str(), 256, &stmt, &tail );
-
-	char* sErrMsg = 0;
-	sqlite3_exec( m_pDB, "BEGIN TRANSACTION", 0, 0, &sErrMsg );
+	insertCommand.append( " )" );
 
-	unsigned long nPhotonElements = raysLists.size();
-	double previousPhotonID = 0;
-
-
-	for( unsigned int i = 0; i < raysLists.size(); i++ )
+	if( ( sqlite3_prepare_v2( m_pDB, insertCommand.toStdString().c_str(), -1, &m_pInsertPhotonStmt, 0 ) != SQLITE_OK ) ||
+		( sqlite3_prepare_v2( m_pDB, "INSERT INTO Surfaces VALUES( @id, @path )", -1, &m_pInsertSurfaceStmt, 0 ) != SQLITE_OK ) )
 	{
-		int parameterIndex = 0;
-		Photon* photon = raysLists[i];
-		if( photon->id < 1 )	previousPhotonID = 0;
-
-		unsigned long urlId = 0;
-		Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-				0.0, 1.0, 0.0, 0.0,
-				0.0, 0.0, 1.0, 0.0,
-				0.0, 0.0, 0.0, 1.0 );
-		if( photon->intersectedSurface )
-		{
-
-			if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				InsertSurface( photon->intersectedSurface );
-
-			urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-			worldToObject = m_surfaceWorldToObject[urlId];
-			urlId++;
-		}
-
-		sqlite3_bind_text( stmt, ++parameterIndex, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-		if( m_saveCoordinates && m_saveCoordinatesInGlobal )
-		{
-			Point3D photonPos =  m_concentratorToWorld( photon->pos );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-		}
-		else if( m_saveCoordinates && !m_saveCoordinatesInGlobal )
-		{
-			Point3D photonPos = worldToObject( photon->pos );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.x ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.y ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photonPos.z ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-		}
-
-		if( m_saveSide )
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( photon->side ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-		if( m_savePrevNexID )
-		{
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( previousPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-
-			int nextPhotonID = 0;
-			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1]->id > 0  ) )
-				nextPhotonID = m_exportedPhoton +1;
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( nextPhotonID ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
-		}
-
-		if( m_saveSurfaceID )
-			sqlite3_bind_text( stmt, ++parameterIndex, QString::number( urlId ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
+		QString message = QString( "Error preparing database statements:\n%1" ).arg( QString( sqlite3_errmsg( m_pDB ) ) );
+		tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
+		FinalizeStatements();
+		return 0;
+	}
 
-		sqlite3_bind_text( stmt, 1, QString::number(++m_exportedPhoton ).toStdString().c_str(), -1, SQLITE_TRANSIENT );
+	return 1;
+}
 
-		sqlite3_step( stmt );
-		sqlite3_clear_bindings( stmt );
-		sqlite3_reset( stmt );
+void PhotonMapExportDB::RemoveExistingFiles()
+{
 
-		previousPhotonID = m_exportedPhoton;
-	}
+	QDir exportDirectory( m_dbDirectory );
+	QString filename = m_dbFileName;
 
-	int rc = sqlite3_exec( m_pDB, "END TRANSACTION", 0, 0, &sErrMsg );
+	QString exportFilename = exportDirectory.absoluteFilePath( filename.append( QLatin1String( ".db" ) ) );
+	QFile exportFile( exportFilename );
 
-	sqlite3_finalize( stmt );
-	if( rc != SQLITE_OK )
+	if(exportFile.exists() && !exportFile.remove() )
 	{
-		std::cout<< "SQL error: "<<sErrMsg<<"\n"<<std::endl;
-		sqlite3_free( sErrMsg );
+		QString message= QString( "Error deleting database:%1.\n"
+				"The database is in use. Please, close it before continuing. \n" ).arg( exportFilename );
+		tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
+		RemoveExistingFiles();
 	}
+
+	//A write ahead log left by an interrupted export must not be applied to the new database
+	QFile::remove( exportFilename + QLatin1String( "-wal" ) );
+	QFile::remove( exportFilename + QLatin1String( "-shm" ) );
 }
 
 
@@ -675,3 +487,13 @@ void PhotonMapExportDB::SetDBFileName( QString filename )
 {
 	m_dbFileName = filename;
 }
+
+/*!
+ *Sets \a value as the number of photons inserted in each transaction. A value of zero saves all the photons in one transaction.
+ */
+void PhotonMapExportDB::SetTransactionSize( QString value )
+{
+	bool ok = false;
+	unsigned long transactionSize = value.toULong( &ok );
+	if( ok )	m_transactionSize = transactionSize;
+}
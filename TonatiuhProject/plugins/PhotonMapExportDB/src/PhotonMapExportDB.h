@@ -55,30 +55,36 @@ public:
 
 	void EndExport();
 	static QStringList GetParameterNames();
-	void SavePhotonMap( std::vector< Photon* > raysLists );
+	void SavePhotonMap( const std::vector< Photon >& raysLists );
 	void SetPowerPerPhoton( double wPhoton );
 	void SetSaveParameterValue( QString parameterName, QString parameterValue );
 	bool StartExport();
 
 private:
+	bool BeginTransaction();
     bool Close();
-    void InsertSurface( InstanceNode* instance );
+	bool CommitTransaction();
+	void FinalizeStatements();
+    unsigned long GetSurfaceID( InstanceNode* surface );
+    void InsertSurface( unsigned long surfaceID, InstanceNode* instance );
 	bool Open();
-	void SaveAllData( std::vector< Photon* > raysLists );
-	void SaveNotNextPrevID( std::vector< Photon* > raysLists );
-	void SaveSelectedData( std::vector< Photon* > raysLists );
+	bool PrepareStatements();
 	void SetDBDirectory( QString path );
 	void SetDBFileName( QString filename );
+	void SetTransactionSize( QString value );
 	void RemoveExistingFiles();
 
 	QString m_dbFileName;
 	QString m_dbDirectory;
 	unsigned long m_exportedPhoton;
 	bool m_isDBOpened;
+	bool m_isTransactionOpened;
 	bool m_isWPhoton;
     sqlite3* m_pDB;
-	QVector< InstanceNode* > m_surfaceIdentfier;
-	QVector< Transform > m_surfaceWorldToObject;
+	sqlite3_stmt* m_pInsertPhotonStmt;
+	sqlite3_stmt* m_pInsertSurfaceStmt;
+	unsigned long m_photonsInTransaction;
+	unsigned long m_transactionSize;
 
 };
 
@@ -75,6 +75,10 @@ QString PhotonMapExportDBParametersWidget::GetParameterValue( QString parameter
 			return filenameDBLine->text();
 		}
 
+		//Photons per transaction.
+		else if( parameter == parametersName[2] )
+			return QString::number( transactionSizeSpin->value() );
+
 	return QString();
 }
 
@@ -36,6 +36,8 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include <QDataStream>
@@ -43,11 +45,12 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QMessageBox>
+#include <QtEndian>
 
 #include "PhotonMapExportFile.h"
 #include "InstanceNode.h"
 #include "SceneModel.h"
+#include "tgf.h"
 
 /*!
  * Creates export object to export photon map photons to a file.
@@ -60,7 +63,10 @@ PhotonMapExportFile::PhotonMapExportFile()
  m_exportDirecotryName( QLatin1String( "" ) ),
  m_exportedPhotons( 0 ),
  m_nPhotonsPerFile( -1 ),
- m_oneFile( true )
+ m_oneFile( true ),
+ m_compactFormat( false ),
+ m_floatCoordinates( false ),
+ m_pCompactFile( 0 )
 {
 
 }
@@ -70,7 +76,7 @@ PhotonMapExportFile::PhotonMapExportFile()
  */
 PhotonMapExportFile::~PhotonMapExportFile()
 {
-
+	CloseCompactFile();
 }
 
 /*!
@@ -82,6 +88,8 @@ QStringList PhotonMapExportFile::GetParameterNames()
 	parametersNames<<QLatin1String( "ExportDirectory" );
 	parametersNames<<QLatin1String( "ExportFile" );
 	parametersNames<<QLatin1String( "FileSize" );
+	parametersNames<<QLatin1String( "FileFormat" );
+	parametersNames<<QLatin1String( "CoordinatesPrecision" );
 
 	return parametersNames;
 }
@@ -91,6 +99,7 @@ QStringList PhotonMapExportFile::GetParameterNames()
  */
 void PhotonMapExportFile::EndExport()
 {
+	CloseCompactFile();
 
 	QDir exportDirectory( m_exportDirecotryName );
 	QString exportFilename;
@@ -116,9 +125,11 @@ void PhotonMapExportFile::EndExport()
 /*!
  * Saves \a raysList photons to file.
  */
-void PhotonMapExportFile::SavePhotonMap( std::vector< Photon* > raysLists )
+void PhotonMapExportFile::SavePhotonMap( const std::vector< Photon >& raysLists )
 {
-	if( m_oneFile )
+	if( m_compactFormat )
+		SaveCompactPhotonMap( raysLists );
+	else if( m_oneFile )
 	{
 		QDir exportDirectory( m_exportDirecotryName );
 		QString filename = m_photonsFilename;
@@ -176,22 +187,192 @@ void PhotonMapExportFile::SetSaveParameterValue( QString parameterName, QString
 		}
 
 	}
+
+	//Binary format of the photons file: "Double" or "Compact"
+	else if( parameterName == parameters[3] )
+		m_compactFormat = ( parameterValue == QLatin1String( "Compact" ) );
+
+	//Coordinates precision for the compact format: "Double" or "Float"
+	else if( parameterName == parameters[4] )
+		m_floatCoordinates = ( parameterValue == QLatin1String( "Float" ) );
 }
 
 /*!
- * Deletes the files that can be uset to export.
+ * Deletes the files that can be uset to export and the surface identifiers of a previous export.
  */
 bool PhotonMapExportFile::StartExport()
 {
 
-	if( m_exportedPhotons < 1  )	RemoveExistingFiles();
+	if( m_exportedPhotons < 1  )
+	{
+		RemoveExistingFiles();
+		m_surfaceIdentifier.Clear();
+	}
 	return 1;
 }
 
+/*!
+ * Flushes and closes the file opened to save the photons in compact format.
+ */
+void PhotonMapExportFile::CloseCompactFile()
+{
+	if( !m_pCompactFile ) return;
+
+	m_pCompactFile->close();
+	delete m_pCompactFile;
+	m_pCompactFile = 0;
+}
+
+/*!
+ * Returns the size in bytes of each photon record in the compact format.
+ *
+ * The photon identifier and the previous and next identifiers are 8 bytes integers, the coordinates 4 or 8 bytes floating
+ * point values, the side 1 byte and the surface identifier a 4 bytes integer. All of them are stored in little-endian.
+ */
+int PhotonMapExportFile::CompactRecordSize() const
+{
+	int recordSize = 8;
+	if( m_saveCoordinates )	recordSize += m_floatCoordinates ? 3 * 4 : 3 * 8;
+	if( m_saveSide )	recordSize += 1;
+	if( m_savePrevNexID )	recordSize += 2 * 8;
+	if( m_saveSurfaceID )	recordSize += 4;
+	return recordSize;
+}
+
+/*!
+ * Opens the file where the next photons are saved in compact format. The file is kept open until it is full
+ * or the export ends.
+ *
+ * Returns false if the file cannot be opened.
+ */
+bool PhotonMapExportFile::OpenCompactFile()
+{
+	QDir exportDirectory( m_exportDirecotryName );
+	QString filename;
+	if( m_oneFile )
+		filename = QString( QLatin1String( "%1.dat" ) ).arg( m_photonsFilename );
+	else
+		filename = QString( QLatin1String( "%1_%2.dat" ) ).arg( m_photonsFilename, QString::number( m_currentFile ) );
+	QString exportFilename = exportDirectory.absoluteFilePath( filename );
+
+	if( m_pCompactFile && ( m_pCompactFile->fileName() == exportFilename ) ) return true;
+	CloseCompactFile();
+
+	m_pCompactFile = new QFile( exportFilename );
+	if( !m_pCompactFile->open( QIODevice::Append ) )
+	{
+		std::cerr<<"Error opening "<<exportFilename.toStdString()<<std::endl;
+		delete m_pCompactFile;
+		m_pCompactFile = 0;
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Saves \a raysLists photons in compact format, splitting them into files of \a m_nPhotonsPerFile photons
+ * if this option is selected.
+ */
+void PhotonMapExportFile::SaveCompactPhotonMap( const std::vector< Photon >& raysLists )
+{
+	unsigned long nPhotons = raysLists.size();
+	unsigned long startIndex = 0;
+	while( startIndex < nPhotons )
+	{
+		unsigned long numberOfPhotons = nPhotons - startIndex;
+		if( !m_oneFile )
+		{
+			unsigned long filePhotons = m_exportedPhotons - ( m_nPhotonsPerFile * ( m_currentFile - 1 ) );
+			if( !( filePhotons < m_nPhotonsPerFile ) )
+			{
+				m_currentFile++;
+				filePhotons = 0;
+			}
+			numberOfPhotons = std::min( numberOfPhotons, std::max( m_nPhotonsPerFile - filePhotons, 1ul ) );
+		}
+
+		if( !OpenCompactFile() ) return;
+		WriteCompactPhotons( raysLists, startIndex, numberOfPhotons );
+		startIndex += numberOfPhotons;
+	}
+}
+
+/*!
+ * Writes \a numberOfPhotons photons of \a raysLists starting from \a startIndex to the current compact file.
+ *
+ * The records are formatted into a buffer that is reused between calls and written with a single call.
+ */
+void PhotonMapExportFile::WriteCompactPhotons( const std::vector< Photon >& raysLists,
+		unsigned long startIndex, unsigned long numberOfPhotons )
+{
+	int recordSize = CompactRecordSize();
+	m_compactBuffer.resize( numberOfPhotons * recordSize );
+	uchar* record = reinterpret_cast< uchar* >( m_compactBuffer.data() );
+
+	//A ray split between two files continues from the last photon written to the previous file
+	unsigned long nPhotonElements = raysLists.size();
+	quint64 previousPhotonID = ( startIndex > 0 ) ? m_exportedPhotons : 0;
+	for( unsigned long i = startIndex; i < startIndex + numberOfPhotons; ++i )
+	{
+		const Photon& photon = raysLists[i];
+		unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+
+		qToLittleEndian< quint64 >( ++m_exportedPhotons, record );
+		record += 8;
+		if( photon.id < 1 )	previousPhotonID = 0;
+
+		if( m_saveCoordinates )
+		{
+			Point3D pos = m_saveCoordinatesInGlobal ? m_concentratorToWorld( photon.pos ) :
+					m_surfaceIdentifier.GetWorldToObject( urlId )( photon.pos );
+			double coordinates[3] = { pos.x, pos.y, pos.z };
+			for( int c = 0; c < 3; ++c )
+			{
+				if( m_floatCoordinates )
+				{
+					float value = float( coordinates[c] );
+					quint32 bits;
+					memcpy( &bits, &value, 4 );
+					qToLittleEndian< quint32 >( bits, record );
+					record += 4;
+				}
+				else
+				{
+					quint64 bits;
+					memcpy( &bits, &coordinates[c], 8 );
+					qToLittleEndian< quint64 >( bits, record );
+					record += 8;
+				}
+			}
+		}
+
+		if( m_saveSide )	*record++ = uchar( photon.side );
+
+		if( m_savePrevNexID )
+		{
+			quint64 nextPhotonID = 0;
+			if( ( i < nPhotonElements - 1 ) && ( raysLists[i+1].id > 0 ) )	nextPhotonID = m_exportedPhotons + 1;
+			qToLittleEndian< quint64 >( previousPhotonID, record );
+			qToLittleEndian< quint64 >( nextPhotonID, record + 8 );
+			record += 16;
+		}
+
+		if( m_saveSurfaceID )
+		{
+			qToLittleEndian< quint32 >( quint32( urlId ), record );
+			record += 4;
+		}
+
+		previousPhotonID = m_exportedPhotons;
+	}
+
+	m_pCompactFile->write( m_compactBuffer.constData(), m_compactBuffer.size() );
+}
+
 /*!
  * Export \a a raysList all data to file \a filename.
  */
-void PhotonMapExportFile::ExportAllPhotonsAllData( QString filename, std::vector< Photon* > raysLists )
+void PhotonMapExportFile::ExportAllPhotonsAllData( QString filename, const std::vector< Photon >& raysLists )
 {
 	QFile exportFile( filename );
 	exportFile.open( QIODevice::Append );
@@ -205,35 +386,24 @@ void PhotonMapExportFile::ExportAllPhotonsAllData( QString filename, std::vector
 		for( unsigned long i = 0; i < nPhotonElements; ++i )
 		{
 
-			Photon* photon = raysLists[i];
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					m_surfaceWorldToObject.push_back( photon->intersectedSurface->GetIntersectionTransform() );
-				}
-				else
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-			}
+			const Photon& photon = raysLists[i];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
 
 			out<<double( ++m_exportedPhotons );
-			if( photon->id < 1 )	previousPhotonID = 0;
+			if( photon.id < 1 )	previousPhotonID = 0;
 
 
 			//m_saveCoordinates
-			Point3D scenePos = m_concentratorToWorld( photon->pos );
+			Point3D scenePos = m_concentratorToWorld( photon.pos );
 			out<<scenePos.x << scenePos.y << scenePos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_savePrevNexID
 			out<<previousPhotonID;
-			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1]->id > 0  ) )
+			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1].id > 0  ) )
 				out<< double( m_exportedPhotons +1 );
 			else
 				out <<0.0;
@@ -251,45 +421,25 @@ void PhotonMapExportFile::ExportAllPhotonsAllData( QString filename, std::vector
 		for( unsigned long i = 0; i < nPhotonElements; ++i )
 		{
 
-			Photon* photon = raysLists[i];
+			const Photon& photon = raysLists[i];
 
 			out<<double( ++m_exportedPhotons );
-			if( photon->id < 1 )	previousPhotonID = 0;
-
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-					0.0, 1.0, 0.0, 0.0,
-					0.0, 0.0, 1.0, 0.0,
-					0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
+			if( photon.id < 1 )	previousPhotonID = 0;
 
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-					m_surfaceWorldToObject.push_back( worldToObject );
-				}
-				else
-				{
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-					worldToObject = m_surfaceWorldToObject[urlId];
-					urlId++;
-				}
-			}
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+			const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 
 			//m_saveCoordinates
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_savePrevNexID
 			out<<previousPhotonID;
-			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1]->id > 0  ) )	out<< double( m_exportedPhotons +1 );
+			if( ( i < ( nPhotonElements - 1 ) ) && ( raysLists[i+1].id > 0  ) )	out<< double( m_exportedPhotons +1 );
 			else out <<0.0;
 
 			//m_saveSurfaceID
@@ -305,7 +455,7 @@ void PhotonMapExportFile::ExportAllPhotonsAllData( QString filename, std::vector
 /*!
  * Exports \a raysLists photons data except previous and next photon identifier to file \a filename.
  */
-void PhotonMapExportFile::ExportAllPhotonsNotNextPrevID( QString filename, std::vector< Photon* > raysLists )
+void PhotonMapExportFile::ExportAllPhotonsNotNextPrevID( QString filename, const std::vector< Photon >& raysLists )
 {
 
 	QFile exportFile( filename );
@@ -317,30 +467,18 @@ void PhotonMapExportFile::ExportAllPhotonsNotNextPrevID( QString filename, std::
 		unsigned long nPhotons = raysLists.size();
 		for( unsigned long i = 0; i < nPhotons; ++i )
 		{
-			Photon* photon = raysLists[i];
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					m_surfaceWorldToObject.push_back( photon->intersectedSurface->GetIntersectionTransform() );
-				}
-				else
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-
-			}
+			const Photon& photon = raysLists[i];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
 
 			out<<double( ++m_exportedPhotons );
 
 			//m_saveCoordinates
-			Point3D scenePos = m_concentratorToWorld( photon->pos );
+			Point3D scenePos = m_concentratorToWorld( photon.pos );
 			out<<scenePos.x << scenePos.y << scenePos.z;
-			//out<<photon->pos.x << photon->pos.y << photon->pos.z;
+			//out<<photon.pos.x << photon.pos.y << photon.pos.z;
 
 			//m_saveSide
-			out<<double( photon->side );
+			out<<double( photon.side );
 
 			//m_saveSurfaceID
 			out<<double( urlId );
@@ -352,37 +490,17 @@ void PhotonMapExportFile::ExportAllPhotonsNotNextPrevID( QString filename, std::
 		unsigned long nPhotons = raysLists.size();
 		for( unsigned long i = 0; i < nPhotons; ++i )
 		{
-			Photon* photon = raysLists[i];
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-							0.0, 1.0, 0.0, 0.0,
-							0.0, 0.0, 1.0, 0.0,
-							0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-					m_surfaceWorldToObject.push_back( worldToObject );
-				}
-				else
-				{
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-					worldToObject = m_surfaceWorldToObject[urlId];
-					urlId++;
-				}
-
-			}
+			const Photon& photon = raysLists[i];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+			const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 			out<<double( ++m_exportedPhotons );
 
 			//m_saveCoordinates
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 
 			//m_saveSide
-			out<<double( photon->side );
+			out<<double( photon.side );
 
 			//m_saveSurfaceID
 			out<<double( urlId );
@@ -397,7 +515,7 @@ void PhotonMapExportFile::ExportAllPhotonsNotNextPrevID( QString filename, std::
  * Exports \a raysLists all photons data to file \a filename.
  * For each photon only selected parameters will be exported.
  */
-void PhotonMapExportFile::ExportAllPhotonsSelectedData( QString filename, std::vector< Photon* > raysLists )
+void PhotonMapExportFile::ExportAllPhotonsSelectedData( QString filename, const std::vector< Photon >& raysLists )
 {
 
 	QFile exportFile( filename );
@@ -409,49 +527,29 @@ void PhotonMapExportFile::ExportAllPhotonsSelectedData( QString filename, std::v
 	unsigned long nPhotons = raysLists.size();
 	for( unsigned long i = 0; i < nPhotons; ++i )
 	{
-		Photon* photon = raysLists[i];
-		unsigned long urlId = 0;
-		Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-							0.0, 1.0, 0.0, 0.0,
-							0.0, 0.0, 1.0, 0.0,
-							0.0, 0.0, 0.0, 1.0 );
-		if( photon->intersectedSurface )
-		{
-			if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-			{
-				m_surfaceIdentfier.push_back( photon->intersectedSurface );
-				urlId = m_surfaceIdentfier.size();
-				worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-				m_surfaceWorldToObject.push_back( worldToObject );
-			}
-			else
-			{
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-				worldToObject = m_surfaceWorldToObject[urlId];
-				urlId++;
-			}
-
-		}
+		const Photon& photon = raysLists[i];
+		unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+		const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 
 		out<<double( ++m_exportedPhotons );
-		if( photon->id < 1 )	previousPhotonID = 0;
+		if( photon.id < 1 )	previousPhotonID = 0;
 
-		if( m_saveCoordinates && m_saveCoordinatesInGlobal )	out<<photon->pos.x << photon->pos.y << photon->pos.z;
+		if( m_saveCoordinates && m_saveCoordinatesInGlobal )	out<<photon.pos.x << photon.pos.y << photon.pos.z;
 		else if( m_saveCoordinates && !m_saveCoordinatesInGlobal )
 		{
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 		}
 
 		if(  m_saveSide )
 		{
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 		}
 		if( m_savePrevNexID )
 		{
 			out<<previousPhotonID;
-			if( ( i < nPhotons - 1 ) && ( raysLists[i+1]->id > 0  ) )	out<< double( m_exportedPhotons +1 );
+			if( ( i < nPhotons - 1 ) && ( raysLists[i+1].id > 0  ) )	out<< double( m_exportedPhotons +1 );
 			else out <<0.0;
 		}
 
@@ -467,7 +565,7 @@ void PhotonMapExportFile::ExportAllPhotonsSelectedData( QString filename, std::v
 /*!
  * Exports \a numberOfPhotons photons from \a raysLists to file \a filename starting from [\a startIndexRaysList, \a endIndexRaysList ].
  */
-void PhotonMapExportFile::ExportSelectedPhotonsAllData( QString filename, std::vector< Photon* > raysLists,
+void PhotonMapExportFile::ExportSelectedPhotonsAllData( QString filename, const std::vector< Photon >& raysLists,
 		unsigned long startIndex, 	unsigned long numberOfPhotons )
 {
 
@@ -483,35 +581,24 @@ void PhotonMapExportFile::ExportSelectedPhotonsAllData( QString filename, std::v
 		unsigned long exportedPhotonsToFile = 0;
 		while( exportedPhotonsToFile < numberOfPhotons )
 		{
-			Photon* photon = raysLists[startIndex + exportedPhotonsToFile];
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					m_surfaceWorldToObject.push_back( photon->intersectedSurface->GetIntersectionTransform() );
-				}
-				else
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-			}
+			const Photon& photon = raysLists[startIndex + exportedPhotonsToFile];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
 
 			out<<double( ++m_exportedPhotons );
-			if( photon->id < 1 )	previousPhotonID = 0;
+			if( photon.id < 1 )	previousPhotonID = 0;
 
 			//m_saveCoordinates
-			Point3D scenePos = m_concentratorToWorld( photon->pos );
+			Point3D scenePos = m_concentratorToWorld( photon.pos );
 			out<<scenePos.x << scenePos.y << scenePos.z;
-			//out<<photon->pos.x << photon->pos.y << photon->pos.z;
+			//out<<photon.pos.x << photon.pos.y << photon.pos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_savePrevNexID
 			out<<previousPhotonID;
-			if( ( ( startIndex + exportedPhotonsToFile ) < ( nPhotonElements - 1 ) ) && ( raysLists[startIndex + exportedPhotonsToFile + 1]->id > 0  ) )
+			if( ( ( startIndex + exportedPhotonsToFile ) < ( nPhotonElements - 1 ) ) && ( raysLists[startIndex + exportedPhotonsToFile + 1].id > 0  ) )
 				out<< double( m_exportedPhotons +1 );
 			else
 				out <<0.0;
@@ -531,43 +618,24 @@ void PhotonMapExportFile::ExportSelectedPhotonsAllData( QString filename, std::v
 		unsigned long exportedPhotonsToFile = 0;
 		while( exportedPhotonsToFile < numberOfPhotons )
 		{
-			Photon* photon = raysLists[startIndex + exportedPhotonsToFile];
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-							0.0, 1.0, 0.0, 0.0,
-							0.0, 0.0, 1.0, 0.0,
-							0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-					m_surfaceWorldToObject.push_back( worldToObject );
-				}
-				else
-				{
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-					worldToObject = m_surfaceWorldToObject[urlId];
-					urlId++;
-				}
-			}
+			const Photon& photon = raysLists[startIndex + exportedPhotonsToFile];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+			const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 
 			out<<double( ++m_exportedPhotons );
-			if( photon->id < 1 )	previousPhotonID = 0;
+			if( photon.id < 1 )	previousPhotonID = 0;
 
 			//m_saveCoordinates
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_savePrevNexID
 			out<<previousPhotonID;
-			if( ( ( startIndex + exportedPhotonsToFile ) < ( nPhotonElements - 1 ) ) && ( raysLists[startIndex + exportedPhotonsToFile + 1]->id > 0  ) )
+			if( ( ( startIndex + exportedPhotonsToFile ) < ( nPhotonElements - 1 ) ) && ( raysLists[startIndex + exportedPhotonsToFile + 1].id > 0  ) )
 				out<< double( m_exportedPhotons +1 );
 			else
 				out <<0.0;
@@ -587,7 +655,7 @@ void PhotonMapExportFile::ExportSelectedPhotonsAllData( QString filename, std::v
 /*!
  * Exports \a numberOfPhotons photons from \a raysLists to file \a filename starting from [\a startIndexRaysList, \a endIndexRaysList ].
  */
-void PhotonMapExportFile::ExportSelectedPhotonsNotNextPrevID( QString filename, std::vector< Photon* > raysLists,
+void PhotonMapExportFile::ExportSelectedPhotonsNotNextPrevID( QString filename, const std::vector< Photon >& raysLists,
 		unsigned long startIndex, unsigned long numberOfPhotons )
 {
 	QFile exportFile( filename );
@@ -600,29 +668,18 @@ void PhotonMapExportFile::ExportSelectedPhotonsNotNextPrevID( QString filename,
 		unsigned long exportedPhotonsToFile = 0;
 		while( exportedPhotonsToFile < numberOfPhotons )
 		{
-			Photon* photon = raysLists[startIndex + exportedPhotonsToFile];
-			unsigned long urlId = 0;
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					m_surfaceWorldToObject.push_back( photon->intersectedSurface->GetIntersectionTransform() );
-				}
-				else
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) + 1;
-			}
+			const Photon& photon = raysLists[startIndex + exportedPhotonsToFile];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
 
 			out<<double( ++m_exportedPhotons );
 
 			//m_saveCoordinates
-			Point3D scenePos = m_concentratorToWorld( photon->pos );
+			Point3D scenePos = m_concentratorToWorld( photon.pos );
 			out<<scenePos.x << scenePos.y << scenePos.z;
-			//out<<photon->pos.x << photon->pos.y << photon->pos.z;
+			//out<<photon.pos.x << photon.pos.y << photon.pos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_saveSurfaceID
@@ -636,37 +693,18 @@ void PhotonMapExportFile::ExportSelectedPhotonsNotNextPrevID( QString filename,
 		unsigned long exportedPhotonsToFile = 0;
 		while( exportedPhotonsToFile < numberOfPhotons )
 		{
-			Photon* photon = raysLists[startIndex + exportedPhotonsToFile];
-			unsigned long urlId = 0;
-			Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-							0.0, 1.0, 0.0, 0.0,
-							0.0, 0.0, 1.0, 0.0,
-							0.0, 0.0, 0.0, 1.0 );
-			if( photon->intersectedSurface )
-			{
-				if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-				{
-					m_surfaceIdentfier.push_back( photon->intersectedSurface );
-					urlId = m_surfaceIdentfier.size();
-					worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-					m_surfaceWorldToObject.push_back( worldToObject );
-				}
-				else
-				{
-					urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-					worldToObject = m_surfaceWorldToObject[urlId];
-					urlId++;
-				}
-			}
+			const Photon& photon = raysLists[startIndex + exportedPhotonsToFile];
+			unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+			const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 
 			out<<double( ++m_exportedPhotons );
 
 			//m_saveCoordinates
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 
 			//m_saveSide
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 
 			//m_saveSurfaceID
@@ -684,7 +722,7 @@ void PhotonMapExportFile::ExportSelectedPhotonsNotNextPrevID( QString filename,
  * Exports \a numberOfPhotons photons from \a raysLists to file \a filename starting from [\a startIndexRaysList, \a endIndexRaysList ].
  *  * For each photon only selected parameters will be exported.
  */
-void PhotonMapExportFile::ExportSelectedPhotonsSelectedData( QString filename, std::vector< Photon* > raysLists,
+void PhotonMapExportFile::ExportSelectedPhotonsSelectedData( QString filename, const std::vector< Photon >& raysLists,
 		unsigned long startIndex, 	unsigned long numberOfPhotons )
 {
 
@@ -698,55 +736,36 @@ void PhotonMapExportFile::ExportSelectedPhotonsSelectedData( QString filename, s
 	unsigned long exportedPhotonsToFile = 0;
 	while( exportedPhotonsToFile < numberOfPhotons )
 	{
-		Photon* photon = raysLists[startIndex + exportedPhotonsToFile];
-		unsigned long urlId = 0;
-		Transform worldToObject( 1.0, 0.0, 0.0, 0.0,
-						0.0, 1.0, 0.0, 0.0,
-						0.0, 0.0, 1.0, 0.0,
-						0.0, 0.0, 0.0, 1.0 );
-		if( photon->intersectedSurface )
-		{
-			if( !m_surfaceIdentfier.contains( photon->intersectedSurface ) )
-			{
-				m_surfaceIdentfier.push_back( photon->intersectedSurface );
-				urlId = m_surfaceIdentfier.size();
-				worldToObject = photon->intersectedSurface->GetIntersectionTransform();
-				m_surfaceWorldToObject.push_back( worldToObject );
-			}
-			else
-			{
-				urlId = m_surfaceIdentfier.indexOf( photon->intersectedSurface ) ;
-				worldToObject = m_surfaceWorldToObject[urlId];
-				urlId++;
-			}
-		}
+		const Photon& photon = raysLists[startIndex + exportedPhotonsToFile];
+		unsigned long urlId = m_surfaceIdentifier.GetSurfaceID( photon.intersectedSurface );
+		const Transform& worldToObject = m_surfaceIdentifier.GetWorldToObject( urlId );
 
 		out<<double( ++m_exportedPhotons );
-		if( photon->id < 1 )	previousPhotonID = 0;
+		if( photon.id < 1 )	previousPhotonID = 0;
 
 		if( m_saveCoordinates && m_saveCoordinatesInGlobal )
 		{
 
-			Point3D scenePos = m_concentratorToWorld( photon->pos );
+			Point3D scenePos = m_concentratorToWorld( photon.pos );
 			out<<scenePos.x << scenePos.y << scenePos.z;
-			//out<<photon->pos.x << photon->pos.y << photon->pos.z;
+			//out<<photon.pos.x << photon.pos.y << photon.pos.z;
 		}
 		else if( m_saveCoordinates && !m_saveCoordinatesInGlobal )
 		{
-			Point3D localPos = worldToObject( photon->pos );
+			Point3D localPos = worldToObject( photon.pos );
 			out<<localPos.x << localPos.y << localPos.z;
 		}
 
 		if(  m_saveSide )
 		{
-			double side = double( photon->side );
+			double side = double( photon.side );
 			out<<side;
 		}
 		if( m_savePrevNexID )
 		{
 			out<<previousPhotonID;
 			if( ( ( startIndex + exportedPhotonsToFile ) < nPhotonElements )
-					&& ( raysLists[startIndex + exportedPhotonsToFile + 1]->id > 0  ) )
+					&& ( raysLists[startIndex + exportedPhotonsToFile + 1].id > 0  ) )
 				out<< double( m_exportedPhotons +1 );
 			else out <<0.0;
 		}
@@ -775,7 +794,7 @@ void PhotonMapExportFile::RemoveExistingFiles()
 		QFile exportFile( exportFilename );
 		if(exportFile.exists()&&!exportFile.remove()) {
 				QString message= QString( "Error deleting %1.\nThe file is in use. Please, close it before continuing. \n" ).arg( QString( exportFilename ) );
-				QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+				tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 				RemoveExistingFiles();
 			}
 	}
@@ -792,7 +811,7 @@ void PhotonMapExportFile::RemoveExistingFiles()
 			QFile partialFile( partialFilesList[i].absoluteFilePath() );
 			if(partialFile.exists() && !partialFile.remove()) {
 					QString message= QString( "Error deleting %1.\nThe file is in use. Please, close it before continuing. \n" ).arg( QString( partialFilesList[i].absoluteFilePath() ) );
-					QMessageBox::warning( NULL, QLatin1String( "Tonatiuh" ), message );
+					tgf::ShowWarning( QLatin1String( "Tonatiuh" ), message );
 					RemoveExistingFiles();
 				}
 
@@ -804,7 +823,7 @@ void PhotonMapExportFile::RemoveExistingFiles()
  * Exports \a raysLists photons data to files with the same number of photons in each file.
  * Each file stores \a m_nPhotonsPerFile photons.
  */
-void PhotonMapExportFile::SaveToVariousFiles( std::vector <Photon* > raysLists )
+void PhotonMapExportFile::SaveToVariousFiles( const std::vector< Photon >& raysLists )
 {
 
 	QDir exportDirectory( m_exportDirecotryName );
@@ -871,33 +890,48 @@ void PhotonMapExportFile::WriteFileFormat( QString exportFilename )
 	QFile exportFile( exportFilename );
 	exportFile.open( QIODevice::WriteOnly );
 	QTextStream out( &exportFile );
+
+	//The compact format stores the type of each parameter after its name
+	QString idType;
+	QString coordinateType;
+	QString sideType;
+	QString surfaceIDType;
+	if( m_compactFormat )
+	{
+		out<<QString( QLatin1String( "FORMAT compact little-endian\n" ) );
+		idType = QLatin1String( " uint64" );
+		coordinateType = m_floatCoordinates ? QLatin1String( " float32" ) : QLatin1String( " float64" );
+		sideType = QLatin1String( " uint8" );
+		surfaceIDType = QLatin1String( " uint32" );
+	}
+
 	out<<QString( QLatin1String( "START PARAMETERS\n" ) );
-	out<<QString( QLatin1String( "id\n" ) );
+	out<<QString( QLatin1String( "id%1\n" ) ).arg( idType );
 	if( m_saveCoordinates  )
 	{
-		out<<QString( QLatin1String( "x\n" ) );
-		out<<QString( QLatin1String( "y\n" ) );
-		out<<QString( QLatin1String( "z\n" ) );
+		out<<QString( QLatin1String( "x%1\n" ) ).arg( coordinateType );
+		out<<QString( QLatin1String( "y%1\n" ) ).arg( coordinateType );
+		out<<QString( QLatin1String( "z%1\n" ) ).arg( coordinateType );
 	}
-	if(  m_saveSide )	out<<QString( QLatin1String( "side\n" ) );
+	if(  m_saveSide )	out<<QString( QLatin1String( "side%1\n" ) ).arg( sideType );
 	if( m_savePrevNexID )
 	{
-		out<<QString( QLatin1String( "previous ID\n" ) );
-		out<<QString( QLatin1String( "next ID\n" ) );
+		out<<QString( QLatin1String( "previous ID%1\n" ) ).arg( idType );
+		out<<QString( QLatin1String( "next ID%1\n" ) ).arg( idType );
 	}
 	if( m_saveSurfaceID )
 	{
-		out<<QString( QLatin1String( "surface ID\n" ) );
+		out<<QString( QLatin1String( "surface ID%1\n" ) ).arg( surfaceIDType );
 	}
 
 	out<<QString( QLatin1String( "END PARAMETERS\n" ) );
 
 
 	out<<QString( QLatin1String( "START SURFACES\n" ) );
-	for( int s = 0; s < m_surfaceIdentfier.count(); s++ )
+	for( int s = 1; s <= m_surfaceIdentifier.GetNumberOfSurfaces(); s++ )
 	{
-		QString surfaceURL = m_surfaceIdentfier[s]->GetNodeURL();
-		out<<QString( QLatin1String( "%1 %2\n" ) ).arg( QString::number( s+1 ),
+		QString surfaceURL = m_surfaceIdentifier.GetSurface( s )->GetNodeURL();
+		out<<QString( QLatin1String( "%1 %2\n" ) ).arg( QString::number( s ),
 				surfaceURL);
 	}
 
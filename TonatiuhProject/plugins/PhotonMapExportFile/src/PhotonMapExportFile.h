@@ -40,12 +40,14 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef EXPORTPHOTONMAPFILE_H_
 #define EXPORTPHOTONMAPFILE_H_
 
+#include <QByteArray>
 #include <QMap>
 #include <QString>
 
 #include "PhotonMapExport.h"
 
 class Photon;
+class QFile;
 
 class PhotonMapExportFile : public PhotonMapExport
 {
@@ -57,37 +59,46 @@ public:
 	static QStringList GetParameterNames();
 
 	void EndExport();
-	void SavePhotonMap( std::vector< Photon* > raysLists );
+	void SavePhotonMap( const std::vector< Photon >& raysLists );
 	void SetPowerPerPhoton( double wPhoton );
 	void SetSaveParameterValue( QString parameterName, QString parameterValue );
 	bool StartExport();
 
 private:
-	void ExportAllPhotonsAllData( QString filename, std::vector< Photon* > raysLists );
-	void ExportAllPhotonsNotNextPrevID( QString filename, std::vector< Photon* > raysLists );
-	void ExportAllPhotonsSelectedData( QString filename, std::vector< Photon* > raysLists );
-	void ExportSelectedPhotonsAllData( QString filename, std::vector< Photon* > raysLists,
+	void ExportAllPhotonsAllData( QString filename, const std::vector< Photon >& raysLists );
+	void ExportAllPhotonsNotNextPrevID( QString filename, const std::vector< Photon >& raysLists );
+	void ExportAllPhotonsSelectedData( QString filename, const std::vector< Photon >& raysLists );
+	void ExportSelectedPhotonsAllData( QString filename, const std::vector< Photon >& raysLists,
 			unsigned long startIndex, 	unsigned long numberOfPhotons );
-	void ExportSelectedPhotonsNotNextPrevID( QString filename, std::vector< Photon* > raysLists,
+	void ExportSelectedPhotonsNotNextPrevID( QString filename, const std::vector< Photon >& raysLists,
 			unsigned long startIndex, 	unsigned long numberOfPhotons );
-	void ExportSelectedPhotonsSelectedData( QString filename, std::vector <Photon* > raysLists,
+	void ExportSelectedPhotonsSelectedData( QString filename, const std::vector< Photon >& raysLists,
 			unsigned long startIndex, 	unsigned long numberOfPhotons );
 
+	void CloseCompactFile();
+	int CompactRecordSize() const;
+	bool OpenCompactFile();
+	void SaveCompactPhotonMap( const std::vector< Photon >& raysLists );
+	void WriteCompactPhotons( const std::vector< Photon >& raysLists,
+			unsigned long startIndex, unsigned long numberOfPhotons );
+
 
     void RemoveExistingFiles();
-    void SaveToVariousFiles( std::vector <Photon* > raysLists );
+    void SaveToVariousFiles( const std::vector< Photon >& raysLists );
     void WriteFileFormat( QString exportFilename );
 
 
 	QString m_photonsFilename;
 	double m_powerPerPhoton;
-	QVector< InstanceNode* > m_surfaceIdentfier;
-	QVector< Transform > m_surfaceWorldToObject;
 	int m_currentFile;
 	QString m_exportDirecotryName;
 	unsigned long m_exportedPhotons;
 	unsigned long m_nPhotonsPerFile;
 	bool m_oneFile;
+	bool m_compactFormat;
+	bool m_floatCoordinates;
+	QFile* m_pCompactFile;
+	QByteArray m_compactBuffer;
 
 };
 
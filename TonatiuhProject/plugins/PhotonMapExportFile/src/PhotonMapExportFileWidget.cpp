@@ -94,6 +94,17 @@ QString PhotonMapExportFileWidget::GetParameterValue( QString parameter ) const
 		else	return QString::number( nOfPhotonsSpin->value() );
 	}
 
+	//Binary format of the photons file.
+	else if( parameter == parametersName[3] )
+		return fileFormatCombo->currentText();
+
+	//Coordinates precision for the compact format.
+	else if( parameter == parametersName[4] )
+	{
+		if( floatCoordinatesCheck->isChecked() )	return QLatin1String( "Float" );
+		else	return QLatin1String( "Double" );
+	}
+
 	return QString();
 }
 
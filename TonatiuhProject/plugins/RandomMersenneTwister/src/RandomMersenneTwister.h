@@ -51,11 +51,13 @@ public:
     RandomMersenneTwister( const unsigned long* seedArray, int seedArraySize, long int randomNumberArraySize = 10000000 );
     virtual ~RandomMersenneTwister( );
     void FillArray( double* array, const unsigned long arraySize );
+    RandomDeviate* CreateStream( unsigned long streamIndex, const unsigned long arraySize ) const;
     unsigned long RandomUInt();
 
 private:
    enum { N = 624, M = 397 };
 
+   unsigned long m_seed;
    unsigned long m_state[N];
    int m_p;
    bool m_init;
@@ -73,14 +75,14 @@ private:
 };
 
 inline RandomMersenneTwister::RandomMersenneTwister( unsigned long seedValue, long int randomNumberArraySize )
-: RandomDeviate( randomNumberArraySize ), m_p(0)
+: RandomDeviate( randomNumberArraySize ), m_seed( seedValue ), m_p(0)
 {
 	Seed( seedValue );
     m_init = true;
 }
 
 inline RandomMersenneTwister::RandomMersenneTwister( const unsigned long* seedArray, int seedArraySize, long int randomNumberArraySize  )
-: RandomDeviate( randomNumberArraySize ), m_p(0)
+: RandomDeviate( randomNumberArraySize ), m_seed( seedArray[0] ), m_p(0)
 {
     Seed( seedArray, seedArraySize );
     m_init = true;
@@ -95,6 +97,16 @@ inline void RandomMersenneTwister::FillArray( double* array, const unsigned long
     for( unsigned int i = 0; i < arraySize; i++ ) array[i] = Random01( );
 }
 
+/*!
+ * Returns a new generator for the stream \a streamIndex. The stream state is initialized with the seed
+ * array { seed, streamIndex }, so each stream is reproducible and independent of the numbers already generated.
+ */
+inline RandomDeviate* RandomMersenneTwister::CreateStream( unsigned long streamIndex, const unsigned long arraySize ) const
+{
+	unsigned long streamSeed[2] = { m_seed, streamIndex };
+	return new RandomMersenneTwister( streamSeed, 2, arraySize );
+}
+
 inline unsigned long RandomMersenneTwister::Twiddle( unsigned long u, unsigned long v )
 {
     return ( ( ( u & 0x80000000UL ) | ( v & 0x7FFFFFFFUL ) ) >> 1 )
@@ -56,8 +56,12 @@ QIcon  RandomMersenneTwisterFactory::RandomDeviateIcon() const
 RandomMersenneTwister* RandomMersenneTwisterFactory::CreateRandomDeviate( ) const
 {
 	unsigned long seed = QTime::currentTime().msec();
+	return CreateRandomDeviate( seed );
+}
+
+RandomMersenneTwister* RandomMersenneTwisterFactory::CreateRandomDeviate( unsigned long seed ) const
+{
 	return new RandomMersenneTwister( seed );
-	//return new RandomMersenneTwister( 123 );
 }
 #if QT_VERSION < 0x050000 // pre Qt 5
 Q_EXPORT_PLUGIN2(RandomMersenneTwister, RandomMersenneTwisterFactory )
@@ -55,6 +55,7 @@ public:
 	QString RandomDeviateName() const;
 	QIcon RandomDeviateIcon() const;
 	RandomMersenneTwister* CreateRandomDeviate( ) const;
+	RandomMersenneTwister* CreateRandomDeviate( unsigned long seed ) const;
 
 };
 
@@ -349,6 +349,43 @@ RandomRngStream::RandomRngStream ( const unsigned long arraySize )
    MatVecModM (A2p127, &sm_nextSeed[3], &sm_nextSeed[3], m2);
 }
 
+/**
+ * Creates the stream number \a seed of the default package seed, so the same seed always gives
+ * the same numbers. The package seed is not changed.
+ */
+RandomRngStream::RandomRngStream( unsigned long seed, const unsigned long arraySize )
+: RandomDeviate(arraySize)
+{
+   m_anti = false;
+   m_incPrec = false;
+
+   double B1[3][3], B2[3][3];
+   MatPowModM (A1p127, B1, m1, long( seed ));
+   MatPowModM (A2p127, B2, m2, long( seed ));
+
+   const double packageSeed[6] = { 12345.0, 12345.0, 12345.0, 12345.0, 12345.0, 12345.0 };
+   MatVecModM (B1, packageSeed, m_ig, m1);
+   MatVecModM (B2, &packageSeed[3], &m_ig[3], m2);
+
+   for (int i = 0; i < 6; ++i) {
+      m_bg[i] = m_cg[i] = m_ig[i];
+   }
+}
+
+/**
+ * Creates a stream that starts in the state \a seed. The package seed is not changed.
+ */
+RandomRngStream::RandomRngStream( const double seed[6], const unsigned long arraySize )
+: RandomDeviate(arraySize)
+{
+   m_anti = false;
+   m_incPrec = false;
+
+   for (int i = 0; i < 6; ++i) {
+      m_bg[i] = m_cg[i] = m_ig[i] = seed[i];
+   }
+}
+
 /**
  * Destructor
  */
@@ -357,6 +394,24 @@ RandomRngStream::~RandomRngStream()
 
 }
 
+/**
+ * Returns a new generator that starts at the beginning of the SubStream \a streamIndex of this stream.
+ *
+ * The SubStreams are 2^76 numbers long, so the generators created for different indexes do not overlap.
+ */
+RandomDeviate* RandomRngStream::CreateStream( unsigned long streamIndex, const unsigned long arraySize ) const
+{
+   double B1[3][3], B2[3][3];
+   MatPowModM (A1p76, B1, m1, streamIndex);
+   MatPowModM (A2p76, B2, m2, streamIndex);
+
+   double seed[6];
+   MatVecModM (B1, m_ig, seed, m1);
+   MatVecModM (B2, &m_ig[3], &seed[3], m2);
+
+   return new RandomRngStream( seed, arraySize );
+}
+
 /**
  * Reset Stream to beginning of Stream.
  */
@@ -48,10 +48,14 @@ class RandomRngStream : public RandomDeviate
 {
 public:
 	RandomRngStream ( const unsigned long arraySize = 1000000 );
+	RandomRngStream( unsigned long seed, const unsigned long arraySize );
 	~RandomRngStream();
 	void FillArray( double* array, const unsigned long arraySize );
+	RandomDeviate* CreateStream( unsigned long streamIndex, const unsigned long arraySize ) const;
 
 private:
+	RandomRngStream( const double seed[6], const unsigned long arraySize );
+
 	static bool SetPackageSeed (const unsigned long seed[6]);
 	void ResetStartStream ();
 	void ResetStartSubstream ();
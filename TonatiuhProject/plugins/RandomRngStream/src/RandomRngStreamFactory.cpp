@@ -55,7 +55,12 @@ QIcon  RandomRngStreamFactory::RandomDeviateIcon() const
 RandomRngStream* RandomRngStreamFactory::CreateRandomDeviate( ) const
 {
 	unsigned long seed = QTime::currentTime().msec();
-	return new RandomRngStream( seed );
+	return CreateRandomDeviate( seed );
+}
+
+RandomRngStream* RandomRngStreamFactory::CreateRandomDeviate( unsigned long seed ) const
+{
+	return new RandomRngStream( seed, 1000000 );
 }
 #if QT_VERSION < 0x050000 // pre Qt 5
 Q_EXPORT_PLUGIN2(RandomRngStream, RandomRngStreamFactory )
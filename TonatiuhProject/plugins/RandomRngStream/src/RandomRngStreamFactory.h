@@ -54,6 +54,7 @@ public:
 	QString RandomDeviateName() const;
 	QIcon RandomDeviateIcon() const;
 	RandomRngStream* CreateRandomDeviate( ) const;
+	RandomRngStream* CreateRandomDeviate( unsigned long seed ) const;
 
 };
 
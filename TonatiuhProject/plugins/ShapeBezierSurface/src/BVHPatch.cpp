@@ -82,10 +82,12 @@ void BVHPatchNode::SetBoundingBox( BBox bbox )
  * **************************** */
 
 /*!
- * Creates bounding volume hierarchy object
+ * Creates bounding volume hierarchy object. The patches build their sub-patches hierarchies
+ * with \a subPatchesDepth levels, that are kept with the patches for the intersections.
  */
-BVHPatch::BVHPatch( std::vector< BezierPatch*>* patchesList, int leafSize )
+BVHPatch::BVHPatch( std::vector< BezierPatch*>* patchesList, int leafSize, int subPatchesDepth )
 :m_leafSize( leafSize ),
+ m_subPatchesDepth( subPatchesDepth ),
  m_nNodes ( 0 ),
  m_nLeafs( 0 ),
  m_rootNode( 0 ),
@@ -260,6 +262,7 @@ void BVHPatch::Build()
 	{
 
 		BezierPatch* patch = m_patchesList->at(t);
+		patch->SetSubPatchesDepth( m_subPatchesDepth );
 
 		hBBox = Union ( hBBox, patch->GetBBox( ) );
 	}
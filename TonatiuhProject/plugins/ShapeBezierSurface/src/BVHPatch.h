@@ -60,7 +60,7 @@ class BVHPatch {
 
 public:
 
-	BVHPatch( std::vector< BezierPatch*>* patchesList, int leafSize = 1 );
+	BVHPatch( std::vector< BezierPatch*>* patchesList, int leafSize = 1, int subPatchesDepth = 3 );
 	~BVHPatch();
 
 	BBox GetBBox() const;
@@ -79,6 +79,7 @@ private:
 
 
 	int m_leafSize;
+	int m_subPatchesDepth;
 	int m_nNodes;
 	int m_nLeafs;
 
@@ -55,7 +55,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "Vector3D.h"
 
 BezierPatch::BezierPatch()
-:m_nIterations( 100 )
+:m_subPatchesDepth( 3 ),
+ m_tolerance( 0.0 )
 {
 
 }
@@ -102,9 +103,18 @@ void BezierPatch::GeneratePrimitives( SoAction* /*action*/ )
 	//SoNurbsSurface::generatePrimitives( action );
 }
 
+/*!
+ * Computes the nearest intersection of \a objectRay with the patch farther than \a bezierTol.
+ *
+ * The ray is tested against the boxes of the sub-patches hierarchy. In each leaf sub-patch reached by the ray,
+ * the intersection is computed with Newton iterations from the sub-patch center. The sub-patch is only subdivided,
+ * as in the Bezier clipping, when the iterations do not converge inside it or the ray may meet it at other points.
+ */
 bool BezierPatch::Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg, double bezierTol ) const
 {
-	//Generate planes u, v perpendicular between themself which intersection is the ray, and plane w perpendicular to the ray which contains the objectRay.origin
+	if( m_subPatches.size() == 0 )	return ( false );
+
+	//Generate planes u, v perpendicular between themself which intersection is the ray
 	Vector3D t;
 	if( fabs(objectRay.direction().x )< fabs(objectRay.direction().y ) )
 	{
@@ -121,164 +131,66 @@ bool BezierPatch::Intersect(const Ray& objectRay, double* tHit, DifferentialGeom
 	Vector3D nu = Normalize( CrossProduct( t, objectRay.direction() ) );
 	Vector3D nv = Normalize( CrossProduct( nu, objectRay.direction() ) );
 
-	//Nw is a plane perpendicural to contains ray direction
-	Vector3D nw = Normalize( objectRay.direction() );
-
-	//The planes contains the ray origin .	Anx rox + Bny roy + Cmn roz + D == 0
-	double au = nu.x;
-	double av = nv.x;
-	double bu = nu.y;
-	double bv = nv.y;
-	double cu = nu.z;
-	double cv = nv.z;
-	double du = DotProduct( -nu, Vector3D( objectRay.origin ) );
-	double dv = DotProduct( -nv, Vector3D( objectRay.origin ) );
-	double dw = DotProduct( -nw, Vector3D( objectRay.origin ) );
-
-	std::vector< std::vector< Vector3D > > buffer1;
-	std::vector< Vector3D > cPCopy;// = m_controlPoints;
-	for( unsigned int p = 0; p < m_controlPoints.size(); p++ )
-		cPCopy.push_back( Vector3D( m_controlPoints[p] ) );
-	SplitIPatch( cPCopy, &buffer1 );
-
-	std::vector < double > previousDistance;
-	std::vector < double > currentDistance;
-	double error = gc::Infinity;
+	// Now check if the function is being called from IntersectP,
+	// in which case the pointers tHit and dg are 0 and any intersection is enough
+	bool anyHit = ( tHit == 0 ) && ( dg == 0 );
 
-	double tol = 0.0000000001; //tolerance for the intersection rutine
-	double lengthBB =  Distance( m_bbox.pMin, m_bbox.pMax ) ;
-	int nIterations = ceil( log( 1 /  ( tol/ lengthBB ) ) * log( 2 ) )+1;
+	double thit = objectRay.maxt;
+	if( tHit && ( *tHit < thit ) )	thit = *tHit;
+	double uHit = 0.0;
+	double vHit = 0.0;
+	bool isIntersection = false;
 
-	int iteration = 0;
+	int firstLeaf = m_subPatches.size() - m_leafControlPoints.size() / 16;
 
-	while( ( iteration < nIterations ) && ( error > tol ) )
+	int nodesToVisit[3 * maxSubPatchesDepth + 1];
+	int toVisit = 0;
+	nodesToVisit[toVisit++] = 0;
+	while( toVisit > 0 )
 	{
-		//Split a subpatch in 4 pieces
-		std::vector< std::vector< Vector3D > > buffer2;
-		for( unsigned int patch = 0; patch < buffer1.size(); patch++ )
-		{
-			SplitIPatch( buffer1[patch], &buffer2 );
-		}
-		buffer1.clear();
+		int node = nodesToVisit[--toVisit];
+		const SubPatch& subPatch = m_subPatches[node];
 
-		//Hull clasification
-		for( unsigned int patch = 0; patch< buffer2.size(); patch++ )
-		{
-			std::vector< Vector3D > iPatch = buffer2[patch];
-			double pu1, pu2, pv1, pv2;
+		double t0;
+		double t1;
+		if( !subPatch.bbox.IntersectP( objectRay, &t0, &t1 ) || ( t0 > thit ) || ( t1 < bezierTol ) )	continue;
 
-			Point3D p00 = Point3D( iPatch[ 0 ] );
-			pu2 = au * p00[0] + bu * p00[1] + cu * p00[2] + du;
-			pv2 = av * p00[0] + bv * p00[1] + cv * p00[2]+ dv;
-
-			double intersectsU = false;
-			double intersectsV = false;
-			for( int i = 0; i < 16; i++ )
-			{
-				Point3D iPoint = Point3D( iPatch[ i ] );
-				pu1 = pu2;
-				pu2 = au * iPoint[0] + bu * iPoint[1] + cu * iPoint[2] + du;
-				pv1 = pv2;
-				pv2 = av * iPoint[0] + bv * iPoint[1] + cv * iPoint[2]+ dv;
-				if( ( pu1 * pu2 < 0 )  )	intersectsU = true;
-				if(  pv1 * pv2 < 0 )	intersectsV = true;
-			}
-
-			//Compute patch center and distance to patch center point
-			if( intersectsU && intersectsV )
+		if( node >= firstLeaf )
+		{
+			if( ClipSubPatch( &m_leafControlPoints[16 * ( node - firstLeaf )], subPatch.u0, subPatch.v0, subPatch.size, 0,
+					objectRay, nu, nv, bezierTol, &thit, &uHit, &vHit ) )
 			{
-				//Projection in w plane of the more external patch vertex
-				Vector3D proyVertex1 = iPatch[0] - nw * ( DotProduct( Vector3D( iPatch[0] ), nw ) + dw);
-				Vector3D proyVertex2 = iPatch[3] - nw * ( DotProduct( Vector3D( iPatch[3]  ), nw ) + dw);
-				Vector3D proyVertex3 = iPatch[12] - nw * ( DotProduct( Vector3D( iPatch[12] ), nw ) + dw);
-				Vector3D proyVertex4 = iPatch[15] - nw * ( DotProduct( Vector3D( iPatch[15] ), nw ) + dw);
-
-				//Determine if the objectRay.origin is inside the patch or not
-				if( DotProduct( CrossProduct( Vector3D( proyVertex2 - proyVertex1 ), Vector3D( objectRay.origin - proyVertex1 ) ), CrossProduct( Vector3D( proyVertex3 - proyVertex1 ), Vector3D( objectRay.origin - proyVertex1 ) ) ) < 0 &&
-						DotProduct( CrossProduct( Vector3D( proyVertex2 - proyVertex4 ), Vector3D( objectRay.origin - proyVertex4 ) ), CrossProduct( Vector3D( proyVertex3 - proyVertex4 ), Vector3D( objectRay.origin - proyVertex4 ) ) ) < 0 )
-				{
-					buffer1.push_back( iPatch );
-					Point3D center = Point3D( ( 1 / 64.0 ) * ( iPatch[0] +  3 * iPatch[4]
-													+ 3 * iPatch[8] + iPatch[12]
-													+ 3 * iPatch[1] +  9 * iPatch[5]
-													+ 9 * iPatch[9] +  3 * iPatch[13]
-													+ 3 * iPatch[2] +  9 * iPatch[6]
-													+ 9 * iPatch[10] +  3 * iPatch[14]
-													+ iPatch[3] +  3 * iPatch[7]
-													+ 3 * iPatch[11] + iPatch[15] ) );
-					currentDistance.push_back( Distance( center, objectRay.origin ) );
-
-					if( iteration == 0 ) previousDistance.push_back( gc::Infinity );
-				}
+				if( anyHit )	return ( true );
+				isIntersection = true;
 			}
 		}
-
-		if( buffer1.size() == 0 ) return ( false );
-
-		if ( currentDistance.size() == previousDistance.size() )
+		else
 		{
-			std::vector< double > errorList;
-			for( unsigned e = 0; e < currentDistance.size(); e++ )
-				errorList.push_back( fabs( previousDistance[e] - currentDistance[e] ) );
-
-			error = *std::max_element( errorList.begin(), errorList.end() );
-			previousDistance = currentDistance;
-			currentDistance.clear();
-			errorList.clear();
+			for( int c = 4; c > 0; c-- )
+				nodesToVisit[toVisit++] = 4 * node + c;
 		}
-		else return ( false );
-		buffer2.clear();
-
-		iteration++;
-	}
-
-	// Now check if the function is being called from IntersectP,
-		// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) )	return ( true );
-
-	std::vector < double > distances;
-	for( unsigned int a = 0; a < previousDistance.size(); a++ )
-	{
-		double thitRay;
-		if( objectRay.direction().x != 0 ) thitRay = ( objectRay( previousDistance[a] ).x - objectRay.origin.x ) / objectRay.direction().x;
-		else if ( objectRay.direction().y != 0 ) thitRay = ( objectRay( previousDistance[a] ).y - objectRay.origin.y ) / objectRay.direction().y;
-		else	thitRay = ( objectRay( previousDistance[a] ).z - objectRay.origin.z ) / objectRay.direction().z;
-		distances.push_back( thitRay );
 	}
-	previousDistance.clear();
-
-	std::map< double, std::vector< Vector3D > > distancesMap;
-	for( unsigned int i = 0; i < buffer1.size(); i++ )
-		distancesMap.insert( std::pair< double, std::vector< Vector3D > > ( distances[i], buffer1[i] ) );
-
-	std::sort( distances.begin(), distances.end() );
 
-	std::vector < double > thitList;
-	for( unsigned int i = 0; i < distances.size(); ++i)
-		if( ( distances[i] < objectRay.maxt ) && ( distances[i] > bezierTol ) ) thitList.push_back( distances[i] );
+	if( !isIntersection )	return ( false );
 
-	if( thitList.size() == 0 ) return ( false );
-
-	std::vector< Vector3D > iPatch = distancesMap[ thitList[0] ];
-	double thit = thitList[0];
-
-	buffer1.clear();
-	distances.clear();
-	distancesMap.clear();
+	Point3D point;
+	Vector3D dpdu;
+	Vector3D dpdv;
+	Evaluate( uHit, vHit, &point, &dpdu, &dpdv );
 
-	Vector3D dpdu = DPDU( 0.5, 0.5, &iPatch);
-	Vector3D dpdv = DPDV( 0.5, 0.5, &iPatch);
+	std::vector< Vector3D > controlPoints;
+	for( unsigned int p = 0; p < m_controlPoints.size(); p++ )
+		controlPoints.push_back( Vector3D( m_controlPoints[p] ) );
 
-	// Compute cylinder \dndu and \dndv
-	Vector3D d2Pduu = D2PDUU( 0.5, 0.5, &iPatch );
-	Vector3D d2Pduv= D2PDUV( 0.5, 0.5, &iPatch );
-	Vector3D d2Pdvv= D2PDVV( 0.5, 0.5, &iPatch );
+	Vector3D d2Pduu = D2PDUU( uHit, vHit, &controlPoints );
+	Vector3D d2Pduv= D2PDUV( uHit, vHit, &controlPoints );
+	Vector3D d2Pdvv= D2PDVV( uHit, vHit, &controlPoints );
 
 	// Compute coefficients for fundamental forms
 	double E = DotProduct( dpdu, dpdu );
 	double F = DotProduct( dpdu, dpdv );
 	double G = DotProduct( dpdv, dpdv );
-	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );;
+	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 	double e = DotProduct( N, d2Pduu );
 	double f = DotProduct( N, d2Pduv );
 	double g = DotProduct( N, d2Pdvv );
@@ -290,15 +202,14 @@ bool BezierPatch::Intersect(const Ray& objectRay, double* tHit, DifferentialGeom
 	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
 					(f*F - g*E) * invEGF2 * dpdv;
 
-// Initialize _DifferentialGeometry_ from parametric information
+	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( objectRay( thit ) ,
 								dpdu,
 								dpdv,
 								dndu,
 								dndv,
-								0.5, 0.5, 0 );
+								uHit, vHit, 0 );
 	*tHit = thit;
-	thitList.clear();
 	return ( true );
 
 }
@@ -308,6 +219,7 @@ void BezierPatch::SetControlPoints( std::vector< Point3D > boundedPoints )
 	//derivates: qu00, qv00, quv00, qu01, qv01, quv01, qu10, qv10, quv10, qu11, qv11,quv11
 	std::vector< Vector3D > derivates = CornerDerivates( boundedPoints );
 
+	m_controlPoints.clear();
 	//m_controlPointsList << boundedPoints[0]; //p00
 	Point3D p00  = boundedPoints[0];
 	m_controlPoints.push_back( p00 );
@@ -345,15 +257,283 @@ void BezierPatch::SetControlPoints( std::vector< Point3D > boundedPoints )
 	Point3D p33  = boundedPoints[6]; //p33
 	m_controlPoints.push_back( p33 );
 
-	m_bbox = BBox();
-	int nControlPoints = m_controlPoints.size();
-	for (int i = 0; i < nControlPoints; i++)
-		m_bbox = Union( m_bbox , m_controlPoints[i] );
+	BuildSubPatches();
+}
+
+/*!
+ * Sets the number of levels of the sub-patches hierarchy to \a depth and builds the hierarchy again.
+ * The leaf sub-patches cover 1/2^depth of the patch parameters in each direction.
+ */
+void BezierPatch::SetSubPatchesDepth( int depth )
+{
+	if( depth < 0 )	depth = 0;
+	if( depth > maxSubPatchesDepth )	depth = maxSubPatchesDepth;
+	if( depth == m_subPatchesDepth )	return;
+
+	m_subPatchesDepth = depth;
+	BuildSubPatches();
+}
+
+
+/*!
+ * Builds the sub-patches hierarchy. Each leaf box contains the control points of the leaf sub-patch and the
+ * patch bounding box is the union of the leaf boxes, tighter than the box of the patch control points.
+ */
+void BezierPatch::BuildSubPatches()
+{
+	m_subPatches.clear();
+	m_leafControlPoints.clear();
+	if( m_controlPoints.size() != 16 )	return;
+
+	BBox controlPointsBBox;
+	std::vector< Vector3D > controlPoints;
+	for( unsigned int p = 0; p < m_controlPoints.size(); p++ )
+	{
+		controlPointsBBox = Union( controlPointsBBox, m_controlPoints[p] );
+		controlPoints.push_back( Vector3D( m_controlPoints[p] ) );
+	}
+	m_tolerance = 0.000000001 * Distance( controlPointsBBox.pMin, controlPointsBBox.pMax );
+
+	int nLeaves = 1 << ( 2 * m_subPatchesDepth );
+	m_subPatches.resize( ( 4 * nLeaves - 1 ) / 3 );
+	m_leafControlPoints.resize( 16 * nLeaves );
+	BuildSubPatchesRecursive( controlPoints, 0, 0.0, 0.0, 1.0, 0 );
 
+	m_bbox = m_subPatches[0].bbox;
 	m_centoid = Point3D( m_bbox.pMin.x + 0.5 * ( m_bbox.pMax.x - m_bbox.pMin.x  ),
 			m_bbox.pMin.y + 0.5 * ( m_bbox.pMax.y - m_bbox.pMin.y  ),
 			m_bbox.pMin.z + 0.5 * ( m_bbox.pMax.z - m_bbox.pMin.z  ) );
+}
+
+/*!
+ * Sets the node \a node of the hierarchy to the sub-patch with control points \a p and creates its children
+ * until the hierarchy depth.
+ */
+void BezierPatch::BuildSubPatchesRecursive( const std::vector< Vector3D >& p, int node, double u0, double v0, double size, int level )
+{
+	m_subPatches[node].u0 = u0;
+	m_subPatches[node].v0 = v0;
+	m_subPatches[node].size = size;
+
+	if( level == m_subPatchesDepth )
+	{
+		int leaf = node - ( m_subPatches.size() - m_leafControlPoints.size() / 16 );
+
+		BBox bbox;
+		for( int i = 0; i < 16; i++ )
+		{
+			m_leafControlPoints[16 * leaf + i] = p[i];
+			bbox = Union( bbox, Point3D( p[i] ) );
+		}
+		bbox.Expand( m_tolerance );
+		m_subPatches[node].bbox = bbox;
+		return;
+	}
+
+	std::vector< std::vector< Vector3D > > children;
+	SplitIPatch( p, &children );
+
+	double half = 0.5 * size;
+	BBox bbox;
+	for( int c = 0; c < 4; c++ )
+	{
+		BuildSubPatchesRecursive( children[c], 4 * node + 1 + c, u0 + ( c / 2 ) * half, v0 + ( c % 2 ) * half, half, level + 1 );
+		bbox = Union( bbox, m_subPatches[4 * node + 1 + c].bbox );
+	}
+	m_subPatches[node].bbox = bbox;
+}
+
+/*!
+ * Looks for the intersection of the ray with the sub-patch of control points \a p, that covers the parameters
+ * [u0, u0 + size] x [v0, v0 + size]. The sub-patch is discarded when all its control points are at the same side
+ * of one of the planes \a nu and \a nv that contain the ray. Otherwise, Newton iterations are started from the
+ * sub-patch center. The search ends at the intersection found if the ray cannot meet the sub-patch at other points.
+ * Otherwise, or if the iterations do not converge inside the sub-patch to an intersection between \a tMin and \a tMax,
+ * the sub-patch is split in four, so other and nearer intersections of the sub-patch are still found.
+ *
+ * Returns true and updates \a tMax, \a uHit and \a vHit when an intersection between \a tMin and \a tMax is found.
+ */
+bool BezierPatch::ClipSubPatch( const Vector3D* p, double u0, double v0, double size, int level, const Ray& objectRay,
+		const Vector3D& nu, const Vector3D& nv, double tMin, double* tMax, double* uHit, double* vHit ) const
+{
+	const int maxClipLevels = 10;
+
+	Vector3D origin( objectRay.origin );
+	double directionLengthSquared = objectRay.direction().lengthSquared();
+	double minU = gc::Infinity;
+	double maxU = -gc::Infinity;
+	double minV = gc::Infinity;
+	double maxV = -gc::Infinity;
+	double minT = gc::Infinity;
+	double maxT = -gc::Infinity;
+	for( int i = 0; i < 16; i++ )
+	{
+		double distanceU = DotProduct( nu, p[i] - origin );
+		double distanceV = DotProduct( nv, p[i] - origin );
+		double distanceT = DotProduct( objectRay.direction(), p[i] - origin ) / directionLengthSquared;
+		minU = std::min( minU, distanceU );
+		maxU = std::max( maxU, distanceU );
+		minV = std::min( minV, distanceV );
+		maxV = std::max( maxV, distanceV );
+		minT = std::min( minT, distanceT );
+		maxT = std::max( maxT, distanceT );
+	}
+	if( ( minU > m_tolerance ) || ( maxU < -m_tolerance ) || ( minV > m_tolerance ) || ( maxV < -m_tolerance ) )
+		return ( false );
+	//The sub-patch is inside the convex hull of its control points, so its points are between minT and maxT
+	if( ( minT >= *tMax ) || ( maxT <= tMin ) )	return ( false );
+
+	bool isIntersection = false;
+	double u;
+	double v;
+	double t;
+	if( NewtonIntersect( u0, v0, size, objectRay, nu, nv, &u, &v, &t ) && ( t > tMin ) && ( t < *tMax ) )
+	{
+		*tMax = t;
+		*uHit = u;
+		*vHit = v;
+		if( HasSingleIntersection( p, nu, nv ) )	return ( true );
+		isIntersection = true;
+	}
+	if( level >= maxClipLevels )	return ( isIntersection );
+
+	std::vector< std::vector< Vector3D > > children;
+	SplitIPatch( std::vector< Vector3D >( p, p + 16 ), &children );
+
+	double half = 0.5 * size;
+	for( int c = 0; c < 4; c++ )
+	{
+		if( ClipSubPatch( &children[c][0], u0 + ( c / 2 ) * half, v0 + ( c % 2 ) * half, half, level + 1,
+				objectRay, nu, nv, tMin, tMax, uHit, vHit ) )
+			isIntersection = true;
+	}
+
+	return ( isIntersection );
+}
+
+/*!
+ * Returns true if the ray, the intersection of the planes \a nu and \a nv, cannot meet the sub-patch of control
+ * points \a p at more than one point.
+ *
+ * The sub-patch is projected on the planes. If every partial derivative in u of the projection turns to the same
+ * side to reach every partial derivative in v, the projection is one to one, so only one point of the sub-patch
+ * projects on the ray. The derivatives are bounded by the hull of the differences of consecutive control points.
+ */
+bool BezierPatch::HasSingleIntersection( const Vector3D* p, const Vector3D& nu, const Vector3D& nv ) const
+{
+	double du[12][2];
+	double dv[12][2];
+	for( int i = 0; i < 3; i++ )
+	{
+		for( int j = 0; j < 4; j++ )
+		{
+			Vector3D differenceU = p[4 * ( i + 1 ) + j] - p[4 * i + j];
+			du[4 * i + j][0] = DotProduct( nu, differenceU );
+			du[4 * i + j][1] = DotProduct( nv, differenceU );
+
+			Vector3D differenceV = p[4 * j + i + 1] - p[4 * j + i];
+			dv[4 * i + j][0] = DotProduct( nu, differenceV );
+			dv[4 * i + j][1] = DotProduct( nv, differenceV );
+		}
+	}
+
+	bool isPositive = false;
+	bool isNegative = false;
+	for( int a = 0; a < 12; a++ )
+	{
+		for( int b = 0; b < 12; b++ )
+		{
+			double cross = du[a][0] * dv[b][1] - du[a][1] * dv[b][0];
+			if( cross > 0.0 )	isPositive = true;
+			else if( cross < 0.0 )	isNegative = true;
+			else	return ( false );
+		}
+		if( isPositive && isNegative )	return ( false );
+	}
+
+	return ( true );
+}
+
+/*!
+ * Computes with Newton iterations, starting from the center of the sub-patch [u0, u0 + size] x [v0, v0 + size],
+ * the parameters \a u and \a v where the patch meets the planes \a nu and \a nv that contain the ray, and the ray
+ * parameter \a t of that point.
+ *
+ * Returns false if the iterations do not converge to a point of the sub-patch.
+ */
+bool BezierPatch::NewtonIntersect( double u0, double v0, double size, const Ray& objectRay, const Vector3D& nu, const Vector3D& nv,
+		double* u, double* v, double* t ) const
+{
+	const int maxNewtonIterations = 8;
+	const double parametersTolerance = 0.000000001;
+
+	double uN = u0 + 0.5 * size;
+	double vN = v0 + 0.5 * size;
+	for( int i = 0; i <= maxNewtonIterations; i++ )
+	{
+		Point3D point;
+		Vector3D dpdu;
+		Vector3D dpdv;
+		Evaluate( uN, vN, &point, &dpdu, &dpdv );
+
+		Vector3D distance = point - objectRay.origin;
+		double fu = DotProduct( nu, distance );
+		double fv = DotProduct( nv, distance );
+		if( ( fabs( fu ) <= m_tolerance ) && ( fabs( fv ) <= m_tolerance ) )
+		{
+			if( ( uN < u0 - parametersTolerance ) || ( uN > u0 + size + parametersTolerance )
+					|| ( vN < v0 - parametersTolerance ) || ( vN > v0 + size + parametersTolerance ) )
+				return ( false );
+
+			*u = std::min( std::max( uN, 0.0 ), 1.0 );
+			*v = std::min( std::max( vN, 0.0 ), 1.0 );
+			*t = DotProduct( distance, objectRay.direction() ) / objectRay.direction().lengthSquared();
+			return ( true );
+		}
+
+		double a = DotProduct( nu, dpdu );
+		double b = DotProduct( nu, dpdv );
+		double c = DotProduct( nv, dpdu );
+		double d = DotProduct( nv, dpdv );
+		double det = a * d - b * c;
+		if( det == 0.0 )	return ( false );
+
+		uN -= ( d * fu - b * fv ) / det;
+		vN -= ( a * fv - c * fu ) / det;
+		if( ( uN < u0 - size ) || ( uN > u0 + 2 * size ) || ( vN < v0 - size ) || ( vN > v0 + 2 * size ) )
+			return ( false );
+	}
+
+	return ( false );
+}
+
+/*!
+ * Computes the patch point \a point and its partial derivatives \a dpdu and \a dpdv at the parameters \a u and \a v.
+ */
+void BezierPatch::Evaluate( double u, double v, Point3D* point, Vector3D* dpdu, Vector3D* dpdv ) const
+{
+	double bu[4] = { ( 1 - u ) * ( 1 - u ) * ( 1 - u ), 3 * u * ( 1 - u ) * ( 1 - u ), 3 * u * u * ( 1 - u ), u * u * u };
+	double dbu[4] = { -3 * ( 1 - u ) * ( 1 - u ), 3 * ( 1 - u ) * ( 1 - 3 * u ), 3 * u * ( 2 - 3 * u ), 3 * u * u };
+	double bv[4] = { ( 1 - v ) * ( 1 - v ) * ( 1 - v ), 3 * v * ( 1 - v ) * ( 1 - v ), 3 * v * v * ( 1 - v ), v * v * v };
+	double dbv[4] = { -3 * ( 1 - v ) * ( 1 - v ), 3 * ( 1 - v ) * ( 1 - 3 * v ), 3 * v * ( 2 - 3 * v ), 3 * v * v };
+
+	Vector3D p;
+	Vector3D pu;
+	Vector3D pv;
+	for( int i = 0; i < 4; i++ )
+	{
+		for( int j = 0; j < 4; j++ )
+		{
+			Vector3D controlPoint( m_controlPoints[4 * i + j] );
+			p += ( bu[i] * bv[j] ) * controlPoint;
+			pu += ( dbu[i] * bv[j] ) * controlPoint;
+			pv += ( bu[i] * dbv[j] ) * controlPoint;
+		}
+	}
 
+	*point = Point3D( p );
+	*dpdu = pu;
+	*dpdv = pv;
 }
 
 std::vector< Vector3D >  BezierPatch::CornerDerivates( std::vector< Point3D > boundedPoints )
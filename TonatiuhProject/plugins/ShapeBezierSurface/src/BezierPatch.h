@@ -59,13 +59,36 @@ public:
 	Point3D GetCentroid() const { return ( m_centoid ); };
 	NormalVector GetNormal( double u, double v ) const;
 	Point3D GetPoint3D (double u, double v) const;
+	int GetSubPatchesDepth() const { return ( m_subPatchesDepth ); };
 
 	void GeneratePrimitives( SoAction *action );
     bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg, double bezierTol ) const;
     void SetControlPoints( std::vector< Point3D > boundedPoints );
+    void SetSubPatchesDepth( int depth );
 
+	static const int maxSubPatchesDepth = 6;
 
 private:
+	/*!
+	 * Sub-patch of the hierarchy. It covers the parameters [u0, u0 + size] x [v0, v0 + size].
+	 */
+	struct SubPatch
+	{
+		BBox bbox;
+		double u0;
+		double v0;
+		double size;
+	};
+
+	void BuildSubPatches();
+	void BuildSubPatchesRecursive( const std::vector< Vector3D >& p, int node, double u0, double v0, double size, int level );
+	bool ClipSubPatch( const Vector3D* p, double u0, double v0, double size, int level, const Ray& objectRay,
+			const Vector3D& nu, const Vector3D& nv, double tMin, double* tMax, double* uHit, double* vHit ) const;
+	bool HasSingleIntersection( const Vector3D* p, const Vector3D& nu, const Vector3D& nv ) const;
+	bool NewtonIntersect( double u0, double v0, double size, const Ray& objectRay, const Vector3D& nu, const Vector3D& nv,
+			double* u, double* v, double* t ) const;
+	void Evaluate( double u, double v, Point3D* point, Vector3D* dpdu, Vector3D* dpdv ) const;
+
     std::vector< Vector3D > CornerDerivates( std::vector< Point3D > boundedPoints );
 	Vector3D DPDU( double u, double v, std::vector< Vector3D >* controlPoint = 0 ) const;
 	Vector3D DPDV( double u, double v, std::vector< Vector3D >* controlPoint = 0 ) const;
@@ -85,7 +108,12 @@ private:
 	Point3D m_centoid;
 	std::vector< Point3D > m_controlPoints;
 
-	int m_nIterations;
+	//Complete quadtree of sub-patches. The children of the node i are the nodes 4i+1 to 4i+4.
+	int m_subPatchesDepth;
+	std::vector< SubPatch > m_subPatches;
+	//Control points of the leaf sub-patches, 16 for each leaf.
+	std::vector< Vector3D > m_leafControlPoints;
+	double m_tolerance;
 };
 
 #endif /* BEZIERPATCH_H_ */
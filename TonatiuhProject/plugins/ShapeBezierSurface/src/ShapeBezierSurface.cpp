@@ -67,7 +67,8 @@ void ShapeBezierSurface::initClass()
 }
 
 ShapeBezierSurface::ShapeBezierSurface( )
-:m_pBVH( 0 ),
+:m_patchesLoaded( true ),
+ m_pBVH( 0 ),
  m_tol( 0.00001 )
 {
 	SO_NODE_CONSTRUCTOR(ShapeBezierSurface);
@@ -79,31 +80,15 @@ ShapeBezierSurface::ShapeBezierSurface( )
 
 
 	m_pPointsSensor = new SoFieldSensor(updatePatchesList, this);
-	m_pPointsSensor->setPriority( 0 );
-	m_pPointsSensor->attach( &m_pointsList );
-
 	m_pUSensor = new SoFieldSensor(updatePatchesList, this);
-	m_pUSensor->setPriority( 0 );
-	m_pUSensor->attach( &m_nOfUCurves );
-
 	m_pVSensor = new SoFieldSensor(updatePatchesList, this);
-	m_pVSensor->setPriority( 0 );
-	m_pVSensor->attach( &m_nOfVCurves );
+	AttachSensors();
 
 }
 
 ShapeBezierSurface::~ShapeBezierSurface()
 {
-	delete m_pBVH;
-
-	if( m_surfacesVector.size() > 0 )
-	{
-		for( unsigned int f = 0; f < m_surfacesVector.size(); f++ )
-		{
-			delete m_surfacesVector[f];
-		}
-	}
-	m_surfacesVector.clear();
+	ClearPatches();
 
 	delete m_pPointsSensor;
 	delete m_pUSensor;
@@ -122,113 +107,35 @@ double ShapeBezierSurface::GetArea() const
 
 BBox ShapeBezierSurface::GetBBox() const
 {
+	LoadPatches();
 	if( m_pBVH )
 		return ( m_pBVH->GetBBox() );
 
 	return ( BBox( ) );
 }
 
+/*!
+ * Sets the surface to the network of \a nUCurves and \a nVCurves curves through the points \a inputData.
+ * The patches and their hierarchies are built again.
+ */
 bool ShapeBezierSurface::DefineSurfacePatches( std::vector< Point3D > inputData, int nUCurves, int nVCurves )
 {
-
-	m_pPointsSensor->detach();
-	m_pUSensor->detach();
-	m_pVSensor->detach();
-
-	if( m_surfacesVector.size() > 0 )
-	{
-		for( unsigned int f = 0; f < m_surfacesVector.size(); f++ )
-		{
-			delete m_surfacesVector[f];
-			m_surfacesVector[f] = 0;
-		}
-	}
-	m_surfacesVector.clear();
-
+	DetachSensors();
 
 	m_nOfUCurves.setValue( nUCurves );
 	m_nOfVCurves.setValue( nVCurves );
 
+	m_pointsList.setNum( inputData.size() );
 	for( unsigned int p = 0; p < inputData.size(); p++ )
 	{
 		Point3D point = inputData[p];
 		m_pointsList.set1Value( p, point.x, point.y, point.z);
 	}
 
-	int k = 4;
-
-	double nPointsPerUCurve = nVCurves;
-	double nPointsPerVCurve = nUCurves;
-
-	CurveNetwork* curveNetwork = new CurveNetwork();
-
-	std::vector< double > uKnotsVector;
-	int nU = nPointsPerUCurve +1;
-	for( int i = 0; i <= ( nU+ k ) ; i++ )
-	{
-		 if( i < k ) uKnotsVector.push_back( 0.0 );
-		 else if( i > nU ) uKnotsVector.push_back( nU- k + 2 );
-		 else uKnotsVector.push_back( i -k + 1 );
-	 }
-
-	for( int i = 0; i < nUCurves; i++ )
-	{
-		 std::vector< Point3D > data;
-		 for( int j = 0; j < nPointsPerUCurve; j++)
-		 {
-			 data.push_back( inputData[nPointsPerUCurve * i + j ] );
-		 }
-
-		 Curve* uCurve = new Curve( data, uKnotsVector );
-		 curveNetwork->AddUCurve( uCurve );
-	 }
-
-
-	std::vector< double > vKnotsVector;
-	int nV = nPointsPerVCurve + 1;
-	 for( int i = 0; i <= ( nV+ k ) ; i++ )
-	 {
-		 if( i < k ) vKnotsVector.push_back(0.0 );
-		 else if( i > nV ) vKnotsVector.push_back( nV - k + 2 );
-		 else vKnotsVector.push_back( i -k + 1 );
-	 }
-
-	 for( int i = 0; i < nVCurves; i++ )
-	 {
-		 std::vector< Point3D > data;
-		 for( int j = 0; j < nPointsPerVCurve; j++)
-		 {
-			 data.push_back( inputData[i + nPointsPerUCurve * j ] );
-		 }
-
-		 Curve* vCurve = new Curve( data, vKnotsVector );
-		 curveNetwork->AddVCurve( vCurve );
-	 }
-
-	m_surfacesVector = curveNetwork->GetSurface();
-
-
-	if( m_pBVH )
-	{
-		delete m_pBVH;
-		m_pBVH = 0;
-	}
-
-	m_pBVH = new BVHPatch( &m_surfacesVector, 1 );
-
-	BBox bbox = m_pBVH->GetBBox();
-	double minDistance = std::min( std::min( bbox.pMax.x-bbox.pMin.x, bbox.pMax.y-bbox.pMin.y ), bbox.pMax.z-bbox.pMin.z );
-	m_tol = std::min( 0.0001, minDistance * 0.0001 );
-
-
-
-	m_pPointsSensor->setPriority( 0 );
-	m_pPointsSensor->attach( &m_pointsList );
-	m_pUSensor->setPriority( 0 );
-	m_pUSensor->attach( &m_nOfUCurves );
-	m_pVSensor->setPriority( 0 );
-	m_pVSensor->attach( &m_nOfVCurves );
+	AttachSensors();
 
+	ClearPatches();
+	LoadPatches();
 
 	return ( true );
 
@@ -242,6 +149,7 @@ bool ShapeBezierSurface::Intersect(const Ray& objectRay, double* tHit, Different
 	double tHitShape= objectRay.maxt; //Inf
 	DifferentialGeometry dgShape;
 
+	LoadPatches();
 	if( !m_pBVH )	return ( false );
 	if ( !m_pBVH->Intersect( objectRay, &tHitShape, &dgShape, m_tol ) )	return ( false );
 
@@ -265,6 +173,15 @@ Point3D ShapeBezierSurface::Sample( double /*u*/, double /*v*/ ) const
 	return Point3D();
 }
 
+/*!
+ * Builds the patches and their hierarchies before the tracing, so they are not built by the first
+ * intersection of one of the tracing threads.
+ */
+void ShapeBezierSurface::PrepareTracing()
+{
+	LoadPatches();
+}
+
 /*
 void ShapeBezierSurface::GLRender( SoGLRenderAction* action )
 {
@@ -313,6 +230,7 @@ void ShapeBezierSurface::generatePrimitives(SoAction *action)
 	    if (columns < 4) columns = 4;
 	    if (columns > 128) columns = 128;
 
+		LoadPatches();
 
 		beginShape(action, QUADS );
 
@@ -399,40 +317,80 @@ void ShapeBezierSurface::generatePrimitives(SoAction *action)
 }
 
 
+/*!
+ * The patches are built again the next time they are used.
+ */
 void ShapeBezierSurface::updatePatchesList( void *data, SoSensor* )
 {
 	ShapeBezierSurface* shapeBezier = (ShapeBezierSurface *) data;
-	if( shapeBezier->m_surfacesVector.size() > 0 )
-	{
-		for( unsigned int f = 0; f < shapeBezier->m_surfacesVector.size(); f++ )
-		{
-			delete ( shapeBezier->m_surfacesVector[f] );
-			shapeBezier->m_surfacesVector[f] = 0;
-		}
-	}
-	shapeBezier->m_surfacesVector.clear();
+	shapeBezier->ClearPatches();
+}
 
-	if( shapeBezier->m_pBVH )
-	{
-		delete shapeBezier->m_pBVH;
-		shapeBezier->m_pBVH = 0;
-	}
+/*!
+ * Attaches the fields sensors.
+ */
+void ShapeBezierSurface::AttachSensors()
+{
+	m_pPointsSensor->setPriority( 0 );
+	m_pPointsSensor->attach( &m_pointsList );
+	m_pUSensor->setPriority( 0 );
+	m_pUSensor->attach( &m_nOfUCurves );
+	m_pVSensor->setPriority( 0 );
+	m_pVSensor->attach( &m_nOfVCurves );
+}
+
+/*!
+ * Deletes the patches and their hierarchies. They are built again from the fields when they are used.
+ */
+void ShapeBezierSurface::ClearPatches()
+{
+	QMutexLocker locker( &m_patchesMutex );
+
+	delete m_pBVH;
+	m_pBVH = 0;
+
+	for( unsigned int f = 0; f < m_surfacesVector.size(); f++ )
+		delete m_surfacesVector[f];
+	m_surfacesVector.clear();
+
+	m_patchesLoaded = false;
+}
 
+/*!
+ * Detaches the fields sensors.
+ */
+void ShapeBezierSurface::DetachSensors()
+{
+	m_pPointsSensor->detach();
+	m_pUSensor->detach();
+	m_pVSensor->detach();
+}
 
-	int pointsSize = shapeBezier->m_pointsList.getNum();
+/*!
+ * Builds the patches of the curves network defined by the fields and the patches hierarchy, if they have not
+ * been built yet. Each patch keeps the hierarchy of its sub-patches, that is built with the patches hierarchy.
+ */
+void ShapeBezierSurface::LoadPatches() const
+{
+	if( m_patchesLoaded )	return;
+
+	QMutexLocker locker( &m_patchesMutex );
+	if( m_patchesLoaded )	return;
+
+	int pointsSize = m_pointsList.getNum();
 
-	int nUCurves = shapeBezier->m_nOfUCurves.getValue();
-	int nVCurves = shapeBezier->m_nOfVCurves.getValue();
+	int nUCurves = m_nOfUCurves.getValue();
+	int nVCurves = m_nOfVCurves.getValue();
 
 
-	if( ( pointsSize > 0 ) &&
-			( nUCurves > 0 ) &&
-			( nVCurves > 0 )   )
+	if( ( nUCurves > 0 ) &&
+			( nVCurves > 0 ) &&
+			( pointsSize >= nUCurves * nVCurves ) )
 	{
 
 		int k = 4;
-		double nPointsPerUCurve = shapeBezier->m_nOfVCurves.getValue();
-		double nPointsPerVCurve = shapeBezier->m_nOfUCurves.getValue();
+		double nPointsPerUCurve = nVCurves;
+		double nPointsPerVCurve = nUCurves;
 		CurveNetwork curveNetwork;
 		std::vector< double > uKnotsVector;
 		int nU = nPointsPerUCurve +1;
@@ -449,9 +407,9 @@ void ShapeBezierSurface::updatePatchesList( void *data, SoSensor* )
 			for( int j = 0; j < nPointsPerUCurve; j++)
 			{
 				int pointIndex =nPointsPerUCurve * i + j;
-				Point3D point = Point3D( shapeBezier->m_pointsList[pointIndex][0],
-						shapeBezier->m_pointsList[pointIndex][1],
-						shapeBezier->m_pointsList[pointIndex][2] );
+				Point3D point = Point3D( m_pointsList[pointIndex][0],
+						m_pointsList[pointIndex][1],
+						m_pointsList[pointIndex][2] );
 
 				data.push_back( point );
 			}
@@ -476,9 +434,9 @@ void ShapeBezierSurface::updatePatchesList( void *data, SoSensor* )
 			{
 
 				int pointIndex = i + nPointsPerUCurve * j;
-				Point3D point = Point3D( shapeBezier->m_pointsList[pointIndex][0],
-						shapeBezier->m_pointsList[pointIndex][1],
-						shapeBezier->m_pointsList[pointIndex][2] );
+				Point3D point = Point3D( m_pointsList[pointIndex][0],
+						m_pointsList[pointIndex][1],
+						m_pointsList[pointIndex][2] );
 
 				data.push_back( point );
 			}
@@ -486,16 +444,15 @@ void ShapeBezierSurface::updatePatchesList( void *data, SoSensor* )
 			Curve* vCurve = new Curve( data, vKnotsVector );
 			curveNetwork.AddVCurve( vCurve );
 		}
-		shapeBezier->m_surfacesVector = curveNetwork.GetSurface();
+		m_surfacesVector = curveNetwork.GetSurface();
 
 
-		shapeBezier->m_pBVH = new BVHPatch( &(shapeBezier->m_surfacesVector), 1);
+		m_pBVH = new BVHPatch( &m_surfacesVector, 1 );
 
-		BBox bbox = shapeBezier->m_pBVH->GetBBox();
+		BBox bbox = m_pBVH->GetBBox();
 		double minDistance = std::min( std::min( bbox.pMax.x-bbox.pMin.x, bbox.pMax.y-bbox.pMin.y ), bbox.pMax.z-bbox.pMin.z );
-		shapeBezier->m_tol = std::min( 0.0001, minDistance * 0.0001 );
+		m_tol = std::min( 0.0001, minDistance * 0.0001 );
 	}
 
-
+	m_patchesLoaded = true;
 }
-
@@ -39,6 +39,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef SHAPEBEZIERPATCH_H_
 #define SHAPEBEZIERPATCH_H_
 
+#include <QMutex>
+
 #include <Inventor/fields/SoSFInt32.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
@@ -70,6 +72,7 @@ public:
 	bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void PrepareTracing();
 
 	bool DefineSurfacePatches( std::vector< Point3D > inputData, int nUCurves, int nVCurves );
 
@@ -85,18 +88,25 @@ protected:
 	virtual ~ShapeBezierSurface();
 
 private:
+	void AttachSensors();
+	void ClearPatches();
+	void DetachSensors();
+	void LoadPatches() const;
+
 	trt::TONATIUH_CONTAINERREALVECTOR3 m_pointsList;
 	SoSFInt32 m_nOfUCurves;
 	SoSFInt32 m_nOfVCurves;
-	std::vector< BezierPatch* > m_surfacesVector;
 
 	SoFieldSensor* m_pPointsSensor;
 	SoFieldSensor* m_pUSensor;
 	SoFieldSensor* m_pVSensor;
 
-	BVHPatch* m_pBVH;
-
-	double m_tol;
+	//The patches and their hierarchies are built the first time they are used
+	mutable QMutex m_patchesMutex;
+	mutable volatile bool m_patchesLoaded;
+	mutable std::vector< BezierPatch* > m_surfacesVector;
+	mutable BVHPatch* m_pBVH;
+	mutable double m_tol;
 };
 
 #endif /* SHAPEBEZIERPATCH_H_ */
@@ -4,6 +4,10 @@ CONFIG       += plugin debug_and_release
 
 include( ../../config.pri )
 
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += concurrent
+}
+
 INCLUDEPATH += . \
 			src \
                 $$(TONATIUH_ROOT)/plugins \
@@ -37,416 +37,443 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 ***************************************************************************/
 
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 #include "BVH.h"
 #include "DifferentialGeometry.h"
-#include "gf.h"
+#include "gc.h"
 #include "Ray.h"
+#include "TriangleMesh.h"
 
-/*! *****************************
- * class BVHNode
- * **************************** */
-
-BVHNode::BVHNode()
-: m_bbox(),
-  m_index( 0 ),
-  m_isLeaf( 0 ),
-  m_nOfTriangles( 0 ),
-  m_leftNode( 0 ),
-  m_rightNode( 0 )
+namespace
 {
+	const int nBuckets = 16;
+	const int maxLeafSize = 255;
+	const int maxSAHDepth = 64;
+	const int maxTraversalDepth = 128;
+
+	/*!
+	 * Returns the greatest float that is not greater than \a value.
+	 */
+	float RoundDown( double value )
+	{
+		float rounded = float( value );
+		if( rounded > value )	rounded -= std::fabs( rounded ) * FLT_EPSILON + FLT_MIN;
+		return rounded;
+	}
 
-}
-
-/*!
- * Removes the node and its children
- */
-BVHNode::~BVHNode()
-{
-	if( !m_isLeaf )
+	/*!
+	 * Returns the lowest float that is not lower than \a value.
+	 */
+	float RoundUp( double value )
 	{
-		if( m_leftNode )	delete m_leftNode;
-		if( m_rightNode )	delete m_rightNode;
+		float rounded = float( value );
+		if( rounded < value )	rounded += std::fabs( rounded ) * FLT_EPSILON + FLT_MIN;
+		return rounded;
 	}
-}
 
+	struct CentroidBucketCompare
+	{
+		CentroidBucketCompare( int splitBucket, int axis, double minCentroid, double centroidExtent )
+		:m_splitBucket( splitBucket ), m_axis( axis ), m_minCentroid( minCentroid ), m_centroidExtent( centroidExtent )
+		{
+		}
 
-/*!
- * Defines this node as leaf node.
- */
-void BVHNode::MakeLeaf(unsigned int index, unsigned int nTriangles )
-{
-	m_isLeaf = true;
-	m_index = index;
-	m_nOfTriangles = nTriangles;
+		template< class T > bool operator()( const T& triangle ) const
+		{
+			int b = int( nBuckets * ( ( triangle.centroid[m_axis] - m_minCentroid ) / m_centroidExtent ) );
+			if( b == nBuckets ) b = nBuckets - 1;
+			return ( b <= m_splitBucket );
+		}
+
+		int m_splitBucket;
+		int m_axis;
+		double m_minCentroid;
+		double m_centroidExtent;
+	};
+
+	struct CentroidCompare
+	{
+		CentroidCompare( int axis )
+		:m_axis( axis )
+		{
+		}
+
+		template< class T > bool operator()( const T& triangle1, const T& triangle2 ) const
+		{
+			return ( triangle1.centroid[m_axis] < triangle2.centroid[m_axis] );
+		}
 
+		int m_axis;
+	};
 }
 
+/*! *****************************
+ * class BVH
+ * **************************** */
+
 /*!
- * Sets left child to \a childNode
+ * Creates the bounding volume hierarchy of the triangles of \a mesh. The nodes with up to \a leafSize triangles
+ * are leaves, as the triangles of a leaf are tested together.
  */
-void BVHNode::SetLeftNode( BVHNode* childNode )
+BVH::BVH( TriangleMesh* mesh, int leafSize, std::vector< int >* triangleOrder )
+:m_leafSize( std::max( 1, std::min( leafSize, maxLeafSize ) ) ),
+ m_mesh( mesh )
 {
-	m_leftNode = childNode;
+
+	Build( triangleOrder );
+
 }
 
 /*!
- * Sets right child to \a childNode
+ * Creates the hierarchy with the saved \a nodes for the triangles of \a mesh. The triangles must be in the order
+ * given by the hierarchy build. If the nodes are not a valid hierarchy for the mesh, it is built again.
  */
-void BVHNode::SetRightNode( BVHNode* childNode )
+BVH::BVH( TriangleMesh* mesh, const std::vector< BVHNode >& nodes )
+:m_leafSize( 4 ),
+ m_nodes( nodes ),
+ m_mesh( mesh )
 {
-	m_rightNode = childNode;
+	if( !IsValid() )	Build( 0 );
 }
 
-
 /*!
- * Sets bbox to the node
+ * Destroys hierarchy. The mesh is not deleted.
  */
-void BVHNode::SetBoundingBox( BBox bbox )
+BVH::~BVH()
 {
-	m_bbox = bbox;
-}
 
-/*! *****************************
- * class BVH
- * **************************** */
+}
 
 /*!
- * Creates bounding volume hierarchy object
+ * Returns the bounding box of all the triangles.
  */
-BVH::BVH( std::vector< Triangle*>* triangleList, int leafSize )
-:m_leafSize( leafSize ),
- m_nNodes ( 0 ),
- m_nLeafs( 0 ),
- m_rootNode( 0 ),
- m_triangleList( triangleList )
+BBox BVH::GetBBox() const
 {
+	if( m_nodes.size() < 1 )	return BBox();
 
-	Build();
-
+	const BVHNode& root = m_nodes[0];
+	return BBox( Point3D( root.bounds[0][0], root.bounds[0][1], root.bounds[0][2] ),
+			Point3D( root.bounds[1][0], root.bounds[1][1], root.bounds[1][2] ) );
 }
 
 /*!
- * Destroys hierarchy
+ * Returns the nodes of the hierarchy in depth first order.
  */
-BVH::~BVH()
+const std::vector< BVHNode >& BVH::GetNodes() const
 {
-	delete m_rootNode;
+	return m_nodes;
 }
 
-
-BBox BVH::GetBBox() const
+/*!
+ * Returns the number of nodes of the hierarchy.
+ */
+int BVH::GetNumberOfNodes() const
 {
-	if( m_rootNode )
-	{
-		return ( m_rootNode->GetBoundingBox( ) );
-	}
-	return BBox();
+	return m_nodes.size();
 }
 
-bool BVH::Intersect(const Ray& objectRay , double* tHit, DifferentialGeometry* dg ) const
+/*!
+ * Finds the nearest triangle intersected by \a objectRay nearer than \a tHit.
+ *
+ * Returns true if there is an intersection. In this case, \a tHit is the intersection distance and \a dg the
+ * intersection differential geometry.
+ */
+bool BVH::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
-
-	if( ! m_rootNode )
-		return ( false );
-
-	if( !m_rootNode->GetBoundingBox().IntersectP( objectRay ) )	return ( false );
-
-	double tHitBVH = objectRay.maxt;
-	if(!Intersect(m_rootNode, objectRay, &tHitBVH, dg ) )	return ( false );
-	if( tHitBVH < *tHit )
+	if( m_nodes.size() < 1 )	return ( false );
+
+	const Vector3D& invDirection = objectRay.invDirection();
+	int dirIsNeg[3] = { invDirection.x < 0.0, invDirection.y < 0.0, invDirection.z < 0.0 };
+
+	double tHitBVH = *tHit;
+	double u = 0.0;
+	double v = 0.0;
+	int hitTriangle = -1;
+	int nodesToVisit[maxTraversalDepth];
+	int toVisitOffset = 0;
+	int currentNodeIndex = 0;
+	while( true )
 	{
-		*tHit = tHitBVH;
-		return ( true );
-	}
-	return ( false );
-
-}
-
-
-bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const
-{
-
-	double tHitNode = *tHit;
-
-	if( !node->IsLeaf() )
-	{
-
-		double tL0 = gc::Infinity;
-		double tL1= gc::Infinity;
-		bool intersectedL = false;
-
-		double tR0 = gc::Infinity;
-		double tR1= gc::Infinity;
-		bool intersectedR = false;
-
-		BVHNode* firstNode = 0;
-		BVHNode* secondNode = 0;
-		BVHNode* leftNode = node->GetLeftNode();
-		if( leftNode )
+		const BVHNode& node = m_nodes[currentNodeIndex];
+		if( IntersectP( node, objectRay, dirIsNeg, tHitBVH ) )
 		{
-			intersectedL = leftNode->GetBoundingBox().IntersectP( objectRay, &tL0, &tL1 );
-			if( intersectedL && tL0 <= tHitNode )
+			if( node.nTriangles > 0 )
 			{
-				firstNode = leftNode;
-			}
-		}
-
+				//IntersectTriangles only updates tHitBVH if the intersection is nearer than tHitBVH
+				int leafHit = m_mesh->IntersectTriangles( node.offset, node.nTriangles, objectRay, &tHitBVH, &u, &v );
+				if( leafHit >= 0 )	hitTriangle = leafHit;
 
-
-		BVHNode* rightNode = node->GetRightNode();
-		if( rightNode )
-		{
-			intersectedR = rightNode->GetBoundingBox().IntersectP( objectRay, &tR0, &tR1 );
-			if( intersectedR && tR0 <= tHitNode )
+				if( toVisitOffset == 0 )	break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+			else
 			{
-				secondNode = rightNode;
+				//Visit first the child nearest to the ray origin
+				if( dirIsNeg[node.axis] )
+				{
+					nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+					currentNodeIndex = node.offset;
+				}
+				else
+				{
+					nodesToVisit[toVisitOffset++] = node.offset;
+					currentNodeIndex = currentNodeIndex + 1;
+				}
 			}
 		}
-
-		bool isIntersection = false;
-
-		//Fist node
-		if( firstNode )
+		else
 		{
-			double thit1 = tHitNode;
-			DifferentialGeometry dg1;
-			bool isIntersection1 = Intersect( firstNode, objectRay, &thit1, &dg1 );
-
-			if( isIntersection1 && thit1 < tHitNode )
-			{
-				tHitNode = thit1;
-				*tHit = thit1;
-				*dg = dg1;
-
-				isIntersection = true;
-
-			}
+			if( toVisitOffset == 0 )	break;
+			currentNodeIndex = nodesToVisit[--toVisitOffset];
 		}
+	}
 
-		//Second node
-		if( secondNode )
-		{
-			double thit2 = tHitNode;
-			DifferentialGeometry dg2;
+	if( hitTriangle < 0 )	return ( false );
 
-			bool isIntersection2 = Intersect( rightNode, objectRay, &thit2, &dg2 );
+	*tHit = tHitBVH;
+	m_mesh->GetDifferentialGeometry( hitTriangle, objectRay, tHitBVH, u, v, dg );
+	return ( true );
+}
 
-			if( isIntersection2 && thit2 < tHitNode )
-			{
-				tHitNode = thit2;
-				*tHit = thit2;
-				*dg = dg2;
-				isIntersection = true;
-			}
-		}
+/*!
+ * Returns true if \a objectRay intersects any triangle before its maxt.
+ *
+ * The traversal stops at the first intersected triangle and the differential geometry is not computed.
+ */
+bool BVH::IntersectP( const Ray& objectRay ) const
+{
+	if( m_nodes.size() < 1 )	return ( false );
 
-		return ( isIntersection );
-	}
-	else
+	const Vector3D& invDirection = objectRay.invDirection();
+	int dirIsNeg[3] = { invDirection.x < 0.0, invDirection.y < 0.0, invDirection.z < 0.0 };
+
+	double tHitBVH = objectRay.maxt;
+	double u = 0.0;
+	double v = 0.0;
+	int nodesToVisit[maxTraversalDepth];
+	int toVisitOffset = 0;
+	int currentNodeIndex = 0;
+	while( true )
 	{
-		bool isIntersection = false;
-		int left_index = node->GetIndex();
-		for( int f = 0; f < node->GetNumberOfTriangles(); f++ )
+		const BVHNode& node = m_nodes[currentNodeIndex];
+		if( IntersectP( node, objectRay, dirIsNeg, tHitBVH ) )
 		{
-			int tIndex = left_index + f;
-			Triangle* triangle = m_triangleList->at( tIndex );
-
-			if( triangle )
+			if( node.nTriangles > 0 )
 			{
+				if( m_mesh->IntersectTriangles( node.offset, node.nTriangles, objectRay, &tHitBVH, &u, &v ) >= 0 )
+					return ( true );
 
-				Point3D v1 = triangle->GetVertex1();
-				Point3D v2 = triangle->GetVertex2();
-				Point3D v3 = triangle->GetVertex3();
-
-				double thitT = tHitNode;
-				DifferentialGeometry dgT;
-
-
-				bool isIntersectionT = triangle->Intersect( objectRay, &thitT, &dgT );
-				if( isIntersectionT && thitT < tHitNode )
-				{
-					tHitNode = thitT;
-					*tHit = thitT;
-					*dg = dgT;
-					isIntersection = true;
-				}
+				if( toVisitOffset == 0 )	break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+			else
+			{
+				//Any intersection is valid, so the children are not ordered
+				nodesToVisit[toVisitOffset++] = node.offset;
+				currentNodeIndex = currentNodeIndex + 1;
 			}
 		}
-
-		return ( isIntersection );
+		else
+		{
+			if( toVisitOffset == 0 )	break;
+			currentNodeIndex = nodesToVisit[--toVisitOffset];
+		}
 	}
 
 	return ( false );
 }
 
 /*!
- * Creates the nodes hierarchy.
+ * Creates the nodes hierarchy. If \a triangleOrder is not null, it is set to the mesh triangle indices in the
+ * build order.
  */
-void BVH::Build()
+void BVH::Build( std::vector< int >* triangleOrder )
 {
+	m_nodes.clear();
 
-	BBox hBBox;
+	int nTriangles = m_mesh->GetNumberOfTriangles();
+	if( nTriangles < 1 )	return;
 
-	for( unsigned int t = 0; t < m_triangleList->size(); t++ )
+	std::vector< BuildTriangle > buildTriangles( nTriangles );
+	for( int t = 0; t < nTriangles; ++t )
 	{
-
-		Triangle* triangle = m_triangleList->at(t);
-
-		hBBox = Union ( hBBox, triangle->GetBBox( ) );
+		buildTriangles[t].bbox = m_mesh->GetTriangleBBox( t );
+		buildTriangles[t].centroid = m_mesh->GetTriangleCentroid( t );
+		buildTriangles[t].triangle = t;
 	}
 
+	m_nodes.reserve( 2 * nTriangles / m_leafSize + 1 );
+	BuildRecursive( buildTriangles, 0, nTriangles, 0 );
 
-	int left_index = 0;
-	int right_index = m_triangleList->size();
-	//int nodeIndex = 1;
-
-	m_rootNode = new BVHNode;
-	m_rootNode->SetBoundingBox( hBBox );
-	m_nNodes++;
-
-	BuildRecursive( left_index, right_index, m_rootNode, 0 );
+	//The leaves reference the triangles in the build order
+	std::vector< int > order( nTriangles );
+	for( int t = 0; t < nTriangles; ++t )
+		order[t] = buildTriangles[t].triangle;
+	m_mesh->Reorder( order );
 
+	if( triangleOrder )	triangleOrder->swap( order );
 }
 
-void BVH::BuildRecursive(int left_index, int right_index, BVHNode* node, int depth)
+/*!
+ * Creates the node for the triangles from \a start to \a end of \a buildTriangles and its children.
+ * Returns the index of the node.
+ */
+int BVH::BuildRecursive( std::vector< BuildTriangle >& buildTriangles, int start, int end, int depth )
 {
+	int nodeIndex = m_nodes.size();
+	m_nodes.push_back( BVHNode() );
 
-	if( ( right_index - left_index ) <= m_leafSize )
+	BBox nodeBBox;
+	BBox centroidBBox;
+	for( int t = start; t < end; ++t )
 	{
-		node->MakeLeaf( left_index, right_index - left_index );
-		m_nLeafs++;
+		nodeBBox = Union( nodeBBox, buildTriangles[t].bbox );
+		centroidBBox = Union( centroidBBox, buildTriangles[t].centroid );
 	}
-	else
+
+	for( int axis = 0; axis < 3; ++axis )
 	{
-		int dimension1 = 0; //x
-		BBox nodeBB = node->GetBoundingBox();
+		m_nodes[nodeIndex].bounds[0][axis] = RoundDown( nodeBBox.pMin[axis] );
+		m_nodes[nodeIndex].bounds[1][axis] = RoundUp( nodeBBox.pMax[axis] );
+	}
 
-		double xLength = nodeBB.pMax.x - nodeBB.pMin.x;
-		double yLength = nodeBB.pMax.y - nodeBB.pMin.y;
-		double zLength = nodeBB.pMax.z - nodeBB.pMin.z;
-		double dMeanX = nodeBB.pMin.x + 0.5 * xLength;
-		double dMeanY = nodeBB.pMin.y + 0.5 * yLength;
-		double dMeanZ = nodeBB.pMin.z + 0.5 * zLength;
+	int nTriangles = end - start;
+	int axis = centroidBBox.MaximumExtent();
+	double minCentroid = centroidBBox.pMin[axis];
+	double centroidExtent = centroidBBox.pMax[axis] - centroidBBox.pMin[axis];
 
-		double dLength1 = xLength;
-		double dMean1 = dMeanX;
+	int mid = -1;
+	if( nTriangles > m_leafSize && centroidExtent > 0.0 && depth < maxSAHDepth )
+	{
+		//Binned surface area heuristic
+		int bucketCount[nBuckets];
+		BBox bucketBBox[nBuckets];
+		for( int b = 0; b < nBuckets; ++b )	bucketCount[b] = 0;
 
-		if( yLength > dLength1 )
-		{
-			dLength1 = yLength;
-			dMean1 = dMeanY;
-			dimension1 = 1;
-		}
-		if( zLength > dLength1 )
+		for( int t = start; t < end; ++t )
 		{
-			dLength1 = zLength;
-			dMean1 = dMeanZ;
-			dimension1 = 2;
+			int b = int( nBuckets * ( ( buildTriangles[t].centroid[axis] - minCentroid ) / centroidExtent ) );
+			if( b == nBuckets ) b = nBuckets - 1;
+			bucketCount[b]++;
+			bucketBBox[b] = Union( bucketBBox[b], buildTriangles[t].bbox );
 		}
 
-
-
-		SortTrinaglesList( left_index, right_index, dimension1 );
-
-
-		BBox leftBBox;
-		int splitIndex = right_index;
-		for ( int f = left_index; f < right_index; f++ )
+		//Sweep the buckets from both sides to compute the cost of each split
+		double belowArea[nBuckets];
+		int belowCount[nBuckets];
+		BBox below;
+		int countBelow = 0;
+		for( int b = 0; b < nBuckets - 1; ++b )
 		{
-
-			Triangle* triangle = m_triangleList->at( f );
-
-			if( ( dimension1 == 0 ) && ( triangle->GetCentroid().x > dMean1 ) )
-			{
-				splitIndex = f;
-				break;
-			}
-			else if( ( dimension1 == 1 ) && ( triangle->GetCentroid().y > dMean1 ) )
-			{
-				splitIndex = f;
-				break;
-			}
-			else if( ( dimension1 == 2 ) && (triangle->GetCentroid().z > dMean1 ) )
-			{
-				splitIndex = f;
-				break;
-			}
-			leftBBox = Union ( leftBBox, triangle->GetBBox( ) );
-
+			below = Union( below, bucketBBox[b] );
+			countBelow += bucketCount[b];
+			belowArea[b] = ( countBelow > 0 ) ? below.SurfaceArea() : 0.0;
+			belowCount[b] = countBelow;
 		}
 
-		if( ( splitIndex == right_index ) || ( splitIndex == left_index ) )
+		double nodeArea = nodeBBox.SurfaceArea();
+		double minCost = gc::Infinity;
+		int minCostSplitBucket = -1;
+		BBox above;
+		int countAbove = 0;
+		for( int split = nBuckets - 2; split >= 0; --split )
 		{
+			above = Union( above, bucketBBox[split + 1] );
+			countAbove += bucketCount[split + 1];
+			if( belowCount[split] == 0 || countAbove == 0 )	continue;
 
-			splitIndex  = left_index + 0.5 * ( right_index -left_index ) ;
-			leftBBox = BBox( );
-			for ( int f = left_index; f < splitIndex; f++ )
+			double cost = ( belowCount[split] * belowArea[split] + countAbove * above.SurfaceArea() ) / nodeArea;
+			if( cost < minCost )
 			{
-				Triangle* triangle = m_triangleList->at( f );
-				leftBBox = Union ( leftBBox, triangle->GetBBox( ) );
+				minCost = cost;
+				minCostSplitBucket = split;
 			}
 		}
 
-
-		BBox rightBBox;
-		for ( int f = splitIndex; f < right_index; f++ )
+		if( minCostSplitBucket >= 0 )
 		{
-			Triangle* triangle = m_triangleList->at( f );
-			rightBBox = Union ( rightBBox, triangle->GetBBox( ) );
+			BuildTriangle* midTriangle = std::partition( &buildTriangles[start], &buildTriangles[end - 1] + 1,
+					CentroidBucketCompare( minCostSplitBucket, axis, minCentroid, centroidExtent ) );
+			mid = midTriangle - &buildTriangles[0];
 		}
-
-
-		BVHNode* leftNode = new BVHNode;
-		leftNode->SetBoundingBox( leftBBox );
-		node->SetLeftNode( leftNode );
-		m_nNodes++;
-
-		BVHNode* rightNode = new BVHNode;
-		rightNode->SetBoundingBox( rightBBox );
-		node->SetRightNode( rightNode );
-		m_nNodes++;
-
-		BuildRecursive( left_index, splitIndex, leftNode, depth +1 );
-		BuildRecursive( splitIndex, right_index, rightNode, depth +1 );
 	}
-}
 
+	//Triangles with the same centroid or too deep hierarchies are split by number
+	if( mid < 0 && nTriangles > m_leafSize )
+	{
+		mid = ( start + end ) / 2;
+		std::nth_element( &buildTriangles[start], &buildTriangles[mid], &buildTriangles[end - 1] + 1, CentroidCompare( axis ) );
+	}
 
-void BVH::SortTrinaglesList(int left_index, int right_index, int dimension )
-{
-	if( dimension == 0 )  //x axis
-		std::sort( m_triangleList->begin()+ left_index, m_triangleList->begin() +  right_index  , BVH::LessXThan );
-	else if( dimension == 1 )  //y axis
-		std::sort( m_triangleList->begin()+ left_index, m_triangleList->begin() +  right_index  , BVH::LessYThan );
-	else if( dimension == 2 )  //y axis
-		std::sort( m_triangleList->begin()+ left_index, m_triangleList->begin() +  right_index  , BVH::LessZThan );
+	if( mid <= start || mid >= end )
+	{
+		m_nodes[nodeIndex].offset = start;
+		m_nodes[nodeIndex].nTriangles = nTriangles;
+		m_nodes[nodeIndex].axis = 0;
+		return nodeIndex;
+	}
 
+	BuildRecursive( buildTriangles, start, mid, depth + 1 );
+	int secondChild = BuildRecursive( buildTriangles, mid, end, depth + 1 );
+	m_nodes[nodeIndex].offset = secondChild;
+	m_nodes[nodeIndex].nTriangles = 0;
+	m_nodes[nodeIndex].axis = axis;
+	return nodeIndex;
 }
 
-
-bool BVH::LessXThan( const Triangle* t1, const Triangle* t2 )
+/*!
+ * Returns true if the nodes are a hierarchy of the mesh triangles that can be traversed.
+ */
+bool BVH::IsValid() const
 {
+	int nNodes = m_nodes.size();
+	int nTriangles = m_mesh->GetNumberOfTriangles();
+	if( nNodes < 1 )	return ( nTriangles == 0 );
+
+	//The children are after their parent, so the depth of a node is known when it is reached
+	std::vector< int > depth( nNodes, -1 );
+	depth[0] = 0;
+	for( int n = 0; n < nNodes; ++n )
+	{
+		const BVHNode& node = m_nodes[n];
+		if( depth[n] < 0 || depth[n] >= maxTraversalDepth - 1 )	return ( false );
 
-	if( t1->GetCentroid().x < t2->GetCentroid().x )
-		return ( true );
-	return ( false );
-}
-
-bool BVH::LessYThan( const Triangle* t1, const Triangle* t2 )
-{
+		if( node.nTriangles > 0 )
+		{
+			if( node.offset < 0 || node.offset + node.nTriangles > nTriangles )	return ( false );
+		}
+		else
+		{
+			if( n + 1 >= nNodes || node.offset <= n + 1 || node.offset >= nNodes || node.axis > 2 )	return ( false );
+			depth[n + 1] = std::max( depth[n + 1], depth[n] + 1 );
+			depth[node.offset] = std::max( depth[node.offset], depth[n] + 1 );
+		}
+	}
 
-	if( t1->GetCentroid().y < t2->GetCentroid().y )
-		return ( true );
-	return ( false );
+	return ( true );
 }
 
-bool BVH::LessZThan( const Triangle* t1, const Triangle* t2 )
+/*!
+ * Returns true if \a objectRay intersects the box of \a node between the ray mint and \a tMax.
+ */
+bool BVH::IntersectP( const BVHNode& node, const Ray& objectRay, const int dirIsNeg[3], double tMax ) const
 {
+	const Point3D& origin = objectRay.origin;
+	const Vector3D& invDirection = objectRay.invDirection();
 
-	if( t1->GetCentroid().z < t2->GetCentroid().z )
-		return ( true );
-	return ( false );
-}
-
+	//The comparisons ignore the NaN slab distances of rays parallel to a node face
+	double t0 = objectRay.mint;
+	double t1 = tMax;
+	for( int axis = 0; axis < 3; ++axis )
+	{
+		double tNear = ( node.bounds[dirIsNeg[axis]][axis] - origin[axis] ) * invDirection[axis];
+		double tFar = ( node.bounds[1 - dirIsNeg[axis]][axis] - origin[axis] ) * invDirection[axis];
+		if( tNear > t0 )	t0 = tNear;
+		if( tFar < t1 )	t1 = tFar;
+		if( t0 > t1 )	return false;
+	}
 
+	return true;
+}
@@ -39,89 +39,75 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #ifndef BVH_H_
 #define BVH_H_
 
-
-
-
 #include <vector>
 
 #include "BBox.h"
-#include "Triangle.h"
+#include "Point3D.h"
 
 class DifferentialGeometry;
+class Ray;
+class TriangleMesh;
 
 /*! *****************************
- * class BVHNode
+ * struct BVHNode
  * **************************** */
-class BVHNode {
-
-public:
-	BVHNode();
-	~BVHNode();
-
-	BBox GetBoundingBox() const { return ( m_bbox ); };
-
-	int GetIndex() const { return  (m_index ); };
-	BVHNode* GetLeftNode() const { return  (m_leftNode ); };
-	int GetNumberOfTriangles() const { return  (m_nOfTriangles ); };
-	BVHNode* GetRightNode() const { return  (m_rightNode ); };
-
-	bool IsLeaf() const { return ( m_isLeaf ); };
-	void MakeLeaf(unsigned int index, unsigned int nTriangles );
-
-	void SetBoundingBox( BBox bbox );
-	void SetLeftNode( BVHNode* childNode );
-	void SetRightNode( BVHNode* childNode );
-
-
-private:
-	BBox m_bbox;
-	int m_index;
-	bool m_isLeaf;
-	int m_nOfTriangles;
-
-	BVHNode* m_leftNode;
-	BVHNode* m_rightNode;
-
-
 
+//!  BVHNode is a node of the linear BVH array.
+/*!
+  The node bounding box is stored in single precision, rounded outwards, so a node takes 32 bytes and two nodes
+  fit in a cache line. The first child of an interior node is the next node of the array.
+*/
+struct BVHNode
+{
+	float bounds[2][3]; //!< Minimum and maximum corners.
+	int offset; //!< First triangle for leaf nodes, second child for interior nodes.
+	unsigned short nTriangles; //!< Zero for interior nodes.
+	unsigned short axis; //!< Split axis of interior nodes.
 };
 
 
 /*! *****************************
  * class BVH
  * **************************** */
+
+//!  BVH is the bounding volume hierarchy of the triangles of a ShapeCAD mesh.
+/*!
+  The hierarchy is built with the binned surface area heuristic and stored as a linear array of nodes in
+  depth first order. The mesh triangles are reordered so the triangles of each leaf are contiguous.
+  It is traversed iteratively, visiting first the child nearest to the ray origin and skipping the nodes
+  farther than the nearest intersection found.
+  A hierarchy can also be created from the nodes of a hierarchy saved before, for a mesh with the triangles
+  in the saved order.
+*/
 class BVH {
 
 public:
-
-	BVH( std::vector< Triangle*>* triangleList, int leafSize = 1 );
+	BVH( TriangleMesh* mesh, int leafSize = 4, std::vector< int >* triangleOrder = 0 );
+	BVH( TriangleMesh* mesh, const std::vector< BVHNode >& nodes );
 	~BVH();
 
 	BBox GetBBox() const;
+	const std::vector< BVHNode >& GetNodes() const;
+	int GetNumberOfNodes() const;
 	bool Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const;
-	bool Intersect(BVHNode* node, const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const;
-	//bool getIntersection( const Ray& ray, IntersectionInfo *intersection, bool occlusion) const;
+	bool IntersectP( const Ray& objectRay ) const;
 
 private:
-	void Build();
-	void BuildRecursive(int left_index, int right_index, BVHNode* node, int depth );
-	void SortTrinaglesList(int left_index, int right_index, int dimension );
-
-
-	static bool LessXThan( const Triangle* t1, const Triangle* t2 );
-	static bool LessYThan( const Triangle* t1, const Triangle* t2 );
-	static bool LessZThan( const Triangle* t1, const Triangle* t2 );
-
+	struct BuildTriangle
+	{
+		BBox bbox;
+		Point3D centroid;
+		int triangle;
+	};
+
+	void Build( std::vector< int >* triangleOrder );
+	int BuildRecursive( std::vector< BuildTriangle >& buildTriangles, int start, int end, int depth );
+	bool IntersectP( const BVHNode& node, const Ray& objectRay, const int dirIsNeg[3], double tMax ) const;
+	bool IsValid() const;
 
 	int m_leafSize;
-	int m_nNodes;
-	int m_nLeafs;
-
-
-	BVHNode* m_rootNode;
-	std::vector< Triangle*>* m_triangleList;
-
-
+	std::vector< BVHNode > m_nodes;
+	TriangleMesh* m_mesh;
 };
 
 
@@ -0,0 +1,170 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
+***************************************************************************/
+
+#include <QDataStream>
+
+#include "MeshEncoder.h"
+
+namespace
+{
+	const quint32 meshMagic = 0x48534d54; //"TMSH"
+	const quint32 meshVersion = 1;
+
+	const quint32 doublePrecisionVertices = 1;
+}
+
+/*! *****************************
+ * class MeshEncoder
+ * **************************** */
+
+/*!
+ * Returns the encoded mesh with \a vertices, the triangles vertex \a indices and the hierarchy \a nodes.
+ * \a nodes can be empty.
+ */
+QByteArray MeshEncoder::Encode( const std::vector< Point3D >& vertices, const std::vector< int >& indices,
+		const std::vector< BVHNode >& nodes )
+{
+	quint32 flags = 0;
+	for( unsigned int v = 0; v < vertices.size() && flags == 0; ++v )
+	{
+		const Point3D& vertex = vertices[v];
+		if( double( float( vertex.x ) ) != vertex.x || double( float( vertex.y ) ) != vertex.y
+				|| double( float( vertex.z ) ) != vertex.z )
+			flags |= doublePrecisionVertices;
+	}
+
+	QByteArray data;
+	QDataStream out( &data, QIODevice::WriteOnly );
+	out.setByteOrder( QDataStream::LittleEndian );
+	out.setFloatingPointPrecision( ( flags & doublePrecisionVertices ) ? QDataStream::DoublePrecision : QDataStream::SinglePrecision );
+
+	out << meshMagic << meshVersion << flags;
+	out << quint32( vertices.size() ) << quint32( indices.size() / 3 ) << quint32( nodes.size() );
+
+	if( flags & doublePrecisionVertices )
+	{
+		for( unsigned int v = 0; v < vertices.size(); ++v )
+			out << vertices[v].x << vertices[v].y << vertices[v].z;
+	}
+	else
+	{
+		for( unsigned int v = 0; v < vertices.size(); ++v )
+			out << float( vertices[v].x ) << float( vertices[v].y ) << float( vertices[v].z );
+	}
+
+	for( unsigned int i = 0; i < indices.size(); ++i )
+		out << quint32( indices[i] );
+
+	out.setFloatingPointPrecision( QDataStream::SinglePrecision );
+	for( unsigned int n = 0; n < nodes.size(); ++n )
+	{
+		const BVHNode& node = nodes[n];
+		for( int c = 0; c < 3; ++c )	out << node.bounds[0][c];
+		for( int c = 0; c < 3; ++c )	out << node.bounds[1][c];
+		out << qint32( node.offset ) << quint16( node.nTriangles ) << quint16( node.axis );
+	}
+
+	return ( qCompress( data ).toBase64() );
+}
+
+/*!
+ * Decodes the mesh \a data encoded by Encode.
+ *
+ * Returns false if \a data is not a valid mesh. The hierarchy \a nodes are only checked to be complete.
+ */
+bool MeshEncoder::Decode( const QByteArray& data, std::vector< Point3D >* vertices, std::vector< int >* indices,
+		std::vector< BVHNode >* nodes )
+{
+	QByteArray meshData = qUncompress( QByteArray::fromBase64( data ) );
+
+	QDataStream in( meshData );
+	in.setByteOrder( QDataStream::LittleEndian );
+
+	quint32 magic, version, flags, nVertices, nTriangles, nNodes;
+	in >> magic >> version >> flags >> nVertices >> nTriangles >> nNodes;
+	if( in.status() != QDataStream::Ok || magic != meshMagic || version != meshVersion )	return ( false );
+
+	//The sizes are checked before allocating the lists
+	qint64 vertexSize = ( flags & doublePrecisionVertices ) ? 24 : 12;
+	qint64 expectedSize = 24 + vertexSize * nVertices + 12 * qint64( nTriangles ) + 32 * qint64( nNodes );
+	if( meshData.size() != expectedSize )	return ( false );
+
+	in.setFloatingPointPrecision( ( flags & doublePrecisionVertices ) ? QDataStream::DoublePrecision : QDataStream::SinglePrecision );
+	vertices->resize( nVertices );
+	if( flags & doublePrecisionVertices )
+	{
+		for( quint32 v = 0; v < nVertices; ++v )
+			in >> ( *vertices )[v].x >> ( *vertices )[v].y >> ( *vertices )[v].z;
+	}
+	else
+	{
+		for( quint32 v = 0; v < nVertices; ++v )
+		{
+			float x, y, z;
+			in >> x >> y >> z;
+			( *vertices )[v] = Point3D( x, y, z );
+		}
+	}
+
+	indices->resize( 3 * nTriangles );
+	for( quint32 i = 0; i < 3 * nTriangles; ++i )
+	{
+		quint32 index;
+		in >> index;
+		if( index >= nVertices )	return ( false );
+		( *indices )[i] = index;
+	}
+
+	in.setFloatingPointPrecision( QDataStream::SinglePrecision );
+	nodes->resize( nNodes );
+	for( quint32 n = 0; n < nNodes; ++n )
+	{
+		BVHNode& node = ( *nodes )[n];
+		for( int c = 0; c < 3; ++c )	in >> node.bounds[0][c];
+		for( int c = 0; c < 3; ++c )	in >> node.bounds[1][c];
+
+		qint32 offset;
+		quint16 nodeTriangles, axis;
+		in >> offset >> nodeTriangles >> axis;
+		node.offset = offset;
+		node.nTriangles = nodeTriangles;
+		node.axis = axis;
+	}
+
+	return ( in.status() == QDataStream::Ok );
+}
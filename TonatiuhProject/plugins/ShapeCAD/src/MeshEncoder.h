@@ -36,50 +36,37 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
 ***************************************************************************/
 
-#ifndef TRIANGLE_H_
-#define TRIANGLE_H_
+#ifndef MESHENCODER_H_
+#define MESHENCODER_H_
 
+#include <vector>
 
-#include "BBox.h"
-#include "NormalVector.h"
+#include <QByteArray>
+
+#include "BVH.h"
 #include "Point3D.h"
-#include "Vector3D.h"
 
-class DifferentialGeometry;
-class Ray;
+/*! *****************************
+ * class MeshEncoder
+ * **************************** */
+
+//!  MeshEncoder converts a ShapeCAD mesh to and from the compact form saved in the scene files.
+/*!
+  The mesh is stored as a little endian binary block with the vertices, the vertex indices of each triangle
+  and, optionally, the nodes of the triangles hierarchy. The block is compressed and base64 encoded, so it
+  can be written as a string field in the ASCII scene files.
 
-class Triangle
+  The vertices are stored in single precision when all of them can be represented without loss, as the
+  meshes read from STL files.
+*/
+class MeshEncoder
 {
 
 public:
-	Triangle( Point3D v1, Point3D v2, Point3D v3, NormalVector normal );
-
-
-	BBox GetBBox() const { return ( m_bbox ); } ;
-	Point3D GetCentroid() const { return ( m_centoid ); };
-	NormalVector GetNormal() const { return ( m_normal ); } ;
-	Point3D GetVertex1() const { return ( m_v1 ); } ;
-	Point3D GetVertex2() const { return ( m_v2 ); } ;
-	Point3D GetVertex3() const { return ( m_v3 ); } ;
-
-	bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const;
-
-private:
-
-	BBox m_bbox;
-	Point3D m_centoid;
-	NormalVector m_normal;
-	Point3D m_v1;
-	Point3D m_v2;
-	Point3D m_v3;
-
-
-	Vector3D m_vE1;
-	Vector3D m_vE2;
-	Vector3D m_vW1;
-
-	double m_tol;
+	static QByteArray Encode( const std::vector< Point3D >& vertices, const std::vector< int >& indices,
+			const std::vector< BVHNode >& nodes );
+	static bool Decode( const QByteArray& data, std::vector< Point3D >* vertices, std::vector< int >* indices,
+			std::vector< BVHNode >* nodes );
 };
 
-
-#endif /* TRIANGLE_H_ */
+#endif /* MESHENCODER_H_ */
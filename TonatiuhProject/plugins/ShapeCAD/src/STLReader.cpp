@@ -0,0 +1,395 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QtEndian>
+#include <QVector>
+
+#include "STLReader.h"
+
+namespace
+{
+	const qint64 binaryHeaderSize = 84;
+	const qint64 binaryFacetSize = 50;
+	const qint64 minChunkSize = 1 << 20;
+
+	/*!
+	 * Hash table of the mesh vertices. Returns the same index for the vertices with the same coordinates.
+	 */
+	class VertexTable
+	{
+	public:
+		VertexTable( int expectedVertices )
+		:m_nVertices( 0 )
+		{
+			int nSlots = 16;
+			while( nSlots < 2 * expectedVertices )	nSlots *= 2;
+			m_slots.assign( nSlots, -1 );
+			m_coordinates.reserve( 3 * expectedVertices );
+		}
+
+		int Insert( float x, float y, float z )
+		{
+			//Adding zero makes -0.0 equal to 0.0
+			x += 0.0f;
+			y += 0.0f;
+			z += 0.0f;
+
+			unsigned int mask = m_slots.size() - 1;
+			unsigned int slot = Hash( x, y, z ) & mask;
+			while( m_slots[slot] >= 0 )
+			{
+				const float* vertex = &m_coordinates[3 * m_slots[slot]];
+				if( vertex[0] == x && vertex[1] == y && vertex[2] == z )	return ( m_slots[slot] );
+				slot = ( slot + 1 ) & mask;
+			}
+
+			int index = m_nVertices++;
+			m_slots[slot] = index;
+			m_coordinates.push_back( x );
+			m_coordinates.push_back( y );
+			m_coordinates.push_back( z );
+
+			if( 2 * m_nVertices > int( m_slots.size() ) )	Grow();
+			return ( index );
+		}
+
+		void GetVertices( std::vector< Point3D >* vertices ) const
+		{
+			vertices->resize( m_nVertices );
+			for( int v = 0; v < m_nVertices; ++v )
+				( *vertices )[v] = Point3D( m_coordinates[3 * v], m_coordinates[3 * v + 1], m_coordinates[3 * v + 2] );
+		}
+
+	private:
+		static unsigned int Hash( float x, float y, float z )
+		{
+			quint32 bits[3];
+			std::memcpy( &bits[0], &x, 4 );
+			std::memcpy( &bits[1], &y, 4 );
+			std::memcpy( &bits[2], &z, 4 );
+
+			quint32 hash = bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+			hash ^= hash >> 16;
+			hash *= 0x85ebca6bu;
+			hash ^= hash >> 13;
+			return ( hash );
+		}
+
+		void Grow()
+		{
+			std::vector< int > slots( 2 * m_slots.size(), -1 );
+			unsigned int mask = slots.size() - 1;
+			for( int v = 0; v < m_nVertices; ++v )
+			{
+				unsigned int slot = Hash( m_coordinates[3 * v], m_coordinates[3 * v + 1], m_coordinates[3 * v + 2] ) & mask;
+				while( slots[slot] >= 0 )	slot = ( slot + 1 ) & mask;
+				slots[slot] = v;
+			}
+			m_slots.swap( slots );
+		}
+
+		int m_nVertices;
+		std::vector< int > m_slots;
+		std::vector< float > m_coordinates;
+	};
+
+	/*!
+	 * Part of an ASCII file with whole facets, and the vertex coordinates read from it.
+	 */
+	struct ASCIIChunk
+	{
+		const char* begin;
+		const char* end;
+		std::vector< float > coordinates;
+		bool valid;
+	};
+
+	bool IsSpace( char c )
+	{
+		return ( c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f' );
+	}
+
+	bool IsDigit( char c )
+	{
+		return ( c >= '0' && c <= '9' );
+	}
+
+	/*!
+	 * Reads the number that starts at \a p after any white space. The number ends at a white space or at \a end.
+	 * Returns false if there is no valid number.
+	 */
+	bool ReadNumber( const char*& p, const char* end, float* value )
+	{
+		while( p < end && IsSpace( *p ) )	++p;
+
+		bool negative = false;
+		if( p < end && ( *p == '-' || *p == '+' ) )	negative = ( *p++ == '-' );
+
+		double mantissa = 0.0;
+		int exponent = 0;
+		int nDigits = 0;
+		for( ; p < end && IsDigit( *p ); ++p, ++nDigits )
+			mantissa = 10.0 * mantissa + ( *p - '0' );
+		if( p < end && *p == '.' )
+		{
+			for( ++p; p < end && IsDigit( *p ); ++p, ++nDigits, --exponent )
+				mantissa = 10.0 * mantissa + ( *p - '0' );
+		}
+		if( nDigits == 0 )	return ( false );
+
+		if( p < end && ( *p == 'e' || *p == 'E' ) )
+		{
+			++p;
+			bool negativeExponent = false;
+			if( p < end && ( *p == '-' || *p == '+' ) )	negativeExponent = ( *p++ == '-' );
+			if( p == end || !IsDigit( *p ) )	return ( false );
+
+			int fileExponent = 0;
+			for( ; p < end && IsDigit( *p ); ++p )
+				if( fileExponent < 1000 )	fileExponent = 10 * fileExponent + ( *p - '0' );
+			exponent += negativeExponent ? -fileExponent : fileExponent;
+		}
+		if( p < end && !IsSpace( *p ) )	return ( false );
+
+		double number = ( exponent < 0 ) ? mantissa / std::pow( 10.0, -exponent ) : mantissa * std::pow( 10.0, exponent );
+		*value = float( negative ? -number : number );
+		return ( true );
+	}
+
+	/*!
+	 * Reads the coordinates of the vertices of \a chunk.
+	 */
+	void ReadASCIIChunk( ASCIIChunk& chunk )
+	{
+		chunk.valid = true;
+
+		const char* p = chunk.begin;
+		while( p < chunk.end )
+		{
+			while( p < chunk.end && IsSpace( *p ) )	++p;
+			const char* word = p;
+			while( p < chunk.end && !IsSpace( *p ) )	++p;
+
+			if( ( p - word == 6 ) && std::memcmp( word, "vertex", 6 ) == 0 )
+			{
+				for( int c = 0; c < 3; ++c )
+				{
+					float coordinate;
+					if( !ReadNumber( p, chunk.end, &coordinate ) )
+					{
+						chunk.valid = false;
+						return;
+					}
+					chunk.coordinates.push_back( coordinate );
+				}
+			}
+		}
+
+		if( chunk.coordinates.size() % 9 != 0 )	chunk.valid = false;
+	}
+
+	/*!
+	 * Returns the position after the first "endfacet" from \a p, or \a end if there is none.
+	 */
+	const char* NextFacetEnd( const char* p, const char* end )
+	{
+		const char endFacet[] = "endfacet";
+		const char* found = std::search( p, end, endFacet, endFacet + 8 );
+		return ( found == end ) ? end : found + 8;
+	}
+}
+
+/*! *****************************
+ * class STLReader
+ * **************************** */
+
+/*!
+ * Creates a reader with an empty mesh.
+ */
+STLReader::STLReader()
+{
+
+}
+
+/*!
+ * Reads the triangles of the stereolithography file \a fileName.
+ *
+ * Returns false and sets the error message if the file cannot be read.
+ */
+bool STLReader::Read( QString fileName )
+{
+	m_error.clear();
+	m_vertices.clear();
+	m_indices.clear();
+
+	QFile file( fileName );
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		m_error = QString( "Cannot open file %1." ).arg( fileName );
+		return ( false );
+	}
+
+	qint64 size = file.size();
+	if( size < 5 )
+	{
+		m_error = QString( "%1 is not a valid STL file." ).arg( fileName );
+		return ( false );
+	}
+
+	//The whole file is read if it cannot be mapped
+	QByteArray fileData;
+	const uchar* data = file.map( 0, size );
+	if( !data )
+	{
+		fileData = file.readAll();
+		data = reinterpret_cast< const uchar* >( fileData.constData() );
+	}
+
+	bool isBinary = false;
+	if( size >= binaryHeaderSize )
+	{
+		qint64 nFacets = qFromLittleEndian< quint32 >( data + 80 );
+		isBinary = ( size == binaryHeaderSize + nFacets * binaryFacetSize );
+	}
+
+	bool readOK = false;
+	if( isBinary )	readOK = ReadBinary( data, size );
+	else if( std::memcmp( data, "solid", 5 ) == 0 )	readOK = ReadASCII( reinterpret_cast< const char* >( data ), size );
+	else	m_error = QString( "%1 is not a valid STL file." ).arg( fileName );
+
+	if( !readOK )
+	{
+		if( m_error.isEmpty() )	m_error = QString( "Error reading file %1." ).arg( fileName );
+		m_vertices.clear();
+		m_indices.clear();
+	}
+
+	return ( readOK );
+}
+
+/*!
+ * Reads the facets of the ASCII file \a data.
+ */
+bool STLReader::ReadASCII( const char* data, qint64 size )
+{
+	const char* end = data + size;
+
+	int nChunks = 1;
+	if( size > minChunkSize )	nChunks = std::min( 4 * QThread::idealThreadCount(), int( size / minChunkSize ) );
+
+	QVector< ASCIIChunk > chunks;
+	const char* chunkBegin = data;
+	for( int c = 1; c <= nChunks && chunkBegin < end; ++c )
+	{
+		ASCIIChunk chunk;
+		chunk.begin = chunkBegin;
+		chunk.end = ( c == nChunks ) ? end : NextFacetEnd( std::max( chunkBegin, data + c * ( size / nChunks ) ), end );
+		chunk.valid = false;
+		chunks.push_back( chunk );
+		chunkBegin = chunk.end;
+	}
+
+	QtConcurrent::blockingMap( chunks, ReadASCIIChunk );
+
+	int nFacets = 0;
+	for( int c = 0; c < chunks.size(); ++c )
+	{
+		if( !chunks[c].valid )	return ( false );
+		nFacets += chunks[c].coordinates.size() / 9;
+	}
+
+	if( nFacets < 1 )
+	{
+		m_error = QString( "The file has no facets." );
+		return ( false );
+	}
+
+	VertexTable vertexTable( nFacets / 2 );
+	m_indices.reserve( 3 * nFacets );
+	for( int c = 0; c < chunks.size(); ++c )
+	{
+		std::vector< float >& coordinates = chunks[c].coordinates;
+		for( unsigned int v = 0; v < coordinates.size(); v += 3 )
+			m_indices.push_back( vertexTable.Insert( coordinates[v], coordinates[v + 1], coordinates[v + 2] ) );
+		std::vector< float >().swap( coordinates );
+	}
+	vertexTable.GetVertices( &m_vertices );
+
+	return ( true );
+}
+
+/*!
+ * Reads the facets of the binary file \a data.
+ */
+bool STLReader::ReadBinary( const uchar* data, qint64 size )
+{
+	int nFacets = ( size - binaryHeaderSize ) / binaryFacetSize;
+	if( nFacets < 1 )
+	{
+		m_error = QString( "The file has no facets." );
+		return ( false );
+	}
+
+	VertexTable vertexTable( nFacets / 2 );
+	m_indices.reserve( 3 * nFacets );
+	for( int f = 0; f < nFacets; ++f )
+	{
+		//Each facet has the normal, the three vertices and two attribute bytes
+		const uchar* vertexData = data + binaryHeaderSize + f * binaryFacetSize + 12;
+		for( int v = 0; v < 3; ++v, vertexData += 12 )
+		{
+			float coordinates[3];
+			for( int c = 0; c < 3; ++c )
+			{
+				quint32 bits = qFromLittleEndian< quint32 >( vertexData + 4 * c );
+				std::memcpy( &coordinates[c], &bits, 4 );
+			}
+			m_indices.push_back( vertexTable.Insert( coordinates[0], coordinates[1], coordinates[2] ) );
+		}
+	}
+	vertexTable.GetVertices( &m_vertices );
+
+	return ( true );
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
+***************************************************************************/
+
+#ifndef STLREADER_H_
+#define STLREADER_H_
+
+#include <vector>
+
+#include <QString>
+
+#include "Point3D.h"
+
+/*! *****************************
+ * class STLReader
+ * **************************** */
+
+//!  STLReader reads the triangles of a binary or ASCII stereolithography file as an indexed mesh.
+/*!
+  The file is memory mapped and read in a single pass. A file is binary if its size is the size given by the
+  number of facets of its header; ASCII files are split in chunks of whole facets that are parsed in parallel.
+  Facets vertices with the same coordinates are stored once. The facet normals are not read, the front side of
+  each triangle is given by the order of its vertices.
+*/
+class STLReader
+{
+
+public:
+	STLReader();
+
+	bool Read( QString fileName );
+
+	QString GetError() const { return ( m_error ); }
+	const std::vector< Point3D >& GetVertices() const { return ( m_vertices ); }
+	const std::vector< int >& GetIndices() const { return ( m_indices ); }
+
+private:
+	bool ReadASCII( const char* data, qint64 size );
+	bool ReadBinary( const uchar* data, qint64 size );
+
+	QString m_error;
+	std::vector< Point3D > m_vertices;
+	std::vector< int > m_indices;
+};
+
+#endif /* STLREADER_H_ */
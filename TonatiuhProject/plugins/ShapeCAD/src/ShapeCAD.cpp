@@ -35,10 +35,7 @@ Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Marti
 Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
 Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
 ***************************************************************************/
-
-#include <algorithm>
-#include <functional> // for std::bind
-
+#include <QMutexLocker>
 #include <QString>
 
 #include <Inventor/SoPrimitiveVertex.h>
@@ -52,11 +49,20 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include "BBox.h"
 #include "DifferentialGeometry.h"
-#include "NormalVector.h"
+#include "MeshEncoder.h"
 #include "Ray.h"
 #include "ShapeCAD.h"
-#include "Triangle.h"
 
+namespace
+{
+	/*!
+	 * Returns the point stored at \a index in \a field.
+	 */
+	Point3D FieldPoint( const trt::TONATIUH_CONTAINERREALVECTOR3& field, int index )
+	{
+		return ( Point3D( field[index][0], field[index][1], field[index][2] ) );
+	}
+}
 
 /*! *****************************
  * class ShapeCAD
@@ -71,43 +77,29 @@ void ShapeCAD::initClass()
 }
 
 ShapeCAD::ShapeCAD(  )
-: m_pBVH( 0 )
+: m_meshLoaded( true ),
+  m_pBVH( 0 )
 {
 	SO_NODE_CONSTRUCTOR(ShapeCAD);
+	SO_NODE_ADD_FIELD( meshData, ( "" ) );
 	SO_NODE_ADD_FIELD( v1VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( v2VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( v3VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( normalVertexList, (0, 0, 0 ) );
 
-
+	m_meshDataSensor = new SoFieldSensor(updateMeshData, this);
 	m_v1Sensor = new SoFieldSensor(updateTrinaglesList, this);
-	m_v1Sensor->setPriority( 0 );
-	m_v1Sensor->attach( &v1VertexList );
 	m_v2Sensor = new SoFieldSensor(updateTrinaglesList, this);
-	m_v2Sensor->setPriority( 0 );
-	m_v2Sensor->attach( &v2VertexList );
 	m_v3Sensor = new SoFieldSensor(updateTrinaglesList, this);
-	m_v3Sensor->setPriority( 0 );
-	m_v3Sensor->attach( &v3VertexList );
 	m_normalSensor = new SoFieldSensor(updateTrinaglesList, this);
-	m_normalSensor->setPriority( 0 );
-	m_normalSensor->attach( &normalVertexList );
+	AttachSensors();
 }
 
 ShapeCAD::~ShapeCAD()
 {
 	delete m_pBVH;
 
-
-	if( m_pTriangleList.size() > 0 )
-	{
-		for( unsigned int f = 0; f < m_pTriangleList.size(); f++ )
-		{
-			delete m_pTriangleList[f];
-		}
-	}
-	m_pTriangleList.clear();
-
+	delete m_meshDataSensor;
 	delete m_v1Sensor;
 	delete m_v2Sensor;
 	delete m_v3Sensor;
@@ -125,8 +117,7 @@ double ShapeCAD::GetArea() const
  */
 BBox ShapeCAD::GetBBox() const
 {
-
-	//return BBox( Point3D( m_xMin, m_yMin, m_zMin ), Point3D( m_xMax, m_yMax, m_zMax ) );
+	LoadMesh();
 	if( m_pBVH )
 		return ( m_pBVH->GetBBox() );
 
@@ -144,7 +135,7 @@ bool ShapeCAD::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 	double tHitShape= objectRay.maxt;
 	DifferentialGeometry dgShape;
 
-
+	LoadMesh();
 	if( !m_pBVH )	return ( false );
 
 	if ( !m_pBVH->Intersect( objectRay, &tHitShape, &dgShape ) )	return ( false );
@@ -162,9 +153,15 @@ bool ShapeCAD::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 
 }
 
-bool ShapeCAD::IntersectP( const Ray& worldRay ) const
+/*!
+ * Returns true if \a objectRay intersects any triangle of the mesh. The differential geometry is not computed.
+ */
+bool ShapeCAD::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	LoadMesh();
+	if( !m_pBVH )	return ( false );
+
+	return ( m_pBVH->IntersectP( objectRay ) );
 }
 
 Point3D ShapeCAD::Sample( double /*u*/, double /*v*/ ) const
@@ -173,60 +170,57 @@ Point3D ShapeCAD::Sample( double /*u*/, double /*v*/ ) const
 	return ( Point3D( 0.0, 0.0, 0.0 ) );
 }
 
-
-bool ShapeCAD:: SetFacetList( std::vector< Triangle* > triangleList )
+/*!
+ * Creates the triangles mesh and its hierarchy before the tracing, so they are not created by the first
+ * intersection of one of the tracing threads.
+ */
+void ShapeCAD::PrepareTracing()
 {
-	m_v1Sensor->detach();
-	m_v2Sensor->detach();
-	m_v3Sensor->detach();
-	m_normalSensor->detach();
-
-
-	if( m_pTriangleList.size() > 0 )
-	{
-		for( unsigned int f = 0; f < m_pTriangleList.size(); f++ )
-		{
-			delete m_pTriangleList[f];
-		}
-	}
-	m_pTriangleList.clear();
-
-	m_pTriangleList = triangleList;
+	LoadMesh();
+}
 
+/*!
+ * Sets the shape mesh. Each three consecutive elements of \a indices are the positions in \a vertices of the
+ * vertices of a triangle, in counterclockwise order seen from the front side.
+ *
+ * Returns false if an index is not a valid vertex position.
+ */
+bool ShapeCAD::SetTriangles( const std::vector< Point3D >& vertices, const std::vector< int >& indices )
+{
+	if( indices.size() % 3 != 0 )	return ( false );
+	for( unsigned int i = 0; i < indices.size(); i++ )
+		if( ( indices[i] < 0 ) || ( indices[i] >= int( vertices.size() ) ) )	return ( false );
 
-	for( unsigned int f = 0; f < triangleList.size(); f++ )
-	{
+	ClearMesh();
 
-		Triangle* facet = triangleList[f];
+	QMutexLocker locker( &m_meshMutex );
 
-		Point3D v1 = facet->GetVertex1();
-		Point3D v2 = facet->GetVertex2();
-		Point3D v3 = facet->GetVertex3();
-		v1VertexList.set1Value( f, v1.x, v1.y, v1.z);
-		v2VertexList.set1Value( f, v2.x, v2.y, v2.z);
-		v3VertexList.set1Value( f, v3.x, v3.y, v3.z);
-		normalVertexList.set1Value( f, facet->GetNormal().x, facet->GetNormal().y, facet->GetNormal().z);
+	int nTriangles = indices.size() / 3;
+	m_mesh.Reserve( nTriangles );
+	for( int t = 0; t < nTriangles; t++ )
+		m_mesh.AddTriangle( vertices[indices[3 * t]], vertices[indices[3 * t + 1]], vertices[indices[3 * t + 2]] );
 
-	}
+	//The triangles are saved in the hierarchy order, so the saved hierarchy is valid for them
+	std::vector< int > triangleOrder;
+	if( nTriangles > 0 )	m_pBVH = new BVH( &m_mesh, 4, &triangleOrder );
 
-	if( m_pBVH )
+	std::vector< int > orderedIndices( indices.size() );
+	for( int t = 0; t < nTriangles; t++ )
 	{
-		delete m_pBVH;
-		m_pBVH = 0;
+		orderedIndices[3 * t] = indices[3 * triangleOrder[t]];
+		orderedIndices[3 * t + 1] = indices[3 * triangleOrder[t] + 1];
+		orderedIndices[3 * t + 2] = indices[3 * triangleOrder[t] + 2];
 	}
 
-	m_pBVH = new BVH( &m_pTriangleList, 1 );
+	std::vector< BVHNode > nodes;
+	if( m_pBVH )	nodes = m_pBVH->GetNodes();
 
+	DetachSensors();
+	meshData.setValue( MeshEncoder::Encode( vertices, orderedIndices, nodes ).constData() );
+	AttachSensors();
 
-	m_v1Sensor->setPriority( 0 );
-	m_v1Sensor->attach( &v1VertexList );
-	m_v2Sensor->setPriority( 0 );
-	m_v2Sensor->attach( &v2VertexList );
-	m_v3Sensor->setPriority( 0 );
-	m_v3Sensor->attach( &v3VertexList );
-	m_normalSensor->setPriority( 0 );
-	m_normalSensor->attach( &normalVertexList );
-	return ( true);
+	m_meshLoaded = true;
+	return ( true );
 }
 
 int ShapeCAD::getFields(SoFieldList & /*fields*/ ) const
@@ -267,18 +261,21 @@ void ShapeCAD::generatePrimitives(SoAction *action)
 	const SoTextureCoordinateElement* tce = 0;
 	if ( useTexFunc ) tce = SoTextureCoordinateElement::getInstance(state);
 
+	LoadMesh();
+	if( !m_pBVH )	return;
+
 	beginShape(action, TRIANGLES );
 
-	for( int f = 0; f < v1VertexList.getNum(); f++ )
+	for( int f = 0; f < m_mesh.GetNumberOfTriangles(); f++ )
 	{
-		//SbVec3f aPoint = v1VertexList[f];
-		SbVec3f aPoint( v1VertexList[f][0], v1VertexList[f][1], v1VertexList[f][2] );
-		SbVec3f bPoint( v2VertexList[f][0], v2VertexList[f][1], v2VertexList[f][2] );
-		SbVec3f cPoint( v3VertexList[f][0], v3VertexList[f][1], v3VertexList[f][2] );
-
-		//SbVec3f dpdu =  bPoint - aPoint;
-		//SbVec3f dpdv = cPoint - aPoint;
-		SbVec3f normal( normalVertexList[f][0], normalVertexList[f][1], normalVertexList[f][2] );
+		Point3D v1, v2, v3;
+		m_mesh.GetTriangleVertices( f, &v1, &v2, &v3 );
+		SbVec3f aPoint( v1.x, v1.y, v1.z );
+		SbVec3f bPoint( v2.x, v2.y, v2.z );
+		SbVec3f cPoint( v3.x, v3.y, v3.z );
+
+		//The normal of the front side, the one used by the ray tracer
+		SbVec3f normal = ( bPoint - aPoint ).cross( cPoint - aPoint );
 		normal.normalize();
 
 
@@ -311,80 +308,132 @@ void ShapeCAD::generatePrimitives(SoAction *action)
 }
 
 
+/*!
+ * The mesh is decoded again the next time it is used.
+ */
+void ShapeCAD::updateMeshData( void* data, SoSensor* )
+{
+	ShapeCAD* shapeCAD = (ShapeCAD *) data;
+	shapeCAD->ClearMesh();
+}
+
 void ShapeCAD::updateTrinaglesList( void* data, SoSensor* )
 {
 
 	ShapeCAD* shapeCAD = (ShapeCAD *) data;
+	shapeCAD->ReadFacetLists();
+}
 
+/*!
+ * Attaches the fields sensors.
+ */
+void ShapeCAD::AttachSensors()
+{
+	m_meshDataSensor->setPriority( 0 );
+	m_meshDataSensor->attach( &meshData );
+	m_v1Sensor->setPriority( 0 );
+	m_v1Sensor->attach( &v1VertexList );
+	m_v2Sensor->setPriority( 0 );
+	m_v2Sensor->attach( &v2VertexList );
+	m_v3Sensor->setPriority( 0 );
+	m_v3Sensor->attach( &v3VertexList );
+	m_normalSensor->setPriority( 0 );
+	m_normalSensor->attach( &normalVertexList );
+}
 
-	if( shapeCAD->m_pTriangleList.size() > 0 )
-	{
-		for( unsigned int f = 0; f < shapeCAD->m_pTriangleList.size(); f++ )
-		{
-			delete shapeCAD->m_pTriangleList[f];
-		}
-	}
-	shapeCAD->m_pTriangleList.clear();
+/*!
+ * Deletes the triangles mesh and its hierarchy. They are created again from the mesh field when they are used.
+ */
+void ShapeCAD::ClearMesh()
+{
+	QMutexLocker locker( &m_meshMutex );
 
-	if( shapeCAD->m_pBVH )
-	{
-		delete shapeCAD->m_pBVH;
-		shapeCAD->m_pBVH = 0;
-	}
+	delete m_pBVH;
+	m_pBVH = 0;
+	m_mesh.Clear();
+	m_meshLoaded = false;
+}
 
+/*!
+ * Detaches the fields sensors.
+ */
+void ShapeCAD::DetachSensors()
+{
+	m_meshDataSensor->detach();
+	m_v1Sensor->detach();
+	m_v2Sensor->detach();
+	m_v3Sensor->detach();
+	m_normalSensor->detach();
+}
 
-	int v1Size = shapeCAD->v1VertexList.getNum();
-	if( ( v1Size > 0 ) &&
-			( shapeCAD->v2VertexList.getNum() == v1Size ) &&
-			( shapeCAD->v3VertexList.getNum() == v1Size ) &&
-			( shapeCAD->normalVertexList.getNum() == v1Size )  )
-	{
-		/*
-		shapeCAD->m_xMin = gc::Infinity;
-		shapeCAD->m_yMin = gc::Infinity;
-		shapeCAD->m_zMin = gc::Infinity;
+/*!
+ * Decodes the mesh field and creates the triangles mesh and its hierarchy, if they have not been created yet.
+ * The saved hierarchy is used if it is valid for the mesh.
+ */
+void ShapeCAD::LoadMesh() const
+{
+	if( m_meshLoaded )	return;
 
-		shapeCAD->m_xMax = - gc::Infinity;
-		shapeCAD->m_yMax = - gc::Infinity;
-		shapeCAD->m_zMax = - gc::Infinity;
-		*/
+	QMutexLocker locker( &m_meshMutex );
+	if( m_meshLoaded )	return;
 
-		for(  int f = 0; f < v1Size; f++ )
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	std::vector< BVHNode > nodes;
+
+	const SbString& data = meshData.getValue();
+	if( data.getLength() > 0 )
+	{
+		if( MeshEncoder::Decode( QByteArray::fromRawData( data.getString(), data.getLength() ), &vertices, &indices, &nodes ) )
 		{
-			Point3D v1 = Point3D( shapeCAD->v1VertexList[f][0], shapeCAD->v1VertexList[f][1], shapeCAD->v1VertexList[f][2] );
-			Point3D v2 = Point3D( shapeCAD->v2VertexList[f][0], shapeCAD->v2VertexList[f][1], shapeCAD->v2VertexList[f][2] );
-			Point3D v3 = Point3D( shapeCAD->v3VertexList[f][0], shapeCAD->v3VertexList[f][1], shapeCAD->v3VertexList[f][2] );
-			NormalVector normal = NormalVector( shapeCAD->normalVertexList[f][0], shapeCAD->normalVertexList[f][1], shapeCAD->normalVertexList[f][2] );
-			Triangle* triangle = new Triangle( v1, v2, v3, normal );
-			shapeCAD->m_pTriangleList.push_back( triangle );
-
-			/*
-			if( v1.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v1.x;
-			if( v2.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v2.x;
-			if( v3.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v3.x;
-
-			if( v1.y < shapeCAD->m_yMin )	shapeCAD->m_yMin = v1.y;
-			if( v2.y < shapeCAD->m_yMin )	shapeCAD->m_yMin = v2.y;
-			if( v3.y < shapeCAD->m_yMin ) 	shapeCAD->m_yMin = v3.y;
-
-			if( v1.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v1.z;
-			if( v2.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v2.z;
-			if( v3.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v3.z;
-
-			if( v1.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v1.x;
-			if( v2.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v2.x;
-			if( v3.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v3.x;
-
-			if( v1.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v1.y;
-			if( v2.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v2.y;
-			if( v3.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v3.y;
-
-			if( v1.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v1.z;
-			if( v2.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v2.z;
-			if( v3.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v3.z;
-			*/
+			int nTriangles = indices.size() / 3;
+			m_mesh.Reserve( nTriangles );
+			for( int t = 0; t < nTriangles; t++ )
+				m_mesh.AddTriangle( vertices[indices[3 * t]], vertices[indices[3 * t + 1]], vertices[indices[3 * t + 2]] );
+
+			if( nTriangles > 0 )	m_pBVH = new BVH( &m_mesh, nodes );
 		}
-		shapeCAD->m_pBVH = new BVH( &shapeCAD->m_pTriangleList, 1);
+		else
+			gf::Warning( "ShapeCAD: the mesh data is not valid." );
 	}
+
+	m_meshLoaded = true;
 }
 
+/*!
+ * Converts the facet vertices lists of the files saved before the encoded mesh to the mesh field.
+ * The facet lists are emptied so they are not saved again.
+ */
+void ShapeCAD::ReadFacetLists()
+{
+	int nFacets = v1VertexList.getNum();
+	if( v1VertexList.isDefault() || v2VertexList.isDefault() || v3VertexList.isDefault() || normalVertexList.isDefault() )	return;
+	if( ( nFacets < 1 ) || ( v2VertexList.getNum() != nFacets ) || ( v3VertexList.getNum() != nFacets )
+			|| ( normalVertexList.getNum() != nFacets ) )	return;
+
+	std::vector< Point3D > vertices( 3 * nFacets );
+	std::vector< int > indices( 3 * nFacets );
+	for( int f = 0; f < nFacets; f++ )
+	{
+		vertices[3 * f] = FieldPoint( v1VertexList, f );
+		vertices[3 * f + 1] = FieldPoint( v2VertexList, f );
+		vertices[3 * f + 2] = FieldPoint( v3VertexList, f );
+
+		indices[3 * f] = 3 * f;
+		indices[3 * f + 1] = 3 * f + 1;
+		indices[3 * f + 2] = 3 * f + 2;
+	}
+
+	DetachSensors();
+	v1VertexList.setNum( 0 );
+	v1VertexList.setDefault( TRUE );
+	v2VertexList.setNum( 0 );
+	v2VertexList.setDefault( TRUE );
+	v3VertexList.setNum( 0 );
+	v3VertexList.setDefault( TRUE );
+	normalVertexList.setNum( 0 );
+	normalVertexList.setDefault( TRUE );
+	AttachSensors();
+
+	SetTriangles( vertices, indices );
+}
@@ -41,13 +41,15 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include <vector>
 
+#include <QMutex>
+
+#include <Inventor/fields/SoSFString.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
 #include "BVH.h"
 #include "Point3D.h"
-#include "NormalVector.h"
 #include "trt.h"
-#include "Triangle.h"
+#include "TriangleMesh.h"
 #include "TShape.h"
 
 /*! *****************************
@@ -58,27 +60,6 @@ class ShapeCAD : public TShape
 {
 	SO_NODE_HEADER(ShapeCAD);
 
-	/*! *****************************
-	 * class sorter
-	 * **************************** */
-	class Sorter {
-	public:
-		Sorter( Point3D referencePoint) : m_referencePoint( referencePoint) {}
-	      bool operator()( const Triangle* t1, const Triangle* t2)
-	      {
-	    	  Point3D cT1 = t1->GetCentroid();
-	    	  double dT1 = Distance( cT1, m_referencePoint );
-	    	  Point3D cT2 = t2->GetCentroid();
-	    	  double dT2 = Distance( cT2, m_referencePoint );
-
-	    	  if( dT1 < dT2 )	return ( true );
-	    	  return ( false );
-	      }
-
-	private:
-	      Point3D m_referencePoint;
-	};
-
 public:
 	ShapeCAD( );
 	static void initClass();
@@ -91,15 +72,16 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void PrepareTracing();
 
-	bool SetFacetList( std::vector< Triangle* > triangleList );
+	bool SetTriangles( const std::vector< Point3D >& vertices, const std::vector< int >& indices );
 
 	int	getFields(SoFieldList & fields) const;
 
 
 protected:
+	static void updateMeshData(void *data, SoSensor *);
 	static void updateTrinaglesList(void *data, SoSensor *);
-	//bool Near( const Triangle* t1, const Triangle* t2, Point3D referencePoint ) const;
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	void generatePrimitives(SoAction *action);
 	virtual ~ShapeCAD();
@@ -107,30 +89,32 @@ protected:
 
 
 private:
+	void AttachSensors();
+	void ClearMesh();
+	void DetachSensors();
+	void LoadMesh() const;
+	void ReadFacetLists();
+
+	//Encoded mesh vertices, triangles and hierarchy. See MeshEncoder.
+	SoSFString meshData;
 
+	//Facet vertices of the files saved before the encoded mesh. They are only read.
 	trt::TONATIUH_CONTAINERREALVECTOR3 v1VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 v2VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 v3VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 normalVertexList;
 
-	std::vector< Triangle*> m_pTriangleList;
-
+	SoFieldSensor* m_meshDataSensor;
 	SoFieldSensor* m_v1Sensor;
 	SoFieldSensor* m_v2Sensor;
 	SoFieldSensor* m_v3Sensor;
 	SoFieldSensor* m_normalSensor;
 
-/*
-	double m_xMin;
-	double m_xMax;
-	double m_yMin;
-	double m_yMax;
-	double m_zMin;
-	double m_zMax;
-	*/
-
-
-	BVH* m_pBVH;
+	//The mesh is decoded the first time it is used
+	mutable QMutex m_meshMutex;
+	mutable volatile bool m_meshLoaded;
+	mutable TriangleMesh m_mesh;
+	mutable BVH* m_pBVH;
 
 };
 
@@ -0,0 +1,556 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
+***************************************************************************/
+
+#include <cmath>
+
+#include "DifferentialGeometry.h"
+#include "Ray.h"
+#include "TriangleMesh.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __SSE2__ ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SHAPECAD_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHAPECAD_AVX2_TARGET
+#else
+#define SHAPECAD_AVX2_TARGET __attribute__(( target( "avx2" ) ))
+#endif
+#endif
+
+namespace
+{
+	/*!
+	 * Pointers to the intersection data of the first triangle of a range.
+	 */
+	struct TriangleRange
+	{
+		const double* v1x;
+		const double* v1y;
+		const double* v1z;
+		const double* e1x;
+		const double* e1y;
+		const double* e1z;
+		const double* e2x;
+		const double* e2y;
+		const double* e2z;
+		const double* tolerance;
+	};
+
+	typedef int ( *TrianglesKernel )( const TriangleRange& triangles, int nTriangles, const Ray& objectRay,
+			double* tHit, double* u, double* v );
+
+	/*!
+	 * Mller-Trumbore intersection of \a objectRay with the triangle \a t of \a triangles.
+	 */
+	inline bool IntersectScalar( const TriangleRange& triangles, int t, const Ray& objectRay, double* tHit, double* u, double* v )
+	{
+		const Vector3D& direction = objectRay.direction();
+
+		double px = direction.y * triangles.e2z[t] - direction.z * triangles.e2y[t];
+		double py = direction.z * triangles.e2x[t] - direction.x * triangles.e2z[t];
+		double pz = direction.x * triangles.e2y[t] - direction.y * triangles.e2x[t];
+
+		double det = triangles.e1x[t] * px + triangles.e1y[t] * py + triangles.e1z[t] * pz;
+		if( std::fabs( det ) <= triangles.tolerance[t] )	return ( false );
+		double invDet = 1.0 / det;
+
+		double sx = objectRay.origin.x - triangles.v1x[t];
+		double sy = objectRay.origin.y - triangles.v1y[t];
+		double sz = objectRay.origin.z - triangles.v1z[t];
+
+		double uHit = ( sx * px + sy * py + sz * pz ) * invDet;
+		if( uHit < 0.0 || uHit > 1.0 )	return ( false );
+
+		double qx = sy * triangles.e1z[t] - sz * triangles.e1y[t];
+		double qy = sz * triangles.e1x[t] - sx * triangles.e1z[t];
+		double qz = sx * triangles.e1y[t] - sy * triangles.e1x[t];
+
+		double vHit = ( direction.x * qx + direction.y * qy + direction.z * qz ) * invDet;
+		if( vHit < 0.0 || ( uHit + vHit ) > 1.0 )	return ( false );
+
+		double thit = ( triangles.e2x[t] * qx + triangles.e2y[t] * qy + triangles.e2z[t] * qz ) * invDet;
+		if( thit > *tHit )	return ( false );
+		if( ( thit - objectRay.mint ) < triangles.tolerance[t] )	return ( false );
+
+		*tHit = thit;
+		*u = uHit;
+		*v = vHit;
+		return ( true );
+	}
+
+#ifdef SHAPECAD_SSE2
+
+	/*!
+	 * Tests the triangles two by two with SSE2 instructions.
+	 * The accepted intersections are the same as the scalar kernel ones.
+	 */
+	int IntersectTrianglesSSE2( const TriangleRange& triangles, int nTriangles, const Ray& objectRay,
+			double* tHit, double* u, double* v )
+	{
+		const Vector3D& direction = objectRay.direction();
+		__m128d dx = _mm_set1_pd( direction.x );
+		__m128d dy = _mm_set1_pd( direction.y );
+		__m128d dz = _mm_set1_pd( direction.z );
+		__m128d ox = _mm_set1_pd( objectRay.origin.x );
+		__m128d oy = _mm_set1_pd( objectRay.origin.y );
+		__m128d oz = _mm_set1_pd( objectRay.origin.z );
+		__m128d mint = _mm_set1_pd( objectRay.mint );
+		__m128d zero = _mm_setzero_pd();
+		__m128d one = _mm_set1_pd( 1.0 );
+		__m128d signMask = _mm_set1_pd( -0.0 );
+
+		int hitTriangle = -1;
+		int t = 0;
+		for( ; t + 2 <= nTriangles; t += 2 )
+		{
+			__m128d e1x = _mm_loadu_pd( triangles.e1x + t );
+			__m128d e1y = _mm_loadu_pd( triangles.e1y + t );
+			__m128d e1z = _mm_loadu_pd( triangles.e1z + t );
+			__m128d e2x = _mm_loadu_pd( triangles.e2x + t );
+			__m128d e2y = _mm_loadu_pd( triangles.e2y + t );
+			__m128d e2z = _mm_loadu_pd( triangles.e2z + t );
+			__m128d tolerance = _mm_loadu_pd( triangles.tolerance + t );
+
+			__m128d px = _mm_sub_pd( _mm_mul_pd( dy, e2z ), _mm_mul_pd( dz, e2y ) );
+			__m128d py = _mm_sub_pd( _mm_mul_pd( dz, e2x ), _mm_mul_pd( dx, e2z ) );
+			__m128d pz = _mm_sub_pd( _mm_mul_pd( dx, e2y ), _mm_mul_pd( dy, e2x ) );
+			__m128d det = _mm_add_pd( _mm_add_pd( _mm_mul_pd( e1x, px ), _mm_mul_pd( e1y, py ) ), _mm_mul_pd( e1z, pz ) );
+			__m128d valid = _mm_cmpgt_pd( _mm_andnot_pd( signMask, det ), tolerance );
+			if( _mm_movemask_pd( valid ) == 0 )	continue;
+			__m128d invDet = _mm_div_pd( one, det );
+
+			__m128d sx = _mm_sub_pd( ox, _mm_loadu_pd( triangles.v1x + t ) );
+			__m128d sy = _mm_sub_pd( oy, _mm_loadu_pd( triangles.v1y + t ) );
+			__m128d sz = _mm_sub_pd( oz, _mm_loadu_pd( triangles.v1z + t ) );
+			__m128d uHit = _mm_mul_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( sx, px ), _mm_mul_pd( sy, py ) ), _mm_mul_pd( sz, pz ) ), invDet );
+			valid = _mm_and_pd( valid, _mm_and_pd( _mm_cmpge_pd( uHit, zero ), _mm_cmple_pd( uHit, one ) ) );
+
+			__m128d qx = _mm_sub_pd( _mm_mul_pd( sy, e1z ), _mm_mul_pd( sz, e1y ) );
+			__m128d qy = _mm_sub_pd( _mm_mul_pd( sz, e1x ), _mm_mul_pd( sx, e1z ) );
+			__m128d qz = _mm_sub_pd( _mm_mul_pd( sx, e1y ), _mm_mul_pd( sy, e1x ) );
+			__m128d vHit = _mm_mul_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( dx, qx ), _mm_mul_pd( dy, qy ) ), _mm_mul_pd( dz, qz ) ), invDet );
+			valid = _mm_and_pd( valid, _mm_and_pd( _mm_cmpge_pd( vHit, zero ), _mm_cmple_pd( _mm_add_pd( uHit, vHit ), one ) ) );
+
+			__m128d thit = _mm_mul_pd( _mm_add_pd( _mm_add_pd( _mm_mul_pd( e2x, qx ), _mm_mul_pd( e2y, qy ) ), _mm_mul_pd( e2z, qz ) ), invDet );
+			valid = _mm_and_pd( valid, _mm_cmple_pd( thit, _mm_set1_pd( *tHit ) ) );
+			valid = _mm_and_pd( valid, _mm_cmpge_pd( _mm_sub_pd( thit, mint ), tolerance ) );
+
+			int hitMask = _mm_movemask_pd( valid );
+			if( hitMask == 0 )	continue;
+
+			double tLanes[2];
+			double uLanes[2];
+			double vLanes[2];
+			_mm_storeu_pd( tLanes, thit );
+			_mm_storeu_pd( uLanes, uHit );
+			_mm_storeu_pd( vLanes, vHit );
+			for( int lane = 0; lane < 2; ++lane )
+			{
+				if( ( hitMask & ( 1 << lane ) ) && tLanes[lane] <= *tHit )
+				{
+					*tHit = tLanes[lane];
+					*u = uLanes[lane];
+					*v = vLanes[lane];
+					hitTriangle = t + lane;
+				}
+			}
+		}
+
+		if( t < nTriangles && IntersectScalar( triangles, t, objectRay, tHit, u, v ) )	hitTriangle = t;
+		return ( hitTriangle );
+	}
+
+	/*!
+	 * Tests the triangles four by four with AVX2 instructions. The last group loads only the remaining triangles.
+	 * The accepted intersections are the same as the scalar kernel ones.
+	 */
+	SHAPECAD_AVX2_TARGET int IntersectTrianglesAVX2( const TriangleRange& triangles, int nTriangles, const Ray& objectRay,
+			double* tHit, double* u, double* v )
+	{
+		const Vector3D& direction = objectRay.direction();
+		__m256d dx = _mm256_set1_pd( direction.x );
+		__m256d dy = _mm256_set1_pd( direction.y );
+		__m256d dz = _mm256_set1_pd( direction.z );
+		__m256d ox = _mm256_set1_pd( objectRay.origin.x );
+		__m256d oy = _mm256_set1_pd( objectRay.origin.y );
+		__m256d oz = _mm256_set1_pd( objectRay.origin.z );
+		__m256d mint = _mm256_set1_pd( objectRay.mint );
+		__m256d zero = _mm256_setzero_pd();
+		__m256d one = _mm256_set1_pd( 1.0 );
+		__m256d signMask = _mm256_set1_pd( -0.0 );
+		__m256i laneIndex = _mm256_set_epi64x( 3, 2, 1, 0 );
+
+		int hitTriangle = -1;
+		for( int t = 0; t < nTriangles; t += 4 )
+		{
+			__m256i loadMask = _mm256_cmpgt_epi64( _mm256_set1_epi64x( nTriangles - t ), laneIndex );
+
+			__m256d e1x = _mm256_maskload_pd( triangles.e1x + t, loadMask );
+			__m256d e1y = _mm256_maskload_pd( triangles.e1y + t, loadMask );
+			__m256d e1z = _mm256_maskload_pd( triangles.e1z + t, loadMask );
+			__m256d e2x = _mm256_maskload_pd( triangles.e2x + t, loadMask );
+			__m256d e2y = _mm256_maskload_pd( triangles.e2y + t, loadMask );
+			__m256d e2z = _mm256_maskload_pd( triangles.e2z + t, loadMask );
+			__m256d tolerance = _mm256_maskload_pd( triangles.tolerance + t, loadMask );
+
+			__m256d px = _mm256_sub_pd( _mm256_mul_pd( dy, e2z ), _mm256_mul_pd( dz, e2y ) );
+			__m256d py = _mm256_sub_pd( _mm256_mul_pd( dz, e2x ), _mm256_mul_pd( dx, e2z ) );
+			__m256d pz = _mm256_sub_pd( _mm256_mul_pd( dx, e2y ), _mm256_mul_pd( dy, e2x ) );
+			__m256d det = _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( e1x, px ), _mm256_mul_pd( e1y, py ) ), _mm256_mul_pd( e1z, pz ) );
+
+			//The masked out lanes have zero determinant and zero tolerance, so they are rejected here
+			__m256d valid = _mm256_cmp_pd( _mm256_andnot_pd( signMask, det ), tolerance, _CMP_GT_OQ );
+			if( _mm256_movemask_pd( valid ) == 0 )	continue;
+			__m256d invDet = _mm256_div_pd( one, det );
+
+			__m256d sx = _mm256_sub_pd( ox, _mm256_maskload_pd( triangles.v1x + t, loadMask ) );
+			__m256d sy = _mm256_sub_pd( oy, _mm256_maskload_pd( triangles.v1y + t, loadMask ) );
+			__m256d sz = _mm256_sub_pd( oz, _mm256_maskload_pd( triangles.v1z + t, loadMask ) );
+			__m256d uHit = _mm256_mul_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( sx, px ), _mm256_mul_pd( sy, py ) ), _mm256_mul_pd( sz, pz ) ), invDet );
+			valid = _mm256_and_pd( valid, _mm256_and_pd( _mm256_cmp_pd( uHit, zero, _CMP_GE_OQ ), _mm256_cmp_pd( uHit, one, _CMP_LE_OQ ) ) );
+
+			__m256d qx = _mm256_sub_pd( _mm256_mul_pd( sy, e1z ), _mm256_mul_pd( sz, e1y ) );
+			__m256d qy = _mm256_sub_pd( _mm256_mul_pd( sz, e1x ), _mm256_mul_pd( sx, e1z ) );
+			__m256d qz = _mm256_sub_pd( _mm256_mul_pd( sx, e1y ), _mm256_mul_pd( sy, e1x ) );
+			__m256d vHit = _mm256_mul_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( dx, qx ), _mm256_mul_pd( dy, qy ) ), _mm256_mul_pd( dz, qz ) ), invDet );
+			valid = _mm256_and_pd( valid, _mm256_and_pd( _mm256_cmp_pd( vHit, zero, _CMP_GE_OQ ),
+					_mm256_cmp_pd( _mm256_add_pd( uHit, vHit ), one, _CMP_LE_OQ ) ) );
+
+			__m256d thit = _mm256_mul_pd( _mm256_add_pd( _mm256_add_pd( _mm256_mul_pd( e2x, qx ), _mm256_mul_pd( e2y, qy ) ), _mm256_mul_pd( e2z, qz ) ), invDet );
+			valid = _mm256_and_pd( valid, _mm256_cmp_pd( thit, _mm256_set1_pd( *tHit ), _CMP_LE_OQ ) );
+			valid = _mm256_and_pd( valid, _mm256_cmp_pd( _mm256_sub_pd( thit, mint ), tolerance, _CMP_GE_OQ ) );
+
+			int hitMask = _mm256_movemask_pd( valid );
+			if( hitMask == 0 )	continue;
+
+			double tLanes[4];
+			double uLanes[4];
+			double vLanes[4];
+			_mm256_storeu_pd( tLanes, thit );
+			_mm256_storeu_pd( uLanes, uHit );
+			_mm256_storeu_pd( vLanes, vHit );
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( ( hitMask & ( 1 << lane ) ) && tLanes[lane] <= *tHit )
+				{
+					*tHit = tLanes[lane];
+					*u = uLanes[lane];
+					*v = vLanes[lane];
+					hitTriangle = t + lane;
+				}
+			}
+		}
+
+		return ( hitTriangle );
+	}
+
+	/*!
+	 * Returns true if the processor and the operating system support AVX2 instructions.
+	 */
+	bool SupportsAVX2()
+	{
+#if defined( __AVX2__ )
+		return ( true );
+#elif defined( _MSC_VER )
+		int info[4];
+		__cpuid( info, 0 );
+		if( info[0] < 7 )	return ( false );
+
+		//OSXSAVE and AVX, and the operating system saves the AVX registers
+		__cpuid( info, 1 );
+		if( ( info[2] & ( 1 << 27 ) ) == 0 || ( info[2] & ( 1 << 28 ) ) == 0 )	return ( false );
+		if( ( _xgetbv( 0 ) & 6 ) != 6 )	return ( false );
+
+		__cpuidex( info, 7, 0 );
+		return ( ( info[1] & ( 1 << 5 ) ) != 0 );
+#else
+		__builtin_cpu_init();
+		return ( __builtin_cpu_supports( "avx2" ) );
+#endif
+	}
+
+#endif
+
+	/*!
+	 * Tests the triangles one by one. The other kernels accept the same intersections as this one.
+	 */
+	int IntersectTrianglesScalar( const TriangleRange& triangles, int nTriangles, const Ray& objectRay,
+			double* tHit, double* u, double* v )
+	{
+		int hitTriangle = -1;
+		for( int t = 0; t < nTriangles; ++t )
+			if( IntersectScalar( triangles, t, objectRay, tHit, u, v ) )	hitTriangle = t;
+
+		return ( hitTriangle );
+	}
+
+	/*!
+	 * Returns the function of \a kernel, or null if the processor does not support it.
+	 */
+	TrianglesKernel KernelFunction( TriangleMesh::Kernel kernel )
+	{
+		switch( kernel )
+		{
+#ifdef SHAPECAD_SSE2
+			case TriangleMesh::AVX2Kernel:
+				return ( SupportsAVX2() ? IntersectTrianglesAVX2 : 0 );
+			case TriangleMesh::SSE2Kernel:
+				return ( IntersectTrianglesSSE2 );
+#endif
+			case TriangleMesh::ScalarKernel:
+				return ( IntersectTrianglesScalar );
+			default:
+				return ( 0 );
+		}
+	}
+
+	/*!
+	 * Returns the function of \a kernel, or the scalar kernel function if the processor does not support it.
+	 */
+	TrianglesKernel KernelFunctionOrScalar( TriangleMesh::Kernel kernel )
+	{
+		TrianglesKernel function = KernelFunction( kernel );
+		return ( function ? function : IntersectTrianglesScalar );
+	}
+
+	/*!
+	 * Returns the widest kernel supported by the processor.
+	 */
+	TriangleMesh::Kernel SelectKernel()
+	{
+		if( KernelFunction( TriangleMesh::AVX2Kernel ) )	return ( TriangleMesh::AVX2Kernel );
+		if( KernelFunction( TriangleMesh::SSE2Kernel ) )	return ( TriangleMesh::SSE2Kernel );
+		return ( TriangleMesh::ScalarKernel );
+	}
+
+	const char* const kernelNames[TriangleMesh::NumberOfKernels] = { "scalar", "SSE2", "AVX2" };
+	const TrianglesKernel kernelFunctions[TriangleMesh::NumberOfKernels] = { KernelFunctionOrScalar( TriangleMesh::ScalarKernel ),
+			KernelFunctionOrScalar( TriangleMesh::SSE2Kernel ), KernelFunctionOrScalar( TriangleMesh::AVX2Kernel ) };
+	const TriangleMesh::Kernel selectedKernel = SelectKernel();
+}
+
+/*! *****************************
+ * class TriangleMesh
+ * **************************** */
+
+/*!
+ * Creates an empty mesh.
+ */
+TriangleMesh::TriangleMesh()
+{
+
+}
+
+/*!
+ * Adds the triangle with vertices \a v1, \a v2 and \a v3 to the mesh.
+ * The front side of the triangle is the side where the vertices are in counterclockwise order.
+ */
+void TriangleMesh::AddTriangle( const Point3D& v1, const Point3D& v2, const Point3D& v3 )
+{
+	Vector3D e1 = v2 - v1;
+	Vector3D e2 = v3 - v1;
+
+	m_v1x.push_back( v1.x );
+	m_v1y.push_back( v1.y );
+	m_v1z.push_back( v1.z );
+	m_e1x.push_back( e1.x );
+	m_e1y.push_back( e1.y );
+	m_e1z.push_back( e1.z );
+	m_e2x.push_back( e2.x );
+	m_e2y.push_back( e2.y );
+	m_e2z.push_back( e2.z );
+	m_tolerance.push_back( e1.length() * e2.length() / 1000000 );
+}
+
+/*!
+ * Removes all the triangles.
+ */
+void TriangleMesh::Clear()
+{
+	std::vector< double >().swap( m_v1x );
+	std::vector< double >().swap( m_v1y );
+	std::vector< double >().swap( m_v1z );
+	std::vector< double >().swap( m_e1x );
+	std::vector< double >().swap( m_e1y );
+	std::vector< double >().swap( m_e1z );
+	std::vector< double >().swap( m_e2x );
+	std::vector< double >().swap( m_e2y );
+	std::vector< double >().swap( m_e2z );
+	std::vector< double >().swap( m_tolerance );
+}
+
+/*!
+ * Reserves memory for \a nTriangles triangles.
+ */
+void TriangleMesh::Reserve( int nTriangles )
+{
+	m_v1x.reserve( nTriangles );
+	m_v1y.reserve( nTriangles );
+	m_v1z.reserve( nTriangles );
+	m_e1x.reserve( nTriangles );
+	m_e1y.reserve( nTriangles );
+	m_e1z.reserve( nTriangles );
+	m_e2x.reserve( nTriangles );
+	m_e2y.reserve( nTriangles );
+	m_e2z.reserve( nTriangles );
+	m_tolerance.reserve( nTriangles );
+}
+
+/*!
+ * Sorts the triangles so the triangle \a order[i] becomes the triangle \a i.
+ */
+void TriangleMesh::Reorder( const std::vector< int >& order )
+{
+	std::vector< double >* components[10] = { &m_v1x, &m_v1y, &m_v1z, &m_e1x, &m_e1y, &m_e1z,
+			&m_e2x, &m_e2y, &m_e2z, &m_tolerance };
+
+	std::vector< double > sorted( order.size() );
+	for( int c = 0; c < 10; ++c )
+	{
+		std::vector< double >& component = *components[c];
+		for( unsigned int t = 0; t < order.size(); ++t )
+			sorted[t] = component[order[t]];
+		component.swap( sorted );
+	}
+}
+
+/*!
+ * Intersects \a objectRay with the \a nTriangles triangles starting at \a firstTriangle.
+ *
+ * Returns the index of the nearest triangle intersected nearer than \a tHit, or -1 if there is no intersection.
+ * If there is an intersection, \a tHit is updated to its distance and \a u and \a v to its barycentric coordinates.
+ */
+int TriangleMesh::IntersectTriangles( int firstTriangle, int nTriangles, const Ray& objectRay, double* tHit, double* u, double* v ) const
+{
+	return ( IntersectTriangles( selectedKernel, firstTriangle, nTriangles, objectRay, tHit, u, v ) );
+}
+
+/*!
+ * Intersects \a objectRay with the \a nTriangles triangles starting at \a firstTriangle as IntersectTriangles does,
+ * but testing them with \a kernel. If the processor does not support \a kernel, the scalar kernel is used.
+ *
+ * All the kernels accept the same intersections. If several triangles give the nearest distance, the returned
+ * triangle can differ.
+ */
+int TriangleMesh::IntersectTriangles( Kernel kernel, int firstTriangle, int nTriangles, const Ray& objectRay, double* tHit, double* u, double* v ) const
+{
+	TriangleRange triangles;
+	triangles.v1x = &m_v1x[firstTriangle];
+	triangles.v1y = &m_v1y[firstTriangle];
+	triangles.v1z = &m_v1z[firstTriangle];
+	triangles.e1x = &m_e1x[firstTriangle];
+	triangles.e1y = &m_e1y[firstTriangle];
+	triangles.e1z = &m_e1z[firstTriangle];
+	triangles.e2x = &m_e2x[firstTriangle];
+	triangles.e2y = &m_e2y[firstTriangle];
+	triangles.e2z = &m_e2z[firstTriangle];
+	triangles.tolerance = &m_tolerance[firstTriangle];
+
+	int hitTriangle = kernelFunctions[kernel]( triangles, nTriangles, objectRay, tHit, u, v );
+	if( hitTriangle < 0 )	return ( -1 );
+	return ( firstTriangle + hitTriangle );
+}
+
+/*!
+ * Returns true if the processor supports the instructions of \a kernel.
+ */
+bool TriangleMesh::IsKernelSupported( Kernel kernel )
+{
+	return ( KernelFunction( kernel ) != 0 );
+}
+
+/*!
+ * Returns the name of the instruction set used by IntersectTriangles.
+ */
+const char* TriangleMesh::KernelName()
+{
+	return ( kernelNames[selectedKernel] );
+}
+
+/*!
+ * Returns the bounding box of the triangle with index \a triangle.
+ */
+BBox TriangleMesh::GetTriangleBBox( int triangle ) const
+{
+	Point3D v1( m_v1x[triangle], m_v1y[triangle], m_v1z[triangle] );
+	Vector3D e1( m_e1x[triangle], m_e1y[triangle], m_e1z[triangle] );
+	Vector3D e2( m_e2x[triangle], m_e2y[triangle], m_e2z[triangle] );
+
+	return ( Union( BBox( v1, v1 + e1 ), v1 + e2 ) );
+}
+
+/*!
+ * Returns the centroid of the triangle with index \a triangle.
+ */
+Point3D TriangleMesh::GetTriangleCentroid( int triangle ) const
+{
+	Point3D v1( m_v1x[triangle], m_v1y[triangle], m_v1z[triangle] );
+	Vector3D e1( m_e1x[triangle], m_e1y[triangle], m_e1z[triangle] );
+	Vector3D e2( m_e2x[triangle], m_e2y[triangle], m_e2z[triangle] );
+
+	return ( v1 + ( e1 + e2 ) / 3.0 );
+}
+
+/*!
+ * Sets \a v1, \a v2 and \a v3 to the vertices of the triangle with index \a triangle.
+ */
+void TriangleMesh::GetTriangleVertices( int triangle, Point3D* v1, Point3D* v2, Point3D* v3 ) const
+{
+	*v1 = Point3D( m_v1x[triangle], m_v1y[triangle], m_v1z[triangle] );
+	*v2 = *v1 + Vector3D( m_e1x[triangle], m_e1y[triangle], m_e1z[triangle] );
+	*v3 = *v1 + Vector3D( m_e2x[triangle], m_e2y[triangle], m_e2z[triangle] );
+}
+
+/*!
+ * Computes in \a dg the differential geometry of the intersection at \a tHit of \a objectRay with the
+ * triangle \a triangle. \a u and \a v are the barycentric coordinates of the intersection point.
+ */
+void TriangleMesh::GetDifferentialGeometry( int triangle, const Ray& objectRay, double tHit, double u, double v, DifferentialGeometry* dg ) const
+{
+	Vector3D e1( m_e1x[triangle], m_e1y[triangle], m_e1z[triangle] );
+	Vector3D e2( m_e2x[triangle], m_e2y[triangle], m_e2z[triangle] );
+
+	//The triangles are flat, so the normal does not change along the surface
+	Vector3D dpdu = Normalize( e1 );
+	Vector3D dpdv = Normalize( e2 );
+	*dg = DifferentialGeometry( objectRay( tHit ), dpdu, dpdv, Vector3D( 0.0, 0.0, 0.0 ), Vector3D( 0.0, 0.0, 0.0 ), u, v, 0 );
+
+	dg->shapeFrontSide = ( DotProduct( CrossProduct( e1, e2 ), objectRay.direction() ) > 0 ) ? false : true;
+}
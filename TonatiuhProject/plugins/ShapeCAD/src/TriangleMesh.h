@@ -0,0 +1,108 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
+***************************************************************************/
+
+#ifndef TRIANGLEMESH_H_
+#define TRIANGLEMESH_H_
+
+#include <vector>
+
+#include "BBox.h"
+#include "Point3D.h"
+
+class DifferentialGeometry;
+class Ray;
+
+/*! *****************************
+ * class TriangleMesh
+ * **************************** */
+
+//!  TriangleMesh stores the triangles of a ShapeCAD in the form used by the intersection tests.
+/*!
+  For each triangle the first vertex and the two edge vectors are precomputed and stored in structure of arrays
+  form, one array for each component, so the triangles of a BVH leaf are contiguous in memory and can be
+  tested together. The vertices and the index buffer of the mesh are kept by the ShapeCAD fields.
+
+  IntersectTriangles tests a range of triangles with the widest kernel supported by the processor, selected at
+  run time: AVX2 tests four triangles at once, SSE2 two, and the scalar kernel is used on other processors.
+  The kernel can also be given, to check the SIMD kernels against the scalar one.
+*/
+class TriangleMesh
+{
+
+public:
+	enum Kernel
+	{
+		ScalarKernel = 0,
+		SSE2Kernel = 1,
+		AVX2Kernel = 2,
+		NumberOfKernels = 3
+	};
+
+	TriangleMesh();
+
+	void AddTriangle( const Point3D& v1, const Point3D& v2, const Point3D& v3 );
+	void Clear();
+	void Reserve( int nTriangles );
+	void Reorder( const std::vector< int >& order );
+
+	int GetNumberOfTriangles() const { return ( m_v1x.size() ); }
+	BBox GetTriangleBBox( int triangle ) const;
+	Point3D GetTriangleCentroid( int triangle ) const;
+	void GetTriangleVertices( int triangle, Point3D* v1, Point3D* v2, Point3D* v3 ) const;
+
+	int IntersectTriangles( int firstTriangle, int nTriangles, const Ray& objectRay, double* tHit, double* u, double* v ) const;
+	int IntersectTriangles( Kernel kernel, int firstTriangle, int nTriangles, const Ray& objectRay, double* tHit, double* u, double* v ) const;
+	void GetDifferentialGeometry( int triangle, const Ray& objectRay, double tHit, double u, double v, DifferentialGeometry* dg ) const;
+
+	static bool IsKernelSupported( Kernel kernel );
+	static const char* KernelName();
+
+private:
+	std::vector< double > m_v1x;
+	std::vector< double > m_v1y;
+	std::vector< double > m_v1z;
+	std::vector< double > m_e1x;
+	std::vector< double > m_e1y;
+	std::vector< double > m_e1z;
+	std::vector< double > m_e2x;
+	std::vector< double > m_e2y;
+	std::vector< double > m_e2z;
+	std::vector< double > m_tolerance;
+};
+
+#endif /* TRIANGLEMESH_H_ */
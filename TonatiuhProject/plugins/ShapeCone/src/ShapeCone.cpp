@@ -73,6 +73,7 @@ ShapeCone::ShapeCone(  )
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (OUTSIDE) );
 
+	CompileParameters();
 }
 
 ShapeCone::~ShapeCone()
@@ -119,8 +120,7 @@ QString ShapeCone::GetIcon() const
 bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
 	// Compute quadratic ShapeCone coefficients
-	double theta = atan2( height.getValue(), ( baseRadius.getValue() - topRadius.getValue() ) );
-	double invTan = 1 / tan(theta);
+	double invTan = m_parameters.invTan;
 
 	double A = (     objectRay.direction().x * objectRay.direction().x )
 				 + ( objectRay.direction().z * objectRay.direction().z )
@@ -128,13 +128,13 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 
 	double B = 2.0 * ( (    objectRay.origin.x * objectRay.direction().x )
 						+ ( objectRay.origin.z * objectRay.direction().z )
-						+ ( baseRadius.getValue() * invTan * objectRay.direction().y )
+						+ ( m_parameters.baseRadius * invTan * objectRay.direction().y )
 						- ( invTan * invTan * objectRay.origin.y * objectRay.direction().y ) );
 
 	double C = (    objectRay.origin.x * objectRay.origin.x )
 				+ ( objectRay.origin.z * objectRay.origin.z )
-				- ( baseRadius.getValue() * baseRadius.getValue() )
-				+ ( 2 * baseRadius.getValue() * invTan * objectRay.origin.y )
+				- ( m_parameters.baseRadius * m_parameters.baseRadius )
+				+ ( 2 * m_parameters.baseRadius * invTan * objectRay.origin.y )
 				- ( invTan * invTan * objectRay.origin.y * objectRay.origin.y );
 
 	// Solve quadratic equation for _t_ values
@@ -157,7 +157,7 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 	double phi = atan2( hitPoint.x, hitPoint.z );
 
 	// Test intersection against clipping parameters
-	if( hitPoint.y < 0 || hitPoint.y > height.getValue() || phi > phiMax.getValue() )
+	if( hitPoint.y < 0 || hitPoint.y > m_parameters.height || phi > m_parameters.phiMax )
 	{
 		if ( thit == t1 ) return false;
 		if ( t1 > objectRay.maxt ) return false;
@@ -165,7 +165,7 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 
 		hitPoint = objectRay( thit );
 		phi = atan2( hitPoint.x, hitPoint.z );
-		if ( hitPoint.y < 0 || hitPoint.y > height.getValue() || phi > phiMax.getValue() ) return false;
+		if ( hitPoint.y < 0 || hitPoint.y > m_parameters.height || phi > m_parameters.phiMax ) return false;
 	}
 	// Now check if the function is being called from IntersectP,
 	// in which case the pointers tHit and dg are 0
@@ -176,33 +176,33 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
     hitPoint = objectRay( thit );
 
 	// Find parametric representation of ShapeCone hit
-	double u = phi / phiMax.getValue();
-	double v = hitPoint.y / height.getValue();
+	double u = phi / m_parameters.phiMax;
+	double v = hitPoint.y / m_parameters.height;
 
 	// Compute ShapeCone \dpdu and \dpdv
-	Vector3D dpdu( phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue()* v + topRadius.getValue()* v )
-						* cos( phiMax.getValue() * u ),
+	Vector3D dpdu( m_parameters.phiMax * ( m_parameters.baseRadius - m_parameters.baseRadius* v + m_parameters.topRadius* v )
+						* cos( m_parameters.phiMax * u ),
 					0.0,
-					-phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue() * v + topRadius.getValue() * v )
-						* sin( phiMax.getValue() * u ) );
+					-m_parameters.phiMax * ( m_parameters.baseRadius - m_parameters.baseRadius * v + m_parameters.topRadius * v )
+						* sin( m_parameters.phiMax * u ) );
 
-	Vector3D dpdv(  -height.getValue()  / tan ( atan2( height.getValue(), ( baseRadius.getValue() - topRadius.getValue() ) ) )
-							* sin( phiMax.getValue() *  u ),
-							height.getValue(),
-					-height.getValue()* cos( phiMax.getValue()* u )
-							 / tan ( atan2( height.getValue(), ( baseRadius.getValue() - topRadius.getValue() ) ) ) );
+	Vector3D dpdv(  -m_parameters.height  * invTan
+							* sin( m_parameters.phiMax *  u ),
+							m_parameters.height,
+					-m_parameters.height* cos( m_parameters.phiMax* u )
+							 * invTan );
 
 	// Compute ShapeCone \dndu and \dndv
 
-	Vector3D d2Pduu( -phiMax.getValue() * phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue() * v + topRadius.getValue() * v )
-			* sin( phiMax.getValue() * u ),
+	Vector3D d2Pduu( -m_parameters.phiMax * m_parameters.phiMax * ( m_parameters.baseRadius - m_parameters.baseRadius * v + m_parameters.topRadius * v )
+			* sin( m_parameters.phiMax * u ),
 	   0.0,
-	   -phiMax.getValue() * phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue() * v + topRadius.getValue() * v )
-		   * cos( phiMax.getValue() * u ) );
+	   -m_parameters.phiMax * m_parameters.phiMax * ( m_parameters.baseRadius - m_parameters.baseRadius * v + m_parameters.topRadius * v )
+		   * cos( m_parameters.phiMax * u ) );
 
-	Vector3D d2Pduv( phiMax.getValue() * ( -baseRadius.getValue() + topRadius.getValue() ) * cos( phiMax.getValue() * u ),
+	Vector3D d2Pduv( m_parameters.phiMax * ( -m_parameters.baseRadius + m_parameters.topRadius ) * cos( m_parameters.phiMax * u ),
 			0.0,
-			phiMax.getValue() * ( baseRadius.getValue() - topRadius.getValue() ) * sin( phiMax.getValue()* u ) );
+			m_parameters.phiMax * ( m_parameters.baseRadius - m_parameters.topRadius ) * sin( m_parameters.phiMax* u ) );
 
 	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
 
@@ -249,6 +249,18 @@ Point3D ShapeCone::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the cone fields used by Intersect and the inverse of the tangent of the cone slope.
+ */
+void ShapeCone::CompileParameters()
+{
+	m_parameters.baseRadius = baseRadius.getValue();
+	m_parameters.topRadius = topRadius.getValue();
+	m_parameters.height = height.getValue();
+	m_parameters.phiMax = phiMax.getValue();
+	m_parameters.invTan = 1 / tan( atan2( m_parameters.height, ( m_parameters.baseRadius - m_parameters.topRadius ) ) );
+}
+
 Point3D ShapeCone::GetPoint3D (double u, double v) const
 {
 	if ( OutOfRange( u, v ) )	gf::SevereError( "Function ShapeCone::GetPoint3D called with invalid parameters" );
@@ -60,6 +60,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	enum Side{
 		INSIDE = 0,
@@ -80,6 +81,19 @@ protected:
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	void generatePrimitives(SoAction *action);
 	virtual ~ShapeCone();
+
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double baseRadius;
+		double topRadius;
+		double height;
+		double phiMax;
+		double invTan;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*ShapeCone_H_*/
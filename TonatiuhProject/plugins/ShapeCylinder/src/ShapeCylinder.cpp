@@ -48,6 +48,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "BBox.h"
 #include "DifferentialGeometry.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "ShapeCylinder.h"
 #include "Vector3D.h"
 
@@ -69,6 +70,8 @@ ShapeCylinder::ShapeCylinder( )
 	SO_NODE_DEFINE_ENUM_VALUE( Side, OUTSIDE );
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (OUTSIDE) );
+
+	CompileParameters();
 }
 
 ShapeCylinder::~ShapeCylinder()
@@ -117,7 +120,7 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 	Vector3D vObjectRayOrigin = Vector3D( objectRay.origin );
 	double A = objectRay.direction().x*objectRay.direction().x + objectRay.direction().y*objectRay.direction().y;
     double B = 2.0 * ( objectRay.direction().x* objectRay.origin.x + objectRay.direction().y * objectRay.origin.y);
-	double C = objectRay.origin.x * objectRay.origin.x + objectRay.origin.y * objectRay.origin.y - radius.getValue() * radius.getValue();
+	double C = objectRay.origin.x * objectRay.origin.x + objectRay.origin.y * objectRay.origin.y - m_parameters.squaredRadius;
 
 	// Solve quadratic equation for _t_ values
 	double t0, t1;
@@ -136,11 +139,11 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 	//Evaluate Tolerance
 	double tol = 0.00001;
 	double zmin = 0.0;
-	double zmax = length.getValue();
+	double zmax = m_parameters.length;
 
 
 	// Test intersection against clipping parameters
-	if( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > phiMax.getValue() )
+	if( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > m_parameters.phiMax )
 	{
 		if ( thit == t1 ) return false;
 		if ( t1 > objectRay.maxt ) return false;
@@ -149,7 +152,7 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 		hitPoint = objectRay( thit );
 		phi = atan2( hitPoint.y, hitPoint.x );
 		if ( phi < 0. ) phi += gc::TwoPi;
-		if ( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > phiMax.getValue() ) return false;
+		if ( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > m_parameters.phiMax ) return false;
 	}
 	// Now check if the fucntion is being called from IntersectP,
 	// in which case the pointers tHit and dg are 0
@@ -159,23 +162,23 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 
 
 	// Find parametric representation of Cylinder hit
-	double u = phi / phiMax.getValue();
-	double v = hitPoint.z /length.getValue();
+	double u = phi / m_parameters.phiMax;
+	double v = hitPoint.z /m_parameters.length;
 
 	// Compute cylinder \dpdu and \dpdv
 	//double zradius = sqrt( hitPoint.x*hitPoint.x + hitPoint.y*hitPoint.y );
 	//double invzradius = 1.0 / zradius;
 
-	Vector3D dpdu( -phiMax.getValue() * radius.getValue() * sin ( phiMax.getValue() * u ),
-						phiMax.getValue() * radius.getValue() * cos( phiMax.getValue() * u ),
+	Vector3D dpdu( -m_parameters.phiMax * m_parameters.radius * sin ( m_parameters.phiMax * u ),
+						m_parameters.phiMax * m_parameters.radius * cos( m_parameters.phiMax * u ),
 						0.0 );
-	Vector3D dpdv( 0.0, 0.0, length.getValue() );
+	Vector3D dpdv( 0.0, 0.0, m_parameters.length );
 
 	// Compute cylinder \dndu and \dndv
-	Vector3D d2Pduu( -phiMax.getValue() * phiMax.getValue() * radius.getValue()
-							* cos( phiMax.getValue() * u ),
-						-phiMax.getValue() * phiMax.getValue() * radius.getValue()
-							* sin( phiMax.getValue() * u ),
+	Vector3D d2Pduu( -m_parameters.phiMax * m_parameters.phiMax * m_parameters.radius
+							* cos( m_parameters.phiMax * u ),
+						-m_parameters.phiMax * m_parameters.phiMax * m_parameters.radius
+							* sin( m_parameters.phiMax * u ),
 						0.0 );
 	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
 	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
@@ -217,11 +220,98 @@ bool ShapeCylinder::IntersectP( const Ray& worldRay ) const
 	return Intersect( worldRay, 0, 0 );
 }
 
+/*!
+ * Intersects the rays of \a objectRays selected in \a raysMask with the cylinder and stores the hit distances in \a tHits.
+ * Returns the mask of the rays that intersect the cylinder.
+ *
+ * The quadratic equations of all the rays are solved together and then each root is clipped as Intersect does.
+ */
+int ShapeCylinder::IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const
+{
+	// Compute quadratic cylinder coefficients
+	double A[RayPacket::Size];
+	double B[RayPacket::Size];
+	double C[RayPacket::Size];
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		A[i] = objectRays.directionX[i] * objectRays.directionX[i] + objectRays.directionY[i] * objectRays.directionY[i];
+		B[i] = 2.0 * ( objectRays.directionX[i] * objectRays.originX[i] + objectRays.directionY[i] * objectRays.originY[i] );
+		C[i] = objectRays.originX[i] * objectRays.originX[i] + objectRays.originY[i] * objectRays.originY[i] - m_parameters.squaredRadius;
+	}
+
+	// Solve quadratic equations for _t_ values
+	double t0[RayPacket::Size];
+	double t1[RayPacket::Size];
+	int hitMask = raysMask & gf::Quadratic( A, B, C, RayPacket::Size, t0, t1 );
+
+	//Evaluate Tolerance
+	double tol = 0.00001;
+	double zmin = 0.0;
+	double zmax = m_parameters.length;
+
+	// The angle is only computed for the cylinders that are not complete
+	bool clipPhi = ( m_parameters.phiMax < gc::TwoPi );
+
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		if( !( hitMask & ( 1 << i ) ) )	continue;
+		hitMask &= ~( 1 << i );
+
+		Ray objectRay = objectRays.GetRay( i );
+
+		// Compute intersection distance along ray
+		if( t0[i] > objectRay.maxt || t1[i] < objectRay.mint ) continue;
+		double thit = ( t0[i] > objectRay.mint )? t0[i] : t1[i] ;
+		if( thit > objectRay.maxt ) continue;
+
+		//Compute possible cylinder hit position and $\phi
+		Point3D hitPoint = objectRay( thit );
+		double phi = 0.0;
+		if( clipPhi )
+		{
+			phi = atan2( hitPoint.y, hitPoint.x );
+			if ( phi < 0. ) phi += gc::TwoPi;
+		}
+
+		// Test intersection against clipping parameters
+		if( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > m_parameters.phiMax )
+		{
+			if ( thit == t1[i] ) continue;
+			if ( t1[i] > objectRay.maxt ) continue;
+			thit = t1[i];
+
+			hitPoint = objectRay( thit );
+			if( clipPhi )
+			{
+				phi = atan2( hitPoint.y, hitPoint.x );
+				if ( phi < 0. ) phi += gc::TwoPi;
+			}
+			if ( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > m_parameters.phiMax ) continue;
+		}
+
+		tHits[i] = thit;
+		hitMask |= ( 1 << i );
+	}
+
+	return hitMask;
+}
+
 Point3D ShapeCylinder::Sample( double u, double v ) const
 {
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the cylinder fields used by Intersect and IntersectPacket.
+ */
+void ShapeCylinder::CompileParameters()
+{
+	m_parameters.radius = radius.getValue();
+	m_parameters.squaredRadius = m_parameters.radius * m_parameters.radius;
+	m_parameters.length = length.getValue();
+	m_parameters.phiMax = phiMax.getValue();
+}
+
 bool ShapeCylinder::OutOfRange( double u, double v ) const
 {
 	return ( ( u < 0.0 ) || ( u > 1.0 ) || ( v < 0.0 ) || ( v > 1.0 ) );
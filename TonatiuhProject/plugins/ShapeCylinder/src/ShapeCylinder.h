@@ -61,8 +61,10 @@ public:
 
 	bool Intersect( const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
 	bool IntersectP( const Ray &ray ) const;
+	int IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 
 	enum Side{
@@ -83,6 +85,18 @@ protected:
 	void generatePrimitives(SoAction *action);
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	virtual ~ShapeCylinder();
+
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double radius;
+		double squaredRadius;
+		double length;
+		double phiMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPECYLINDER_H_*/
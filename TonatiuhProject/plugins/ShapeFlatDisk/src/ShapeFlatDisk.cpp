@@ -68,6 +68,8 @@ ShapeFlatDisk::ShapeFlatDisk( )
 	SO_NODE_DEFINE_ENUM_VALUE( Side, BACK );
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (FRONT) );
+
+	CompileParameters();
 }
 
 ShapeFlatDisk::~ShapeFlatDisk()
@@ -112,7 +114,7 @@ bool ShapeFlatDisk::Intersect(const Ray& objectRay, double *tHit, DifferentialGe
     Point3D hitPoint = objectRay( t );
 
 	// Test intersection against clipping parameters
-	if( sqrt(hitPoint.x*hitPoint.x + hitPoint.z*hitPoint.z) > radius.getValue()) return false;
+	if( sqrt(hitPoint.x*hitPoint.x + hitPoint.z*hitPoint.z) > m_parameters.radius) return false;
 
 	// Now check if the fucntion is being called from IntersectP,
 	// in which case the pointers tHit and dg are 0
@@ -125,11 +127,11 @@ bool ShapeFlatDisk::Intersect(const Ray& objectRay, double *tHit, DifferentialGe
 	double iradius = sqrt( hitPoint.x*hitPoint.x + hitPoint.z*hitPoint.z );
 
 	double u = phi/gc::TwoPi;
-	double v = iradius/radius.getValue();
+	double v = iradius/m_parameters.radius;
 
 	// Compute rectangle \dpdu and \dpdv
-	Vector3D dpdu ( -v * radius.getValue() * sin( u * gc::TwoPi ) * gc::TwoPi, 0.0, v * radius.getValue() * cos( u * gc::TwoPi ) * gc::TwoPi );
-	Vector3D dpdv ( radius.getValue()* cos( u * gc::TwoPi ), 0.0,  radius.getValue() * sin( u * gc::TwoPi ) );
+	Vector3D dpdu ( -v * m_parameters.radius * sin( u * gc::TwoPi ) * gc::TwoPi, 0.0, v * m_parameters.radius * cos( u * gc::TwoPi ) * gc::TwoPi );
+	Vector3D dpdv ( m_parameters.radius* cos( u * gc::TwoPi ), 0.0,  m_parameters.radius * sin( u * gc::TwoPi ) );
 
 	NormalVector N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
@@ -166,6 +168,14 @@ Point3D ShapeFlatDisk::Sample( double u, double v ) const
 	//return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the disk radius used by Intersect.
+ */
+void ShapeFlatDisk::CompileParameters()
+{
+	m_parameters.radius = radius.getValue();
+}
+
 Point3D ShapeFlatDisk::GetPoint3D (double u, double v) const
 {
 	if (OutOfRange( u, v ) ) gf::SevereError("Function ShapeFlatDisk::GetPoint3D called with invalid parameters" );
@@ -62,6 +62,7 @@ public:
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	enum Side{
 		FRONT = 0,
@@ -79,6 +80,15 @@ protected:
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	void generatePrimitives(SoAction *action);
 	~ShapeFlatDisk();
+
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double radius;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPEFLATDISK_H_*/
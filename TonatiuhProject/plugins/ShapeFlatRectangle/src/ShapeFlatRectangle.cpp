@@ -36,6 +36,10 @@ Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimen
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include <QString>
 
 #include <Inventor/SoPrimitiveVertex.h>
@@ -47,7 +51,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include "BBox.h"
 #include "DifferentialGeometry.h"
+#include "InstancedShape.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "ShapeFlatRectangle.h"
 #include "Vector3D.h"
 
@@ -69,6 +75,8 @@ ShapeFlatRectangle::ShapeFlatRectangle( )
 	SO_NODE_DEFINE_ENUM_VALUE( Side, BACK );
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (FRONT) );
+
+	CompileParameters();
 }
 
 ShapeFlatRectangle::~ShapeFlatRectangle()
@@ -114,7 +122,7 @@ bool ShapeFlatRectangle::Intersect(const Ray& objectRay, double *tHit, Different
     Point3D hitPoint = objectRay( t );
 
 	// Test intersection against clipping parameters
-	if( hitPoint.x < -height.getValue()/2 || hitPoint.x > height.getValue()/2 || hitPoint.z < -width.getValue()/2 || hitPoint.z > width.getValue()/2 ) return false;
+	if( hitPoint.x < -m_parameters.halfHeight || hitPoint.x > m_parameters.halfHeight || hitPoint.z < -m_parameters.halfWidth || hitPoint.z > m_parameters.halfWidth ) return false;
 
 	// Now check if the fucntion is being called from IntersectP,
 	// in which case the pointers tHit and dg are 0
@@ -123,12 +131,12 @@ bool ShapeFlatRectangle::Intersect(const Ray& objectRay, double *tHit, Different
 
 
 	// Find parametric representation of the rectangle hit point
-	double u = ( hitPoint.x + height.getValue()/2 ) / ( height.getValue() );
-	double v = ( hitPoint.z + width.getValue()/2 ) / ( width.getValue() );
+	double u = ( hitPoint.x + m_parameters.halfHeight ) / ( m_parameters.height );
+	double v = ( hitPoint.z + m_parameters.halfWidth ) / ( m_parameters.width );
 
 	// Compute rectangle \dpdu and \dpdv
-	Vector3D dpdu ( 0.0, 0.0, height.getValue() );
-	Vector3D dpdv ( width.getValue(), 0.0, 0.0 );
+	Vector3D dpdu ( 0.0, 0.0, m_parameters.height );
+	Vector3D dpdv ( m_parameters.width, 0.0, 0.0 );
 
 	NormalVector N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
@@ -156,11 +164,91 @@ bool ShapeFlatRectangle::IntersectP( const Ray& objectRay ) const
 	return Intersect( objectRay, 0, 0 );
 }
 
+/*!
+ * Intersects the rays of \a objectRays selected in \a raysMask with the rectangle and stores the hit distances in \a tHits.
+ * Returns the mask of the rays that intersect the rectangle. The tests are the same as Intersect ones.
+ */
+int ShapeFlatRectangle::IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const
+{
+	double halfHeight = m_parameters.halfHeight;
+	double halfWidth = m_parameters.halfWidth;
+	double tol = 0.00001;
+
+	int hitMask = 0;
+
+#ifdef __AVX2__
+	for( int i = 0; i < RayPacket::Size; i += 4 )
+	{
+		// Solve equation for _t_ value. The rays parallel to the plane have a NaN or infinite t.
+		__m256d t = _mm256_mul_pd( _mm256_sub_pd( _mm256_setzero_pd(), _mm256_loadu_pd( objectRays.originY + i ) ),
+				_mm256_loadu_pd( objectRays.invDirectionY + i ) );
+
+		// Compute intersection distance along ray and evaluate tolerance
+		__m256d hit = _mm256_and_pd( _mm256_cmp_pd( t, _mm256_loadu_pd( objectRays.maxt + i ), _CMP_LE_OQ ),
+				_mm256_cmp_pd( _mm256_sub_pd( t, _mm256_loadu_pd( objectRays.mint + i ) ), _mm256_set1_pd( tol ), _CMP_GE_OQ ) );
+
+		// Test intersection against clipping parameters
+		__m256d x = _mm256_add_pd( _mm256_loadu_pd( objectRays.originX + i ), _mm256_mul_pd( t, _mm256_loadu_pd( objectRays.directionX + i ) ) );
+		__m256d z = _mm256_add_pd( _mm256_loadu_pd( objectRays.originZ + i ), _mm256_mul_pd( t, _mm256_loadu_pd( objectRays.directionZ + i ) ) );
+		hit = _mm256_and_pd( hit, _mm256_cmp_pd( x, _mm256_set1_pd( -halfHeight ), _CMP_GE_OQ ) );
+		hit = _mm256_and_pd( hit, _mm256_cmp_pd( x, _mm256_set1_pd( halfHeight ), _CMP_LE_OQ ) );
+		hit = _mm256_and_pd( hit, _mm256_cmp_pd( z, _mm256_set1_pd( -halfWidth ), _CMP_GE_OQ ) );
+		hit = _mm256_and_pd( hit, _mm256_cmp_pd( z, _mm256_set1_pd( halfWidth ), _CMP_LE_OQ ) );
+
+		_mm256_storeu_pd( tHits + i, t );
+		hitMask |= _mm256_movemask_pd( hit ) << i;
+	}
+#else
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		// Solve equation for _t_ value
+		if( ( objectRays.originY[i] == 0 ) && ( objectRays.directionY[i] == 0 ) ) continue;
+		double t = -objectRays.originY[i] * objectRays.invDirectionY[i];
+
+		// Compute intersection distance along ray and evaluate tolerance
+		if( t > objectRays.maxt[i] || ( t - objectRays.mint[i] ) < tol ) continue;
+
+		// Test intersection against clipping parameters
+		double x = objectRays.originX[i] + t * objectRays.directionX[i];
+		double z = objectRays.originZ[i] + t * objectRays.directionZ[i];
+		if( x < -halfHeight || x > halfHeight || z < -halfWidth || z > halfWidth ) continue;
+
+		tHits[i] = t;
+		hitMask |= ( 1 << i );
+	}
+#endif
+
+	return hitMask & raysMask;
+}
+
 Point3D ShapeFlatRectangle::Sample( double u, double v ) const
 {
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the rectangle fields used by Intersect and IntersectPacket.
+ */
+void ShapeFlatRectangle::CompileParameters()
+{
+	m_parameters.width = width.getValue();
+	m_parameters.height = height.getValue();
+	m_parameters.halfWidth = 0.5 * m_parameters.width;
+	m_parameters.halfHeight = 0.5 * m_parameters.height;
+}
+
+/*!
+ * Returns the rectangle as an InstancedShape::FlatRectangle, the x and z half lengths are the Intersect clipping limits.
+ */
+bool ShapeFlatRectangle::GetInstancedShape( InstancedShape* instancedShape ) const
+{
+	instancedShape->type = InstancedShape::FlatRectangle;
+	instancedShape->parameters[0] = m_parameters.halfHeight;
+	instancedShape->parameters[1] = m_parameters.halfWidth;
+	instancedShape->parameters[2] = 0.0;
+	return true;
+}
+
 Point3D ShapeFlatRectangle::GetPoint3D (double u, double v) const
 {
 	if( OutOfRange( u, v ) ) 	gf::SevereError("Function ShapeFlatRectangle::GetPoint3D called with invalid parameters" );
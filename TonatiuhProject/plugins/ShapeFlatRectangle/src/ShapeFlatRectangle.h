@@ -60,8 +60,11 @@ public:
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
 	bool IntersectP( const Ray &ray ) const;
+	int IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
+	bool GetInstancedShape( InstancedShape* instancedShape ) const;
 
 	enum Side{
 		FRONT = 0,
@@ -81,6 +84,17 @@ protected:
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	~ShapeFlatRectangle();
 
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double width;
+		double height;
+		double halfWidth;
+		double halfHeight;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPEFLARRECTANGULE_H_*/
@@ -93,6 +93,8 @@ ShapeFlatTriangle::ShapeFlatTriangle(  )
 	m_lastValidA = a;
 	m_lastValidB = b;
 	m_lastValidC = c;
+
+	CompileParameters();
 }
 
 /**
@@ -139,11 +141,11 @@ QString ShapeFlatTriangle::GetIcon() const
 bool ShapeFlatTriangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
 
-	Vector3D vAB = Vector3D( b.getValue()[0], b.getValue()[1], b.getValue()[2] ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
-	Vector3D vAC = Vector3D( c.getValue()[0], c.getValue()[1], c.getValue()[2] ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
+	const Vector3D& vAB = m_parameters.vAB;
+	const Vector3D& vAC = m_parameters.vAC;
 
-	Vector3D vN = CrossProduct( vAB, vAC );
-	double d = -vN.x * a.getValue()[0] - vN.y * a.getValue()[1] - vN.z * a.getValue()[2];
+	const Vector3D& vN = m_parameters.vN;
+	double d = m_parameters.d;
 	//if( objectRay.direction.z ==0.0 ) return false;
 
 	double thit = (-d - vN.x * objectRay.origin.x - vN.y * objectRay.origin.y - vN.z * objectRay.origin.z )
@@ -161,13 +163,13 @@ bool ShapeFlatTriangle::Intersect( const Ray& objectRay, double* tHit, Different
 
 	// is hitPoint inside triangle?
 	//double uu, uv, vv, wu, wv, D;
-	double uu = DotProduct( vAB, vAB );
-	double uv = DotProduct( vAB, vAC );
-	double vv = DotProduct( vAC, vAC );
-	Vector3D  w = Vector3D( hitPoint ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
+	double uu = m_parameters.uu;
+	double uv = m_parameters.uv;
+	double vv = m_parameters.vv;
+	Vector3D  w = hitPoint - m_parameters.a;
 	double wu = DotProduct( w, vAB );
 	double wv = DotProduct( w, vAC );
-	double D = uv * uv - uu * vv;
+	double D = m_parameters.D;
 
 	// get and test parametric coords
 	double u = (uv * wv - vv * wu) / D;
@@ -234,6 +236,22 @@ Point3D ShapeFlatTriangle::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the triangle vertices used by Intersect, and the triangle plane and edges products derived from them.
+ */
+void ShapeFlatTriangle::CompileParameters()
+{
+	m_parameters.a = Point3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
+	m_parameters.vAB = Point3D( b.getValue()[0], b.getValue()[1], b.getValue()[2] ) - m_parameters.a;
+	m_parameters.vAC = Point3D( c.getValue()[0], c.getValue()[1], c.getValue()[2] ) - m_parameters.a;
+	m_parameters.vN = CrossProduct( m_parameters.vAB, m_parameters.vAC );
+	m_parameters.d = -DotProduct( m_parameters.vN, Vector3D( m_parameters.a ) );
+	m_parameters.uu = DotProduct( m_parameters.vAB, m_parameters.vAB );
+	m_parameters.uv = DotProduct( m_parameters.vAB, m_parameters.vAC );
+	m_parameters.vv = DotProduct( m_parameters.vAC, m_parameters.vAC );
+	m_parameters.D = m_parameters.uv * m_parameters.uv - m_parameters.uu * m_parameters.vv;
+}
+
 void ShapeFlatTriangle::updateA( void *data, SoSensor * )
 {
 	ShapeFlatTriangle* shapeFlatTriangle = (ShapeFlatTriangle *) data;
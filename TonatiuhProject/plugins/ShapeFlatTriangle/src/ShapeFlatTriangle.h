@@ -63,6 +63,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REALVECTOR3 a;
 	trt::TONATIUH_REALVECTOR3 b;
@@ -86,6 +87,22 @@ private:
 	trt::TONATIUH_REALVECTOR3 m_lastValidA;
 	trt::TONATIUH_REALVECTOR3 m_lastValidB;
 	trt::TONATIUH_REALVECTOR3 m_lastValidC;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		Point3D a;
+		Vector3D vAB;
+		Vector3D vAC;
+		Vector3D vN;
+		double d;
+		double uu;
+		double uv;
+		double vv;
+		double D;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /* SHAPEFLATTRIANGLE_H_ */
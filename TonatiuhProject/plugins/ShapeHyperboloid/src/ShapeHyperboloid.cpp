@@ -70,6 +70,8 @@ ShapeHyperboloid::ShapeHyperboloid( )
 	SO_NODE_DEFINE_ENUM_VALUE( Side, OUTSIDE );
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (OUTSIDE) );
+
+	CompileParameters();
 }
 
 ShapeHyperboloid::~ShapeHyperboloid()
@@ -124,9 +126,8 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 	double yd= objectRay.direction().y;
 	double zd= objectRay.direction().z;
 
-	double cConic = fabs( distanceTwoFocus.getValue() /2 );
-	double aConic = cConic - focusLegth.getValue();
-	double bConic = sqrt( fabs( cConic * cConic - aConic * aConic ) );
+	double aConic = m_parameters.aConic;
+	double bConic = m_parameters.bConic;
 
 	double A =  ( bConic * bConic * yd * yd  - aConic * aConic * (xd * xd  + zd * zd ) );
 	double B = 2 * (aConic  * bConic * bConic * yd + bConic * bConic * yd * yo - aConic * aConic * (xd * xo + zd * zo ) );
@@ -149,10 +150,8 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 
 	if( (thit - objectRay.mint) < tol ) return false;
 
-	double r = reflectorMaxDiameter.getValue() / 2;
-	double ymax = -aConic + ( sqrt( aConic * aConic * bConic * bConic
-											*  ( bConic * bConic + r * r) )
-								/ ( bConic * bConic ) );
+	double r = m_parameters.reflectorMaxRadius;
+	double ymax = m_parameters.yMax;
 
 
 	double ymin  = 0.0;
@@ -175,7 +174,7 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
 
 	// Find parametric representation of hyperbola hit
-	double u = yradius / ( reflectorMaxDiameter.getValue() / 2 );
+	double u = yradius / r;
 	double phi = atan2( hitPoint.z , hitPoint.x );
 	if( phi < 0.0 ) phi = phi + gc::TwoPi;
 	double v = phi / gc::TwoPi;
@@ -186,17 +185,17 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 
 	// Compute cylinder \dndu and \dndv
 	Vector3D d2Pduu( 0.0,
-					(2 * pow( aConic, 4) * pow( bConic, 4 ) *  reflectorMaxDiameter.getValue() *  reflectorMaxDiameter.getValue() )
+					(2 * pow( aConic, 4) * pow( bConic, 4 ) *  m_parameters.reflectorMaxDiameter *  m_parameters.reflectorMaxDiameter )
 					/ ( pow( aConic, 2 )* pow( bConic, 2)
-							* pow( 4 *  bConic * bConic + reflectorMaxDiameter.getValue() * reflectorMaxDiameter.getValue() * u * u , 3 / 2.0 ) ),
+							* pow( 4 *  bConic * bConic + m_parameters.reflectorMaxDiameter * m_parameters.reflectorMaxDiameter * u * u , 3 / 2.0 ) ),
 					0.0 );
 
-	Vector3D d2Pduv( - reflectorMaxDiameter.getValue() *gc::Pi * sin( gc::TwoPi * v ),
+	Vector3D d2Pduv( - m_parameters.reflectorMaxDiameter *gc::Pi * sin( gc::TwoPi * v ),
 					0.0,
-					reflectorMaxDiameter.getValue() *gc::Pi * cos( gc::TwoPi * v ) );
-	Vector3D d2Pdvv( -2.0 * reflectorMaxDiameter.getValue() * gc::Pi * gc::Pi * u * cos( gc::TwoPi * v),
+					m_parameters.reflectorMaxDiameter *gc::Pi * cos( gc::TwoPi * v ) );
+	Vector3D d2Pdvv( -2.0 * m_parameters.reflectorMaxDiameter * gc::Pi * gc::Pi * u * cos( gc::TwoPi * v),
 					0.0,
-					-2.0 * reflectorMaxDiameter.getValue() * gc::Pi * gc::Pi * u * sin( gc::TwoPi * v ) );
+					-2.0 * m_parameters.reflectorMaxDiameter * gc::Pi * gc::Pi * u * sin( gc::TwoPi * v ) );
 
 	// Compute coefficients for fundamental forms
 	double E = DotProduct( dpdu, dpdu );
@@ -242,6 +241,25 @@ Point3D ShapeHyperboloid::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the hyperboloid fields used by Intersect, and the conic coefficients and height derived from them.
+ */
+void ShapeHyperboloid::CompileParameters()
+{
+	double cConic = fabs( distanceTwoFocus.getValue() /2 );
+	double aConic = cConic - focusLegth.getValue();
+	double bConic = sqrt( fabs( cConic * cConic - aConic * aConic ) );
+	double r = reflectorMaxDiameter.getValue() / 2;
+
+	m_parameters.reflectorMaxDiameter = reflectorMaxDiameter.getValue();
+	m_parameters.reflectorMaxRadius = r;
+	m_parameters.aConic = aConic;
+	m_parameters.bConic = bConic;
+	m_parameters.yMax = -aConic + ( sqrt( aConic * aConic * bConic * bConic
+											*  ( bConic * bConic + r * r) )
+								/ ( bConic * bConic ) );
+}
+
 bool ShapeHyperboloid::OutOfRange( double u, double v ) const
 {
 	return ( ( u < 0.0 ) || ( u > 1.0 ) || ( v < 0.0 ) || ( v > 1.0 ) );
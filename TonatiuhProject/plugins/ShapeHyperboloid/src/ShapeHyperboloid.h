@@ -71,6 +71,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL focusLegth;
 	trt::TONATIUH_REAL distanceTwoFocus;
@@ -91,6 +92,18 @@ protected:
 private:
 	Vector3D Dpdu( double u, double v ) const;
 	Vector3D Dpdv( double u, double v ) const;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double reflectorMaxDiameter;
+		double reflectorMaxRadius;
+		double aConic;
+		double bConic;
+		double yMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /* ShapeHyperboloid_H_ */
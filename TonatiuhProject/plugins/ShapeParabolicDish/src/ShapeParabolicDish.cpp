@@ -81,6 +81,8 @@ ShapeParabolicDish::ShapeParabolicDish()
 	SoFieldSensor* dishMaxRadiusSensor = new SoFieldSensor( updateMaxRadius, this );
 	dishMaxRadiusSensor->setPriority( 1 );
 	dishMaxRadiusSensor->attach( &dishMaxRadius );
+
+	CompileParameters();
 }
 
 ShapeParabolicDish::~ShapeParabolicDish()
@@ -122,10 +124,10 @@ QString ShapeParabolicDish::GetIcon() const
 
 bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg) const
 {
-	double pMax = phiMax.getValue();
+	double pMax = m_parameters.phiMax;
 	double A = objectRay.direction().x*objectRay.direction().x + objectRay.direction().z * objectRay.direction().z;
-    double B = 2.0 * ( objectRay.direction().x* objectRay.origin.x + objectRay.direction().z * objectRay.origin.z - 2 * focusLength.getValue() * objectRay.direction().y );
-	double C = objectRay.origin.x * objectRay.origin.x + objectRay.origin.z * objectRay.origin.z - 4 * focusLength.getValue() * objectRay.origin.y;
+    double B = 2.0 * ( objectRay.direction().x* objectRay.origin.x + objectRay.direction().z * objectRay.origin.z - 2 * m_parameters.focusLength * objectRay.direction().y );
+	double C = objectRay.origin.x * objectRay.origin.x + objectRay.origin.z * objectRay.origin.z - 4 * m_parameters.focusLength * objectRay.origin.y;
 
 
 	// Solve quadratic equation for _t_ values
@@ -150,7 +152,7 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
     else phi = gc::TwoPi + atan2( hitPoint.x, hitPoint.z );
 
     // Test intersection against clipping parameters
-	if( (thit - objectRay.mint) < tol ||  radius < dishMinRadius.getValue() || radius > dishMaxRadius.getValue() || phi > pMax )
+	if( (thit - objectRay.mint) < tol ||  radius < m_parameters.dishMinRadius || radius > m_parameters.dishMaxRadius || phi > pMax )
 		{
 			if ( thit == t1 ) return false;
 			if ( t1 > objectRay.maxt ) return false;
@@ -162,7 +164,7 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
 		    else if( hitPoint.x > 0 ) phi = atan2( hitPoint.x, hitPoint.z );
 		    else phi = gc::TwoPi + atan2( hitPoint.x, hitPoint.z );
 
-			if( (thit - objectRay.mint) < tol ||  radius < dishMinRadius.getValue() || radius > dishMaxRadius.getValue() || phi > pMax ) return false;
+			if( (thit - objectRay.mint) < tol ||  radius < m_parameters.dishMinRadius || radius > m_parameters.dishMaxRadius || phi > pMax ) return false;
 		}
 
 	// Now check if the function is being called from IntersectP,
@@ -174,28 +176,28 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
 
 	// Find parametric representation of paraboloid hit
 	double u = phi / pMax;
-	double v = ( radius - dishMinRadius.getValue() )  /( dishMaxRadius.getValue() - dishMinRadius.getValue() );
+	double v = ( radius - m_parameters.dishMinRadius )  /m_parameters.radiusLength;
 
 	// Compute Circular Parabolic Facet \dpdu and \dpdv
-	double r = v * ( dishMaxRadius.getValue() - dishMinRadius.getValue() ) + dishMinRadius.getValue();
+	double r = v * m_parameters.radiusLength + m_parameters.dishMinRadius;
 	Vector3D dpdu( pMax * r * cos( pMax * u ),
 					0,
 					-pMax * r * sin( pMax * u ) );
 
-	Vector3D dpdv( ( dishMaxRadius.getValue() - dishMinRadius.getValue() )  * sin( pMax * u ),
-				   ( ( dishMaxRadius.getValue() - dishMinRadius.getValue() ) * r  )
-							   / ( 2 * focusLength.getValue() ),
-					( dishMaxRadius.getValue() - dishMinRadius.getValue() ) * cos( pMax * u ) );
+	Vector3D dpdv( m_parameters.radiusLength  * sin( pMax * u ),
+				   ( m_parameters.radiusLength * r  )
+							   / ( 2 * m_parameters.focusLength ),
+					m_parameters.radiusLength * cos( pMax * u ) );
 
 
 	// Compute Circular Parabolic Facet \dndu and \dndv
 	Vector3D d2Pduu ( -pMax * pMax * r * sin( pMax * u ),
 			0.0,
 			-pMax* pMax * r * cos( pMax * u ) );
-	Vector3D d2Pduv ( pMax* ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * cos( pMax * u ),
+	Vector3D d2Pduv ( pMax* m_parameters.radiusLength * cos( pMax * u ),
 					0.0,
-					-pMax * ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * sin( pMax * u ) );
-	Vector3D d2Pdvv (0, ( ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) ) /(2 * focusLength.getValue() ), 0 );
+					-pMax * m_parameters.radiusLength * sin( pMax * u ) );
+	Vector3D d2Pdvv (0, ( m_parameters.radiusLength * m_parameters.radiusLength ) /(2 * m_parameters.focusLength ), 0 );
 
 
 	// Compute coefficients for fundamental forms
@@ -244,6 +246,18 @@ Point3D ShapeParabolicDish::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the dish fields used by Intersect.
+ */
+void ShapeParabolicDish::CompileParameters()
+{
+	m_parameters.focusLength = focusLength.getValue();
+	m_parameters.dishMinRadius = dishMinRadius.getValue();
+	m_parameters.dishMaxRadius = dishMaxRadius.getValue();
+	m_parameters.phiMax = phiMax.getValue();
+	m_parameters.radiusLength = m_parameters.dishMaxRadius - m_parameters.dishMinRadius;
+}
+
 Point3D ShapeParabolicDish::GetPoint3D (double u, double v) const
 {
 
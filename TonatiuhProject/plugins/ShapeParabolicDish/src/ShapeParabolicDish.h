@@ -70,6 +70,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL focusLength;
 	trt::TONATIUH_REAL dishMinRadius;
@@ -90,8 +91,19 @@ protected:
 	static void updateMaxRadius( void* data, SoSensor* );
 
 private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double focusLength;
+		double dishMinRadius;
+		double dishMaxRadius;
+		double phiMax;
+		double radiusLength;
+	};
+
 	double m_lastMaxRadius;
 	double m_lastMinRadius;
+	Parameters m_parameters;
 };
 
 #endif /*SHAPEPARABOLICDISH_H_*/
@@ -49,7 +49,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include "BBox.h"
 #include "DifferentialGeometry.h"
+#include "InstancedShape.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "ShapeParabolicRectangle.h"
 #include "Vector3D.h"
 
@@ -72,6 +74,8 @@ ShapeParabolicRectangle::ShapeParabolicRectangle()
 	SO_NODE_DEFINE_ENUM_VALUE( Side, OUTSIDE );
 	SO_NODE_SET_SF_ENUM_TYPE( activeSide, Side );
 	SO_NODE_ADD_FIELD( activeSide, (OUTSIDE) );
+
+	CompileParameters();
 }
 
 ShapeParabolicRectangle::~ShapeParabolicRectangle()
@@ -106,9 +110,9 @@ QString ShapeParabolicRectangle::GetIcon() const
 
 bool ShapeParabolicRectangle::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
 {
-	double focus = focusLength.getValue();
-	double wX = widthX.getValue();
-	double wZ = widthZ.getValue();
+	double focus = m_parameters.focusLength;
+	double wX = m_parameters.widthX;
+	double wZ = m_parameters.widthZ;
 
 	// Compute quadratic coefficients
 	double A = objectRay.direction().x * objectRay.direction().x + objectRay.direction().z * objectRay.direction().z;
@@ -205,11 +209,98 @@ bool ShapeParabolicRectangle::IntersectP( const Ray& objectRay ) const
 	return Intersect( objectRay, 0, 0 );
 }
 
+/*!
+ * Intersects the rays of \a objectRays selected in \a raysMask with the parabolic surface and stores the hit distances in \a tHits.
+ * Returns the mask of the rays that intersect the surface.
+ *
+ * The quadratic equations of all the rays are solved together and then each root is clipped as Intersect does.
+ */
+int ShapeParabolicRectangle::IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const
+{
+	double focus = m_parameters.focusLength;
+	double wX = m_parameters.widthX;
+	double wZ = m_parameters.widthZ;
+
+	// Compute quadratic coefficients
+	double A[RayPacket::Size];
+	double B[RayPacket::Size];
+	double C[RayPacket::Size];
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		A[i] = objectRays.directionX[i] * objectRays.directionX[i] + objectRays.directionZ[i] * objectRays.directionZ[i];
+		B[i] = 2.0 * ( objectRays.directionX[i] * objectRays.originX[i] + objectRays.directionZ[i] * objectRays.originZ[i] - 2 * focus * objectRays.directionY[i] );
+		C[i] = objectRays.originX[i] * objectRays.originX[i] + objectRays.originZ[i] * objectRays.originZ[i] - 4 * focus * objectRays.originY[i];
+	}
+
+	// Solve quadratic equations for _t_ values
+	double t0[RayPacket::Size];
+	double t1[RayPacket::Size];
+	int hitMask = raysMask & gf::Quadratic( A, B, C, RayPacket::Size, t0, t1 );
+
+	//Evaluate Tolerance
+	double tol = 0.00001;
+
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		if( !( hitMask & ( 1 << i ) ) )	continue;
+		hitMask &= ~( 1 << i );
+
+		double mint = objectRays.mint[i];
+		double maxt = objectRays.maxt[i];
+
+		// Compute intersection distance along ray
+		if( t0[i] > maxt || t1[i] < mint ) continue;
+		double thit = ( t0[i] > mint )? t0[i] : t1[i] ;
+		if( thit > maxt ) continue;
+
+		// Test intersection against clipping parameters
+		double x = objectRays.originX[i] + thit * objectRays.directionX[i];
+		double z = objectRays.originZ[i] + thit * objectRays.directionZ[i];
+		if( (thit - mint) < tol ||  x < ( - wX / 2 ) || x > ( wX / 2 ) || z < ( - wZ / 2 ) || z > ( wZ / 2 ) )
+		{
+			if ( thit == t1[i] ) continue;
+			if ( t1[i] > maxt ) continue;
+			thit = t1[i];
+
+			x = objectRays.originX[i] + thit * objectRays.directionX[i];
+			z = objectRays.originZ[i] + thit * objectRays.directionZ[i];
+			if( (thit - mint) < tol ||  x < ( - wX / 2 ) || x > ( wX / 2 ) || z < ( - wZ / 2 ) || z > ( wZ / 2 ) )	continue;
+		}
+
+		tHits[i] = thit;
+		hitMask |= ( 1 << i );
+	}
+
+	return hitMask;
+}
+
 Point3D ShapeParabolicRectangle::Sample( double u, double v ) const
 {
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the parabolic rectangle fields used by Intersect and IntersectPacket.
+ */
+void ShapeParabolicRectangle::CompileParameters()
+{
+	m_parameters.focusLength = focusLength.getValue();
+	m_parameters.widthX = widthX.getValue();
+	m_parameters.widthZ = widthZ.getValue();
+}
+
+/*!
+ * Returns the surface as an InstancedShape::ParabolicRectangle with the compiled focus length and widths.
+ */
+bool ShapeParabolicRectangle::GetInstancedShape( InstancedShape* instancedShape ) const
+{
+	instancedShape->type = InstancedShape::ParabolicRectangle;
+	instancedShape->parameters[0] = m_parameters.focusLength;
+	instancedShape->parameters[1] = m_parameters.widthX;
+	instancedShape->parameters[2] = m_parameters.widthZ;
+	return true;
+}
+
 bool ShapeParabolicRectangle::OutOfRange( double u, double v ) const
 {
 	return ( ( u < 0.0 ) || ( u > 1.0 ) || ( v < 0.0 ) || ( v > 1.0 ) );
@@ -66,8 +66,11 @@ public:
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
 	bool IntersectP( const Ray &ray ) const;
+	int IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
+	bool GetInstancedShape( InstancedShape* instancedShape ) const;
 
 	trt::TONATIUH_REAL focusLength;
 	trt::TONATIUH_REAL widthX;
@@ -82,6 +85,17 @@ protected:
 	void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
 	void generatePrimitives(SoAction *action);
    	~ShapeParabolicRectangle();
+
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double focusLength;
+		double widthX;
+		double widthZ;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*RECTANGULARPARABOLICFACET_H_*/
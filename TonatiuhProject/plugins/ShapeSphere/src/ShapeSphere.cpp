@@ -95,6 +95,8 @@ ShapeSphere::ShapeSphere( )
 	SoFieldSensor* m_phiMaxSensor = new SoFieldSensor(updatePhiMax, this);
 	m_phiMaxSensor->setPriority( 1 );
 	m_phiMaxSensor->attach( &phiMax );
+
+	CompileParameters();
 }
 
 ShapeSphere::~ShapeSphere()
@@ -162,6 +164,20 @@ Point3D ShapeSphere::Sample( double u1, double u2 ) const
 	return GetPoint3D( u1, u2 );
 }
 
+/*!
+ * Copies the sphere fields used by Intersect and the polar angles limits derived from them.
+ */
+void ShapeSphere::CompileParameters()
+{
+	m_parameters.radius = radius.getValue();
+	m_parameters.squaredRadius = m_parameters.radius * m_parameters.radius;
+	m_parameters.yMin = yMin.getValue();
+	m_parameters.yMax = yMax.getValue();
+	m_parameters.phiMax = phiMax.getValue();
+	m_parameters.thetaMin = acos( m_parameters.yMax / m_parameters.radius );
+	m_parameters.thetaMax = acos( m_parameters.yMin / m_parameters.radius );
+}
+
 bool ShapeSphere::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
 
@@ -169,7 +185,7 @@ bool ShapeSphere::Intersect( const Ray& objectRay, double* tHit, DifferentialGeo
 	Vector3D vObjectRayOrigin = Vector3D( objectRay.origin );
 	double A = objectRay.direction().lengthSquared();
     double B = 2.0 * DotProduct( vObjectRayOrigin, objectRay.direction() );
-	double C = vObjectRayOrigin.lengthSquared() - radius.getValue() * radius.getValue();
+	double C = vObjectRayOrigin.lengthSquared() - m_parameters.squaredRadius;
 
 	// Solve quadratic equation for _t_ values
 	double t0, t1;
@@ -189,7 +205,7 @@ bool ShapeSphere::Intersect( const Ray& objectRay, double* tHit, DifferentialGeo
 	if ( phi < 0. ) phi += gc::TwoPi;
 
 	// Test intersection against clipping parameters
-	if( (thit - objectRay.mint) < tol || hitPoint.y < yMin.getValue() || hitPoint.y > yMax.getValue() || phi > phiMax.getValue() )
+	if( (thit - objectRay.mint) < tol || hitPoint.y < m_parameters.yMin || hitPoint.y > m_parameters.yMax || phi > m_parameters.phiMax )
 	{
 		if ( thit == t1 ) return false;
 		if ( t1 > objectRay.maxt ) return false;
@@ -200,7 +216,7 @@ bool ShapeSphere::Intersect( const Ray& objectRay, double* tHit, DifferentialGeo
 		phi = atan2( hitPoint.x, hitPoint.z );
 	    if ( phi < 0. ) phi += gc::TwoPi;
 
-		if ( (thit - objectRay.mint) < tol || hitPoint.y < yMin.getValue() || hitPoint.y > yMax.getValue() || phi > phiMax.getValue() )	return false;
+		if ( (thit - objectRay.mint) < tol || hitPoint.y < m_parameters.yMin || hitPoint.y > m_parameters.yMax || phi > m_parameters.phiMax )	return false;
 	}
 	// Now check if the fucntion is being called from IntersectP,
 	// in which case the pointers tHit and dg are 0
@@ -208,33 +224,33 @@ bool ShapeSphere::Intersect( const Ray& objectRay, double* tHit, DifferentialGeo
 	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeSphere::Intersect(...) called with null pointers" );
 
 	// Find parametric representation of ShapeSphere hit
-	double theta = acos( hitPoint.y / radius.getValue() );
-	double thetaMin = acos( yMax.getValue() / radius.getValue() );
-	double thetaMax = acos( yMin.getValue()/radius.getValue() );
+	double theta = acos( hitPoint.y / m_parameters.radius );
+	double thetaMin = m_parameters.thetaMin;
+	double thetaMax = m_parameters.thetaMax;
 	double u = ( theta - thetaMin ) / ( thetaMax - thetaMin );
-	double v = phi / phiMax.getValue();
+	double v = phi / m_parameters.phiMax;
 
 	// Compute ShapeSphere \dpdu and \dpdv
-	Vector3D dpdu( radius.getValue() * ( -thetaMin + thetaMax ) * cos( ( -1 + u ) * thetaMin - u * thetaMax ) * sin( phiMax.getValue() * v ),
-					radius.getValue() * ( -thetaMin + thetaMax ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ),
-					radius.getValue() * ( -thetaMin + thetaMax ) * cos( phiMax.getValue() * v ) * cos( ( -1 + u ) * thetaMin - u * thetaMax ) );
+	Vector3D dpdu( m_parameters.radius * ( -thetaMin + thetaMax ) * cos( ( -1 + u ) * thetaMin - u * thetaMax ) * sin( m_parameters.phiMax * v ),
+					m_parameters.radius * ( -thetaMin + thetaMax ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ),
+					m_parameters.radius * ( -thetaMin + thetaMax ) * cos( m_parameters.phiMax * v ) * cos( ( -1 + u ) * thetaMin - u * thetaMax ) );
 
-	Vector3D dpdv( -phiMax.getValue() * radius.getValue() * cos( phiMax.getValue() * v ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ),
+	Vector3D dpdv( -m_parameters.phiMax * m_parameters.radius * cos( m_parameters.phiMax * v ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ),
 					0.0,
-					phiMax.getValue() * radius.getValue() * sin( phiMax.getValue() * v ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ) );
+					m_parameters.phiMax * m_parameters.radius * sin( m_parameters.phiMax * v ) * sin( ( -1 + u ) * thetaMin - u * thetaMax ) );
 
 	// Compute ShapeSphere \dndu and \dndv
-	Vector3D d2Pduu(  -radius.getValue() * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * sin( phiMax.getValue() * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ),
-					radius.getValue() * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * cos( (-1 + u) * thetaMin - u * thetaMax ),
-					-radius.getValue() * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * cos( phiMax.getValue() * v ) * sin( (-1 + u) * thetaMin -u * thetaMax )  );
+	Vector3D d2Pduu(  -m_parameters.radius * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * sin( m_parameters.phiMax * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ),
+					m_parameters.radius * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * cos( (-1 + u) * thetaMin - u * thetaMax ),
+					-m_parameters.radius * ( thetaMin - thetaMax ) * ( -thetaMin + thetaMax ) * cos( m_parameters.phiMax * v ) * sin( (-1 + u) * thetaMin -u * thetaMax )  );
 
-	Vector3D d2Pduv( phiMax.getValue() * radius.getValue() * ( -thetaMin + thetaMax ) * cos( phiMax.getValue() * v ) * cos( (-1 + u ) * thetaMin - u  * thetaMax ),
+	Vector3D d2Pduv( m_parameters.phiMax * m_parameters.radius * ( -thetaMin + thetaMax ) * cos( m_parameters.phiMax * v ) * cos( (-1 + u ) * thetaMin - u  * thetaMax ),
 					0.0,
-					-phiMax.getValue() * radius.getValue() * ( -thetaMin + thetaMax ) * cos( (-1 + u ) * thetaMin - u  * thetaMax ) * sin( phiMax.getValue() * v ) );
+					-m_parameters.phiMax * m_parameters.radius * ( -thetaMin + thetaMax ) * cos( (-1 + u ) * thetaMin - u  * thetaMax ) * sin( m_parameters.phiMax * v ) );
 
-	Vector3D d2Pdvv( phiMax.getValue() * phiMax.getValue() * radius.getValue() * sin( phiMax.getValue() * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ),
+	Vector3D d2Pdvv( m_parameters.phiMax * m_parameters.phiMax * m_parameters.radius * sin( m_parameters.phiMax * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ),
 					0.0,
-					phiMax.getValue() * phiMax.getValue() *  radius.getValue() * cos( phiMax.getValue() * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ) );
+					m_parameters.phiMax * m_parameters.phiMax *  m_parameters.radius * cos( m_parameters.phiMax * v ) * sin( (-1 + u) * thetaMin - u * thetaMax ) );
 
 	// Compute coefficients for fundamental forms
 	double E = DotProduct( dpdu, dpdu );
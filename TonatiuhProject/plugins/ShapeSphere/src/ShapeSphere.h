@@ -68,6 +68,7 @@ public:
     QString GetIcon() const;
 
     Point3D Sample( double u1, double u2 ) const;
+    void CompileParameters();
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
 	bool IntersectP( const Ray &ray ) const;
@@ -102,6 +103,19 @@ private:
 	SoFieldSensor* m_yMaxSensor;
 	SoFieldSensor* m_phiMaxSensor;
 
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double radius;
+		double squaredRadius;
+		double yMin;
+		double yMax;
+		double phiMax;
+		double thetaMin;
+		double thetaMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPESPHERE_H_*/
@@ -89,6 +89,8 @@ ShapeSphericalPolygon::ShapeSphericalPolygon()
     m_sidesSensor = new SoFieldSensor( SidesChanged, this );
     m_sidesSensor->setPriority( 1 );
     m_sidesSensor->attach( &polygonSides );
+
+	CompileParameters();
 }
 
 ShapeSphericalPolygon::~ShapeSphericalPolygon()
@@ -135,12 +137,12 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 	double B = 2.0 * ( objectRay.origin.x *  objectRay.direction().x
 					 + objectRay.origin.y *  objectRay.direction().y
 					 + objectRay.origin.z *  objectRay.direction().z
-					 - objectRay.direction().z * sphereRadius.getValue() );
+					 - objectRay.direction().z * m_parameters.sphereRadius );
 
 	double C = objectRay.origin.x * objectRay.origin.x
 			 + objectRay.origin.y * objectRay.origin.y
 			 + objectRay.origin.z * objectRay.origin.z
-			 - 2 * objectRay.origin.z * sphereRadius.getValue();
+			 - 2 * objectRay.origin.z * m_parameters.sphereRadius;
 
 	// Solve quadratic equation for _t_ values
 	double t0, t1;
@@ -164,19 +166,18 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 	if( phi < 0.0 )	phi += gc::TwoPi;
 
 	double u = phi / gc::TwoPi;
-	double centralAngle = gc::TwoPi / polygonSides.getValue();
+	double centralAngle = m_parameters.centralAngle;
 
 	double part  =  floor( phi / centralAngle );
-	if( fabs( u - 1.0 ) < gc::Epsilon ) 	part = polygonSides.getValue() - 1;
+	if( fabs( u - 1.0 ) < gc::Epsilon ) 	part = m_parameters.polygonSides - 1;
 
-	double t2 = radius.getValue() * cos( 0.5 * centralAngle  )
-							* ( 1 / cos( 0.5 * centralAngle  - phi + centralAngle * part ) );
+	double t2 = m_parameters.apothem * ( 1 / cos( 0.5 * centralAngle  - phi + centralAngle * part ) );
 	double x = sin( phi ) * t2;
 	double y = cos( phi )* t2;
-	Vector3D tPoint = Vector3D( x, y,  sphereRadius.getValue()- sqrt( sphereRadius.getValue() * sphereRadius.getValue() - x * x - y * y  ) );
+	Vector3D tPoint = Vector3D( x, y,  m_parameters.sphereRadius- sqrt( m_parameters.squaredSphereRadius - x * x - y * y  ) );
 	double zRadius = sqrt( hitPoint.x * hitPoint.x + hitPoint.y * hitPoint.y );
 
-	if( (thit - objectRay.mint) < tol || zRadius > radius.getValue() || Vector3D( hitPoint).length() > tPoint.length() )
+	if( (thit - objectRay.mint) < tol || zRadius > m_parameters.radius || Vector3D( hitPoint).length() > tPoint.length() )
 	{
 		if ( thit == t1 ) return false;
 		if ( t1 > objectRay.maxt ) return false;
@@ -190,18 +191,17 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 
 		u = phi / gc::TwoPi;
 		part  =  floor( phi / centralAngle );
-		if( fabs( u - 1.0 ) < gc::Epsilon ) 	part = polygonSides.getValue() - 1;
+		if( fabs( u - 1.0 ) < gc::Epsilon ) 	part = m_parameters.polygonSides - 1;
 
-		t2 = radius.getValue() * cos( 0.5 * centralAngle  )
-										* ( 1 / cos( 0.5 * centralAngle  - phi + centralAngle * part ) );
+		t2 = m_parameters.apothem * ( 1 / cos( 0.5 * centralAngle  - phi + centralAngle * part ) );
 		x = sin( phi ) * t2;
 		y = cos( phi )* t2;
-		tPoint = Vector3D( x, y,  sphereRadius.getValue()- sqrt( sphereRadius.getValue() * sphereRadius.getValue() - x * x - y * y  ) );
+		tPoint = Vector3D( x, y,  m_parameters.sphereRadius- sqrt( m_parameters.squaredSphereRadius - x * x - y * y  ) );
 
 
 		zRadius = sqrt( hitPoint.x * hitPoint.x + hitPoint.y * hitPoint.y );
 
-		if( (thit - objectRay.mint) < tol || zRadius > radius.getValue() || Vector3D( hitPoint).length() > tPoint.length() )	return false;
+		if( (thit - objectRay.mint) < tol || zRadius > m_parameters.radius || Vector3D( hitPoint).length() > tPoint.length() )	return false;
 	}
 
 	// Now check if the fucntion is being called from IntersectP,
@@ -212,27 +212,27 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 	double v = Vector3D( hitPoint).length()/ tPoint.length();
 
 	// Compute ShapeSphere \dpdu and \dpdv
-	double theta = acos( ( sphereRadius.getValue() - hitPoint.z ) / sphereRadius.getValue() );
-	double thetaMax =  asin( radius.getValue() / sphereRadius.getValue() ) ;
+	double theta = acos( ( m_parameters.sphereRadius - hitPoint.z ) / m_parameters.sphereRadius );
+	double thetaMax =  m_parameters.thetaMax ;
 
 	// Compute sphere \dpdu and \dpdv
-	Vector3D dpdu( gc::TwoPi * radius.getValue() * cos( phi ) * sin( theta ),
-					- gc::TwoPi * radius.getValue() * sin( phi ) *sin( theta ),
+	Vector3D dpdu( gc::TwoPi * m_parameters.radius * cos( phi ) * sin( theta ),
+					- gc::TwoPi * m_parameters.radius * sin( phi ) *sin( theta ),
 					0.0 );
-	Vector3D dpdv( radius.getValue() * thetaMax * cos( theta ) * sin( phi ),
-					radius.getValue() * thetaMax * cos( phi ) * cos( theta ),
-					radius.getValue() * thetaMax * sin( theta ) );
+	Vector3D dpdv( m_parameters.radius * thetaMax * cos( theta ) * sin( phi ),
+					m_parameters.radius * thetaMax * cos( phi ) * cos( theta ),
+					m_parameters.radius * thetaMax * sin( theta ) );
 
-	Vector3D d2Pduu( -4  * gc::Pi * gc::Pi * radius.getValue() * sin( phi ) * sin( theta ),
-					 -4  * gc::Pi * gc::Pi * radius.getValue() * cos( phi ) * sin( theta ),
+	Vector3D d2Pduu( -4  * gc::Pi * gc::Pi * m_parameters.radius * sin( phi ) * sin( theta ),
+					 -4  * gc::Pi * gc::Pi * m_parameters.radius * cos( phi ) * sin( theta ),
 					 0.0 );
-	Vector3D d2Pduv( gc::TwoPi * radius.getValue() * thetaMax * cos( phi ) * cos( theta ),
-					- gc::TwoPi * radius.getValue() * thetaMax * sin( phi ) * cos( theta ),
+	Vector3D d2Pduv( gc::TwoPi * m_parameters.radius * thetaMax * cos( phi ) * cos( theta ),
+					- gc::TwoPi * m_parameters.radius * thetaMax * sin( phi ) * cos( theta ),
 						 0.0 );
 
-	Vector3D d2Pdvv( -radius.getValue() * thetaMax * thetaMax * sin( phi )* sin( theta ),
-			-radius.getValue() * thetaMax * thetaMax * cos( phi )* sin( theta ),
-			radius.getValue() * thetaMax * thetaMax * cos( theta ) );
+	Vector3D d2Pdvv( -m_parameters.radius * thetaMax * thetaMax * sin( phi )* sin( theta ),
+			-m_parameters.radius * thetaMax * thetaMax * cos( phi )* sin( theta ),
+			m_parameters.radius * thetaMax * thetaMax * cos( theta ) );
 
 
 	// Compute coefficients for fundamental forms
@@ -278,6 +278,20 @@ Point3D ShapeSphericalPolygon::Sample( double u, double v) const
 	return GetPoint3D( u , v );
 }
 
+/*!
+ * Copies the polygon fields used by Intersect and computes the angles of the polygon sides.
+ */
+void ShapeSphericalPolygon::CompileParameters()
+{
+	m_parameters.sphereRadius = sphereRadius.getValue();
+	m_parameters.squaredSphereRadius = m_parameters.sphereRadius * m_parameters.sphereRadius;
+	m_parameters.radius = radius.getValue();
+	m_parameters.polygonSides = polygonSides.getValue();
+	m_parameters.centralAngle = gc::TwoPi / m_parameters.polygonSides;
+	m_parameters.apothem = m_parameters.radius * cos( 0.5 * m_parameters.centralAngle );
+	m_parameters.thetaMax = asin( m_parameters.radius / m_parameters.sphereRadius );
+}
+
 Point3D ShapeSphericalPolygon::GetPoint3D( double u, double v ) const
 {
 	if ( OutOfRange( u, v ) ) gf::SevereError( "Function ShapeSphericalPolygon::GetPoint3D called with invalid parameters" );
@@ -70,6 +70,7 @@ public:
 	bool IntersectP( const Ray& objectRay ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	enum Side{
 		INSIDE = 0,
@@ -85,6 +86,18 @@ protected:
 	static void updatePolygonSides(void *data, SoSensor *);
 
 private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double sphereRadius;
+		double squaredSphereRadius;
+		double radius;
+		int polygonSides;
+		double centralAngle;
+		double apothem;
+		double thetaMax;
+	};
+
    	~ShapeSphericalPolygon();
 
 	Point3D GetPoint3D( double u, double v ) const;
@@ -104,6 +117,8 @@ private:
 	SoFieldSensor* m_radiusSensor;
 	SoFieldSensor* m_sidesSensor;
 	SoFieldSensor* m_sphereRadiusSensor;
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPESPHERICALPOLYGON_H_*/
@@ -91,6 +91,8 @@ ShapeSphericalRectangle::ShapeSphericalRectangle()
 	m_widthZSensor = new SoFieldSensor(updateWidthZ, this);
 	m_widthZSensor->setPriority( 1 );
 	m_widthZSensor->attach( &widthZ );
+
+	CompileParameters();
 }
 
 ShapeSphericalRectangle::~ShapeSphericalRectangle()
@@ -126,9 +128,9 @@ QString ShapeSphericalRectangle::GetIcon() const
 
 bool ShapeSphericalRectangle::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
 {
-	double r = radius.getValue();
-	double wX = widthX.getValue();
-	double wZ = widthZ.getValue();
+	double r = m_parameters.radius;
+	double wX = m_parameters.widthX;
+	double wZ = m_parameters.widthZ;
 
 	// Compute quadratic ShapeSphere coefficients
 	double A =   objectRay.direction().x * objectRay.direction().x
@@ -157,8 +159,7 @@ bool ShapeSphericalRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
     //Evaluate Tolerance
 	double tol = 0.00001;
 
-	double ymax = r - sqrt( r* r - ( wX / 2 ) * ( wX / 2 )
-													- ( wZ / 2 ) * ( wZ / 2 ) );
+	double ymax = m_parameters.yMax;
 
 	//Compute possible hit position
 	Point3D hitPoint = objectRay( thit );
@@ -257,6 +258,22 @@ Point3D ShapeSphericalRectangle::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the spherical rectangle fields used by Intersect and the height derived from them.
+ */
+void ShapeSphericalRectangle::CompileParameters()
+{
+	m_parameters.radius = radius.getValue();
+	m_parameters.widthX = widthX.getValue();
+	m_parameters.widthZ = widthZ.getValue();
+
+	double r = m_parameters.radius;
+	double wX = m_parameters.widthX;
+	double wZ = m_parameters.widthZ;
+	m_parameters.yMax = r - sqrt( r* r - ( wX / 2 ) * ( wX / 2 )
+											- ( wZ / 2 ) * ( wZ / 2 ) );
+}
+
 bool ShapeSphericalRectangle::OutOfRange( double u, double v ) const
 {
 	return ( ( u < 0.0 ) || ( u > 1.0 ) || ( v < 0.0 ) || ( v > 1.0 ) );
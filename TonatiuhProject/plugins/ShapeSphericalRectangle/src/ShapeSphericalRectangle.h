@@ -71,6 +71,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL radius;
 	trt::TONATIUH_REAL widthX;
@@ -96,6 +97,17 @@ private:
 	SoFieldSensor* m_radiusSensor;
 	SoFieldSensor* m_widthXSensor;
 	SoFieldSensor* m_widthZSensor;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double radius;
+		double widthX;
+		double widthZ;
+		double yMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPESPHERICALRECTANGLE_H_*/
@@ -119,12 +119,12 @@ double ShapeTroughAsymmetricCPC::GetArea() const
 
 BBox ShapeTroughAsymmetricCPC::GetBBox() const
 {
-	double xMin = ConcentratorProfileX( std::max( -( 3*gc::Pi/2 - acceptanceAngleCW.getValue() - m_tangentAngle ) , m_thetaMin ) );
-	double xMax = ConcentratorProfileX( std::min( 3*gc::Pi/2 - acceptanceAngleCCW.getValue() - m_tangentAngle , m_thetaMax ) );
+	double xMin = ConcentratorProfileX( std::max( -( 3*gc::Pi/2 - m_parameters.acceptanceAngleCW - m_tangentAngle ) , m_thetaMin ) );
+	double xMax = ConcentratorProfileX( std::min( 3*gc::Pi/2 - m_parameters.acceptanceAngleCCW - m_tangentAngle , m_thetaMax ) );
 	double yMin = std::min( ConcentratorProfileY( ( gc::Pi / 2 ) - m_tangentAngle ) ,  ConcentratorProfileY( ( - gc::Pi / 2 ) - m_tangentAngle ) );
 	double yMax = std::max( ConcentratorProfileY( m_thetaMax ) , ConcentratorProfileY( m_thetaMin ) );
 	double zMin = 0.0;
-	double zMax = length.getValue();
+	double zMax = m_parameters.length;
 
 	return BBox( Point3D( xMin, yMin, zMin ), Point3D( xMax, yMax, zMax ) );
 
@@ -167,7 +167,7 @@ bool ShapeTroughAsymmetricCPC::Intersect(const Ray& objectRay, double *tHit, Dif
 		{
 			// Compute possible collector hit position. Only Z must be checked, as find root only computes roots within the shape limits.
 			hitPoint = objectRay( thit );
-			if( hitPoint.z < 0.0 || hitPoint.z > length.getValue() )	valid = false;
+			if( hitPoint.z < 0.0 || hitPoint.z > m_parameters.length )	valid = false;
 			else	valid = true;
 		}
 		i++;
@@ -181,7 +181,7 @@ bool ShapeTroughAsymmetricCPC::Intersect(const Ray& objectRay, double *tHit, Dif
 	// Find parametric representation of CPC concentrator hit
 	double thetaHit = intersectionsMap.value( thit );
 	double u = ( thetaHit - m_thetaMin ) / ( m_thetaMax - m_thetaMin );
-	double v = hitPoint.z / length.getValue();
+	double v = hitPoint.z / m_parameters.length;
 
 	Vector3D dpdu = GetDPDU( u , v );
 	Vector3D dpdv( 0.0 , 0.0 , 1.0 );
@@ -226,6 +226,17 @@ Point3D ShapeTroughAsymmetricCPC::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the concentrator fields used by the intersection and the profile functions. SetInternalValues calls it, so the parameters are updated with the internal values whenever a field changes.
+ */
+void ShapeTroughAsymmetricCPC::CompileParameters()
+{
+	m_parameters.rInt = rInt.getValue();
+	m_parameters.acceptanceAngleCW = acceptanceAngleCW.getValue();
+	m_parameters.acceptanceAngleCCW = acceptanceAngleCCW.getValue();
+	m_parameters.length = length.getValue();
+}
+
 void ShapeTroughAsymmetricCPC::updateInternalValues( void *data, SoSensor *)
 {
 	ShapeTroughAsymmetricCPC* shapeTroughAsymmetricCPC = (ShapeTroughAsymmetricCPC *) data;
@@ -237,7 +248,7 @@ Point3D ShapeTroughAsymmetricCPC::GetPoint3D( double u, double v ) const
 	double theta = m_thetaMin + u * ( m_thetaMax - m_thetaMin );
 	double x = ConcentratorProfileX( theta );
 	double y = ConcentratorProfileY( theta );
-	double z = v * length.getValue();
+	double z = v * m_parameters.length;
 	return Point3D( x, y, z );
 }
 
@@ -256,12 +267,12 @@ bool ShapeTroughAsymmetricCPC::OutOfRange( double u, double v ) const
 
 void ShapeTroughAsymmetricCPC::computeBBox(SoAction*, SbBox3f& box, SbVec3f& /*center*/)
 {
-	double xMin = ConcentratorProfileX( std::max( -( 3*gc::Pi/2 - acceptanceAngleCW.getValue() - m_tangentAngle ) , m_thetaMin ) );
-	double xMax = ConcentratorProfileX( std::min( 3*gc::Pi/2 - acceptanceAngleCCW.getValue() - m_tangentAngle , m_thetaMax ) );
+	double xMin = ConcentratorProfileX( std::max( -( 3*gc::Pi/2 - m_parameters.acceptanceAngleCW - m_tangentAngle ) , m_thetaMin ) );
+	double xMax = ConcentratorProfileX( std::min( 3*gc::Pi/2 - m_parameters.acceptanceAngleCCW - m_tangentAngle , m_thetaMax ) );
 	double yMin = std::min( ConcentratorProfileY( ( gc::Pi / 2 ) - m_tangentAngle ) ,  ConcentratorProfileY( ( - gc::Pi / 2 ) - m_tangentAngle ) );
 	double yMax = std::max( ConcentratorProfileY( m_thetaMax ) , ConcentratorProfileY( m_thetaMin ) );
 	double zMin = 0.0;
-	double zMax = length.getValue();
+	double zMax = m_parameters.length;
 
 	box.setBounds(SbVec3f( xMin, yMin, zMin ), SbVec3f( xMax, yMax, zMax ) );
 }
@@ -370,13 +381,13 @@ Vector3D ShapeTroughAsymmetricCPC::GetDPDURight( double acceptanceAngle, double
 	double y;
 	if( theta > involuteLimit )
 	{
-		x =   ( rInt.getValue() * ( 2*acceptanceAngle + gc::Pi + 2*( theta + m_tangentAngle ) - 4*m_thetaZero - 2*cos( acceptanceAngle - ( theta + m_tangentAngle ) ) )*( cos( acceptanceAngle ) + sin( ( theta + m_tangentAngle ) ) ) ) / ( 2 * pow( -1 + sin( acceptanceAngle - ( theta + m_tangentAngle ) ) , 2 ) );
-		y = - ( rInt.getValue() * ( 2*acceptanceAngle + gc::Pi + 2*( theta + m_tangentAngle ) - 4*m_thetaZero - 2*cos( acceptanceAngle - ( theta + m_tangentAngle ) ) )*( cos( ( theta + m_tangentAngle ) ) - sin( acceptanceAngle ) ) ) / ( 2 * pow( -1 + sin( acceptanceAngle - ( theta + m_tangentAngle ) ) , 2 ) );
+		x =   ( m_parameters.rInt * ( 2*acceptanceAngle + gc::Pi + 2*( theta + m_tangentAngle ) - 4*m_thetaZero - 2*cos( acceptanceAngle - ( theta + m_tangentAngle ) ) )*( cos( acceptanceAngle ) + sin( ( theta + m_tangentAngle ) ) ) ) / ( 2 * pow( -1 + sin( acceptanceAngle - ( theta + m_tangentAngle ) ) , 2 ) );
+		y = - ( m_parameters.rInt * ( 2*acceptanceAngle + gc::Pi + 2*( theta + m_tangentAngle ) - 4*m_thetaZero - 2*cos( acceptanceAngle - ( theta + m_tangentAngle ) ) )*( cos( ( theta + m_tangentAngle ) ) - sin( acceptanceAngle ) ) ) / ( 2 * pow( -1 + sin( acceptanceAngle - ( theta + m_tangentAngle ) ) , 2 ) );
 	}
 	else
 	{
-		x = rInt.getValue() * ( theta + m_tangentAngle - m_thetaZero) * sin( theta + m_tangentAngle );
-		y = - rInt.getValue() * ( theta + m_tangentAngle - m_thetaZero) * cos( theta + m_tangentAngle );
+		x = m_parameters.rInt * ( theta + m_tangentAngle - m_thetaZero) * sin( theta + m_tangentAngle );
+		y = - m_parameters.rInt * ( theta + m_tangentAngle - m_thetaZero) * cos( theta + m_tangentAngle );
 	}
 
 	return Vector3D( x , y , 0.0 );
@@ -388,10 +399,10 @@ Vector3D ShapeTroughAsymmetricCPC::GetDPDU( double u , double /* v */ ) const
 	Vector3D dpdu;
 
 	if( theta >= 0.0 )
-		dpdu = GetDPDURight( acceptanceAngleCCW.getValue() , theta ) * ( m_thetaMax - m_thetaMin );
+		dpdu = GetDPDURight( m_parameters.acceptanceAngleCCW , theta ) * ( m_thetaMax - m_thetaMin );
 	else
 	{
-		dpdu = GetDPDURight( acceptanceAngleCW.getValue() , - theta ) * ( m_thetaMax - m_thetaMin );
+		dpdu = GetDPDURight( m_parameters.acceptanceAngleCW , - theta ) * ( m_thetaMax - m_thetaMin );
 		dpdu = Vector3D( -dpdu.x , dpdu.y, 0.0 );
 	}
 
@@ -405,14 +416,14 @@ Vector3D ShapeTroughAsymmetricCPC::GetD2PDUURight( double acceptanceAngle, doubl
 	double y;
 	if( theta > involuteLimit )
 	{
-		x = ( rInt.getValue() * (
+		x = ( m_parameters.rInt * (
 				( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) * ( cos( theta + m_tangentAngle ) + 2 * sin( acceptanceAngle ) ) )
 				- 4 * sin( 2 * acceptanceAngle - ( theta + m_tangentAngle ) )
 				- 5 * sin( theta + m_tangentAngle )
 				- 4 * cos( acceptanceAngle ) ) ) /
 				( -3 + cos( 2 * ( acceptanceAngle - ( theta + m_tangentAngle ) ) ) + 4 * sin( acceptanceAngle - ( theta + m_tangentAngle ) ));
 
-		y = ( rInt.getValue() * (
+		y = ( m_parameters.rInt * (
 				( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) * ( 2 * cos( acceptanceAngle )- sin( theta + m_tangentAngle ) ) )
 				+ cos( 2 * acceptanceAngle - ( theta + m_tangentAngle ) )
 				+ 5 * cos( theta + m_tangentAngle )
@@ -422,8 +433,8 @@ Vector3D ShapeTroughAsymmetricCPC::GetD2PDUURight( double acceptanceAngle, doubl
 	}
 	else
 	{
-		x = rInt.getValue() * ( ( theta + m_tangentAngle - m_thetaZero) * cos( theta + m_tangentAngle ) + sin( theta + m_tangentAngle ) );
-		y = rInt.getValue() * ( ( theta + m_tangentAngle - m_thetaZero) * sin( theta + m_tangentAngle ) - cos( theta + m_tangentAngle ) );
+		x = m_parameters.rInt * ( ( theta + m_tangentAngle - m_thetaZero) * cos( theta + m_tangentAngle ) + sin( theta + m_tangentAngle ) );
+		y = m_parameters.rInt * ( ( theta + m_tangentAngle - m_thetaZero) * sin( theta + m_tangentAngle ) - cos( theta + m_tangentAngle ) );
 	}
 
 	return Vector3D( x , y , 0.0 );
@@ -435,10 +446,10 @@ Vector3D ShapeTroughAsymmetricCPC::GetD2PDUU( double u , double /* v */ ) const
 	Vector3D d2pduu;
 
 	if( theta >= 0.0 )
-		d2pduu = GetD2PDUURight( acceptanceAngleCCW.getValue() , theta ) * pow( m_thetaMax - m_thetaMin , 2 );
+		d2pduu = GetD2PDUURight( m_parameters.acceptanceAngleCCW , theta ) * pow( m_thetaMax - m_thetaMin , 2 );
 	else
 	{
-		d2pduu = GetD2PDUURight( acceptanceAngleCW.getValue() , - theta ) * pow( m_thetaMax - m_thetaMin , 2 );
+		d2pduu = GetD2PDUURight( m_parameters.acceptanceAngleCW , - theta ) * pow( m_thetaMax - m_thetaMin , 2 );
 		d2pduu = Vector3D( -d2pduu.x , d2pduu.y, 0.0 );
 	}
 
@@ -450,12 +461,14 @@ Vector3D ShapeTroughAsymmetricCPC::GetD2PDUU( double u , double /* v */ ) const
  */
 void ShapeTroughAsymmetricCPC::SetInternalValues()
 {
-	m_tangentAngle = acos( rInt.getValue() / rExt.getValue() );
-	m_thetaZero = m_tangentAngle - ( ( rExt.getValue()/rInt.getValue() ) * sin( m_tangentAngle ) );
+	CompileParameters();
+
+	m_tangentAngle = acos( m_parameters.rInt / rExt.getValue() );
+	m_thetaZero = m_tangentAngle - ( ( rExt.getValue()/m_parameters.rInt ) * sin( m_tangentAngle ) );
 
 	// Full length limits
-	m_thetaMax = 3*gc::Pi/2 - acceptanceAngleCW.getValue() - m_tangentAngle;
-	m_thetaMin = -( 3*gc::Pi/2 - acceptanceAngleCCW.getValue() - m_tangentAngle );
+	m_thetaMax = 3*gc::Pi/2 - m_parameters.acceptanceAngleCW - m_tangentAngle;
+	m_thetaMin = -( 3*gc::Pi/2 - m_parameters.acceptanceAngleCCW - m_tangentAngle );
 
 	// Truncation
 	double thetaMaxTruncated = m_thetaMax;
@@ -480,28 +493,28 @@ double ShapeTroughAsymmetricCPC::ConcentratorProfileX( double theta ) const
 	double x;
 	if( theta >= 0.0 )
 	{
-		double acceptanceAngle = acceptanceAngleCCW.getValue();
+		double acceptanceAngle = m_parameters.acceptanceAngleCCW;
 		double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
 		double ro;
 		if( theta < involuteLimit )
-			ro = rInt.getValue() * ( theta + m_tangentAngle - m_thetaZero );
+			ro = m_parameters.rInt * ( theta + m_tangentAngle - m_thetaZero );
 		else
-			ro = ( rInt.getValue() * ( ( theta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( theta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( theta + m_tangentAngle - acceptanceAngle ) );
+			ro = ( m_parameters.rInt * ( ( theta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( theta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( theta + m_tangentAngle - acceptanceAngle ) );
 
-		x = ( rInt.getValue() * sin( theta + m_tangentAngle ) + ro * sin( theta + m_tangentAngle - ( gc::Pi / 2 ) ) );
+		x = ( m_parameters.rInt * sin( theta + m_tangentAngle ) + ro * sin( theta + m_tangentAngle - ( gc::Pi / 2 ) ) );
 	}
 	else
 	{
 		double negTheta = -theta;
-		double acceptanceAngle = acceptanceAngleCW.getValue();
+		double acceptanceAngle = m_parameters.acceptanceAngleCW;
 		double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
 		double ro;
 		if( negTheta < involuteLimit )
-			ro = rInt.getValue() * ( negTheta + m_tangentAngle - m_thetaZero );
+			ro = m_parameters.rInt * ( negTheta + m_tangentAngle - m_thetaZero );
 		else
-			ro = ( rInt.getValue() * ( ( negTheta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( negTheta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( negTheta + m_tangentAngle - acceptanceAngle ) );
+			ro = ( m_parameters.rInt * ( ( negTheta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( negTheta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( negTheta + m_tangentAngle - acceptanceAngle ) );
 
-		x = - ( rInt.getValue() * sin( negTheta + m_tangentAngle ) + ro * sin( negTheta + m_tangentAngle - ( gc::Pi / 2 ) ) );
+		x = - ( m_parameters.rInt * sin( negTheta + m_tangentAngle ) + ro * sin( negTheta + m_tangentAngle - ( gc::Pi / 2 ) ) );
 	}
 
 	return x;
@@ -512,28 +525,28 @@ double ShapeTroughAsymmetricCPC::ConcentratorProfileY( double theta ) const
 	double y;
 	if( theta >= 0.0 )
 	{
-		double acceptanceAngle = acceptanceAngleCCW.getValue();
+		double acceptanceAngle = m_parameters.acceptanceAngleCCW;
 		double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
 		double ro;
 		if( theta < involuteLimit )
-			ro = rInt.getValue() * ( theta + m_tangentAngle - m_thetaZero );
+			ro = m_parameters.rInt * ( theta + m_tangentAngle - m_thetaZero );
 		else
-			ro = ( rInt.getValue() * ( ( theta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( theta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( theta + m_tangentAngle - acceptanceAngle ) );
+			ro = ( m_parameters.rInt * ( ( theta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( theta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( theta + m_tangentAngle - acceptanceAngle ) );
 
-		y = ( - rInt.getValue() * cos( theta + m_tangentAngle ) - ro * cos( theta + m_tangentAngle - ( gc::Pi / 2 ) ) );
+		y = ( - m_parameters.rInt * cos( theta + m_tangentAngle ) - ro * cos( theta + m_tangentAngle - ( gc::Pi / 2 ) ) );
 	}
 	else
 	{
 		double negTheta = -theta;
-		double acceptanceAngle = acceptanceAngleCW.getValue();
+		double acceptanceAngle = m_parameters.acceptanceAngleCW;
 		double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
 		double ro;
 		if( negTheta < involuteLimit )
-			ro = rInt.getValue() * ( negTheta + m_tangentAngle - m_thetaZero );
+			ro = m_parameters.rInt * ( negTheta + m_tangentAngle - m_thetaZero );
 		else
-			ro = ( rInt.getValue() * ( ( negTheta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( negTheta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( negTheta + m_tangentAngle - acceptanceAngle ) );
+			ro = ( m_parameters.rInt * ( ( negTheta + m_tangentAngle + acceptanceAngle + ( gc::Pi / 2 ) - ( 2 * m_thetaZero ) ) -  cos( negTheta + m_tangentAngle - acceptanceAngle )  ) ) / ( 1 + sin( negTheta + m_tangentAngle - acceptanceAngle ) );
 
-		y = ( - rInt.getValue() * cos( negTheta + m_tangentAngle ) - ro * cos( negTheta + m_tangentAngle - ( gc::Pi / 2 ) ) );
+		y = ( - m_parameters.rInt * cos( negTheta + m_tangentAngle ) - ro * cos( negTheta + m_tangentAngle - ( gc::Pi / 2 ) ) );
 	}
 
 	return y;
@@ -625,14 +638,14 @@ std::vector<double> ShapeTroughAsymmetricCPC::FindRigthRoots( const Ray ray, dou
 std::vector<double> ShapeTroughAsymmetricCPC::FindRoots( const Ray ray ) const
 {
 	// Right branch roots
-	std::vector<double> roots = FindRigthRoots( ray, 0 , m_thetaMax , acceptanceAngleCCW.getValue() );
+	std::vector<double> roots = FindRigthRoots( ray, 0 , m_thetaMax , m_parameters.acceptanceAngleCCW );
 
 	// Left branch hits calculated with the symmetric ray.
 	Point3D symmetricRayOrigin = Point3D( - ray.origin.x , ray.origin.y , ray.origin.z );
 	Vector3D symmetricRayDirection = Vector3D( - ray.direction().x , ray.direction().y , ray.direction().z );
 	Ray symmetricRay = Ray( symmetricRayOrigin , symmetricRayDirection );
 
-	std::vector<double> rootsLeft = FindRigthRoots( symmetricRay, 0 , - m_thetaMin , acceptanceAngleCW.getValue() );
+	std::vector<double> rootsLeft = FindRigthRoots( symmetricRay, 0 , - m_thetaMin , m_parameters.acceptanceAngleCW );
 
 	// Change sign to roots thetaRoot --> -thetaRoot and append to roots
 	for ( unsigned int i = 0; i < rootsLeft.size(); i++)
@@ -651,12 +664,12 @@ double ShapeTroughAsymmetricCPC::TDeviation( const Ray ray, double theta, double
 
 	double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
 	if( theta < involuteLimit )
-		return -dy * ox + dx * oy + rInt.getValue() * ( dx - dy * ( theta + m_tangentAngle - m_thetaZero ) ) * cos( theta + m_tangentAngle ) + rInt.getValue() * ( dy + dx * ( theta + m_tangentAngle - m_thetaZero ) ) * sin( theta + m_tangentAngle );
+		return -dy * ox + dx * oy + m_parameters.rInt * ( dx - dy * ( theta + m_tangentAngle - m_thetaZero ) ) * cos( theta + m_tangentAngle ) + m_parameters.rInt * ( dy + dx * ( theta + m_tangentAngle - m_thetaZero ) ) * sin( theta + m_tangentAngle );
 	else
-		return ( ( -2 * dy * rInt.getValue() * cos( acceptanceAngle ) )
-			+ rInt.getValue() * ( -2 * dx + dy * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * cos( theta + m_tangentAngle )
-			+ 2 * ( dx * rInt.getValue() * sin( acceptanceAngle ) - ( dy * ox - dx * oy ) * ( -1 + sin( acceptanceAngle - theta - m_tangentAngle ) ) )
-			- rInt.getValue() * ( 2*dy + dx * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * sin( theta + m_tangentAngle ) ) /
+		return ( ( -2 * dy * m_parameters.rInt * cos( acceptanceAngle ) )
+			+ m_parameters.rInt * ( -2 * dx + dy * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * cos( theta + m_tangentAngle )
+			+ 2 * ( dx * m_parameters.rInt * sin( acceptanceAngle ) - ( dy * ox - dx * oy ) * ( -1 + sin( acceptanceAngle - theta - m_tangentAngle ) ) )
+			- m_parameters.rInt * ( 2*dy + dx * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * sin( theta + m_tangentAngle ) ) /
 			( 2*( -1 + sin( acceptanceAngle - theta - m_tangentAngle ) ) );
 
 }
@@ -68,6 +68,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL rInt;
 	trt::TONATIUH_REAL rExt;
@@ -108,6 +109,17 @@ private:
 	double m_thetaZero;
 	double m_thetaMin;
 	double m_thetaMax;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double rInt;
+		double acceptanceAngleCW;
+		double acceptanceAngleCCW;
+		double length;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPETROUGHASYMMETRICCPC_H_*/
@@ -93,7 +93,7 @@ ShapeTroughCHC::ShapeTroughCHC()
 	m_heightSensor->setPriority( 1 );
 	m_heightSensor->attach( &height );
 
-
+	CompileParameters();
 }
 
 ShapeTroughCHC::~ShapeTroughCHC()
@@ -126,12 +126,12 @@ QString ShapeTroughCHC::GetIcon() const
 
 bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
 {
-	double a = ( m_s - height.getValue() )/( cos( m_theta ) * 2 *  m_eccentricity);
+	double a = ( m_s - m_parameters.height )/( cos( m_theta ) * 2 *  m_eccentricity);
 	double b = sqrt( ( m_eccentricity * m_eccentricity - 1 ) *  a * a );
 
 	double angle = -( 0.5 * gc::Pi ) + m_theta;
 
-	Transform hTransform( cos( angle ), -sin( angle ), 0.0, -r1.getValue() + a * m_eccentricity * sin( m_theta ),
+	Transform hTransform( cos( angle ), -sin( angle ), 0.0, -m_parameters.r1 + a * m_eccentricity * sin( m_theta ),
 			sin( angle ), cos( angle ), 0.0, - a * m_eccentricity * cos( m_theta ),
 	           0.0, 0.0, 1.0, 0.0,
 	           0.0, 0.0, 0.0, 1.0 );
@@ -165,14 +165,14 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	Point3D hitPoint = objectRay( thit );
 
 	// Test intersection against clipping parameters
-	double m =  ( lengthX2.getValue() / 2- lengthX1.getValue() / 2 ) / ( p1.getValue() - r1.getValue() );
-	double zmax = ( lengthX1.getValue()  / 2 ) + m * ( hitPoint.x - r1.getValue() );
+	double m =  ( m_parameters.lengthX2 / 2- m_parameters.lengthX1 / 2 ) / ( m_parameters.p1 - m_parameters.r1 );
+	double zmax = ( m_parameters.lengthX1  / 2 ) + m * ( hitPoint.x - m_parameters.r1 );
 	double zmin = - zmax;
 
 	// Test intersection against clipping parameters
 	if( (thit - objectRay.mint) < tol
-			|| hitPoint.x < r1.getValue() || hitPoint.x > p1.getValue()
-			|| hitPoint.y < 0.0 || hitPoint.y > height.getValue()
+			|| hitPoint.x < m_parameters.r1 || hitPoint.x > m_parameters.p1
+			|| hitPoint.y < 0.0 || hitPoint.y > m_parameters.height
 			|| hitPoint.z < zmin ||  hitPoint.z > zmax )
 	{
 
@@ -183,12 +183,12 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 		// Compute ShapeSphere hit position and $\phi$
 		hitPoint = objectRay( thit );
 
-		zmax = ( lengthX1.getValue()  / 2 ) + m * ( hitPoint.x - r1.getValue() );
+		zmax = ( m_parameters.lengthX1  / 2 ) + m * ( hitPoint.x - m_parameters.r1 );
 		zmin = - zmax;
 
 		if( (thit - objectRay.mint) < tol
-					|| hitPoint.x < r1.getValue() || hitPoint.x > p1.getValue()
-					|| hitPoint.y < 0.0 || hitPoint.y > height.getValue()
+					|| hitPoint.x < m_parameters.r1 || hitPoint.x > m_parameters.p1
+					|| hitPoint.y < 0.0 || hitPoint.y > m_parameters.height
 					|| hitPoint.z < zmin ||  hitPoint.z > zmax )	return false;
 	}
 
@@ -198,11 +198,11 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	double inf = m_theta + m_phi;
 
 	double alpha;
-	bool isAlpha = findRoot( fPart, hitPoint.x,  m_eccentricity,  r1.getValue(), m_theta, inf, sup, 0.5*( sup-inf), 500, &alpha );
+	bool isAlpha = findRoot( fPart, hitPoint.x,  m_eccentricity,  m_parameters.r1, m_theta, inf, sup, 0.5*( sup-inf), 500, &alpha );
 	if( !isAlpha )return false;
 	double u = ( alpha - inf ) / ( sup - inf );
 
-	zmax = (lengthX1.getValue() / 2 ) + m* ( hitPoint.x - r1.getValue() );
+	zmax = (m_parameters.lengthX1 / 2 ) + m* ( hitPoint.x - m_parameters.r1 );
 	double v = ( ( hitPoint.z / zmax ) + 1 )/ 2;
 
 
@@ -262,6 +262,18 @@ Point3D ShapeTroughCHC::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the concentrator fields used by Intersect.
+ */
+void ShapeTroughCHC::CompileParameters()
+{
+	m_parameters.r1 = r1.getValue();
+	m_parameters.p1 = p1.getValue();
+	m_parameters.height = height.getValue();
+	m_parameters.lengthX1 = lengthX1.getValue();
+	m_parameters.lengthX2 = lengthX2.getValue();
+}
+
 void ShapeTroughCHC::updateInternalValues( void *data, SoSensor *)
 {
 	ShapeTroughCHC* shapeTroughCHC = (ShapeTroughCHC *) data;
@@ -65,6 +65,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL r1;
 	trt::TONATIUH_REAL p1;
@@ -95,6 +96,18 @@ private:
 	double m_s;
 	double m_theta;
 	double m_eccentricity;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double r1;
+		double p1;
+		double height;
+		double lengthX1;
+		double lengthX2;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPETROUGHCHC_H_*/
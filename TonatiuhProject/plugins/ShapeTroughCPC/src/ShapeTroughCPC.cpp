@@ -107,7 +107,7 @@ ShapeTroughCPC::ShapeTroughCPC()
 	m_heightSensor->setPriority( 0 );
 	m_heightSensor->attach( &height );
 
-
+	CompileParameters();
 }
 
 ShapeTroughCPC::~ShapeTroughCPC()
@@ -148,21 +148,21 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	double inf = 2 * m_thetaI;
 	double sup = ( gc::Pi / 2 ) + m_thetaI;
 	double ts11;
-	bool isRoot1 = findRoot( fPart, objectRay, a.getValue(), m_thetaI, inf, sup, 0, 500, &ts11 );
+	bool isRoot1 = findRoot( fPart, objectRay, m_parameters.a, m_thetaI, inf, sup, 0, 500, &ts11 );
 	if( isRoot1 )
 	{
 
 		double tr11 = findThit( objectRay, ts11, true );
 		vectorTr.insert( tr11, ts11 );
 		double ts12;
-		if ( findRoot( fPart, objectRay, a.getValue(), m_thetaI, inf, ts11 - 0.00001, 0, 500, &ts12 ) )
+		if ( findRoot( fPart, objectRay, m_parameters.a, m_thetaI, inf, ts11 - 0.00001, 0, 500, &ts12 ) )
 		{
 			double tr12  = findThit( objectRay, ts12, true );
 			vectorTr.insert( tr12, ts12 );
 		}
 		else
 		{
-			if( findRoot( fPart, objectRay, a.getValue(), m_thetaI, ts11 + 0.00001, sup, 0, 500, &ts12 ) )
+			if( findRoot( fPart, objectRay, m_parameters.a, m_thetaI, ts11 + 0.00001, sup, 0, 500, &ts12 ) )
 			{
 				double tr12 = findThit( objectRay, ts12, true );
 				vectorTr.insert( tr12, ts12 );
@@ -184,11 +184,11 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	bool valid = false;
 	Point3D hitPoint;
 
-	double xmin = a.getValue();
-	double xmax = ( (2 * a.getValue() * (1 + sin(m_thetaI) ) * sin(m_thetaMin-m_thetaI) )
-			 / ( 1 - cos(m_thetaMin) ) )- a.getValue();
+	double xmin = m_parameters.a;
+	double xmax = ( (2 * m_parameters.a * (1 + sin(m_thetaI) ) * sin(m_thetaMin-m_thetaI) )
+			 / ( 1 - cos(m_thetaMin) ) )- m_parameters.a;
 	double ymin = 0.0;
-	double ymax = ( 2 * a.getValue() * cos(m_thetaI)* (1 + sin(m_thetaI ) ) )/(1 - cos( 2 * m_thetaI ) );
+	double ymax = ( 2 * m_parameters.a * cos(m_thetaI)* (1 + sin(m_thetaI ) ) )/(1 - cos( 2 * m_thetaI ) );
 
 	while(  ( intersection < vectorTr.size() ) && !valid )
 	{
@@ -212,8 +212,8 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 					hitPoint = objectRay( thit );
 
 					// Test intersection against clipping parameters
-					double m =  ( lengthXMax.getValue() / 2- lengthXMin.getValue() / 2 ) / ( xmax - xmin );
-					double zmax = ( lengthXMin.getValue()  / 2 )+ m * ( hitPoint.x - xmin );
+					double m =  ( m_parameters.lengthXMax / 2- m_parameters.lengthXMin / 2 ) / ( xmax - xmin );
+					double zmax = ( m_parameters.lengthXMin  / 2 )+ m * ( hitPoint.x - xmin );
 					double zmin = -zmax;
 
 					if( hitPoint.z < zmin || hitPoint.z > zmax ||
@@ -238,26 +238,26 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	// Find parametric representation of CPC concentrator hit
 	double u = ( theta - 2 * m_thetaI ) / ( gc::Pi / 2 - m_thetaI );
 
-	double m =  (  ( lengthXMax.getValue()- lengthXMin.getValue() ) / 2 ) /  ( xmax - xmin );
-	double zmax = (lengthXMin.getValue() / 2 ) + m* ( hitPoint.x - xmin );
+	double m =  (  ( m_parameters.lengthXMax- m_parameters.lengthXMin ) / 2 ) /  ( xmax - xmin );
+	double zmax = (m_parameters.lengthXMin / 2 ) + m* ( hitPoint.x - xmin );
 	double v = ( ( hitPoint.z / zmax ) + 1 )/ 2;
 
 
 	// Compute  \dpdu and \dpdv
-	double dpduX = - 0.5 * a.getValue() * (gc::Pi - 2 * m_thetaI )* pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 3 )
+	double dpduX = - 0.5 * m_parameters.a * (gc::Pi - 2 * m_thetaI )* pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 3 )
 							* sin( 0.25 * u * ( gc::Pi  - 2 * m_thetaI ) ) * (1 + sin( m_thetaI ) );
 
-	double dpduY = - 0.5 * a.getValue() * (gc::Pi - 2 * m_thetaI )* pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 3 )
+	double dpduY = - 0.5 * m_parameters.a * (gc::Pi - 2 * m_thetaI )* pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 3 )
 								* cos( 0.25 * u * ( gc::Pi  - 2 * m_thetaI ) ) * (1 + sin( m_thetaI ) );
 
 	Vector3D dpdu(dpduX, dpduY, 0.0);
 	Vector3D dpdv(0.0, 0.0, 1.0);
 
 	// Compute cylinder \dndu and \dndv
-	double dpduuX = 0.125 * a.getValue() * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
+	double dpduuX = 0.125 * m_parameters.a * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
 								* ( -2 * sin( m_thetaI ) + sin( u * gc::Pi  / 2  + m_thetaI - u * m_thetaI ) ) * (1 + sin( m_thetaI ) );
 
-	double dpduuY = 0.125 * a.getValue() * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
+	double dpduuY = 0.125 * m_parameters.a * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
 									* ( 2 * cos( m_thetaI ) + cos( u * gc::Pi  / 2  + m_thetaI - u * m_thetaI ) ) * (1 + sin( m_thetaI ) );
 
 	Vector3D d2Pduu(dpduuX , dpduuY, 0);
@@ -305,6 +305,16 @@ Point3D ShapeTroughCPC::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the concentrator fields used by Intersect.
+ */
+void ShapeTroughCPC::CompileParameters()
+{
+	m_parameters.a = a.getValue();
+	m_parameters.lengthXMin = lengthXMin.getValue();
+	m_parameters.lengthXMax = lengthXMax.getValue();
+}
+
 void ShapeTroughCPC::updateCMaxValues( void *data, SoSensor *)
 {
 	ShapeTroughCPC* shapeTroughCPC = (ShapeTroughCPC *) data;
@@ -549,15 +559,15 @@ double ShapeTroughCPC::findThit( Ray ray, double theta, bool right ) const
 	double tHit;
 	if( ray.direction().x > 0 )
 	{
-		double x = ((2 * a.getValue() * (1 + sin(m_thetaI) ) * sin( theta-m_thetaI ))
-				/( 1 - cos(theta ))) - a.getValue();
+		double x = ((2 * m_parameters.a * (1 + sin(m_thetaI) ) * sin( theta-m_thetaI ))
+				/( 1 - cos(theta ))) - m_parameters.a;
 
 		if( !right )	x *= -1;
 		tHit = ( x - ray.origin.x ) * ray.invDirection().x;
 	}
 	else
 	{
-		double y = ( 2 * a.getValue() * (1 + sin(m_thetaI) ) *cos( theta-m_thetaI ) )
+		double y = ( 2 * m_parameters.a * (1 + sin(m_thetaI) ) *cos( theta-m_thetaI ) )
 				/( 1 - cos(theta) );
 		tHit = ( y - ray.origin.y ) * ray.invDirection().y;
 	}
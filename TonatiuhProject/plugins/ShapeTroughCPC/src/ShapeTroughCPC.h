@@ -65,6 +65,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL a;
 	trt::TONATIUH_REAL cMax;
@@ -96,6 +97,15 @@ private:
 	SoFieldSensor* m_cMaxSensor;
 	SoFieldSensor* m_heightSensor;
 
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double a;
+		double lengthXMin;
+		double lengthXMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPETROUGHCPC_H_*/
@@ -104,7 +104,7 @@ ShapeTroughHyperbola::ShapeTroughHyperbola()
 	m_truncationSensor->setPriority( 1 );
 	m_truncationSensor->attach( &truncationHeight );
 
-
+	CompileParameters();
 }
 
 ShapeTroughHyperbola::~ShapeTroughHyperbola()
@@ -145,7 +145,7 @@ QString ShapeTroughHyperbola::GetIcon() const
 
 bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
 {
-	double a = a0.getValue();
+	double a = m_parameters.a0;
 	double b = a / tan( m_asymptoticAngle );
 
 	double A = ( ( b * b ) * ( objectRay.direction().x * objectRay.direction().x ) )
@@ -174,22 +174,22 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 	Point3D hitPoint = objectRay( thit );
 
 	double xMin = sqrt( a * a *
-							( 1 + ( ( truncationHeight.getValue() * truncationHeight.getValue() )
+							( 1 + ( ( m_parameters.truncationHeight * m_parameters.truncationHeight )
 									/ ( b* b ) ) ) );
 	double xMax = sqrt( a * a * ( 1 +
-				( ( hyperbolaHeight.getValue() * hyperbolaHeight.getValue() )
+				( ( m_parameters.hyperbolaHeight * m_parameters.hyperbolaHeight )
 						/ ( b * b ) ) ) );
 
 	// Test intersection against clipping parameters
-	double m =  ( zLengthXMax.getValue() / 2- zLengthXMin.getValue() / 2 ) / ( xMax - xMin );
-	double zmax = ( zLengthXMin.getValue()  / 2 ) + m * ( hitPoint.x - xMin );
+	double m =  ( m_parameters.zLengthXMax / 2- m_parameters.zLengthXMin / 2 ) / ( xMax - xMin );
+	double zmax = ( m_parameters.zLengthXMin  / 2 ) + m * ( hitPoint.x - xMin );
 	double zmin = - zmax;
 
 
 	// Test intersection against clipping parameters
 	if( (thit - objectRay.mint) < tol
 			|| hitPoint.x < xMin || hitPoint.x > xMax
-			|| hitPoint.y < truncationHeight.getValue() || hitPoint.y > hyperbolaHeight.getValue()
+			|| hitPoint.y < m_parameters.truncationHeight || hitPoint.y > m_parameters.hyperbolaHeight
 			|| hitPoint.z < zmin ||  hitPoint.z > zmax )
 	{
 		if ( thit == t1 ) return false;
@@ -198,12 +198,12 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 
 		// Compute ShapeSphere hit position and $\phi$
 		hitPoint = objectRay( thit );
-		zmax = ( zLengthXMin.getValue() * 0.5 ) + m * ( hitPoint.x - xMin );
+		zmax = ( m_parameters.zLengthXMin * 0.5 ) + m * ( hitPoint.x - xMin );
 		zmin = - zmax;
 
 		if( (thit - objectRay.mint) < tol
 				|| hitPoint.x < xMin || hitPoint.x > xMax
-				|| hitPoint.y < truncationHeight.getValue() || hitPoint.y > hyperbolaHeight.getValue()
+				|| hitPoint.y < m_parameters.truncationHeight || hitPoint.y > m_parameters.hyperbolaHeight
 				|| hitPoint.z < zmin ||  hitPoint.z > zmax )	return false;
 	}
 	// Now check if the fucntion is being called from IntersectP,
@@ -222,8 +222,8 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 
 	// Compute cylinder \dndu and \dndv
 	double tanAngle = tan( m_asymptoticAngle );
-	double h = hyperbolaHeight.getValue();
-	double t = truncationHeight.getValue();
+	double h = m_parameters.hyperbolaHeight;
+	double t = m_parameters.truncationHeight;
 	double cotAngle = 1 / tanAngle;
 	double aux1 = sqrt( a * a * (1 + ( ( h * h * tanAngle * tanAngle )/ ( a * a ) ) ) );
 	double aux2 = sqrt( a * a * (1 + ( ( t * t * tanAngle * tanAngle )/ ( a * a ) ) ) );
@@ -238,7 +238,7 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 								( -1 + ( ( ( a + u * aux ) * ( a + u * aux ) )
 										/ ( a * a ) ) ) ) );
 	Vector3D d2Pduu(0 , d2PduuY, 0);
-	Vector3D d2Pduv( 0.0, 0.0, 2 * ( -0.5 * zLengthXMin.getValue() + 0.5 * zLengthXMax.getValue() ) );
+	Vector3D d2Pduv( 0.0, 0.0, 2 * ( -0.5 * m_parameters.zLengthXMin + 0.5 * m_parameters.zLengthXMax ) );
 	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
 
 	// Compute coefficients for fundamental forms
@@ -282,6 +282,18 @@ Point3D ShapeTroughHyperbola::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the trough fields used by Intersect.
+ */
+void ShapeTroughHyperbola::CompileParameters()
+{
+	m_parameters.a0 = a0.getValue();
+	m_parameters.truncationHeight = truncationHeight.getValue();
+	m_parameters.hyperbolaHeight = hyperbolaHeight.getValue();
+	m_parameters.zLengthXMin = zLengthXMin.getValue();
+	m_parameters.zLengthXMax = zLengthXMax.getValue();
+}
+
 void ShapeTroughHyperbola::updateApertureValue( void *data, SoSensor *)
 {
 	ShapeTroughHyperbola* shape = (ShapeTroughHyperbola *) data;
@@ -64,6 +64,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
+	void CompileParameters();
 
 	trt::TONATIUH_REAL a0;
 	trt::TONATIUH_REAL focusHyperbola;
@@ -103,6 +104,17 @@ private:
 	double m_lastZLengthXMinValue;
 	double m_lastZLengthXMaxValue;
 
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double a0;
+		double truncationHeight;
+		double hyperbolaHeight;
+		double zLengthXMin;
+		double zLengthXMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPETROUGHHYPERBOLA_H_*/
@@ -87,6 +87,7 @@ ShapeTroughParabola::ShapeTroughParabola()
 	m_xMaxSensor->setPriority( 1 );
 	m_xMaxSensor->attach( &xMax );
 
+	CompileParameters();
 }
 
 ShapeTroughParabola::~ShapeTroughParabola()
@@ -126,8 +127,8 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
 	// Compute quadratic parabolic cylinder coefficients
 	Vector3D vObjectRayOrigin = Vector3D( objectRay.origin );
 	double A = objectRay.direction().x*objectRay.direction().x;
-    double B = 2.0 * ( objectRay.direction().x* objectRay.origin.x - 2 * focusLength.getValue() * objectRay.direction().y);
-	double C = objectRay.origin.x * objectRay.origin.x - 4 * focusLength.getValue() * objectRay.origin.y;
+    double B = 2.0 * ( objectRay.direction().x* objectRay.origin.x - 2 * m_parameters.focusLength * objectRay.direction().y);
+	double C = objectRay.origin.x * objectRay.origin.x - 4 * m_parameters.focusLength * objectRay.origin.y;
 
 	// Solve quadratic equation for _t_ values
 	double t0, t1;
@@ -146,15 +147,15 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
     Point3D hitPoint = objectRay( thit );
 
 	// Test intersection against clipping parameters
-	double xmin = xMin.getValue();
-	double xmax = xMax.getValue();
+	double xmin = m_parameters.xMin;
+	double xmax = m_parameters.xMax;
 
-	double zmax = std::max( lengthXMin.getValue(), lengthXMax.getValue() );
-	double z1 = ( ( zmax - lengthXMin.getValue() ) / 2 ) + ( (lengthXMin.getValue() - lengthXMax.getValue() ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
-	double z2 = ( ( zmax + lengthXMin.getValue() ) / 2 )  + ( ( (lengthXMax.getValue() - lengthXMin.getValue() ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
+	double zmax = std::max( m_parameters.lengthXMin, m_parameters.lengthXMax );
+	double z1 = ( ( zmax - m_parameters.lengthXMin ) / 2 ) + ( (m_parameters.lengthXMin - m_parameters.lengthXMax ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
+	double z2 = ( ( zmax + m_parameters.lengthXMin ) / 2 )  + ( ( (m_parameters.lengthXMax - m_parameters.lengthXMin ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
 
-	double y1 = ( xmin * xmin ) / ( 4 * focusLength.getValue() );
-	double y2 = ( xmax * xmax ) / ( 4 * focusLength.getValue() );
+	double y1 = ( xmin * xmin ) / ( 4 * m_parameters.focusLength );
+	double y2 = ( xmax * xmax ) / ( 4 * m_parameters.focusLength );
 
 	double ymin = 0.0;
 	if( ( xmin * xmax ) > 0 ) ymin = std::min( y1, y2 );
@@ -173,8 +174,8 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
 		// Compute parabolic cylinder hit position
 		hitPoint = objectRay( thit );
 
-		z1 = ( ( zmax - lengthXMin.getValue() ) / 2 ) + ( (lengthXMin.getValue() - lengthXMax.getValue() ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
-		z2 = ( ( zmax + lengthXMin.getValue() ) / 2 )  + ( ( (lengthXMax.getValue() - lengthXMin.getValue() ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
+		z1 = ( ( zmax - m_parameters.lengthXMin ) / 2 ) + ( (m_parameters.lengthXMin - m_parameters.lengthXMax ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
+		z2 = ( ( zmax + m_parameters.lengthXMin ) / 2 )  + ( ( (m_parameters.lengthXMax - m_parameters.lengthXMin ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
 
 		if( ( thit - objectRay.mint) < tol ||
 			hitPoint.z < z1 ||
@@ -193,19 +194,19 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
 	hitPoint = objectRay( thit );
 
 	// Find parametric representation of paraboloid hit
-	double u =  hitPoint.x  / focusLength.getValue();
+	double u =  hitPoint.x  / m_parameters.focusLength;
 
-	z1 = ( ( zmax - lengthXMin.getValue() ) / 2 ) + ( (lengthXMin.getValue() - lengthXMax.getValue() ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
-	z2 = ( ( zmax + lengthXMin.getValue() ) / 2 )  + ( ( (lengthXMax.getValue() - lengthXMin.getValue() ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
+	z1 = ( ( zmax - m_parameters.lengthXMin ) / 2 ) + ( (m_parameters.lengthXMin - m_parameters.lengthXMax ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
+	z2 = ( ( zmax + m_parameters.lengthXMin ) / 2 )  + ( ( (m_parameters.lengthXMax - m_parameters.lengthXMin ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
 
 	double v = ( hitPoint.z - z1 ) / (z2 - z1);
 
 	// Compute parabaloid \dpdu and \dpdv
-	Vector3D dpdu(1.0, hitPoint.x /( 2.0 * focusLength.getValue() ), 0.0);
+	Vector3D dpdu(1.0, hitPoint.x /( 2.0 * m_parameters.focusLength ), 0.0);
 	Vector3D dpdv(0.0, 0.0, 1.0);
 
 	// Compute parabaloid \dndu and \dndv
-	Vector3D d2Pduu ( 0.0, 1.0/( 2.0* focusLength.getValue() ), 0.0 );
+	Vector3D d2Pduu ( 0.0, 1.0/( 2.0* m_parameters.focusLength ), 0.0 );
 	Vector3D d2Pduv ( 0.0, 0.0, 0.0 );
 	Vector3D d2Pdvv ( 0.0, 0.0, 0.0 );
 
@@ -247,6 +248,18 @@ Point3D ShapeTroughParabola::Sample( double u, double v ) const
 	return GetPoint3D( u, v );
 }
 
+/*!
+ * Copies the trough fields used by Intersect.
+ */
+void ShapeTroughParabola::CompileParameters()
+{
+	m_parameters.focusLength = focusLength.getValue();
+	m_parameters.xMin = xMin.getValue();
+	m_parameters.xMax = xMax.getValue();
+	m_parameters.lengthXMin = lengthXMin.getValue();
+	m_parameters.lengthXMax = lengthXMax.getValue();
+}
+
 void ShapeTroughParabola::updateXMinValues( void *data, SoSensor *)
 {
 	ShapeTroughParabola* shapeTroughParabola = (ShapeTroughParabola *) data;
@@ -64,6 +64,7 @@ public:
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
+	void CompileParameters();
 
 	enum Side{
 		INSIDE = 0,
@@ -89,6 +90,19 @@ protected:
 	void computeBBox( SoAction* action, SbBox3f& box, SbVec3f& center);
 	void generatePrimitives(SoAction *action);
 	virtual ~ShapeTroughParabola();
+
+private:
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double focusLength;
+		double xMin;
+		double xMax;
+		double lengthXMin;
+		double lengthXMax;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /*SHAPETROUGHPARABOLA_H_*/
@@ -120,6 +120,7 @@ ShapeTrumpet::ShapeTrumpet()
 	m_truncationSensor->setPriority( 1 );
 	m_truncationSensor->attach( &truncationHeight );
 
+	CompileParameters();
 }
 
 /*!
@@ -178,9 +179,9 @@ QString ShapeTrumpet::GetIcon() const
  */
 bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
-	double a0 = a.getValue();
-	double tH = truncationHeight.getValue();
-	double hH = hyperbolaHeight.getValue();
+	double a0 = m_parameters.a;
+	double tH = m_parameters.truncationHeight;
+	double hH = m_parameters.hyperbolaHeight;
 
 	double b = m_bHyperbola;
 
@@ -335,6 +336,16 @@ Point3D ShapeTrumpet::Sample( double u, double v ) const
 	return Point3D( x, y, z  );
 }
 
+/*!
+ * Copies the trumpet fields used by Intersect.
+ */
+void ShapeTrumpet::CompileParameters()
+{
+	m_parameters.a = a.getValue();
+	m_parameters.truncationHeight = truncationHeight.getValue();
+	m_parameters.hyperbolaHeight = hyperbolaHeight.getValue();
+}
+
 /*!
  * Checks whether the defined aperture parameter is a valid parameter.
  */
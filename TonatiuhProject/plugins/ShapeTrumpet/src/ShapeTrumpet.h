@@ -65,6 +65,7 @@ public:
 	bool IntersectP( const Ray& objectRay ) const;
 
 	Point3D Sample( double u, double v ) const;
+	void CompileParameters();
 
 	enum Side{
 		INSIDE = 0,
@@ -108,6 +109,16 @@ private:
 	SoFieldSensor* m_fHSensor;
 	SoFieldSensor* m_heightSensor;
 	SoFieldSensor* m_truncationSensor;
+
+	//Parameters used by the intersection. See CompileParameters.
+	struct Parameters
+	{
+		double a;
+		double truncationHeight;
+		double hyperbolaHeight;
+	};
+
+	Parameters m_parameters;
 };
 
 #endif /* SHAPETRUMPET_H_ */
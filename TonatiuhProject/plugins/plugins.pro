@@ -9,6 +9,7 @@ SUBDIRS = ComponentHeliostatField \
 			MaterialStandardSpecular \
             MaterialStandardRoughSpecular \
             MaterialVirtual \
+			PhotonMapExportColumns \
 			PhotonMapExportDB \
 			PhotonMapExportFile \
 			PhotonMapExportNull\
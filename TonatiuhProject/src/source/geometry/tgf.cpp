@@ -37,6 +37,10 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
 #include <cmath>
+#include <iostream>
+
+#include <QApplication>
+#include <QMessageBox>
 
 #include <Inventor/nodes/SoTransform.h>
 
@@ -147,3 +151,18 @@ SbMatrix tgf::MatrixFromSoTransform( SoTransform* const & soTransform )
 
 }
 
+/*!
+ * Shows \a message in a warning message box with \a title.
+ *
+ * If the application has no graphical user interface, as tonatiuh-cli, the message is written to the standard error.
+ */
+void tgf::ShowWarning( QString title, QString message )
+{
+	if( !qobject_cast< QApplication* >( QCoreApplication::instance() ) )
+	{
+		std::cerr<<title.toStdString()<<": "<<message.toStdString()<<std::endl;
+		return;
+	}
+
+	QMessageBox::warning( 0, title, message );
+}
@@ -39,6 +39,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef TGF_H_
 #define TGF_H_
 
+class QString;
 class SbMatrix;
 class RandomDeviate;
 class SoTransform;
@@ -51,6 +52,7 @@ namespace tgf
 	Transform TransformFromMatrix( SbMatrix const& matrix );
 	Transform TransformFromSoTransform( SoTransform* const & soTransform );
 	SbMatrix MatrixFromSoTransform( SoTransform* const & soTransform );
+	void ShowWarning( QString title, QString message );
 }
 
 #endif /*TGF_H_*/
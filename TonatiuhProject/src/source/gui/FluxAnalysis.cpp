@@ -38,6 +38,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include <cmath>
 
+#include <QApplication>
 #include <QFileDialog>
 #include <QFutureWatcher>
 #include <QMutex>
@@ -57,6 +58,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include "gc.h"
 #include "RayTracer.h"
 #include "RayTracerNoTr.h"
+#include "RayTracingScheduler.h"
+#include "ScheduledRayTracer.h"
+#include "TraceScene.h"
 #include "TLightKit.h"
 #include "TLightShape.h"
 #include "Transform.h"
@@ -73,13 +77,14 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
  * Create FluxAnalysis object
  */
 FluxAnalysis::FluxAnalysis( TSceneKit* currentScene, SceneModel& currentSceneModel, InstanceNode* rootSeparatorInstance,
-		int sunWidthDivisions, int sunHeightDivisions, RandomDeviate* randomDeviate ):
+		int sunWidthDivisions, int sunHeightDivisions, RandomDeviate* randomDeviate, unsigned long* usedRandomStreams ):
 m_pCurrentScene( currentScene ),
 m_pCurrentSceneModel( &currentSceneModel ),
 m_pRootSeparatorInstance( rootSeparatorInstance ),
 m_sunWidthDivisions( sunWidthDivisions ),
 m_sunHeightDivisions( sunHeightDivisions ),
 m_pRandomDeviate( randomDeviate ),
+m_pUsedRandomStreams( usedRandomStreams ),
 m_pPhotonMap( 0 ),
 m_surfaceURL( "" ),
 m_tracedRays( 0 ),
@@ -284,57 +289,64 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 
 	m_pPhotonMap->SetConcentratorToWorld( m_pRootSeparatorInstance->GetIntersectionTransform() );
 
+	TraceScene traceScene;
+	traceScene.Compile( m_pRootSeparatorInstance );
+
 	QStringList disabledNodes = QString( lightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
 	QVector< QPair< TShapeKit*, Transform > > surfacesList;
 	trf::ComputeFistStageSurfaceList( m_pRootSeparatorInstance, disabledNodes, &surfacesList );
 	lightKit->ComputeLightSourceArea( m_sunWidthDivisions, m_sunHeightDivisions, surfacesList );
 	if( surfacesList.count() < 1 )	return;
 
-	QVector< long > raysPerThread;
-	int maximumValueProgressScale = 100;
-
-	unsigned long  t1 = nOfRays/ maximumValueProgressScale;
-	for( int progressCount = 0; progressCount < maximumValueProgressScale; ++ progressCount )
-		raysPerThread<< t1;
-
-	if( ( t1 * maximumValueProgressScale ) < nOfRays )	raysPerThread<< ( nOfRays - ( t1* maximumValueProgressScale) );
+	//Each block of rays uses its own random stream and the blocks are distributed between the threads as they run
+	RayTracingScheduler scheduler( nOfRays, *m_pUsedRandomStreams, QThread::idealThreadCount() );
+	*m_pUsedRandomStreams += scheduler.NumberOfBlocks();
+	QVector< int > workers = scheduler.Workers();
 
 	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
 	lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
 
-	// Create a progress dialog.
-	QProgressDialog dialog;
-	dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThread::idealThreadCount() ) );
-
-	// Create a QFutureWatcher and conncect signals and slots.
-	QFutureWatcher< void > futureWatcher;
-	QObject::connect(&futureWatcher, SIGNAL(finished()), &dialog, SLOT(reset()));
-	QObject::connect(&dialog, SIGNAL(canceled()), &futureWatcher, SLOT(cancel()));
-	QObject::connect(&futureWatcher, SIGNAL(progressRangeChanged(int, int)), &dialog, SLOT(setRange(int, int)));
-	QObject::connect(&futureWatcher, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
-
 	QMutex mutex;
-	QMutex mutexPhotonMap;
+	m_pPhotonMap->StartStore();
 	QFuture< void > photonMap;
 	if( transmissivity )
-		photonMap = QtConcurrent::map( raysPerThread, RayTracer( m_pRootSeparatorInstance,
+		photonMap = QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracer >( &scheduler, RayTracer( &traceScene,
 							 lightInstance, raycastingSurface, sunShape, lightToWorld,
 							 transmissivity,
 							 *m_pRandomDeviate,
-							 &mutex, m_pPhotonMap, &mutexPhotonMap,
-							 exportSuraceList ) );
+							 &mutex, m_pPhotonMap,
+							 exportSuraceList ) ) );
 	else
-		photonMap = QtConcurrent::map( raysPerThread, RayTracerNoTr( m_pRootSeparatorInstance,
+		photonMap = QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracerNoTr >( &scheduler, RayTracerNoTr( &traceScene,
 						lightInstance, raycastingSurface, sunShape, lightToWorld,
 						*m_pRandomDeviate,
-						&mutex, m_pPhotonMap, &mutexPhotonMap,
-						exportSuraceList ) );
-
-	futureWatcher.setFuture( photonMap );
+						&mutex, m_pPhotonMap,
+						exportSuraceList ) ) );
 
-	// Display the dialog and start the event loop.
-	dialog.exec();
-	futureWatcher.waitForFinished();
+	//The progress dialog is only shown when there is a graphical application, the command line tracer just waits
+	if( qobject_cast< QApplication* >( QCoreApplication::instance() ) )
+	{
+		// Create a progress dialog.
+		QProgressDialog dialog;
+		dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThread::idealThreadCount() ) );
+
+		// Create a QFutureWatcher and conncect signals and slots.
+		QFutureWatcher< void > futureWatcher;
+		QObject::connect(&futureWatcher, SIGNAL(finished()), &dialog, SLOT(reset()));
+		QObject::connect(&dialog, SIGNAL(canceled()), &futureWatcher, SLOT(cancel()));
+		QObject::connect(&dialog, SIGNAL(canceled()), &scheduler, SLOT(Cancel()));
+		QObject::connect(&scheduler, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+		dialog.setRange( 0, 100 );
+
+		futureWatcher.setFuture( photonMap );
+
+		// Display the dialog and start the event loop.
+		dialog.exec();
+	}
+	photonMap.waitForFinished();
+	m_pPhotonMap->FinishStore();
 
 	m_tracedRays += nOfRays;
 
@@ -449,15 +461,15 @@ void FluxAnalysis::FluxAnalysisCylinder( InstanceNode* node )
 	m_xmax = phiMax  * radius;
 	m_ymax = length;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
+	const std::vector< Photon >& photonList = m_pPhotonMap->GetAllPhotons();
 	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
-		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		const Photon& photon = photonList[p];
+		if( photon.side == activeSideID )
 		{
 			totalPhotons++;
-			Point3D photonLocalCoord = worldToObject( photon->pos );
+			Point3D photonLocalCoord = worldToObject( photon.pos );
 			double phi  = atan2( photonLocalCoord.y, photonLocalCoord.x );
 			if( phi < 0.0 ) phi += 2* gc::Pi;
 			double arcLength = phi * radius;
@@ -532,15 +544,15 @@ void FluxAnalysis::FluxAnalysisFlatDisk( InstanceNode* node )
 	m_xmax = radius;
 	m_ymax = radius;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
+	const std::vector< Photon >& photonList = m_pPhotonMap->GetAllPhotons();
 	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
-		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		const Photon& photon = photonList[p];
+		if( photon.side == activeSideID )
 		{
 			totalPhotons++;
-			Point3D photonLocalCoord = worldToObject( photon->pos );
+			Point3D photonLocalCoord = worldToObject( photon.pos );
 			int xbin = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax - m_xmin ) * m_widthDivisions );
 			int ybin = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * m_heightDivisions );
 			m_photonCounts[ybin][xbin] += 1;
@@ -615,15 +627,15 @@ void FluxAnalysis::FluxAnalysisFlatRectangle( InstanceNode* node )
 	m_xmax = 0.5 * surfaceHeight;
 	m_ymax = 0.5 * surfaceWidth;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
+	const std::vector< Photon >& photonList = m_pPhotonMap->GetAllPhotons();
 	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
-		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		const Photon& photon = photonList[p];
+		if( photon.side == activeSideID )
 		{
 			totalPhotons++;
-			Point3D photonLocalCoord = worldToObject( photon->pos );
+			Point3D photonLocalCoord = worldToObject( photon.pos );
 			int xbin = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax - m_xmin ) * m_widthDivisions ) ;
 			int ybin = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * m_heightDivisions );
 
@@ -51,7 +51,7 @@ class FluxAnalysis
 
 public:
 	FluxAnalysis( TSceneKit* currentScene, SceneModel& currentSceneModel, InstanceNode* rootSeparatorInstance,
-			int sunWidthDivisions, int sunHeightDivisions, RandomDeviate* randomDeviate);
+			int sunWidthDivisions, int sunHeightDivisions, RandomDeviate* randomDeviate, unsigned long* usedRandomStreams );
 	~FluxAnalysis();
 	QString GetSurfaceType( QString nodeURL );
 	void RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned long nOfRays, bool increasePhotonMap, int heightDivisions, int widthDivisions );
@@ -84,6 +84,7 @@ private:
 	int m_sunWidthDivisions;
 	int m_sunHeightDivisions;
 	RandomDeviate* m_pRandomDeviate;
+	unsigned long* m_pUsedRandomStreams;
 
 	TPhotonMap* m_pPhotonMap;
 
@@ -78,7 +78,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 FluxAnalysisDialog::FluxAnalysisDialog( TSceneKit* currentScene, SceneModel& currentSceneModel,
 		InstanceNode* rootSeparatorInstance,
 		int sunWidthDivisions, int sunHeightDivisions,
-		RandomDeviate* randomDeviate,  QWidget* parent  )
+		RandomDeviate* randomDeviate, unsigned long* usedRandomStreams, QWidget* parent  )
 :QDialog( parent),
  m_currentSurfaceURL( "" ),
  m_pCurrentSceneModel( &currentSceneModel ),
@@ -87,7 +87,7 @@ FluxAnalysisDialog::FluxAnalysisDialog( TSceneKit* currentScene, SceneModel& cur
  m_pNOfRays ( 0 ),
  m_fluxLabelString( QString( "Flux((unit power)/(unit length)^2)"))
 {
-	m_fluxAnalysis = new FluxAnalysis( currentScene, currentSceneModel, rootSeparatorInstance, sunWidthDivisions, sunHeightDivisions, randomDeviate );
+	m_fluxAnalysis = new FluxAnalysis( currentScene, currentSceneModel, rootSeparatorInstance, sunWidthDivisions, sunHeightDivisions, randomDeviate, usedRandomStreams );
 	setupUi( this );
 
 	QSize windowSize = size();
@@ -60,7 +60,7 @@ class FluxAnalysisDialog: public QDialog, private Ui::FluxAnalysisDialog
 public:
 	FluxAnalysisDialog( TSceneKit* currentScene, SceneModel& currentSceneModel, InstanceNode* rootSeparatorInstance,
 			int sunWidthDivisions, int sunHeightDivisions,
-			RandomDeviate* randomDeviate, QWidget* parent = 0 );
+			RandomDeviate* randomDeviate, unsigned long* usedRandomStreams, QWidget* parent = 0 );
 	~FluxAnalysisDialog();
 
 protected:
@@ -42,27 +42,23 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
 
 #include "BBox.h"
-#include "DifferentialGeometry.h"
 #include "InstanceNode.h"
-#include "Ray.h"
 #include "tgf.h"
-#include "TMaterial.h"
 #include "Transform.h"
-#include "TShape.h"
-#include "TShapeKit.h"
 #include "TLightKit.h"
 #include "TTracker.h"
 #include "TTrackerForAiming.h"
 
 
 InstanceNode::InstanceNode( SoNode* node )
-: m_coinNode( node ), m_parent( 0 )
+: m_coinNode( node ), m_parent( 0 ), m_pIntersectionData( 0 )
 {
 }
 
 InstanceNode::~InstanceNode()
 {
 		qDeleteAll( children );
+		delete m_pIntersectionData;
 }
 
 /**
@@ -106,82 +102,6 @@ void InstanceNode::InsertChild( int row, InstanceNode* instanceChild)
    instanceChild->SetParent(this);
 }
 
-
-//bool InstanceNode::Intersect( const Ray& ray, RandomDeviate& rand, InstanceNode** modelNode, Ray* outputRay )
-bool InstanceNode::Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay )
-{
-
-	//Check if the ray intersects with the BoundingBox
-   if( !m_bbox.IntersectP(ray) ) return false;
-   if( !GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
-   {
-
-      bool isOutputRay = false;
-      double t = ray.maxt;
-      for( int index = 0; index < children.size(); ++index )
-      {
-         InstanceNode* intersectedChild = 0;
-         Ray childOutputRay;
-         bool childShapreFront = true;
-         bool isChildOutputRay = children[index]->Intersect( ray, rand, &childShapreFront, &intersectedChild, &childOutputRay );
-
-         if( ray.maxt < t )
-         {
-            t = ray.maxt;
-            *modelNode = intersectedChild;
-            *isShapeFront = childShapreFront;
-
-            *outputRay = childOutputRay;
-            isOutputRay = isChildOutputRay;
-
-         }
-      }
-
-      return isOutputRay;
-
-   }
-	else
-	{
-		Ray childCoordinatesRay( m_transformWTO( ray ) );
-
-		TShape* tshape = 0;
-		TMaterial* tmaterial = 0;
-		if( children[0]->GetNode()->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )
-		{
-			tshape = static_cast< TShape* >( children[0]->GetNode() );
-			if( children.size() > 1 )	tmaterial = static_cast< TMaterial* > ( children[1]->GetNode() );
-		}
-		else if(  children.count() > 1 )
-		{
-			tmaterial = static_cast< TMaterial* > ( children[0]->GetNode() );
-			tshape = static_cast< TShape* >( children[1]->GetNode() );
-		}
-
-		if( tshape )
-		{
-			 double thit = 0.0;
-			 DifferentialGeometry dg;
-			 if( !tshape->Intersect( childCoordinatesRay, &thit, &dg ) ) return false;
-
-			 ray.maxt = thit;
-			 *modelNode = this;
-
-			 *isShapeFront = dg.shapeFrontSide;
-
-			 if( tmaterial )
-			 {
-				 Ray surfaceOutputRay;
-				 if( tmaterial->OutputRay( childCoordinatesRay, &dg, rand, &surfaceOutputRay ) )
-				 {
-					 *outputRay = m_transformOTW( surfaceOutputRay );
-					 return true;
-				 }
-			}
-      }
-   }
-	return false;
-}
-
 void InstanceNode::DisconnectAllTrackers()
 {
 	//RecursivlyApply<TTracker>(&TTracker::Disconnect);
@@ -209,26 +129,35 @@ void InstanceNode::extendBoxForLight( SbBox3f * extendedBox )
 
 BBox InstanceNode::GetIntersectionBBox()
 {
-	return m_bbox;
+	if( !m_pIntersectionData ) return BBox();
+	return m_pIntersectionData->bbox;
 }
 
 Transform InstanceNode::GetIntersectionTransform()
 {
-	return m_transformWTO;
+	if( !m_pIntersectionData ) return Transform();
+	return m_pIntersectionData->worldToObject;
 }
 
 void InstanceNode::SetIntersectionBBox( BBox nodeBBox )
 {
-	m_bbox = nodeBBox;
+	GetIntersectionData()->bbox = nodeBBox;
 }
 /**
  * Set node world to object transform to \a nodeTransform .
  */
 void InstanceNode::SetIntersectionTransform( Transform nodeTransform )
 {
+	GetIntersectionData()->worldToObject = nodeTransform;
+}
 
-	m_transformWTO = nodeTransform;
-	m_transformOTW = m_transformWTO.GetInverse();
+/**
+ * Returns the node intersection data. The data is created the first time the node is placed in the scene.
+ */
+InstanceNode::IntersectionData* InstanceNode::GetIntersectionData()
+{
+	if( !m_pIntersectionData ) m_pIntersectionData = new IntersectionData;
+	return m_pIntersectionData;
 }
 
 QDataStream& operator<< ( QDataStream & s, const InstanceNode& node )
@@ -285,7 +214,7 @@ template<class T,class Param1> void InstanceNode::RecursivlyApplyWithMto(void (T
 	if (GetNode()->getTypeId().isDerivedFrom( T::getClassTypeId() ) )
 	{
 	   T * elem = static_cast< T* > ( GetNode() );
-	   (elem->*func)(&m_transformWTO, param1);
+	   (elem->*func)(&m_pIntersectionData->worldToObject, param1);
 	}
 	else
 	{
@@ -300,7 +229,7 @@ template<class T,class Param1,class Param2> void InstanceNode::RecursivlyApplyWi
 	if (GetNode()->getTypeId().isDerivedFrom( T::getClassTypeId() ) )
 	{
 	   T * elem = static_cast< T* > ( GetNode() );
-	   (elem->*func)(&m_transformWTO, param1,param2);
+	   (elem->*func)(&m_pIntersectionData->worldToObject, param1,param2);
 	}
 	else
 	{
@@ -49,8 +49,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "BBox.h"
 #include "Transform.h"
 
-class RandomDeviate;
-class Ray;
 class SoNode;
 class TLightKit;
 class SceneModel;
@@ -77,8 +75,6 @@ public:
     QString GetNodeURL() const;
     void Print( int level ) const;
 
-    bool Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay );
-
     //template<class T> void RecursivlyApply(void (T::*func)(void));
     //template<class T,class Param1> void RecursivlyApply(void (T::*func)(Param1),Param1 param1);
     //template<class T,class Param1> void RecursivlyApplyWithMto(void (T::*func)(Param1),Param1 param1);
@@ -96,11 +92,24 @@ public:
     QVector< InstanceNode* > children;
 
 private:
+    //! Intersection data of the nodes that take part in the ray tracing.
+    /*!
+     * Only the separator and surface nodes have it, the shape, material and tracker instances are left without it.
+     * The object to world transform is not stored, Transform::GetInverse returns it from \a worldToObject.
+     */
+    struct IntersectionData
+    {
+        BBox bbox;
+        Transform worldToObject;
+    };
+
+    InstanceNode( const InstanceNode& );
+    InstanceNode& operator=( const InstanceNode& );
+    IntersectionData* GetIntersectionData();
+
     SoNode* m_coinNode;
     InstanceNode* m_parent;
-    BBox m_bbox;
-    Transform m_transformWTO;
-    Transform m_transformOTW;
+    IntersectionData* m_pIntersectionData;
 };
 
 QDataStream & operator<< ( QDataStream & s, const InstanceNode& node );
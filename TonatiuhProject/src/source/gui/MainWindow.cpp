@@ -40,6 +40,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <QCloseEvent>
 #include <QDir>
+#include <QFile>
 #include <QFileDialog>
 #include <QFuture>
 #include <QFutureWatcher>
@@ -49,6 +50,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QProgressDialog>
 #include <QSettings>
 #include <QtConcurrentMap>
+#include <QTextStream>
 #include <QTime>
 #include <QUndoStack>
 #include <QUndoView>
@@ -119,9 +121,13 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "RayTraceDialog.h"
 #include "RayTracer.h"
 #include "RayTracerNoTr.h"
+#include "RayTracingScheduler.h"
+#include "ScheduledRayTracer.h"
+#include "TraceScene.h"
 #include "SceneModel.h"
 #include "ScriptEditorDialog.h"
 #include "SunPositionCalculatorDialog.h"
+#include "SunPositionSweep.h"
 #include "TComponentFactory.h"
 #include "TDefaultTracker.h"
 #include "tgf.h"
@@ -171,6 +177,7 @@ m_sceneModel( 0 ),
 m_selectionModel( 0 ),
 m_rand( 0 ),
 m_selectedRandomDeviate( -1 ),
+m_usedRandomStreams( 0 ),
 m_bufferPhotons( 5000000 ),
 m_increasePhotonMap( false ),
 m_pExportModeSettings( 0 ),
@@ -183,6 +190,7 @@ m_coinNode_Buffer( 0 ),
 m_manipulators_Buffer( 0 ),
 m_tracedRays( 0 ),
 m_raysPerIteration( 10000 ),
+m_rayPacketMode( false ),
 m_heightDivisions( 200 ),
 m_widthDivisions( 200 ),
 m_drawPhotons( false ),
@@ -594,9 +602,9 @@ void MainWindow::RunFluxAnalysisRayTracer()
 	}
 
 	//Create the random generator
-	RandomDeviate* 	pRandomDeviate =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+	if( !m_rand )	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
 
-	FluxAnalysisDialog dialog( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, pRandomDeviate );
+	FluxAnalysisDialog dialog( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand, &m_usedRandomStreams );
 	dialog.exec();
 
 }
@@ -1855,6 +1863,9 @@ void MainWindow::Run()
 
 		m_pPhotonMap->SetConcentratorToWorld( rootSeparatorInstance->GetIntersectionTransform() );
 
+		TraceScene traceScene;
+		traceScene.Compile( rootSeparatorInstance );
+
 		TLightKit* light = static_cast< TLightKit* > ( lightInstance->GetNode() );
 		QStringList disabledNodes = QString( light->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
 		QVector< QPair< TShapeKit*, Transform > > surfacesList;
@@ -1868,13 +1879,10 @@ void MainWindow::Run()
 			return;
 		}
 
-		QVector< long > raysPerThread;
-		int maximumValueProgressScale = 100;
-		unsigned long  t1 = m_raysPerIteration / maximumValueProgressScale;
-		for( int progressCount = 0; progressCount < maximumValueProgressScale; ++ progressCount )
-			raysPerThread<< t1;
-
-		if( ( t1 * maximumValueProgressScale ) < m_raysPerIteration )	raysPerThread<< ( m_raysPerIteration-( t1* maximumValueProgressScale) );
+		//Each block of rays uses its own random stream and the blocks are distributed between the threads as they run
+		RayTracingScheduler scheduler( m_raysPerIteration, m_usedRandomStreams, QThread::idealThreadCount() );
+		m_usedRandomStreams += scheduler.NumberOfBlocks();
+		QVector< int > workers = scheduler.Workers();
 
 
 		Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
@@ -1890,32 +1898,38 @@ void MainWindow::Run()
 		QFutureWatcher< void > futureWatcher;
 		QObject::connect(&futureWatcher, SIGNAL(finished()), &dialog, SLOT(reset()));
 		QObject::connect(&dialog, SIGNAL(canceled()), &futureWatcher, SLOT(cancel()));
-		QObject::connect(&futureWatcher, SIGNAL(progressRangeChanged(int, int)), &dialog, SLOT(setRange(int, int)));
-		QObject::connect(&futureWatcher, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+		QObject::connect(&dialog, SIGNAL(canceled()), &scheduler, SLOT(Cancel()));
+		QObject::connect(&scheduler, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+		dialog.setRange( 0, 100 );
 
 		QMutex mutex;
-		QMutex mutexPhotonMap;
+		m_pPhotonMap->StartStore();
 		QFuture< void > photonMap;
 		if( transmissivity )
-			 photonMap = QtConcurrent::map( raysPerThread, RayTracer(  rootSeparatorInstance,
+			 photonMap = QtConcurrent::map( workers,
+					ScheduledRayTracer< RayTracer >( &scheduler, RayTracer(  &traceScene,
 							 lightInstance, raycastingSurface, sunShape, lightToWorld,
 							 transmissivity,
 							 *m_rand,
-							 &mutex, m_pPhotonMap, &mutexPhotonMap,
-							 exportSuraceList ) );
+							 &mutex, m_pPhotonMap,
+							 exportSuraceList,
+							 m_rayPacketMode ) ) );
 
 		else
-			photonMap = QtConcurrent::map( raysPerThread, RayTracerNoTr(  rootSeparatorInstance,
+			photonMap = QtConcurrent::map( workers,
+					ScheduledRayTracer< RayTracerNoTr >( &scheduler, RayTracerNoTr(  &traceScene,
 						lightInstance, raycastingSurface, sunShape, lightToWorld,
 						*m_rand,
-						&mutex, m_pPhotonMap, &mutexPhotonMap,
-						exportSuraceList ) );
+						&mutex, m_pPhotonMap,
+						exportSuraceList,
+						m_rayPacketMode ) ) );
 
 		futureWatcher.setFuture( photonMap );
 
 		// Display the dialog and start the event loop.
 		dialog.exec();
 		futureWatcher.waitForFinished();
+		m_pPhotonMap->FinishStore();
 
 		m_tracedRays += m_raysPerIteration;
 
@@ -1940,6 +1954,23 @@ void MainWindow::Run()
 	std::cout <<"Elapsed time: "<< startTime.secsTo( endTime ) << std::endl;
 }
 
+/*!
+ * Runs a ray tracing for each hour of the \a year with sun for the location given by \a latitude and \a longitude
+ * coordinates in degrees. The power of the surfaces with the urls in \a surfaceNodes, separated by ';', is saved
+ * in the \a resultsFile for each hour.
+ */
+void MainWindow::RunAnnualSunPositionSweep( int year, double latitude, double longitude, QString surfaceNodes, QString resultsFile )
+{
+	if( ( longitude < -180. ) || ( longitude > 180.  ) ||
+			( latitude < -90. ) || ( latitude > 90.  ) )
+	{
+		emit Abort( tr( "RunAnnualSunPositionSweep: Not valid location defined." ) );
+		return;
+	}
+
+	TraceSunPositions( SunPositionSweep::HourlySunPositions( year, latitude, longitude ), surfaceNodes, resultsFile );
+}
+
 /*
  * Runs ray trace to calculate a flux distribution map in the surface of the node \a nodeURL related to the side \a surfaceSide.
  * The map will be calculated with the parameters \a nOfRays, \a heightDivisions and \a heightDivisions.
@@ -1967,7 +1998,7 @@ void MainWindow::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned
 	//Create the random generator
 	if( !m_rand )	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
 
-	FluxAnalysis fluxAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand );
+	FluxAnalysis fluxAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand, &m_usedRandomStreams );
 
 	fluxAnalysis.RunFluxAnalysis( nodeURL, surfaceSide, nOfRays, false, heightDivisions, widthDivisions );
 
@@ -1981,6 +2012,24 @@ void MainWindow::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned
 	fluxAnalysis.ExportAnalysis( directory, fileName, saveCoords );
 }
 
+/*!
+ * Runs a ray tracing for each sun position defined in the \a sunPositionsFile. The power of the surfaces with the urls
+ * in \a surfaceNodes, separated by ';', is saved in the \a resultsFile for each position.
+ *
+ * \sa SunPositionSweep::ReadSunPositions.
+ */
+void MainWindow::RunSunPositionSweep( QString sunPositionsFile, QString surfaceNodes, QString resultsFile )
+{
+	QVector< QPair< double, double > > sunPositions;
+	if( !SunPositionSweep::ReadSunPositions( sunPositionsFile, &sunPositions ) )
+	{
+		emit Abort( tr( "RunSunPositionSweep: Cannot read the sun positions file %1." ).arg( sunPositionsFile ) );
+		return;
+	}
+
+	TraceSunPositions( sunPositions, surfaceNodes, resultsFile );
+}
+
 /*!
  * Saves current tonatiuh model into \a fileName file.
  */
@@ -2174,6 +2223,7 @@ void MainWindow::SetRandomDeviateType( QString typeName )
 	{
 		delete m_rand;
 		m_rand = 0;
+		m_usedRandomStreams = 0;
 	}
 
 }
@@ -2187,6 +2237,15 @@ void MainWindow::SetRayCastingGrid( int widthDivisions, int heightDivisions )
 	m_heightDivisions = heightDivisions;
 }
 
+/*!
+ * Sets if the rays from the light are intersected with the scene in packets. If \a enabled is true,
+ * the rays are traced in groups until their first intersection with the packet kernels of the shapes.
+ */
+void MainWindow::SetRayPacketMode( bool enabled )
+{
+	m_rayPacketMode = enabled;
+}
+
 /*!
  * Sets the parameters to represent the ray tracer results.
  * Tonatiuh draws the \a raysFaction faction of traced rays. If \a drawPhotons is true all photons are represented.
@@ -3926,6 +3985,78 @@ QString MainWindow::StrippedName( const QString& fullFileName )
 	return QFileInfo( fullFileName ).fileName();
 }
 
+/*!
+ * Traces the scene for each sun position of \a sunPositions, as azimuth and elevation in degrees, with the current
+ * ray tracing options. The power of the surfaces with the urls in \a surfaceNodes is saved in \a resultsFile.
+ *
+ * The sun is moved back to its position when the sweep finishes.
+ */
+void MainWindow::TraceSunPositions( QVector< QPair< double, double > > sunPositions, QString surfaceNodes, QString resultsFile )
+{
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	if ( !coinScene )  return;
+
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	if ( !lightKit )
+	{
+		emit Abort( tr( "RunSunPositionSweep: Sun not defined in scene." ) );
+		return;
+	}
+
+	InstanceNode* rootSeparatorInstance = m_sceneModel->NodeFromIndex( sceneModelView->rootIndex() );
+	if ( !rootSeparatorInstance )  return;
+
+	QVector< InstanceNode* > surfaces;
+	QStringList surfacesURL = surfaceNodes.split( ";", QString::SkipEmptyParts );
+	for( int s = 0; s < surfacesURL.count(); ++s )
+	{
+		QModelIndex nodeIndex = m_sceneModel->IndexFromNodeUrl( surfacesURL[s] );
+		if( !nodeIndex.isValid() )
+		{
+			emit Abort( tr( "RunSunPositionSweep: %1 is not a valid node." ).arg( surfacesURL[s] ) );
+			return;
+		}
+		surfaces.push_back( m_sceneModel->NodeFromIndex( nodeIndex ) );
+	}
+	if( surfaces.count() < 1 )
+	{
+		emit Abort( tr( "RunSunPositionSweep: There are no surfaces defined." ) );
+		return;
+	}
+
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+	//Check if there is a random generator selected;
+	if( m_selectedRandomDeviate == -1 )
+	{
+		if( randomDeviateFactoryList.size() > 0 ) m_selectedRandomDeviate = 0;
+		else	return;
+	}
+
+	//Create the random generator
+	if( !m_rand )	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+
+	QFile results( resultsFile );
+	if( !results.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		emit Abort( tr( "RunSunPositionSweep: Cannot open file %1." ).arg( resultsFile ) );
+		return;
+	}
+	QTextStream out( &results );
+
+	double azimuth = lightKit->azimuth.getValue();
+	double zenith = lightKit->zenith.getValue();
+
+	SunPositionSweep sweep( coinScene, rootSeparatorInstance, *m_rand, surfaces, m_widthDivisions, m_heightDivisions );
+	sweep.SetFirstRandomStream( m_usedRandomStreams );
+	sweep.SetRayPacketMode( m_rayPacketMode );
+	if( !sweep.Run( sunPositions, m_raysPerIteration, out ) )
+		emit Abort( tr( "RunSunPositionSweep: The scene is not ready for ray tracing." ) );
+	m_usedRandomStreams = sweep.GetUsedRandomStreams();
+
+	lightKit->ChangePosition( azimuth, zenith );
+	UpdateLightSize();
+}
+
 /*!
  * Computes the new light size to the scene current dimensions.
  */
@@ -119,7 +119,9 @@ public slots:
 	void PasteCopy();
 	void PasteLink();
 	void Run();
+	void RunAnnualSunPositionSweep( int year, double latitude, double longitude, QString surfaceNodes, QString resultsFile );
 	void RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords );
+	void RunSunPositionSweep( QString sunPositionsFile, QString surfaceNodes, QString resultsFile );
 	bool Save();
 	void SaveComponent( QString componentFileName  );
 	void SaveAs( QString fileName );
@@ -138,6 +140,7 @@ public slots:
     void SetPhotonMapBufferSize( unsigned int nPhotons );
     void SetRandomDeviateType( QString typeName );
     void SetRayCastingGrid( int widthDivisions, int heightDivisions );
+    void SetRayPacketMode( bool enabled );
     void SetRaysDrawingOptions( bool drawRays, bool drawPhotons );
     void SetRaysPerIteration( unsigned int rays );
     void SetSunshape( QString sunshapeType );
@@ -255,6 +258,7 @@ private:
 	void ShowRaysIn3DView();
     bool StartOver( const QString& fileName );
     QString StrippedName( const QString& fullFileName );
+    void TraceSunPositions( QVector< QPair< double, double > > sunPositions, QString surfaceNodes, QString resultsFile );
     void UpdateLightSize();
     void UpdateRecentFileActions();
     void WriteSettings();
@@ -275,6 +279,7 @@ private:
 
     RandomDeviate* m_rand;
     int m_selectedRandomDeviate;
+    unsigned long m_usedRandomStreams;
 
 
     unsigned long m_bufferPhotons;
@@ -292,6 +297,7 @@ private:
 
     unsigned long m_tracedRays;
     unsigned long m_raysPerIteration;
+    bool m_rayPacketMode;
     int m_heightDivisions;
     int m_widthDivisions;
 
@@ -44,6 +44,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QStringList>
 
 #include "Photon.h"
+#include "PhotonMapSurfaceIdentifier.h"
 
 class SceneModel;
 
@@ -55,7 +56,7 @@ public:
 	virtual ~PhotonMapExport();
 
 	virtual void EndExport() = 0;
-	virtual void SavePhotonMap( std::vector < Photon* > raysLists ) = 0;
+	virtual void SavePhotonMap( const std::vector< Photon >& raysLists ) = 0;
 	void SetConcentratorToWorld( Transform concentratorToWorld );
 	virtual void SetPowerPerPhoton( double wPhoton ) = 0;
 
@@ -81,6 +82,7 @@ protected:
 	bool m_saveSide;
 	bool m_saveSurfaceID;
 	QStringList m_saveSurfacesURLList;
+	PhotonMapSurfaceIdentifier m_surfaceIdentifier;
 
 };
 
@@ -0,0 +1,105 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "InstanceNode.h"
+#include "PhotonMapSurfaceIdentifier.h"
+
+/*!
+ * Creates an empty surface identifier.
+ */
+PhotonMapSurfaceIdentifier::PhotonMapSurfaceIdentifier()
+:m_lastSurface( 0 ),
+ m_lastSurfaceID( 0 ),
+ m_identity( 1.0, 0.0, 0.0, 0.0,
+		0.0, 1.0, 0.0, 0.0,
+		0.0, 0.0, 1.0, 0.0,
+		0.0, 0.0, 0.0, 1.0 )
+{
+
+}
+
+/*!
+ * Destroys the surface identifier.
+ */
+PhotonMapSurfaceIdentifier::~PhotonMapSurfaceIdentifier()
+{
+
+}
+
+/*!
+ * Removes all the assigned identifiers. The next surface will get the identifier 1.
+ */
+void PhotonMapSurfaceIdentifier::Clear()
+{
+	m_surfaceIDs.clear();
+	m_surfaces.clear();
+	m_surfacesWorldToObject.clear();
+	m_lastSurface = 0;
+	m_lastSurfaceID = 0;
+}
+
+/*!
+ * Returns the number of surfaces with identifier.
+ */
+int PhotonMapSurfaceIdentifier::GetNumberOfSurfaces() const
+{
+	return m_surfaces.size();
+}
+
+/*!
+ * Returns the surface with identifier \a surfaceID, or null if there is not any surface with this identifier.
+ */
+InstanceNode* PhotonMapSurfaceIdentifier::GetSurface( unsigned long surfaceID ) const
+{
+	if( ( surfaceID < 1 ) || ( surfaceID > ( unsigned long ) m_surfaces.size() ) ) return 0;
+	return m_surfaces[surfaceID - 1];
+}
+
+/*!
+ * Assigns the next identifier to \a surface and stores its world to object transform.
+ */
+unsigned long PhotonMapSurfaceIdentifier::InsertSurface( InstanceNode* surface )
+{
+	m_surfaces.push_back( surface );
+	m_surfacesWorldToObject.push_back( surface->GetIntersectionTransform() );
+
+	unsigned long surfaceID = m_surfaces.size();
+	m_surfaceIDs.insert( surface, surfaceID );
+	return surfaceID;
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PHOTONMAPSURFACEIDENTIFIER_H_
+#define PHOTONMAPSURFACEIDENTIFIER_H_
+
+#include <QHash>
+#include <QVector>
+
+#include "Transform.h"
+
+class InstanceNode;
+
+//!  PhotonMapSurfaceIdentifier class assigns the identifiers of the surfaces intersected by the exported photons.
+/*!
+ * The surfaces are numbered from 1 in the order they are found, 0 is kept for the photons without surface.
+ * The identifiers are stored in a hash, so each photon surface is resolved in constant time. The world to object
+ * transform of each surface is saved with its identifier to export the photons in local coordinates.
+*/
+class PhotonMapSurfaceIdentifier
+{
+
+public:
+	PhotonMapSurfaceIdentifier();
+	~PhotonMapSurfaceIdentifier();
+
+	void Clear();
+	int GetNumberOfSurfaces() const;
+	InstanceNode* GetSurface( unsigned long surfaceID ) const;
+	unsigned long GetSurfaceID( InstanceNode* surface, bool* isNewSurface = 0 );
+	const Transform& GetWorldToObject( unsigned long surfaceID ) const;
+
+private:
+	unsigned long InsertSurface( InstanceNode* surface );
+
+	QHash< InstanceNode*, unsigned long > m_surfaceIDs;
+	QVector< InstanceNode* > m_surfaces;
+	QVector< Transform > m_surfacesWorldToObject;
+	InstanceNode* m_lastSurface;
+	unsigned long m_lastSurfaceID;
+	Transform m_identity;
+
+};
+
+/*!
+ * Returns the identifier of \a surface, assigning the next one if it has not been found before.
+ * \a isNewSurface is set to true when the identifier has been assigned in this call.
+ *
+ * Returns 0 for a null \a surface.
+ */
+inline unsigned long PhotonMapSurfaceIdentifier::GetSurfaceID( InstanceNode* surface, bool* isNewSurface )
+{
+	if( isNewSurface ) *isNewSurface = false;
+	if( !surface ) return 0;
+
+	//Consecutive photons usually hit the same surface
+	if( surface == m_lastSurface ) return m_lastSurfaceID;
+
+	QHash< InstanceNode*, unsigned long >::const_iterator it = m_surfaceIDs.find( surface );
+	if( it != m_surfaceIDs.end() )	m_lastSurfaceID = it.value();
+	else
+	{
+		m_lastSurfaceID = InsertSurface( surface );
+		if( isNewSurface ) *isNewSurface = true;
+	}
+
+	m_lastSurface = surface;
+	return m_lastSurfaceID;
+}
+
+/*!
+ * Returns the world to object transform of the surface with identifier \a surfaceID.
+ * The identity is returned for the identifier 0.
+ */
+inline const Transform& PhotonMapSurfaceIdentifier::GetWorldToObject( unsigned long surfaceID ) const
+{
+	if( surfaceID < 1 ) return m_identity;
+	return m_surfacesWorldToObject[surfaceID - 1];
+}
+
+#endif /* PHOTONMAPSURFACEIDENTIFIER_H_ */
@@ -37,7 +37,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
 #include <QIcon>
-#include <QMessageBox>
 
 #include <Inventor/actions/SoSearchAction.h>
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
@@ -59,6 +58,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "TShape.h"
 #include "TShapeKit.h"
 #include "TTracker.h"
+#include "tgf.h"
 
 /*!
  * Creates an empty model.
@@ -806,7 +806,7 @@ bool SceneModel::Paste( tgc::PasteType type, SoBaseKit& coinParent, SoNode& coin
 			TTracker* tracker = static_cast< TTracker* >( separatorKit->getPart( "tracker", false ) );
 			if (tracker)
 			{
-				QMessageBox::warning( 0, tr( "Tonatiuh warning" ), tr( "This TSeparatorKit already contains a tracker" ) );
+				tgf::ShowWarning( tr( "Tonatiuh warning" ), tr( "This TSeparatorKit already contains a tracker" ) );
 				return false;
 			}
 			coinParent.setPart( "tracker", coinChild );
@@ -820,7 +820,7 @@ bool SceneModel::Paste( tgc::PasteType type, SoBaseKit& coinParent, SoNode& coin
 
     		if (shape)
     		{
-    			QMessageBox::warning( 0, tr( "Tonatiuh warning" ), tr( "This TShapeKit already contains a shape" ) );
+    			tgf::ShowWarning( tr( "Tonatiuh warning" ), tr( "This TShapeKit already contains a shape" ) );
     			return false;
     		}
 			coinParent.setPart("shape", coinChild );
@@ -832,7 +832,7 @@ bool SceneModel::Paste( tgc::PasteType type, SoBaseKit& coinParent, SoNode& coin
 			TMaterial* material = static_cast< TMaterial* >( shapeKit->getPart( "material", false ) );
 			if (material)
     		{
-    			QMessageBox::warning( 0, tr( "Tonatiuh warning" ), tr( "This TShapeKit already contains a material" ) );
+    			tgf::ShowWarning( tr( "Tonatiuh warning" ), tr( "This TShapeKit already contains a material" ) );
     			return false;
     		}
 			coinParent.setPart("material", coinChild );
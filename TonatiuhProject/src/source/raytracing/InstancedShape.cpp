@@ -0,0 +1,310 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "DifferentialGeometry.h"
+#include "gf.h"
+#include "InstancedShape.h"
+#include "Ray.h"
+#include "RayPacket.h"
+
+namespace
+{
+	//The same tolerance of the shapes Intersect
+	const double tol = 0.00001;
+
+	/*!
+	 * Transforms \a ray to the object coordinates with the 3x4 matrix \a m.
+	 */
+	inline void TransformRay( const double* m, const Ray& ray, double origin[3], double direction[3] )
+	{
+		double x = ray.origin.x;
+		double y = ray.origin.y;
+		double z = ray.origin.z;
+		origin[0] = m[0]*x + m[1]*y + m[2]*z + m[3];
+		origin[1] = m[4]*x + m[5]*y + m[6]*z + m[7];
+		origin[2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+
+		x = ray.direction().x;
+		y = ray.direction().y;
+		z = ray.direction().z;
+		direction[0] = m[0]*x + m[1]*y + m[2]*z;
+		direction[1] = m[4]*x + m[5]*y + m[6]*z;
+		direction[2] = m[8]*x + m[9]*y + m[10]*z;
+	}
+
+	/*!
+	 * Returns true if the distance \a thit is valid for the ray with \a mint and the hit point \a x, \a z is inside
+	 * the rectangle of half lengths \a halfX and \a halfZ.
+	 */
+	inline bool IsInside( double thit, double mint, double x, double z, double halfX, double halfZ )
+	{
+		return !( ( thit - mint ) < tol || x < -halfX || x > halfX || z < -halfZ || z > halfZ );
+	}
+}
+
+/*!
+ * Creates an InstancedShape with type None.
+ */
+InstancedShape::InstancedShape()
+:type( None )
+{
+	parameters[0] = 0.0;
+	parameters[1] = 0.0;
+	parameters[2] = 0.0;
+}
+
+/*!
+ * Returns true if \a instancedShape has the same type and parameters, so the surfaces of both can share them.
+ */
+bool InstancedShape::operator==( const InstancedShape& instancedShape ) const
+{
+	return ( type == instancedShape.type ) && ( parameters[0] == instancedShape.parameters[0] ) &&
+			( parameters[1] == instancedShape.parameters[1] ) && ( parameters[2] == instancedShape.parameters[2] );
+}
+
+/*!
+ * Computes in \a dg the differential geometry of the intersection of \a objectRay, in the shape coordinates, at the distance
+ * \a tHit found by Intersect. The values are the ones the Intersect of the shape \a shape computes.
+ */
+void InstancedShape::GetDifferentialGeometry( const Ray& objectRay, double tHit, const TShape* shape, DifferentialGeometry* dg ) const
+{
+	Point3D hitPoint = objectRay( tHit );
+
+	if( type == FlatRectangle )
+	{
+		double height = 2.0 * parameters[0];
+		double width = 2.0 * parameters[1];
+
+		double u = ( hitPoint.x + parameters[0] ) / height;
+		double v = ( hitPoint.z + parameters[1] ) / width;
+
+		Vector3D dpdu( 0.0, 0.0, height );
+		Vector3D dpdv( width, 0.0, 0.0 );
+		*dg = DifferentialGeometry( hitPoint, dpdu, dpdv, Vector3D( 0.0, 0.0, 0.0 ), Vector3D( 0.0, 0.0, 0.0 ), u, v, shape );
+	}
+	else if( type == ParabolicRectangle )
+	{
+		double focus = parameters[0];
+		double wX = parameters[1];
+		double wZ = parameters[2];
+
+		double u = ( hitPoint.x / wX ) + 0.5;
+		double v = ( hitPoint.z / wZ ) + 0.5;
+
+		Vector3D dpdu( wX, ( ( -0.5 + u ) * wX * wX ) / ( 2 * focus ), 0 );
+		Vector3D dpdv( 0.0, ( ( -0.5 + v ) * wZ * wZ ) / ( 2 * focus ), wZ );
+
+		Vector3D d2Pduu( 0.0, ( wX * wX ) / ( 2 * focus ), 0.0 );
+		Vector3D d2Pdvv( 0.0, ( wZ * wZ ) / ( 2 * focus ), 0.0 );
+
+		// Compute \dndu and \dndv from fundamental form coefficients, d2Pduv is zero
+		double E = DotProduct( dpdu, dpdu );
+		double F = DotProduct( dpdu, dpdv );
+		double G = DotProduct( dpdv, dpdv );
+
+		NormalVector N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
+		double e = DotProduct( N, d2Pduu );
+		double f = 0.0;
+		double g = DotProduct( N, d2Pdvv );
+
+		double invEGF2 = 1.0 / ( E * G - F * F );
+		Vector3D dndu = ( f * F - e * G ) * invEGF2 * dpdu + ( e * F - f * E ) * invEGF2 * dpdv;
+		Vector3D dndv = ( g * F - f * G ) * invEGF2 * dpdu + ( f * F - g * E ) * invEGF2 * dpdv;
+
+		*dg = DifferentialGeometry( hitPoint, dpdu, dpdv, dndu, dndv, u, v, shape );
+	}
+
+	dg->shapeFrontSide = ( DotProduct( dg->normal, objectRay.direction() ) > 0 ) ? false : true;
+}
+
+/*!
+ * Intersects \a ray, in world coordinates, with the shape transformed by the 3x4 matrix \a worldToObject.
+ *
+ * Returns true if the ray intersects the shape between its mint and maxt and stores the distance in \a tHit.
+ */
+bool InstancedShape::Intersect( const double* worldToObject, const Ray& ray, double* tHit ) const
+{
+	double origin[3];
+	double direction[3];
+	TransformRay( worldToObject, ray, origin, direction );
+
+	if( type == FlatRectangle )
+	{
+		if( ( origin[1] == 0 ) && ( direction[1] == 0 ) )	return false;
+		double t = -origin[1] * ( 1.0 / direction[1] );
+		if( t > ray.maxt || t < ray.mint )	return false;
+
+		if( !IsInside( t, ray.mint, origin[0] + direction[0] * t, origin[2] + direction[2] * t,
+				parameters[0], parameters[1] ) )	return false;
+
+		*tHit = t;
+		return true;
+	}
+	else if( type == ParabolicRectangle )
+	{
+		double focus = parameters[0];
+		double halfX = parameters[1] / 2;
+		double halfZ = parameters[2] / 2;
+
+		double A = direction[0] * direction[0] + direction[2] * direction[2];
+		double B = 2.0 * ( direction[0] * origin[0] + direction[2] * origin[2] - 2 * focus * direction[1] );
+		double C = origin[0] * origin[0] + origin[2] * origin[2] - 4 * focus * origin[1];
+
+		double t0, t1;
+		if( !gf::Quadratic( A, B, C, &t0, &t1 ) )	return false;
+
+		if( t0 > ray.maxt || t1 < ray.mint )	return false;
+		double thit = ( t0 > ray.mint )? t0 : t1;
+		if( thit > ray.maxt )	return false;
+
+		if( !IsInside( thit, ray.mint, origin[0] + direction[0] * thit, origin[2] + direction[2] * thit, halfX, halfZ ) )
+		{
+			if( thit == t1 || t1 > ray.maxt )	return false;
+			thit = t1;
+			if( !IsInside( thit, ray.mint, origin[0] + direction[0] * thit, origin[2] + direction[2] * thit, halfX, halfZ ) )
+				return false;
+		}
+
+		*tHit = thit;
+		return true;
+	}
+
+	return false;
+}
+
+/*!
+ * Intersects the rays of \a rays with a bit set in \a raysMask with the shape transformed by the 3x4 matrix \a worldToObject.
+ * Returns a mask with the bit of each intersected ray set and stores its intersection distance in \a tHits.
+ *
+ * The rays are transformed and the flat and quadratic equations solved for all the rays together. These loops
+ * have no dependencies between rays, so the compiler vectorizes them.
+ */
+int InstancedShape::IntersectPacket( const double* worldToObject, const RayPacket& rays, int raysMask, double* tHits ) const
+{
+	const double* m = worldToObject;
+	double originX[RayPacket::Size];
+	double originY[RayPacket::Size];
+	double originZ[RayPacket::Size];
+	double directionX[RayPacket::Size];
+	double directionY[RayPacket::Size];
+	double directionZ[RayPacket::Size];
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		double x = rays.originX[i];
+		double y = rays.originY[i];
+		double z = rays.originZ[i];
+		originX[i] = m[0]*x + m[1]*y + m[2]*z + m[3];
+		originY[i] = m[4]*x + m[5]*y + m[6]*z + m[7];
+		originZ[i] = m[8]*x + m[9]*y + m[10]*z + m[11];
+
+		x = rays.directionX[i];
+		y = rays.directionY[i];
+		z = rays.directionZ[i];
+		directionX[i] = m[0]*x + m[1]*y + m[2]*z;
+		directionY[i] = m[4]*x + m[5]*y + m[6]*z;
+		directionZ[i] = m[8]*x + m[9]*y + m[10]*z;
+	}
+
+	int hitMask = 0;
+	if( type == FlatRectangle )
+	{
+		double halfX = parameters[0];
+		double halfZ = parameters[1];
+
+		double t[RayPacket::Size];
+		for( int i = 0; i < RayPacket::Size; ++i )
+			t[i] = -originY[i] * ( 1.0 / directionY[i] );
+
+		for( int i = 0; i < RayPacket::Size; ++i )
+		{
+			if( !( raysMask & ( 1 << i ) ) )	continue;
+			if( ( originY[i] == 0 ) && ( directionY[i] == 0 ) )	continue;
+			if( t[i] > rays.maxt[i] || t[i] < rays.mint[i] )	continue;
+			if( !IsInside( t[i], rays.mint[i], originX[i] + directionX[i] * t[i], originZ[i] + directionZ[i] * t[i], halfX, halfZ ) )
+				continue;
+
+			tHits[i] = t[i];
+			hitMask |= ( 1 << i );
+		}
+	}
+	else if( type == ParabolicRectangle )
+	{
+		double focus = parameters[0];
+		double halfX = parameters[1] / 2;
+		double halfZ = parameters[2] / 2;
+
+		double A[RayPacket::Size];
+		double B[RayPacket::Size];
+		double C[RayPacket::Size];
+		for( int i = 0; i < RayPacket::Size; ++i )
+		{
+			A[i] = directionX[i] * directionX[i] + directionZ[i] * directionZ[i];
+			B[i] = 2.0 * ( directionX[i] * originX[i] + directionZ[i] * originZ[i] - 2 * focus * directionY[i] );
+			C[i] = originX[i] * originX[i] + originZ[i] * originZ[i] - 4 * focus * originY[i];
+		}
+
+		double t0[RayPacket::Size];
+		double t1[RayPacket::Size];
+		int solvedMask = raysMask & gf::Quadratic( A, B, C, RayPacket::Size, t0, t1 );
+
+		for( int i = 0; i < RayPacket::Size; ++i )
+		{
+			if( !( solvedMask & ( 1 << i ) ) )	continue;
+
+			double mint = rays.mint[i];
+			double maxt = rays.maxt[i];
+			if( t0[i] > maxt || t1[i] < mint )	continue;
+			double thit = ( t0[i] > mint )? t0[i] : t1[i];
+			if( thit > maxt )	continue;
+
+			if( !IsInside( thit, mint, originX[i] + directionX[i] * thit, originZ[i] + directionZ[i] * thit, halfX, halfZ ) )
+			{
+				if( thit == t1[i] || t1[i] > maxt )	continue;
+				thit = t1[i];
+				if( !IsInside( thit, mint, originX[i] + directionX[i] * thit, originZ[i] + directionZ[i] * thit, halfX, halfZ ) )
+					continue;
+			}
+
+			tHits[i] = thit;
+			hitMask |= ( 1 << i );
+		}
+	}
+
+	return hitMask;
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef INSTANCEDSHAPE_H_
+#define INSTANCEDSHAPE_H_
+
+struct DifferentialGeometry;
+class Ray;
+struct RayPacket;
+class TShape;
+
+//!  InstancedShape struct describes a shape that TraceScene intersects with its own kernels.
+/*!
+  Heliostat fields have many surfaces with the same shape parameters that only differ by their transform.
+  A shape that returns an InstancedShape from TShape::GetInstancedShape is intersected by TraceScene with
+  the kernels of this struct: the shape parameters are shared by all the surfaces with the same parameters and
+  each surface only stores its world to object transform as a 3x4 matrix in a contiguous array. The kernels are
+  not virtual and make the same tests as the shape Intersect, and the differential geometry of the intersections
+  is computed as the shape Intersect does, so the shape is not called while tracing.
+
+  The parameters of each type are:
+  - FlatRectangle: half length along x, half length along z.
+  - ParabolicRectangle: focus length, length along x, length along z.
+*/
+
+struct InstancedShape
+{
+	enum Type { None = 0, FlatRectangle = 1, ParabolicRectangle = 2 };
+	enum { MatrixSize = 12 };
+
+	InstancedShape();
+
+	bool operator==( const InstancedShape& instancedShape ) const;
+
+	bool Intersect( const double* worldToObject, const Ray& ray, double* tHit ) const;
+	int IntersectPacket( const double* worldToObject, const RayPacket& rays, int raysMask, double* tHits ) const;
+	void GetDifferentialGeometry( const Ray& objectRay, double tHit, const TShape* shape, DifferentialGeometry* dg ) const;
+
+	int type;
+	double parameters[3];
+};
+
+#endif /* INSTANCEDSHAPE_H_ */
@@ -0,0 +1,133 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstring>
+
+#include <QtEndian>
+
+#include "PhotonMapColumns.h"
+
+/*!
+ * Appends \a value to \a buffer as a 4 bytes little-endian integer.
+ */
+void PhotonMapColumns::AppendUInt32( QByteArray* buffer, quint32 value )
+{
+	uchar bytes[4];
+	qToLittleEndian< quint32 >( value, bytes );
+	buffer->append( reinterpret_cast< const char* >( bytes ), 4 );
+}
+
+/*!
+ * Appends \a value to \a buffer as a 8 bytes little-endian integer.
+ */
+void PhotonMapColumns::AppendUInt64( QByteArray* buffer, quint64 value )
+{
+	uchar bytes[8];
+	qToLittleEndian< quint64 >( value, bytes );
+	buffer->append( reinterpret_cast< const char* >( bytes ), 8 );
+}
+
+/*!
+ * Appends \a value to \a buffer as a little-endian IEEE 754 double.
+ */
+void PhotonMapColumns::AppendDouble( QByteArray* buffer, double value )
+{
+	quint64 bits;
+	memcpy( &bits, &value, 8 );
+	AppendUInt64( buffer, bits );
+}
+
+/*!
+ * Appends \a value to \a buffer with 7 bits per byte, the lowest first. The high bit of each byte is set if more bytes follow.
+ */
+void PhotonMapColumns::AppendVarint( QByteArray* buffer, quint64 value )
+{
+	while( value >= 0x80 )
+	{
+		buffer->append( char( ( value & 0x7F ) | 0x80 ) );
+		value >>= 7;
+	}
+	buffer->append( char( value ) );
+}
+
+/*!
+ * Returns the little-endian double stored at \a data.
+ */
+double PhotonMapColumns::ReadDouble( const uchar* data )
+{
+	quint64 bits = qFromLittleEndian< quint64 >( data );
+	double value;
+	memcpy( &value, &bits, 8 );
+	return value;
+}
+
+/*!
+ * Reads into \a value the variable length integer stored at \a data and moves \a data after it.
+ *
+ * Returns false if the integer does not end before \a end.
+ */
+bool PhotonMapColumns::ReadVarint( const uchar** data, const uchar* end, quint64* value )
+{
+	*value = 0;
+	int shift = 0;
+	while( ( *data < end ) && ( shift < 64 ) )
+	{
+		uchar byte = *( *data )++;
+		*value |= quint64( byte & 0x7F ) << shift;
+		if( !( byte & 0x80 ) ) return true;
+		shift += 7;
+	}
+	return false;
+}
+
+/*!
+ * Maps the signed \a value to an unsigned integer so small negative values are encoded with few bytes.
+ */
+quint64 PhotonMapColumns::ZigZagEncode( qint64 value )
+{
+	return ( quint64( value ) << 1 ) ^ quint64( value >> 63 );
+}
+
+/*!
+ * Inverse of ZigZagEncode.
+ */
+qint64 PhotonMapColumns::ZigZagDecode( quint64 value )
+{
+	return qint64( value >> 1 ) ^ -qint64( value & 1 );
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PHOTONMAPCOLUMNS_H_
+#define PHOTONMAPCOLUMNS_H_
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/*!
+ * Definitions of the columnar photon map file format shared by PhotonMapColumnsWriter and PhotonMapColumnsReader.
+ *
+ * A file starts with the magic number, the format version and the mask of the stored columns. Then the chunks follow
+ * one after the other. Each chunk stores the number of photons and the number of blocks, and a block for each stored
+ * column with the column, its encoding, whether it is compressed, the stored and decoded sizes and the minimum and
+ * maximum column values in the chunk. All the numbers are little-endian.
+ */
+namespace PhotonMapColumns
+{
+	enum Column
+	{
+		Id = 0,
+		X = 1,
+		Y = 2,
+		Z = 3,
+		Side = 4,
+		PreviousId = 5,
+		NextId = 6,
+		SurfaceId = 7,
+		NumberOfColumns = 8
+	};
+
+	enum Encoding
+	{
+		Float64 = 0,
+		Float32 = 1,
+		UInt8 = 2,
+		DeltaVarint = 3,
+		Varint = 4,
+		IdDeltaVarint = 5
+	};
+
+	const quint32 Magic = 0x434D5054; //"TPMC"
+	const quint32 Version = 1;
+	const int FileHeaderSize = 12;
+	const int ChunkHeaderSize = 8;
+	const int BlockHeaderSize = 28;
+
+	void AppendUInt32( QByteArray* buffer, quint32 value );
+	void AppendUInt64( QByteArray* buffer, quint64 value );
+	void AppendDouble( QByteArray* buffer, double value );
+	void AppendVarint( QByteArray* buffer, quint64 value );
+	double ReadDouble( const uchar* data );
+	bool ReadVarint( const uchar** data, const uchar* end, quint64* value );
+	quint64 ZigZagEncode( qint64 value );
+	qint64 ZigZagDecode( quint64 value );
+}
+
+#endif /* PHOTONMAPCOLUMNS_H_ */
@@ -0,0 +1,272 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstring>
+
+#include <QIODevice>
+#include <QtEndian>
+
+#include "PhotonMapColumnsReader.h"
+
+/*!
+ * Creates a reader for the photon map stored in \a device. The device must be open and seekable.
+ */
+PhotonMapColumnsReader::PhotonMapColumnsReader( QIODevice* device )
+:m_pDevice( device ),
+ m_columnsMask( 0 )
+{
+
+}
+
+/*!
+ * Destroys the reader.
+ */
+PhotonMapColumnsReader::~PhotonMapColumnsReader()
+{
+
+}
+
+/*!
+ * Sets \a minValue and \a maxValue to the range of the \a column values in the chunk \a chunk.
+ *
+ * Returns false if the chunk does not exist or the column is not stored.
+ */
+bool PhotonMapColumnsReader::GetColumnRange( int chunk, int column, double* minValue, double* maxValue ) const
+{
+	if( ( chunk < 0 ) || ( chunk >= m_chunks.size() ) || !HasColumn( column ) ) return false;
+
+	const Block& block = m_chunks[chunk].blocks[column];
+	*minValue = block.minValue;
+	*maxValue = block.maxValue;
+	return true;
+}
+
+/*!
+ * Returns the number of photons of the chunk \a chunk.
+ */
+unsigned long PhotonMapColumnsReader::GetChunkNumberOfPhotons( int chunk ) const
+{
+	if( ( chunk < 0 ) || ( chunk >= m_chunks.size() ) ) return 0;
+	return m_chunks[chunk].nPhotons;
+}
+
+/*!
+ * Returns the number of chunks of the file.
+ */
+int PhotonMapColumnsReader::GetNumberOfChunks() const
+{
+	return m_chunks.size();
+}
+
+/*!
+ * Returns the number of photons of the file.
+ */
+quint64 PhotonMapColumnsReader::GetNumberOfPhotons() const
+{
+	quint64 nPhotons = 0;
+	for( int c = 0; c < m_chunks.size(); ++c )
+		nPhotons += m_chunks[c].nPhotons;
+	return nPhotons;
+}
+
+/*!
+ * Returns true if the file stores the column \a column.
+ */
+bool PhotonMapColumnsReader::HasColumn( int column ) const
+{
+	if( ( column < 0 ) || ( column >= PhotonMapColumns::NumberOfColumns ) ) return false;
+	return ( m_columnsMask & ( 1 << column ) ) != 0;
+}
+
+/*!
+ * Reads the file header and the headers of the chunks. A chunk that is not complete at the end of the file,
+ * for example if the export was interrupted, is ignored.
+ *
+ * Returns false if the device is not a columnar photon map file.
+ */
+bool PhotonMapColumnsReader::Open()
+{
+	m_chunks.clear();
+	if( !m_pDevice->seek( 0 ) ) return false;
+
+	QByteArray header = m_pDevice->read( PhotonMapColumns::FileHeaderSize );
+	if( header.size() < PhotonMapColumns::FileHeaderSize ) return false;
+
+	const uchar* headerData = reinterpret_cast< const uchar* >( header.constData() );
+	if( qFromLittleEndian< quint32 >( headerData ) != PhotonMapColumns::Magic ) return false;
+	if( qFromLittleEndian< quint32 >( headerData + 4 ) != PhotonMapColumns::Version ) return false;
+	m_columnsMask = qFromLittleEndian< quint32 >( headerData + 8 );
+
+	qint64 position = PhotonMapColumns::FileHeaderSize;
+	qint64 fileSize = m_pDevice->size();
+	while( position + PhotonMapColumns::ChunkHeaderSize <= fileSize )
+	{
+		QByteArray chunkHeader = m_pDevice->read( PhotonMapColumns::ChunkHeaderSize );
+		if( chunkHeader.size() < PhotonMapColumns::ChunkHeaderSize ) break;
+		const uchar* chunkData = reinterpret_cast< const uchar* >( chunkHeader.constData() );
+
+		Chunk chunk;
+		chunk.nPhotons = qFromLittleEndian< quint32 >( chunkData );
+		for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+			chunk.blocks[c].offset = -1;
+		quint32 nBlocks = qFromLittleEndian< quint32 >( chunkData + 4 );
+		position += PhotonMapColumns::ChunkHeaderSize;
+
+		bool isComplete = true;
+		for( quint32 b = 0; b < nBlocks && isComplete; ++b )
+		{
+			QByteArray blockHeader = m_pDevice->read( PhotonMapColumns::BlockHeaderSize );
+			if( blockHeader.size() < PhotonMapColumns::BlockHeaderSize )
+			{
+				isComplete = false;
+				break;
+			}
+			const uchar* blockData = reinterpret_cast< const uchar* >( blockHeader.constData() );
+
+			int column = blockData[0];
+			if( column >= PhotonMapColumns::NumberOfColumns ) return false;
+
+			Block& block = chunk.blocks[column];
+			block.encoding = blockData[1];
+			block.compressed = ( blockData[2] != 0 );
+			block.storedSize = qFromLittleEndian< quint32 >( blockData + 4 );
+			block.minValue = PhotonMapColumns::ReadDouble( blockData + 12 );
+			block.maxValue = PhotonMapColumns::ReadDouble( blockData + 20 );
+			block.offset = position + PhotonMapColumns::BlockHeaderSize;
+
+			position = block.offset + block.storedSize;
+			if( ( position > fileSize ) || !m_pDevice->seek( position ) )	isComplete = false;
+		}
+
+		if( !isComplete ) break;
+		m_chunks.push_back( chunk );
+	}
+
+	return true;
+}
+
+/*!
+ * Reads into \a values the \a column values of the photons of the chunk \a chunk.
+ *
+ * Returns false if the column is not stored or its data is not valid.
+ */
+bool PhotonMapColumnsReader::ReadColumn( int chunk, int column, std::vector< double >* values ) const
+{
+	if( ( chunk < 0 ) || ( chunk >= m_chunks.size() ) || !HasColumn( column ) ) return false;
+
+	const Chunk& chunkData = m_chunks[chunk];
+	const Block& block = chunkData.blocks[column];
+	if( ( block.offset < 0 ) || !m_pDevice->seek( block.offset ) ) return false;
+
+	QByteArray data = m_pDevice->read( block.storedSize );
+	if( data.size() != int( block.storedSize ) ) return false;
+	if( block.compressed )	data = qUncompress( data );
+
+	unsigned long nPhotons = chunkData.nPhotons;
+	values->resize( nPhotons );
+
+	const uchar* begin = reinterpret_cast< const uchar* >( data.constData() );
+	const uchar* end = begin + data.size();
+	switch( block.encoding )
+	{
+		case PhotonMapColumns::Float64:
+			if( data.size() != int( nPhotons * 8 ) ) return false;
+			for( unsigned long p = 0; p < nPhotons; ++p )
+				( *values )[p] = PhotonMapColumns::ReadDouble( begin + 8 * p );
+			break;
+
+		case PhotonMapColumns::Float32:
+			if( data.size() != int( nPhotons * 4 ) ) return false;
+			for( unsigned long p = 0; p < nPhotons; ++p )
+			{
+				quint32 bits = qFromLittleEndian< quint32 >( begin + 4 * p );
+				float value;
+				memcpy( &value, &bits, 4 );
+				( *values )[p] = value;
+			}
+			break;
+
+		case PhotonMapColumns::UInt8:
+			if( data.size() != int( nPhotons ) ) return false;
+			for( unsigned long p = 0; p < nPhotons; ++p )
+				( *values )[p] = begin[p];
+			break;
+
+		case PhotonMapColumns::Varint:
+			for( unsigned long p = 0; p < nPhotons; ++p )
+			{
+				quint64 value;
+				if( !PhotonMapColumns::ReadVarint( &begin, end, &value ) ) return false;
+				( *values )[p] = double( value );
+			}
+			break;
+
+		case PhotonMapColumns::DeltaVarint:
+		{
+			qint64 previous = 0;
+			for( unsigned long p = 0; p < nPhotons; ++p )
+			{
+				quint64 value;
+				if( !PhotonMapColumns::ReadVarint( &begin, end, &value ) ) return false;
+				previous += PhotonMapColumns::ZigZagDecode( value );
+				( *values )[p] = double( previous );
+			}
+			break;
+		}
+
+		case PhotonMapColumns::IdDeltaVarint:
+		{
+			std::vector< double > ids;
+			if( !ReadColumn( chunk, PhotonMapColumns::Id, &ids ) ) return false;
+			for( unsigned long p = 0; p < nPhotons; ++p )
+			{
+				quint64 value;
+				if( !PhotonMapColumns::ReadVarint( &begin, end, &value ) ) return false;
+				qint64 delta = PhotonMapColumns::ZigZagDecode( value );
+				( *values )[p] = ( delta != 0 ) ? ids[p] + double( delta ) : 0.0;
+			}
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	return true;
+}
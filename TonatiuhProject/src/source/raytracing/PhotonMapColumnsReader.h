@@ -0,0 +1,106 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PHOTONMAPCOLUMNSREADER_H_
+#define PHOTONMAPCOLUMNSREADER_H_
+
+#include <vector>
+
+#include <QVector>
+
+#include "PhotonMapColumns.h"
+
+class QIODevice;
+
+//!  PhotonMapColumnsReader class reads the photons of a columnar photon map file.
+/*!
+ * Open reads the chunks and blocks headers, skipping the blocks data. Then each column of each chunk is read only
+ * when it is requested, and the column ranges can be used to skip the chunks without the photons of interest.
+ *
+ * \code
+ * QFile file( "PhotonMap.tpmc" );
+ * file.open( QIODevice::ReadOnly );
+ * PhotonMapColumnsReader reader( &file );
+ * if( reader.Open() )
+ * {
+ * 	std::vector< double > surfaces;
+ * 	for( int chunk = 0; chunk < reader.GetNumberOfChunks(); ++chunk )
+ * 		reader.ReadColumn( chunk, PhotonMapColumns::SurfaceId, &surfaces );
+ * }
+ * \endcode
+ * \sa PhotonMapColumnsWriter
+ */
+class PhotonMapColumnsReader
+{
+
+public:
+	PhotonMapColumnsReader( QIODevice* device );
+	~PhotonMapColumnsReader();
+
+	bool GetColumnRange( int chunk, int column, double* minValue, double* maxValue ) const;
+	unsigned long GetChunkNumberOfPhotons( int chunk ) const;
+	int GetNumberOfChunks() const;
+	quint64 GetNumberOfPhotons() const;
+	bool HasColumn( int column ) const;
+	bool Open();
+	bool ReadColumn( int chunk, int column, std::vector< double >* values ) const;
+
+private:
+	struct Block
+	{
+		qint64 offset;
+		quint32 storedSize;
+		int encoding;
+		bool compressed;
+		double minValue;
+		double maxValue;
+	};
+
+	struct Chunk
+	{
+		unsigned long nPhotons;
+		Block blocks[PhotonMapColumns::NumberOfColumns];
+	};
+
+	QIODevice* m_pDevice;
+	unsigned int m_columnsMask;
+	QVector< Chunk > m_chunks;
+};
+
+#endif /* PHOTONMAPCOLUMNSREADER_H_ */
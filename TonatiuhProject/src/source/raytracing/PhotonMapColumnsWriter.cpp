@@ -0,0 +1,223 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <QIODevice>
+
+#include "PhotonMapColumnsWriter.h"
+
+/*!
+ * Creates a writer that saves the columns selected in \a columnsMask to \a device in chunks of \a chunkSize photons.
+ * The identifier column is always saved.
+ *
+ * If \a floatCoordinates is true the coordinates are saved as 4 bytes floats. If \a compress is true each block is
+ * compressed when it takes less space.
+ */
+PhotonMapColumnsWriter::PhotonMapColumnsWriter( QIODevice* device, unsigned int columnsMask, unsigned long chunkSize,
+		bool floatCoordinates, bool compress )
+:m_pDevice( device ),
+ m_columnsMask( columnsMask | ( 1 << PhotonMapColumns::Id ) ),
+ m_chunkSize( std::max( chunkSize, 1ul ) ),
+ m_floatCoordinates( floatCoordinates ),
+ m_compress( compress ),
+ m_chunkPhotons( 0 )
+{
+	for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+		if( m_columnsMask & ( 1 << c ) )	m_columns[c].reserve( m_chunkSize );
+}
+
+/*!
+ * Destroys the writer. The photons that are not flushed are lost.
+ */
+PhotonMapColumnsWriter::~PhotonMapColumnsWriter()
+{
+
+}
+
+/*!
+ * Adds a photon with the column \a values. \a values has a value for each PhotonMapColumns::Column,
+ * the values of the columns that are not saved are ignored.
+ *
+ * The chunk is written when it has the chunk size photons.
+ */
+void PhotonMapColumnsWriter::AddPhoton( const double* values )
+{
+	for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+		if( m_columnsMask & ( 1 << c ) )	m_columns[c].push_back( values[c] );
+
+	if( ++m_chunkPhotons == m_chunkSize )	WriteChunk();
+}
+
+/*!
+ * Writes the added photons as a chunk, even if it has less photons than the chunk size.
+ */
+void PhotonMapColumnsWriter::Flush()
+{
+	if( m_chunkPhotons > 0 )	WriteChunk();
+}
+
+/*!
+ * Writes the file header. It must be called before the first chunk when the device is empty.
+ */
+void PhotonMapColumnsWriter::WriteHeader()
+{
+	QByteArray header;
+	PhotonMapColumns::AppendUInt32( &header, PhotonMapColumns::Magic );
+	PhotonMapColumns::AppendUInt32( &header, PhotonMapColumns::Version );
+	PhotonMapColumns::AppendUInt32( &header, m_columnsMask );
+	m_pDevice->write( header );
+}
+
+/*!
+ * Encodes the \a column values of the current chunk into \a data and returns the encoding used.
+ */
+PhotonMapColumns::Encoding PhotonMapColumnsWriter::EncodeColumn( int column, QByteArray* data ) const
+{
+	const std::vector< double >& values = m_columns[column];
+	const std::vector< double >& ids = m_columns[PhotonMapColumns::Id];
+
+	switch( column )
+	{
+		case PhotonMapColumns::X:
+		case PhotonMapColumns::Y:
+		case PhotonMapColumns::Z:
+			if( m_floatCoordinates )
+			{
+				for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+				{
+					float value = float( values[p] );
+					quint32 bits;
+					memcpy( &bits, &value, 4 );
+					PhotonMapColumns::AppendUInt32( data, bits );
+				}
+				return PhotonMapColumns::Float32;
+			}
+			for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+				PhotonMapColumns::AppendDouble( data, values[p] );
+			return PhotonMapColumns::Float64;
+
+		case PhotonMapColumns::Side:
+			for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+				data->append( char( values[p] ) );
+			return PhotonMapColumns::UInt8;
+
+		case PhotonMapColumns::PreviousId:
+		case PhotonMapColumns::NextId:
+			//The previous and next photons are next to the photon, 0 is kept for the photons without them
+			for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+			{
+				qint64 delta = ( values[p] > 0 ) ? qint64( values[p] ) - qint64( ids[p] ) : 0;
+				PhotonMapColumns::AppendVarint( data, PhotonMapColumns::ZigZagEncode( delta ) );
+			}
+			return PhotonMapColumns::IdDeltaVarint;
+
+		case PhotonMapColumns::SurfaceId:
+			for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+				PhotonMapColumns::AppendVarint( data, quint64( values[p] ) );
+			return PhotonMapColumns::Varint;
+
+		default:
+		{
+			qint64 previous = 0;
+			for( unsigned long p = 0; p < m_chunkPhotons; ++p )
+			{
+				qint64 value = qint64( values[p] );
+				PhotonMapColumns::AppendVarint( data, PhotonMapColumns::ZigZagEncode( value - previous ) );
+				previous = value;
+			}
+			return PhotonMapColumns::DeltaVarint;
+		}
+	}
+}
+
+/*!
+ * Writes the current chunk with a single device write and empties it.
+ */
+void PhotonMapColumnsWriter::WriteChunk()
+{
+	int nBlocks = 0;
+	for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+		if( m_columnsMask & ( 1 << c ) )	nBlocks++;
+
+	m_chunkBuffer.clear();
+	PhotonMapColumns::AppendUInt32( &m_chunkBuffer, quint32( m_chunkPhotons ) );
+	PhotonMapColumns::AppendUInt32( &m_chunkBuffer, quint32( nBlocks ) );
+
+	for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+	{
+		if( !( m_columnsMask & ( 1 << c ) ) )	continue;
+
+		std::vector< double >& values = m_columns[c];
+		double minValue = *std::min_element( values.begin(), values.end() );
+		double maxValue = *std::max_element( values.begin(), values.end() );
+
+		QByteArray data;
+		PhotonMapColumns::Encoding encoding = EncodeColumn( c, &data );
+		quint32 decodedSize = data.size();
+
+		bool compressed = false;
+		if( m_compress )
+		{
+			QByteArray compressedData = qCompress( data );
+			if( compressedData.size() < data.size() )
+			{
+				data = compressedData;
+				compressed = true;
+			}
+		}
+
+		m_chunkBuffer.append( char( c ) );
+		m_chunkBuffer.append( char( encoding ) );
+		m_chunkBuffer.append( char( compressed ) );
+		m_chunkBuffer.append( char( 0 ) );
+		PhotonMapColumns::AppendUInt32( &m_chunkBuffer, quint32( data.size() ) );
+		PhotonMapColumns::AppendUInt32( &m_chunkBuffer, decodedSize );
+		PhotonMapColumns::AppendDouble( &m_chunkBuffer, minValue );
+		PhotonMapColumns::AppendDouble( &m_chunkBuffer, maxValue );
+		m_chunkBuffer.append( data );
+	}
+
+	m_pDevice->write( m_chunkBuffer );
+
+	for( int c = 0; c < PhotonMapColumns::NumberOfColumns; ++c )
+		m_columns[c].clear();
+	m_chunkPhotons = 0;
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "Photon.h"
+#include "PhotonMapSurfaceCounter.h"
+
+/*!
+ * Creates an export mode that counts the photons of each surface of \a surfaces.
+ */
+PhotonMapSurfaceCounter::PhotonMapSurfaceCounter( QVector< InstanceNode* > surfaces )
+:PhotonMapExport(),
+ m_photonCounts( surfaces.size(), 0 ),
+ m_wPhoton( 0.0 )
+{
+	for( int s = 0; s < surfaces.size(); ++s )
+		m_surfaceIndex.insert( surfaces[s], s );
+}
+
+/*!
+ * Destroys the counter.
+ */
+PhotonMapSurfaceCounter::~PhotonMapSurfaceCounter()
+{
+
+}
+
+/*!
+ * Nothing is done, the counts are kept until the next StartExport.
+ */
+void PhotonMapSurfaceCounter::EndExport()
+{
+
+}
+
+/*!
+ * Returns the number of photons counted for the surface with index \a surface in the list of surfaces.
+ */
+unsigned long PhotonMapSurfaceCounter::GetNumberOfPhotons( int surface ) const
+{
+	return m_photonCounts[surface];
+}
+
+/*!
+ * Returns the power of the photons that hit the surface with index \a surface in the list of surfaces.
+ */
+double PhotonMapSurfaceCounter::GetPower( int surface ) const
+{
+	return m_photonCounts[surface] * m_wPhoton;
+}
+
+/*!
+ * Counts the photons of \a raysLists that hit one of the surfaces.
+ */
+void PhotonMapSurfaceCounter::SavePhotonMap( const std::vector< Photon >& raysLists )
+{
+	for( unsigned int p = 0; p < raysLists.size(); ++p )
+	{
+		QHash< InstanceNode*, int >::const_iterator surface = m_surfaceIndex.constFind( raysLists[p].intersectedSurface );
+		if( surface != m_surfaceIndex.constEnd() )	m_photonCounts[surface.value()]++;
+	}
+}
+
+/*!
+ * Sets the power of each photon to \a wPhoton.
+ */
+void PhotonMapSurfaceCounter::SetPowerPerPhoton( double wPhoton )
+{
+	m_wPhoton = wPhoton;
+}
+
+/*!
+ * The counter has no parameters. Nothing is done.
+ */
+void PhotonMapSurfaceCounter::SetSaveParameterValue( QString /*parameterName*/, QString /*parameterValue*/ )
+{
+
+}
+
+/*!
+ * Sets the counts to zero.
+ */
+bool PhotonMapSurfaceCounter::StartExport()
+{
+	for( unsigned int s = 0; s < m_photonCounts.size(); ++s )
+		m_photonCounts[s] = 0;
+	m_wPhoton = 0.0;
+	return 1;
+}
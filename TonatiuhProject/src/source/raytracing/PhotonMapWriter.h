@@ -0,0 +1,69 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PHOTONMAPWRITER_H_
+#define PHOTONMAPWRITER_H_
+
+#include <QThread>
+
+class TPhotonMap;
+
+//!  PhotonMapWriter class is the thread that saves the photon buffers filled in a photon map.
+/*!
+  While the rays are traced, the ray tracing threads swap their photon lists into one of the photon map buffers. This
+  thread saves each filled buffer while the ray tracing threads fill another one, so they do not wait for the export to
+  files or databases.
+  \sa TPhotonMap::StartStore, TPhotonMap::FinishStore
+*/
+
+class PhotonMapWriter : public QThread
+{
+
+public:
+	PhotonMapWriter( TPhotonMap* photonMap );
+	~PhotonMapWriter();
+
+protected:
+	void run();
+
+private:
+	TPhotonMap* m_pPhotonMap;
+};
+
+#endif /* PHOTONMAPWRITER_H_ */
@@ -0,0 +1,168 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "PrimitiveRayGenerator.h"
+#include "RandomDeviate.h"
+#include "TLightShape.h"
+#include "TraceScene.h"
+#include "TSunShape.h"
+
+/*!
+ * Creates a generator for \a numberOfRays rays from the \a validAreas of \a lightShape. The directions are sampled from \a sunShape
+ * and the rays are transformed to world coordinates with \a lightToWorld.
+ *
+ * If \a packetMode is true, the rays are intersected with \a traceScene in packets.
+ */
+PrimitiveRayGenerator::PrimitiveRayGenerator( const TraceScene* traceScene,
+		const TLightShape* lightShape,
+		const TSunShape* sunShape,
+		const Transform& lightToWorld,
+		const std::vector< QPair< int, int > >& validAreas,
+		unsigned long numberOfRays,
+		bool packetMode )
+:m_traceScene( traceScene ),
+ m_lightShape( lightShape ),
+ m_sunShape( sunShape ),
+ m_lightToWorld( lightToWorld ),
+ m_validAreas( validAreas ),
+ m_remainingRays( numberOfRays ),
+ m_packetMode( packetMode ),
+ m_packetHitMask( 0 ),
+ m_packetSize( 0 ),
+ m_currentRay( 0 )
+{
+
+}
+
+/*!
+ * Destroys the generator.
+ */
+PrimitiveRayGenerator::~PrimitiveRayGenerator()
+{
+
+}
+
+/*!
+ * Returns the size of the random numbers array for a chunk of \a numberOfRays rays.
+ *
+ * A ray takes a few numbers for its origin and direction and a few more at each reflection, so the array is sized
+ * for about 16 numbers per ray, up to 100000. The numbers of a stream do not depend on the array size, the small
+ * chunks only avoid filling numbers that are not used.
+ */
+unsigned long PrimitiveRayGenerator::RandomArraySize( unsigned long numberOfRays )
+{
+	const unsigned long numbersPerRay = 16;
+	const unsigned long maximumArraySize = 100000;
+	if( numberOfRays >= maximumArraySize / numbersPerRay )	return maximumArraySize;
+	return ( numberOfRays > 0 ) ? numberOfRays * numbersPerRay : numbersPerRay;
+}
+
+/*!
+ * Generates the next ray and stores it in \a ray. Returns false if the light has not valid areas
+ * or, in packet mode, if all the rays have been generated.
+ */
+bool PrimitiveRayGenerator::NewPrimitiveRay( Ray* ray, RandomDeviate& rand )
+{
+	if( !m_packetMode )	return GenerateRay( ray, rand );
+	if( m_validAreas.size() < 1 )	return false;
+
+	if( ( m_currentRay == m_packetSize ) && !GeneratePacket( rand ) )	return false;
+
+	*ray = m_packetRays[m_currentRay++];
+	return true;
+}
+
+/*!
+ * Finds the first intersection of \a ray, the last ray generated with NewPrimitiveRay, as TraceScene::Intersect does.
+ */
+bool PrimitiveRayGenerator::IntersectPrimitiveRay( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const
+{
+	if( !m_packetMode )	return m_traceScene->Intersect( ray, rand, isShapeFront, modelNode, outputRay );
+
+	int rayIndex = m_currentRay - 1;
+	if( !( m_packetHitMask & ( 1 << rayIndex ) ) )	return false;
+	return m_traceScene->IntersectSurface( m_packetSurfaces[rayIndex], ray, rand, isShapeFront, modelNode, outputRay );
+}
+
+/*!
+ * Generates a ray from a random point of a random valid area of the light.
+ */
+bool PrimitiveRayGenerator::GenerateRay( Ray* ray, RandomDeviate& rand ) const
+{
+	if( m_validAreas.size() < 1 )	return false;
+	int area = int ( rand.RandomDouble() * m_validAreas.size() );
+
+	QPair< int, int > areaIndex = m_validAreas[area] ;
+
+	//generating the photon
+	Point3D origin = m_lightShape->Sample( rand.RandomDouble(), rand.RandomDouble(), areaIndex.first, areaIndex.second );
+
+	//generating the ray direction
+	Vector3D direction;
+	m_sunShape->GenerateRayDirection( direction, rand );
+
+	//generatin the ray
+	*ray =  m_lightToWorld( Ray( origin, direction ) );
+
+	return true;
+}
+
+/*!
+ * Generates the next packet of rays and finds the surface intersected by each ray.
+ * Returns false if all the rays have been generated.
+ */
+bool PrimitiveRayGenerator::GeneratePacket( RandomDeviate& rand )
+{
+	if( m_remainingRays == 0 )	return false;
+
+	m_packetSize = ( m_remainingRays < RayPacket::Size ) ? int( m_remainingRays ) : int( RayPacket::Size );
+	m_remainingRays -= m_packetSize;
+	m_currentRay = 0;
+
+	RayPacket rays;
+	for( int i = 0; i < m_packetSize; ++i )
+	{
+		GenerateRay( &m_packetRays[i], rand );
+		rays.SetRay( i, m_packetRays[i] );
+	}
+	rays.nRays = m_packetSize;
+
+	m_packetHitMask = m_traceScene->IntersectPacket( rays, m_packetSurfaces );
+	return true;
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PRIMITIVERAYGENERATOR_H_
+#define PRIMITIVERAYGENERATOR_H_
+
+#include <vector>
+
+#include <QPair>
+
+#include "Ray.h"
+#include "RayPacket.h"
+#include "Transform.h"
+
+class InstanceNode;
+class RandomDeviate;
+class TLightShape;
+class TraceScene;
+class TSunShape;
+
+//!  PrimitiveRayGenerator class generates the rays of a ray tracer chunk from the light.
+/*!
+  Each ray starts at a random point of the valid areas of the light shape and its direction is sampled from the sunshape.
+
+  In packet mode, the rays are generated in groups of RayPacket::Size and each group is intersected with the scene
+  as a RayPacket. The rays from the sun are almost parallel, so the rays of a group visit the same scene nodes and the
+  packet kernels test them together. Then, IntersectPrimitiveRay only evaluates the material of the surface found for the ray.
+*/
+
+class PrimitiveRayGenerator
+{
+
+public:
+	PrimitiveRayGenerator( const TraceScene* traceScene,
+			const TLightShape* lightShape,
+			const TSunShape* sunShape,
+			const Transform& lightToWorld,
+			const std::vector< QPair< int, int > >& validAreas,
+			unsigned long numberOfRays,
+			bool packetMode );
+	~PrimitiveRayGenerator();
+
+	static unsigned long RandomArraySize( unsigned long numberOfRays );
+
+	bool NewPrimitiveRay( Ray* ray, RandomDeviate& rand );
+	bool IntersectPrimitiveRay( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const;
+
+private:
+	bool GenerateRay( Ray* ray, RandomDeviate& rand ) const;
+	bool GeneratePacket( RandomDeviate& rand );
+
+	const TraceScene* m_traceScene;
+	const TLightShape* m_lightShape;
+	const TSunShape* m_sunShape;
+	Transform m_lightToWorld;
+	const std::vector< QPair< int, int > >& m_validAreas;
+	unsigned long m_remainingRays;
+	bool m_packetMode;
+
+	Ray m_packetRays[RayPacket::Size];
+	int m_packetSurfaces[RayPacket::Size];
+	int m_packetHitMask;
+	int m_packetSize;
+	int m_currentRay;
+};
+
+#endif /* PRIMITIVERAYGENERATOR_H_ */
@@ -40,14 +40,16 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include "DifferentialGeometry.h"
 #include "ParallelRandomDeviate.h"
+#include "PrimitiveRayGenerator.h"
 #include "Ray.h"
 #include "RayTracer.h"
+#include "TraceScene.h"
 #include "TPhotonMap.h"
 #include "TLightShape.h"
 #include "TSunShape.h"
 #include "TTransmissivity.h"
 
-RayTracer::RayTracer( InstanceNode* rootNode,
+RayTracer::RayTracer( const TraceScene* traceScene,
 	       InstanceNode* lightNode,
 	       TLightShape* lightShape,
 	       TSunShape* const lightSunShape,
@@ -56,10 +58,10 @@ RayTracer::RayTracer( InstanceNode* rootNode,
 	       RandomDeviate& rand,
 	       QMutex* mutex,
 	       TPhotonMap* photonMap,
-	       QMutex* mutexPhotonMap,
-	       QVector< InstanceNode* > exportSuraceList  )
+	       QVector< InstanceNode* > exportSuraceList,
+	       bool packetMode )
 :m_exportSuraceList( exportSuraceList ),
-m_rootNode( rootNode ),
+m_traceScene( traceScene ),
 m_lightNode( lightNode ),
 m_lightShape( lightShape ),
 m_lightSunShape( lightSunShape ),
@@ -67,56 +69,44 @@ m_lightToWorld( lightToWorld ),
 m_pRand( &rand ),
 m_mutex( mutex ),
 m_photonMap( photonMap ),
-m_pPhotonMapMutex( mutexPhotonMap ),
-m_transmissivity( transmissivity )
+m_transmissivity( transmissivity ),
+m_packetMode( packetMode )
 {
 	m_validAreasVector = m_lightShape->GetValidAreasCoord();
 }
 
-//generating the ray
-bool RayTracer::NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand )
+/*!
+ * Traces the \a raysChunk.second rays of a chunk. The random numbers are taken from the stream \a raysChunk.first
+ * of the generator, so the traced rays only depend on the chunk and not on the thread that traces it.
+ */
+void RayTracer::operator()( QPair< unsigned long, unsigned long > raysChunk )
 {
-	if( m_validAreasVector.size() < 1 )	return false;
-	int area = int ( rand.RandomDouble() * m_validAreasVector.size() );
-
-	QPair< int, int > areaIndex = m_validAreasVector[area] ;
+	unsigned long streamIndex = raysChunk.first;
+	double numberOfRays = raysChunk.second;
 
-	//generating the photon
-	Point3D origin = m_lightShape->Sample( rand.RandomDouble(), rand.RandomDouble(), areaIndex.first, areaIndex.second );
-
-	//generating the ray direction
-	Vector3D direction;
-	m_lightSunShape->GenerateRayDirection( direction, rand );
-	//generatin the ray
-	*ray =  m_lightToWorld( Ray( origin, direction ) );
-
-	return true;
-}
-
-void RayTracer::operator()( double numberOfRays )
-{
 	if( m_exportSuraceList.size() < 1 )
-		RayTracerCreatingAllPhotons( numberOfRays );
+		RayTracerCreatingAllPhotons( streamIndex, numberOfRays );
 	else if( m_exportSuraceList.size() > 0 &&  m_exportSuraceList.contains( m_lightNode ) )
-		RayTracerCreatingLightPhotons( numberOfRays );
+		RayTracerCreatingLightPhotons( streamIndex, numberOfRays );
 	else
-		RayTracerNotCreatingLightPhotons( numberOfRays );
+		RayTracerNotCreatingLightPhotons( streamIndex, numberOfRays );
 }
 
 
 /*!
  * Traces \a numberOfRays rays and creates photons for all intersections.
  */
-void RayTracer::RayTracerCreatingAllPhotons( double numberOfRays  )
+void RayTracer::RayTracerCreatingAllPhotons( unsigned long streamIndex, double numberOfRays )
 {
 
 	std::vector< Photon > photonsVector;
-	ParallelRandomDeviate rand( m_pRand, m_mutex );
+	ParallelRandomDeviate rand( m_pRand, streamIndex, m_mutex, PrimitiveRayGenerator::RandomArraySize( (unsigned long) numberOfRays ) );
+	PrimitiveRayGenerator primitiveRays( m_traceScene, m_lightShape, m_lightSunShape, m_lightToWorld, m_validAreasVector, (unsigned long) numberOfRays, m_packetMode );
 
 	for(  unsigned long  i = 0; i < numberOfRays; ++i )
 	{
 		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
+		if( primitiveRays.NewPrimitiveRay( &ray, rand ) )
 		{
 			photonsVector.push_back( Photon( ray.origin, 1, 0, m_lightNode ) );
 			int rayLength = 0;
@@ -131,7 +121,10 @@ void RayTracer::RayTracerCreatingAllPhotons( double numberOfRays  )
 				intersectedSurface = 0;
 				isFront = 0;
 				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				if( rayLength == 0 )
+					isReflectedRay = primitiveRays.IntersectPrimitiveRay( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				else
+					isReflectedRay = m_traceScene->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
 
 				if( rayLength > 0 )
 				{
@@ -173,25 +166,24 @@ void RayTracer::RayTracerCreatingAllPhotons( double numberOfRays  )
 
 	photonsVector.resize( photonsVector.size() );
 
-	m_pPhotonMapMutex->lock();
 	m_photonMap->StoreRays( photonsVector );
-	m_pPhotonMapMutex->unlock();
 
 }
 
 /*!
  * Traces \a numberOfRays rays. Creates photons for the ray origin and to the selected surfaces
  */
-void RayTracer::RayTracerCreatingLightPhotons(  double numberOfRays  )
+void RayTracer::RayTracerCreatingLightPhotons( unsigned long streamIndex, double numberOfRays )
 {
 
 	std::vector< Photon > photonsVector;
-	ParallelRandomDeviate rand( m_pRand, m_mutex );
+	ParallelRandomDeviate rand( m_pRand, streamIndex, m_mutex, PrimitiveRayGenerator::RandomArraySize( (unsigned long) numberOfRays ) );
+	PrimitiveRayGenerator primitiveRays( m_traceScene, m_lightShape, m_lightSunShape, m_lightToWorld, m_validAreasVector, (unsigned long) numberOfRays, m_packetMode );
 
 	for(  unsigned long  i = 0; i < numberOfRays; ++i )
 	{
 		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
+		if( primitiveRays.NewPrimitiveRay( &ray, rand ) )
 		{
 			photonsVector.push_back( Photon( ray.origin, 1, 0, m_lightNode ) );
 			int rayLength = 0;
@@ -206,7 +198,10 @@ void RayTracer::RayTracerCreatingLightPhotons(  double numberOfRays  )
 				intersectedSurface = 0;
 				isFront = 0;
 				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				if( rayLength == 0 )
+					isReflectedRay = primitiveRays.IntersectPrimitiveRay( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				else
+					isReflectedRay = m_traceScene->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
 
 				if( rayLength > 0 )
 				{
@@ -247,9 +242,7 @@ void RayTracer::RayTracerCreatingLightPhotons(  double numberOfRays  )
 	}
 	photonsVector.resize( photonsVector.size() );
 
-	m_pPhotonMapMutex->lock();
 	m_photonMap->StoreRays( photonsVector );
-	m_pPhotonMapMutex->unlock();
 
 }
 
@@ -257,15 +250,16 @@ void RayTracer::RayTracerCreatingLightPhotons(  double numberOfRays  )
  * Traces \a numberOfRays rays. Creates photons for the selected surfaces.
  * Photons for the rays origin will not be created.
  */
-void RayTracer::RayTracerNotCreatingLightPhotons(  double numberOfRays  )
+void RayTracer::RayTracerNotCreatingLightPhotons( unsigned long streamIndex, double numberOfRays )
 {
 	std::vector< Photon > photonsVector;
-	ParallelRandomDeviate rand( m_pRand, m_mutex );
+	ParallelRandomDeviate rand( m_pRand, streamIndex, m_mutex, PrimitiveRayGenerator::RandomArraySize( (unsigned long) numberOfRays ) );
+	PrimitiveRayGenerator primitiveRays( m_traceScene, m_lightShape, m_lightSunShape, m_lightToWorld, m_validAreasVector, (unsigned long) numberOfRays, m_packetMode );
 
 	for(  unsigned long  i = 0; i < numberOfRays; ++i )
 	{
 		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
+		if( primitiveRays.NewPrimitiveRay( &ray, rand ) )
 		{
 			int rayLength = 0;
 
@@ -279,7 +273,10 @@ void RayTracer::RayTracerNotCreatingLightPhotons(  double numberOfRays  )
 				intersectedSurface = 0;
 				isFront = 0;
 				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				if( rayLength == 0 )
+					isReflectedRay = primitiveRays.IntersectPrimitiveRay( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
+				else
+					isReflectedRay = m_traceScene->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
 
 				if( rayLength > 0 )
 				{
@@ -321,8 +318,6 @@ void RayTracer::RayTracerNotCreatingLightPhotons(  double numberOfRays  )
 	}
 	photonsVector.resize( photonsVector.size() );
 
-	m_pPhotonMapMutex->lock();
 	m_photonMap->StoreRays( photonsVector );
-	m_pPhotonMapMutex->unlock();
 
 }
@@ -50,12 +50,12 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "Transform.h"
 
 class InstanceNode;
-class ParallelRandomDeviate;
 struct Photon;
 class RandomDeviate;
 struct RayTracerPhoton;
 class QMutex;
 class QPoint;
+class TraceScene;
 class TPhotonMap;
 class TLightShape;
 class TSunShape;
@@ -65,7 +65,7 @@ class RayTracer
 {
 
 public:
-	RayTracer( InstanceNode* rootNode,
+	RayTracer( const TraceScene* traceScene,
 		       InstanceNode* lightNode,
 		       TLightShape* lightShape,
 		       TSunShape* const lightSunShape,
@@ -74,22 +74,21 @@ public:
 		       RandomDeviate& rand,
 		       QMutex* mutex,
 		       TPhotonMap* photonMap,
-		       QMutex* mutexPhotonMap,
-		       QVector< InstanceNode* > exportSuraceList );
+		       QVector< InstanceNode* > exportSuraceList,
+		       bool packetMode = false );
 
 	typedef void result_type;
-	void operator()( double numberOfRays );
+	void operator()( QPair< unsigned long, unsigned long > raysChunk );
 
 
 private:
-	bool NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand );
-	void RayTracerCreatingAllPhotons(  double numberOfRays  );
-	void RayTracerCreatingLightPhotons(  double numberOfRays  );
-	void RayTracerNotCreatingLightPhotons(  double numberOfRays  );
+	void RayTracerCreatingAllPhotons( unsigned long streamIndex, double numberOfRays );
+	void RayTracerCreatingLightPhotons( unsigned long streamIndex, double numberOfRays );
+	void RayTracerNotCreatingLightPhotons( unsigned long streamIndex, double numberOfRays );
 
 
     QVector< InstanceNode* > m_exportSuraceList;
-	InstanceNode* m_rootNode;
+	const TraceScene* m_traceScene;
 	InstanceNode* m_lightNode;
 	TLightShape* m_lightShape;
 	const TSunShape* m_lightSunShape;
@@ -97,9 +96,9 @@ private:
 	RandomDeviate* m_pRand;
     QMutex* m_mutex;
 	TPhotonMap* m_photonMap;
-    QMutex* m_pPhotonMapMutex;
 	TTransmissivity * m_transmissivity;
 	std::vector< QPair< int, int > >  m_validAreasVector;
+	bool m_packetMode;
 
 
 };
@@ -0,0 +1,186 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QMutexLocker>
+
+#include "RayTracingScheduler.h"
+
+/*!
+ * Creates a scheduler for \a numberOfRays rays traced by \a numberOfWorkers workers.
+ * The blocks use the random streams from \a firstStream to \a firstStream + NumberOfBlocks() - 1.
+ */
+RayTracingScheduler::RayTracingScheduler( unsigned long numberOfRays, unsigned long firstStream, int numberOfWorkers, QObject* parent )
+:QObject( parent ),
+ m_numberOfRays( numberOfRays ),
+ m_firstStream( firstStream ),
+ m_blockSize( MinimumBlockSize ),
+ m_numberOfBlocks( 0 ),
+ m_tracedRays( 0 ),
+ m_progress( 0 ),
+ m_canceled( false )
+{
+	if( m_numberOfRays / MaximumNumberOfBlocks > m_blockSize )	m_blockSize = m_numberOfRays / MaximumNumberOfBlocks;
+	m_numberOfBlocks = ( m_numberOfRays + m_blockSize - 1 ) / m_blockSize;
+
+	if( numberOfWorkers < 1 )	numberOfWorkers = 1;
+	m_workers.resize( numberOfWorkers );
+	for( int w = 0; w < numberOfWorkers; ++w )
+	{
+		m_workers[w].begin = ( m_numberOfBlocks * w ) / numberOfWorkers;
+		m_workers[w].end = ( m_numberOfBlocks * ( w + 1 ) ) / numberOfWorkers;
+		m_workers[w].raysPerSecond = 0.0;
+	}
+}
+
+/*!
+ * Destroys the scheduler.
+ */
+RayTracingScheduler::~RayTracingScheduler()
+{
+
+}
+
+/*!
+ * Returns the random stream and the number of rays of the \a block.
+ */
+QPair< unsigned long, unsigned long > RayTracingScheduler::Block( unsigned long block ) const
+{
+	unsigned long firstRay = block * m_blockSize;
+	unsigned long nRays = ( firstRay + m_blockSize <= m_numberOfRays ) ? m_blockSize : m_numberOfRays - firstRay;
+	return QPair< unsigned long, unsigned long >( m_firstStream + block, nRays );
+}
+
+/*!
+ * Returns the number of blocks of rays. It is also the number of random streams used by the run.
+ */
+unsigned long RayTracingScheduler::NumberOfBlocks() const
+{
+	return m_numberOfBlocks;
+}
+
+/*!
+ * Returns the indexes of the workers, to map them to the tracing threads.
+ */
+QVector< int > RayTracingScheduler::Workers() const
+{
+	QVector< int > workers;
+	for( int w = 0; w < m_workers.size(); ++w )
+		workers<< w;
+	return workers;
+}
+
+/*!
+ * Assigns the next chunk of blocks to the \a worker. The chunk starts at \a firstBlock and has \a nBlocks blocks.
+ * Returns false if all the blocks have been assigned or the run has been canceled.
+ */
+bool RayTracingScheduler::NextChunk( int worker, unsigned long* firstBlock, unsigned long* nBlocks )
+{
+	QMutexLocker locker( &m_mutex );
+	if( m_canceled )	return false;
+
+	WorkerRange& range = m_workers[worker];
+	if( range.begin == range.end )
+	{
+		//Steal the second half of the largest range
+		int victim = -1;
+		unsigned long victimBlocks = 0;
+		for( int w = 0; w < m_workers.size(); ++w )
+		{
+			unsigned long remainingBlocks = m_workers[w].end - m_workers[w].begin;
+			if( remainingBlocks > victimBlocks )
+			{
+				victim = w;
+				victimBlocks = remainingBlocks;
+			}
+		}
+		if( victim < 0 )	return false;
+
+		unsigned long stolenBlocks = ( victimBlocks + 1 ) / 2;
+		range.end = m_workers[victim].end;
+		range.begin = range.end - stolenBlocks;
+		m_workers[victim].end = range.begin;
+	}
+
+	unsigned long chunkBlocks = 1;
+	if( range.raysPerSecond > 0.0 )
+	{
+		double chunkRays = range.raysPerSecond * TargetChunkTime / 1000.0;
+		if( chunkRays > m_blockSize )	chunkBlocks = (unsigned long) ( chunkRays / m_blockSize );
+	}
+	if( chunkBlocks > range.end - range.begin )	chunkBlocks = range.end - range.begin;
+
+	*firstBlock = range.begin;
+	*nBlocks = chunkBlocks;
+	range.begin += chunkBlocks;
+	return true;
+}
+
+/*!
+ * Notifies that the \a worker has traced a chunk of \a nBlocks blocks in \a milliseconds.
+ * The time is used to size the next chunks of the worker.
+ */
+void RayTracingScheduler::ChunkFinished( int worker, unsigned long nBlocks, int milliseconds )
+{
+	m_mutex.lock();
+
+	double chunkRays = double( nBlocks * m_blockSize );
+	double raysPerSecond = chunkRays * 1000.0 / ( milliseconds > 0 ? milliseconds : 1 );
+	WorkerRange& range = m_workers[worker];
+	if( range.raysPerSecond > 0.0 )	range.raysPerSecond = 0.5 * ( range.raysPerSecond + raysPerSecond );
+	else	range.raysPerSecond = raysPerSecond;
+
+	m_tracedRays += nBlocks * m_blockSize;
+	if( m_tracedRays > m_numberOfRays )	m_tracedRays = m_numberOfRays;
+	int progress = ( m_numberOfRays > 0 ) ? int( ( 100.0 * m_tracedRays ) / m_numberOfRays ) : 100;
+	bool progressChanged = ( progress > m_progress );
+	if( progressChanged )	m_progress = progress;
+
+	m_mutex.unlock();
+
+	if( progressChanged )	emit progressValueChanged( progress );
+}
+
+/*!
+ * Cancels the run. The workers finish their current chunks and do not get more blocks.
+ */
+void RayTracingScheduler::Cancel()
+{
+	QMutexLocker locker( &m_mutex );
+	m_canceled = true;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef RAYTRACINGSCHEDULER_H_
+#define RAYTRACINGSCHEDULER_H_
+
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+//!  RayTracingScheduler class distributes the rays of a ray tracing run between the tracing threads.
+/*!
+  The rays are divided in blocks of the same size and each block is traced with its own random stream.
+  The block size only depends on the number of rays, so the traced rays are the same for any number of threads.
+
+  Each worker starts with a contiguous range of blocks and takes from it chunks sized to last TargetChunkTime
+  milliseconds at the rays per second measured for that worker. When its range is empty, the worker steals the
+  second half of the largest remaining range. The progress is reported by traced rays with progressValueChanged,
+  independently of the chunks.
+*/
+
+class RayTracingScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	RayTracingScheduler( unsigned long numberOfRays, unsigned long firstStream, int numberOfWorkers, QObject* parent = 0 );
+	~RayTracingScheduler();
+
+	QPair< unsigned long, unsigned long > Block( unsigned long block ) const;
+	unsigned long NumberOfBlocks() const;
+	QVector< int > Workers() const;
+
+	bool NextChunk( int worker, unsigned long* firstBlock, unsigned long* nBlocks );
+	void ChunkFinished( int worker, unsigned long nBlocks, int milliseconds );
+
+public slots:
+	void Cancel();
+
+signals:
+	void progressValueChanged( int progress );
+
+private:
+	struct WorkerRange
+	{
+		unsigned long begin;
+		unsigned long end;
+		double raysPerSecond;
+	};
+
+	enum
+	{
+		MinimumBlockSize = 100,
+		MaximumNumberOfBlocks = 10000,
+		TargetChunkTime = 50
+	};
+
+	unsigned long m_numberOfRays;
+	unsigned long m_firstStream;
+	unsigned long m_blockSize;
+	unsigned long m_numberOfBlocks;
+
+	QMutex m_mutex;
+	QVector< WorkerRange > m_workers;
+	unsigned long m_tracedRays;
+	int m_progress;
+	bool m_canceled;
+};
+
+#endif /* RAYTRACINGSCHEDULER_H_ */
@@ -0,0 +1,457 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+
+#include "gc.h"
+#include "DifferentialGeometry.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "SceneBVH.h"
+#include "TraceScene.h"
+
+namespace
+{
+	const int nBuckets = 12;
+	const int maxSAHDepth = 30;
+	const int maxTraversalDepth = 64;
+	const double traversalCost = 0.125;
+
+	struct CentroidBucketCompare
+	{
+		CentroidBucketCompare( int splitBucket, int axis, double minCentroid, double centroidExtent )
+		:m_splitBucket( splitBucket ), m_axis( axis ), m_minCentroid( minCentroid ), m_centroidExtent( centroidExtent )
+		{
+		}
+
+		template< class T > bool operator()( const T& surface ) const
+		{
+			int b = int( nBuckets * ( ( surface.centroid[m_axis] - m_minCentroid ) / m_centroidExtent ) );
+			if( b == nBuckets ) b = nBuckets - 1;
+			return ( b <= m_splitBucket );
+		}
+
+		int m_splitBucket;
+		int m_axis;
+		double m_minCentroid;
+		double m_centroidExtent;
+	};
+
+	struct CentroidCompare
+	{
+		CentroidCompare( int axis )
+		:m_axis( axis )
+		{
+		}
+
+		template< class T > bool operator()( const T& surface1, const T& surface2 ) const
+		{
+			return ( surface1.centroid[m_axis] < surface2.centroid[m_axis] );
+		}
+
+		int m_axis;
+	};
+}
+
+/*!
+ * Creates an empty hierarchy. The leaves will store up to \a maxSurfacesInLeaf surfaces
+ * unless the surface area heuristic finds a leaf cheaper than any split.
+ */
+SceneBVH::SceneBVH( int maxSurfacesInLeaf )
+:m_pScene( 0 ),
+ m_maxSurfacesInLeaf( maxSurfacesInLeaf )
+{
+
+}
+
+/*!
+ * Destroys the hierarchy. The scene surfaces are not deleted.
+ */
+SceneBVH::~SceneBVH()
+{
+
+}
+
+/*!
+ * Builds the hierarchy for the surfaces of the compiled \a scene.
+ */
+void SceneBVH::Build( const TraceScene* scene )
+{
+	Clear();
+	m_pScene = scene;
+
+	int nSurfaces = scene->GetNumberOfSurfaces();
+	if( nSurfaces < 1 )	return;
+
+	std::vector< BuildSurface > buildSurfaces( nSurfaces );
+	for( int s = 0; s < nSurfaces; ++s )
+	{
+		BBox surfaceBBox = scene->GetSurfaceBBox( s );
+		buildSurfaces[s].bbox = surfaceBBox;
+		buildSurfaces[s].centroid = Point3D( 0.5 * ( surfaceBBox.pMin.x + surfaceBBox.pMax.x ),
+											0.5 * ( surfaceBBox.pMin.y + surfaceBBox.pMax.y ),
+											0.5 * ( surfaceBBox.pMin.z + surfaceBBox.pMax.z ) );
+		buildSurfaces[s].surface = s;
+	}
+
+	m_nodes.reserve( 2 * buildSurfaces.size() );
+	m_surfaces.reserve( buildSurfaces.size() );
+	BuildRecursive( buildSurfaces, 0, buildSurfaces.size(), 0 );
+}
+
+/*!
+ * Updates the bounding boxes of the nodes to the current world bounding boxes of the scene surfaces.
+ *
+ * The tree is kept, so the surfaces must be the same the hierarchy was built for. This is much cheaper than Build
+ * when only the surfaces transforms have changed, as the trackers do when the sun moves.
+ */
+void SceneBVH::Refit()
+{
+	//The children of a node are always after it in the array
+	for( int n = int( m_nodes.size() ) - 1; n >= 0; --n )
+	{
+		LinearNode& node = m_nodes[n];
+		if( node.nSurfaces > 0 )
+		{
+			BBox nodeBBox;
+			for( int s = 0; s < node.nSurfaces; ++s )
+				nodeBBox = Union( nodeBBox, m_pScene->GetSurfaceBBox( m_surfaces[node.offset + s] ) );
+			node.bbox = nodeBBox;
+		}
+		else
+			node.bbox = Union( m_nodes[n + 1].bbox, m_nodes[node.offset].bbox );
+	}
+}
+
+/*!
+ * Removes all the nodes of the hierarchy.
+ */
+void SceneBVH::Clear()
+{
+	m_nodes.clear();
+	m_surfaces.clear();
+}
+
+/*!
+ * Returns the world bounding box of the whole hierarchy.
+ */
+BBox SceneBVH::GetBBox() const
+{
+	if( m_nodes.size() < 1 )	return BBox();
+	return m_nodes[0].bbox;
+}
+
+/*!
+ * Returns the number of nodes of the hierarchy.
+ */
+int SceneBVH::GetNumberOfNodes() const
+{
+	return m_nodes.size();
+}
+
+/*!
+ * Finds the nearest surface intersected by \a ray. The ray \a maxt is updated to the intersection distance.
+ *
+ * Returns true if there is an intersection. In this case, \a surface is the index of the intersected surface in
+ * the scene, \a dg the intersection differential geometry and \a objectRay the ray in the surface coordinates.
+ */
+bool SceneBVH::Intersect( const Ray& ray, int* surface, DifferentialGeometry* dg, Ray* objectRay ) const
+{
+	if( m_nodes.size() < 1 )	return false;
+
+	bool dirIsNeg[3] = { ray.invDirection().x < 0.0, ray.invDirection().y < 0.0, ray.invDirection().z < 0.0 };
+
+	bool isIntersection = false;
+	int nodesToVisit[maxTraversalDepth];
+	int toVisitOffset = 0;
+	int currentNodeIndex = 0;
+	while( true )
+	{
+		const LinearNode& node = m_nodes[currentNodeIndex];
+		//ray.maxt is reduced at each intersection, so the farther nodes are discarded here
+		if( node.bbox.IntersectP( ray ) )
+		{
+			if( node.nSurfaces > 0 )
+			{
+				for( int s = 0; s < node.nSurfaces; ++s )
+				{
+					int surfaceIndex = m_surfaces[node.offset + s];
+					if( m_pScene->IntersectSurface( surfaceIndex, ray, dg, objectRay ) )
+					{
+						*surface = surfaceIndex;
+						isIntersection = true;
+					}
+				}
+
+				if( toVisitOffset == 0 )	break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+			else
+			{
+				//Visit first the child nearest to the ray origin
+				if( dirIsNeg[node.axis] )
+				{
+					nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+					currentNodeIndex = node.offset;
+				}
+				else
+				{
+					nodesToVisit[toVisitOffset++] = node.offset;
+					currentNodeIndex = currentNodeIndex + 1;
+				}
+			}
+		}
+		else
+		{
+			if( toVisitOffset == 0 )	break;
+			currentNodeIndex = nodesToVisit[--toVisitOffset];
+		}
+	}
+
+	return isIntersection;
+}
+
+/*!
+ * Returns true if \a ray intersects any surface before its maxt.
+ *
+ * The traversal stops at the first intersected surface, so the children are not ordered and the
+ * intersection differential geometry is not computed.
+ */
+bool SceneBVH::IntersectP( const Ray& ray ) const
+{
+	if( m_nodes.size() < 1 )	return false;
+
+	int nodesToVisit[maxTraversalDepth];
+	int toVisitOffset = 0;
+	int currentNodeIndex = 0;
+	while( true )
+	{
+		const LinearNode& node = m_nodes[currentNodeIndex];
+		if( node.bbox.IntersectP( ray ) )
+		{
+			if( node.nSurfaces > 0 )
+			{
+				for( int s = 0; s < node.nSurfaces; ++s )
+					if( m_pScene->IntersectSurfaceP( m_surfaces[node.offset + s], ray ) )	return true;
+
+				if( toVisitOffset == 0 )	break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+			else
+			{
+				nodesToVisit[toVisitOffset++] = node.offset;
+				currentNodeIndex = currentNodeIndex + 1;
+			}
+		}
+		else
+		{
+			if( toVisitOffset == 0 )	break;
+			currentNodeIndex = nodesToVisit[--toVisitOffset];
+		}
+	}
+
+	return false;
+}
+
+/*!
+ * Finds the nearest surface intersected by each ray of \a rays. The rays maxt are updated to the intersection distances.
+ *
+ * Returns a mask with the bit of each ray that intersects a surface set, the index of the surface is stored in \a surfaces.
+ * The nodes are visited in the order of the first active ray, as the rays of a packet are expected to be coherent.
+ */
+int SceneBVH::IntersectPacket( const RayPacket& rays, int* surfaces ) const
+{
+	if( m_nodes.size() < 1 )	return 0;
+
+	int activeMask = rays.ActiveMask();
+	if( activeMask == 0 )	return 0;
+
+	int firstRay = 0;
+	while( !( activeMask & ( 1 << firstRay ) ) )	++firstRay;
+	bool dirIsNeg[3] = { rays.invDirectionX[firstRay] < 0.0, rays.invDirectionY[firstRay] < 0.0, rays.invDirectionZ[firstRay] < 0.0 };
+
+	int hitMask = 0;
+	int nodesToVisit[maxTraversalDepth];
+	int toVisitOffset = 0;
+	int currentNodeIndex = 0;
+	while( true )
+	{
+		const LinearNode& node = m_nodes[currentNodeIndex];
+		int nodeMask = node.bbox.IntersectP( rays );
+		if( nodeMask != 0 )
+		{
+			if( node.nSurfaces > 0 )
+			{
+				for( int s = 0; s < node.nSurfaces; ++s )
+					hitMask |= m_pScene->IntersectSurfacePacket( m_surfaces[node.offset + s], rays, nodeMask, surfaces );
+
+				if( toVisitOffset == 0 )	break;
+				currentNodeIndex = nodesToVisit[--toVisitOffset];
+			}
+			else
+			{
+				if( dirIsNeg[node.axis] )
+				{
+					nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+					currentNodeIndex = node.offset;
+				}
+				else
+				{
+					nodesToVisit[toVisitOffset++] = node.offset;
+					currentNodeIndex = currentNodeIndex + 1;
+				}
+			}
+		}
+		else
+		{
+			if( toVisitOffset == 0 )	break;
+			currentNodeIndex = nodesToVisit[--toVisitOffset];
+		}
+	}
+
+	return hitMask;
+}
+
+/*!
+ * Creates the node for the surfaces between \a start and \a end and its children.
+ * Returns the index of the created node.
+ */
+int SceneBVH::BuildRecursive( std::vector< BuildSurface >& buildSurfaces, int start, int end, int depth )
+{
+	int nodeIndex = m_nodes.size();
+	m_nodes.push_back( LinearNode() );
+
+	BBox nodeBBox;
+	BBox centroidBBox;
+	for( int s = start; s < end; ++s )
+	{
+		nodeBBox = Union( nodeBBox, buildSurfaces[s].bbox );
+		centroidBBox = Union( centroidBBox, buildSurfaces[s].centroid );
+	}
+
+	int nSurfaces = end - start;
+	int axis = centroidBBox.MaximumExtent();
+	double minCentroid = centroidBBox.pMin[axis];
+	double centroidExtent = centroidBBox.pMax[axis] - centroidBBox.pMin[axis];
+
+	int mid = -1;
+	if( nSurfaces > 1 && centroidExtent > 0.0 && depth < maxSAHDepth )
+	{
+		//Binned surface area heuristic
+		int bucketCount[nBuckets];
+		BBox bucketBBox[nBuckets];
+		for( int b = 0; b < nBuckets; ++b )	bucketCount[b] = 0;
+
+		for( int s = start; s < end; ++s )
+		{
+			int b = int( nBuckets * ( ( buildSurfaces[s].centroid[axis] - minCentroid ) / centroidExtent ) );
+			if( b == nBuckets ) b = nBuckets - 1;
+			bucketCount[b]++;
+			bucketBBox[b] = Union( bucketBBox[b], buildSurfaces[s].bbox );
+		}
+
+		double nodeArea = nodeBBox.SurfaceArea();
+		double minCost = gc::Infinity;
+		int minCostSplitBucket = -1;
+		for( int split = 0; split < nBuckets - 1; ++split )
+		{
+			BBox bbox0;
+			BBox bbox1;
+			int count0 = 0;
+			int count1 = 0;
+			for( int b = 0; b <= split; ++b )
+			{
+				if( bucketCount[b] < 1 )	continue;
+				bbox0 = Union( bbox0, bucketBBox[b] );
+				count0 += bucketCount[b];
+			}
+			for( int b = split + 1; b < nBuckets; ++b )
+			{
+				if( bucketCount[b] < 1 )	continue;
+				bbox1 = Union( bbox1, bucketBBox[b] );
+				count1 += bucketCount[b];
+			}
+			if( count0 < 1 || count1 < 1 )	continue;
+
+			double cost = traversalCost * nodeArea + count0 * bbox0.SurfaceArea() + count1 * bbox1.SurfaceArea();
+			if( cost < minCost )
+			{
+				minCost = cost;
+				minCostSplitBucket = split;
+			}
+		}
+
+		double leafCost = nSurfaces * nodeArea;
+		if( minCostSplitBucket >= 0 && ( nSurfaces > m_maxSurfacesInLeaf || minCost < leafCost ) )
+		{
+			BuildSurface* midSurface = std::partition( &buildSurfaces[start], &buildSurfaces[end - 1] + 1,
+					CentroidBucketCompare( minCostSplitBucket, axis, minCentroid, centroidExtent ) );
+			mid = midSurface - &buildSurfaces[0];
+		}
+	}
+
+	if( mid < 0 && nSurfaces > m_maxSurfacesInLeaf )
+	{
+		//Equal counts split when the heuristic can not separate the surfaces
+		mid = ( start + end ) / 2;
+		std::nth_element( &buildSurfaces[start], &buildSurfaces[mid], &buildSurfaces[end - 1] + 1, CentroidCompare( axis ) );
+	}
+
+	if( mid <= start || mid >= end )
+	{
+		m_nodes[nodeIndex].bbox = nodeBBox;
+		m_nodes[nodeIndex].offset = m_surfaces.size();
+		m_nodes[nodeIndex].nSurfaces = nSurfaces;
+		m_nodes[nodeIndex].axis = axis;
+		for( int s = start; s < end; ++s )
+			m_surfaces.push_back( buildSurfaces[s].surface );
+	}
+	else
+	{
+		BuildRecursive( buildSurfaces, start, mid, depth + 1 );
+		int secondChild = BuildRecursive( buildSurfaces, mid, end, depth + 1 );
+
+		m_nodes[nodeIndex].bbox = nodeBBox;
+		m_nodes[nodeIndex].offset = secondChild;
+		m_nodes[nodeIndex].nSurfaces = 0;
+		m_nodes[nodeIndex].axis = axis;
+	}
+
+	return nodeIndex;
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef SCENEBVH_H_
+#define SCENEBVH_H_
+
+#include <vector>
+
+#include "BBox.h"
+
+struct DifferentialGeometry;
+class Ray;
+struct RayPacket;
+class TraceScene;
+
+//!  SceneBVH class is the scene level acceleration structure used by the ray tracers.
+/*!
+  SceneBVH is a bounding volume hierarchy built with the surface area heuristic over the world
+  bounding boxes of the surfaces of a TraceScene.
+  The nodes are stored in a linear array in depth first order, so the first child of a node is
+  always the next node of the array and only the second child offset is stored.
+  The hierarchy is traversed front to back and the nodes farther than the current ray maxt are skipped.
+  IntersectP only answers if a ray is occluded, so it stops at the first intersected surface.
+  A RayPacket is traversed together, a node is visited while any ray of the packet intersects its box.
+*/
+
+class SceneBVH
+{
+
+public:
+	SceneBVH( int maxSurfacesInLeaf = 4 );
+	~SceneBVH();
+
+	void Build( const TraceScene* scene );
+	void Clear();
+	BBox GetBBox() const;
+	int GetNumberOfNodes() const;
+	bool Intersect( const Ray& ray, int* surface, DifferentialGeometry* dg, Ray* objectRay ) const;
+	bool IntersectP( const Ray& ray ) const;
+	int IntersectPacket( const RayPacket& rays, int* surfaces ) const;
+	void Refit();
+
+private:
+	struct BuildSurface
+	{
+		BBox bbox;
+		Point3D centroid;
+		int surface;
+	};
+
+	struct LinearNode
+	{
+		BBox bbox;
+		int offset; //!< First surface for leaf nodes, second child for interior nodes.
+		int nSurfaces; //!< Zero for interior nodes.
+		int axis;
+	};
+
+	int BuildRecursive( std::vector< BuildSurface >& buildSurfaces, int start, int end, int depth );
+
+	const TraceScene* m_pScene;
+	int m_maxSurfacesInLeaf;
+	std::vector< LinearNode > m_nodes;
+	std::vector< int > m_surfaces;
+};
+
+#endif /* SCENEBVH_H_ */
@@ -0,0 +1,313 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+
+#include <QHash>
+#include <QSet>
+#include <QTextStream>
+
+#include <Inventor/nodes/SoTransform.h>
+
+#include "DifferentialGeometry.h"
+#include "gc.h"
+#include "InstanceNode.h"
+#include "Matrix4x4.h"
+#include "RandomDeviate.h"
+#include "Ray.h"
+#include "ShadingBlockingAnalysis.h"
+#include "tgf.h"
+#include "TLightKit.h"
+#include "trf.h"
+#include "TSceneKit.h"
+
+namespace
+{
+	//Distance before the receiver where the blocking occlusion rays end, so the receiver itself is not found
+	const double receiverTolerance = 0.00001;
+}
+
+/*!
+ * Creates the analysis for the scene \a coinScene with concentrator instance \a rootSeparatorInstance.
+ *
+ * The samples are generated with \a rand. The reflected rays are blocked if they intersect any surface before
+ * the surfaces of the \a receivers subtrees. If \a receivers is empty, any surface blocks the reflected rays.
+ */
+ShadingBlockingAnalysis::ShadingBlockingAnalysis( TSceneKit* coinScene, InstanceNode* rootSeparatorInstance, RandomDeviate& rand,
+		QVector< InstanceNode* > receivers )
+:m_pCoinScene( coinScene ),
+ m_pRootSeparatorInstance( rootSeparatorInstance ),
+ m_pLightKit( 0 ),
+ m_pRand( &rand ),
+ m_receivers( receivers ),
+ m_isCompiled( false )
+{
+	if( m_pCoinScene )	m_pLightKit = static_cast< TLightKit* >( m_pCoinScene->getPart( "lightList[0]", false ) );
+}
+
+/*!
+ * Destroys the analysis.
+ */
+ShadingBlockingAnalysis::~ShadingBlockingAnalysis()
+{
+
+}
+
+/*!
+ * Returns the number of heliostats found in the scene. The heliostats are found when the first sun position is computed.
+ */
+int ShadingBlockingAnalysis::GetNumberOfHeliostats() const
+{
+	return m_heliostats.count();
+}
+
+/*!
+ * Returns the instance of the heliostat with index \a heliostat.
+ */
+InstanceNode* ShadingBlockingAnalysis::GetHeliostat( int heliostat ) const
+{
+	return m_heliostats[heliostat];
+}
+
+/*!
+ * Computes the shading and blocking fractions for each sun position of \a sunPositions with \a samplesPerHeliostat
+ * sun rays for each heliostat.
+ *
+ * After each position is computed, a line with the sun azimuth and elevation, the heliostat, the number of sun rays
+ * that intersect it and its shading and blocking fractions is written to \a results for each heliostat.
+ * Returns false if a sun position could not be computed.
+ */
+bool ShadingBlockingAnalysis::Run( const QVector< QPair< double, double > >& sunPositions, unsigned long samplesPerHeliostat, QTextStream& results )
+{
+	results<<"# azimuth\televation\theliostat\tsamples\tshading\tblocking"<<endl;
+
+	QVector< unsigned long > samples;
+	QVector< double > shading;
+	QVector< double > blocking;
+	for( int p = 0; p < sunPositions.count(); ++p )
+	{
+		if( !Compute( sunPositions[p].first, sunPositions[p].second, samplesPerHeliostat, &samples, &shading, &blocking ) )
+			return false;
+
+		for( int h = 0; h < m_heliostats.count(); ++h )
+			results<<sunPositions[p].first<<"\t"<<sunPositions[p].second<<"\t"<<m_heliostats[h]->GetNodeURL()<<"\t"
+				<<samples[h]<<"\t"<<shading[h]<<"\t"<<blocking[h]<<endl;
+	}
+
+	return true;
+}
+
+/*!
+ * Moves the sun to \a azimuth and \a elevation, in degrees, and samples each heliostat with \a samplesPerHeliostat sun rays.
+ *
+ * For each heliostat, the number of sun rays that intersect it is stored in \a samples and its shading and blocking
+ * fractions in \a shading and \a blocking. Returns false if the scene has no heliostats or no sun.
+ */
+bool ShadingBlockingAnalysis::Compute( double azimuth, double elevation, unsigned long samplesPerHeliostat, QVector< unsigned long >* samples,
+		QVector< double >* shading, QVector< double >* blocking )
+{
+	if( !m_pLightKit || !m_pRootSeparatorInstance || samplesPerHeliostat < 1 )	return false;
+
+	SoTransform* lightTransform = static_cast< SoTransform* >( m_pLightKit->getPart( "transform", false ) );
+	if( !lightTransform )	return false;
+
+	//The scene tracker moves the trackers with TSceneKit::UpdateSunPosition when the sun node transform is read
+	m_pLightKit->ChangePosition( azimuth * gc::Degree, ( 90 - elevation ) * gc::Degree );
+
+	if( !m_isCompiled )
+	{
+		trf::ComputeSceneTreeMap( m_pRootSeparatorInstance, Transform( new Matrix4x4 ), true );
+		m_traceScene.Compile( m_pRootSeparatorInstance );
+
+		//The heliostats are the tracker instances
+		m_heliostats.clear();
+		m_trackerAncestors.clear();
+		trf::ComputeTrackerInstances( m_pRootSeparatorInstance, &m_heliostats, &m_trackerAncestors );
+		ComputeSurfaces();
+		m_isCompiled = true;
+	}
+	else
+	{
+		//Only the heliostats subtrees move with the sun
+		trf::UpdateTrackerInstances( m_pRootSeparatorInstance, m_heliostats, m_trackerAncestors );
+		m_traceScene.Refit();
+	}
+
+	if( m_heliostats.count() < 1 )	return false;
+
+	//The sun shape directions are centered on the light -y axis
+	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
+	Vector3D sunDirection = Normalize( lightToWorld( Vector3D( 0.0, -1.0, 0.0 ) ) );
+
+	samples->fill( 0, m_heliostats.count() );
+	shading->fill( 0.0, m_heliostats.count() );
+	blocking->fill( 0.0, m_heliostats.count() );
+	for( int h = 0; h < m_heliostats.count(); ++h )
+		SampleHeliostat( h, sunDirection, samplesPerHeliostat, &( *samples )[h], &( *shading )[h], &( *blocking )[h] );
+
+	return true;
+}
+
+/*!
+ * Assigns each surface of the compiled scene to the heliostat or the receiver whose subtree contains it.
+ */
+void ShadingBlockingAnalysis::ComputeSurfaces()
+{
+	QHash< InstanceNode*, int > heliostatIndex;
+	for( int h = 0; h < m_heliostats.count(); ++h )
+		heliostatIndex.insert( m_heliostats[h], h );
+
+	QSet< InstanceNode* > receivers;
+	for( int r = 0; r < m_receivers.count(); ++r )
+		receivers.insert( m_receivers[r] );
+
+	m_heliostatSurfaces.fill( QVector< int >(), m_heliostats.count() );
+	m_receiverSurfaces.clear();
+	for( int s = 0; s < m_traceScene.GetNumberOfSurfaces(); ++s )
+	{
+		for( InstanceNode* node = m_traceScene.GetSurfaceInstance( s ); node; node = node->GetParent() )
+		{
+			if( receivers.contains( node ) )
+			{
+				m_receiverSurfaces.push_back( s );
+				break;
+			}
+			if( heliostatIndex.contains( node ) )
+			{
+				m_heliostatSurfaces[heliostatIndex.value( node )].push_back( s );
+				break;
+			}
+		}
+	}
+}
+
+/*!
+ * Samples the heliostat with index \a heliostat with \a samplesPerHeliostat sun rays with direction \a sunDirection.
+ *
+ * The rays start in front of the heliostat bounding box at uniform positions of the box projected perpendicular to
+ * the sun direction. The number of rays that intersect the heliostat surfaces is stored in \a samples and the
+ * shading and blocking fractions of these rays in \a shading and \a blocking.
+ */
+void ShadingBlockingAnalysis::SampleHeliostat( int heliostat, const Vector3D& sunDirection, unsigned long samplesPerHeliostat,
+		unsigned long* samples, double* shading, double* blocking )
+{
+	const QVector< int >& surfaces = m_heliostatSurfaces[heliostat];
+	if( surfaces.count() < 1 )	return;
+
+	//Orthonormal basis with the sun direction as third axis
+	Vector3D axis = ( fabs( sunDirection.x ) < 0.9 ) ? Vector3D( 1.0, 0.0, 0.0 ) : Vector3D( 0.0, 1.0, 0.0 );
+	Vector3D e1 = Normalize( CrossProduct( sunDirection, axis ) );
+	Vector3D e2 = CrossProduct( sunDirection, e1 );
+
+	BBox heliostatBBox = m_heliostats[heliostat]->GetIntersectionBBox();
+	double uMin = gc::Infinity;
+	double uMax = -gc::Infinity;
+	double vMin = gc::Infinity;
+	double vMax = -gc::Infinity;
+	double wMin = gc::Infinity;
+	for( int c = 0; c < 8; ++c )
+	{
+		Vector3D corner( ( c & 1 ) ? heliostatBBox.pMax.x : heliostatBBox.pMin.x,
+				( c & 2 ) ? heliostatBBox.pMax.y : heliostatBBox.pMin.y,
+				( c & 4 ) ? heliostatBBox.pMax.z : heliostatBBox.pMin.z );
+		double u = DotProduct( corner, e1 );
+		double v = DotProduct( corner, e2 );
+		double w = DotProduct( corner, sunDirection );
+		if( u < uMin )	uMin = u;
+		if( u > uMax )	uMax = u;
+		if( v < vMin )	vMin = v;
+		if( v > vMax )	vMax = v;
+		if( w < wMin )	wMin = w;
+	}
+
+	unsigned long nSamples = 0;
+	unsigned long nShaded = 0;
+	unsigned long nBlocked = 0;
+	for( unsigned long i = 0; i < samplesPerHeliostat; ++i )
+	{
+		double u = uMin + ( uMax - uMin ) * m_pRand->RandomDouble();
+		double v = vMin + ( vMax - vMin ) * m_pRand->RandomDouble();
+		Ray sunRay( Point3D( e1 * u + e2 * v + sunDirection * ( wMin - 1.0 ) ), sunDirection );
+
+		//IntersectSurface reduces the ray maxt, so the last intersected surface is the nearest one
+		int hitSurface = -1;
+		DifferentialGeometry dg;
+		Ray objectRay;
+		for( int s = 0; s < surfaces.count(); ++s )
+			if( m_traceScene.IntersectSurface( surfaces[s], sunRay, &dg, &objectRay ) )	hitSurface = surfaces[s];
+		if( hitSurface < 0 )	continue;
+		++nSamples;
+
+		Point3D hitPoint = sunRay( sunRay.maxt );
+		if( m_traceScene.IntersectP( Ray( hitPoint, -sunDirection ) ) )
+		{
+			++nShaded;
+			continue;
+		}
+
+		Vector3D reflectedDirection = objectRay.direction() - 2.0 * Vector3D( dg.normal ) * DotProduct( dg.normal, objectRay.direction() );
+		Transform objectToWorld = m_traceScene.GetSurfaceInstance( hitSurface )->GetIntersectionTransform().GetInverse();
+		if( IsBlocked( Ray( hitPoint, Normalize( objectToWorld( reflectedDirection ) ) ) ) )	++nBlocked;
+	}
+
+	*samples = nSamples;
+	if( nSamples > 0 )	*shading = double( nShaded ) / nSamples;
+	if( nSamples > nShaded )	*blocking = double( nBlocked ) / ( nSamples - nShaded );
+}
+
+/*!
+ * Returns true if \a reflectedRay intersects any surface before it reaches a receiver surface.
+ * If the ray does not reach a receiver, any surface in its path blocks it.
+ */
+bool ShadingBlockingAnalysis::IsBlocked( const Ray& reflectedRay ) const
+{
+	DifferentialGeometry dg;
+	Ray objectRay;
+	bool isReceiverHit = false;
+	for( int r = 0; r < m_receiverSurfaces.count(); ++r )
+		if( m_traceScene.IntersectSurface( m_receiverSurfaces[r], reflectedRay, &dg, &objectRay ) )	isReceiverHit = true;
+
+	if( isReceiverHit )
+	{
+		if( reflectedRay.maxt <= reflectedRay.mint + receiverTolerance )	return false;
+		reflectedRay.maxt -= receiverTolerance;
+	}
+
+	return m_traceScene.IntersectP( reflectedRay );
+}
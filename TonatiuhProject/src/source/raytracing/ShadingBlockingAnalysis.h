@@ -0,0 +1,108 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef SHADINGBLOCKINGANALYSIS_H_
+#define SHADINGBLOCKINGANALYSIS_H_
+
+#include <QPair>
+#include <QVector>
+
+#include "TraceScene.h"
+
+class InstanceNode;
+class QTextStream;
+class RandomDeviate;
+class Ray;
+class TLightKit;
+class TSceneKit;
+struct Vector3D;
+
+//!  ShadingBlockingAnalysis class computes the shading and blocking fractions of each heliostat of a scene.
+/*!
+  The heliostats are the TSeparatorKit nodes with a tracker. For each sun position, sun rays are sampled uniformly
+  over the heliostat bounding box projected perpendicular to the sun direction and intersected with the heliostat
+  surfaces only, so the samples are weighted by the sun power intercepted by the heliostat.
+
+  For each sample, an occlusion ray from the hit point to the sun finds if it is shaded. The unshaded samples are
+  reflected with the surface normal and an occlusion ray finds if the reflected ray is blocked before it reaches the
+  receiver surfaces. The occlusion rays use TraceScene::IntersectP, so the materials and the intersection
+  derivatives are not evaluated and each query stops at the first surface found.
+
+  The shading fraction is the fraction of the samples that are shaded and the blocking fraction the fraction of the
+  unshaded samples that are blocked. The sun is taken as a point source at the center of the sun disk.
+
+  The scene is compiled for the first sun position only. For the next positions only the heliostats subtrees are
+  updated and the TraceScene hierarchy is refitted, as in SunPositionSweep.
+*/
+
+class ShadingBlockingAnalysis
+{
+
+public:
+	ShadingBlockingAnalysis( TSceneKit* coinScene, InstanceNode* rootSeparatorInstance, RandomDeviate& rand,
+			QVector< InstanceNode* > receivers );
+	~ShadingBlockingAnalysis();
+
+	int GetNumberOfHeliostats() const;
+	InstanceNode* GetHeliostat( int heliostat ) const;
+
+	bool Run( const QVector< QPair< double, double > >& sunPositions, unsigned long samplesPerHeliostat, QTextStream& results );
+	bool Compute( double azimuth, double elevation, unsigned long samplesPerHeliostat, QVector< unsigned long >* samples,
+			QVector< double >* shading, QVector< double >* blocking );
+
+private:
+	void ComputeSurfaces();
+	void SampleHeliostat( int heliostat, const Vector3D& sunDirection, unsigned long samplesPerHeliostat,
+			unsigned long* samples, double* shading, double* blocking );
+	bool IsBlocked( const Ray& reflectedRay ) const;
+
+	TSceneKit* m_pCoinScene;
+	InstanceNode* m_pRootSeparatorInstance;
+	TLightKit* m_pLightKit;
+	RandomDeviate* m_pRand;
+	QVector< InstanceNode* > m_receivers;
+	bool m_isCompiled;
+	TraceScene m_traceScene;
+	QVector< InstanceNode* > m_heliostats;
+	QVector< InstanceNode* > m_trackerAncestors;
+	QVector< QVector< int > > m_heliostatSurfaces;
+	QVector< int > m_receiverSurfaces;
+};
+
+#endif /* SHADINGBLOCKINGANALYSIS_H_ */
@@ -0,0 +1,347 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QDate>
+#include <QFile>
+#include <QMutex>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <Inventor/nodes/SoTransform.h>
+
+#include "BBox.h"
+#include "gc.h"
+#include "InstanceNode.h"
+#include "Matrix4x4.h"
+#include "PhotonMapSurfaceCounter.h"
+#include "RandomDeviate.h"
+#include "RayTracer.h"
+#include "RayTracerNoTr.h"
+#include "RayTracingScheduler.h"
+#include "ScheduledRayTracer.h"
+#include "SunPositionSweep.h"
+#include "tgf.h"
+#include "TLightKit.h"
+#include "TLightShape.h"
+#include "TPhotonMap.h"
+#include "trf.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "TSunShape.h"
+#include "TTransmissivity.h"
+#include "sunpos.h"
+
+namespace
+{
+	//Photons kept in memory before they are counted
+	const unsigned long sweepBufferPhotons = 1000000;
+}
+
+/*!
+ * Creates a sweep for the scene \a coinScene with concentrator instance \a rootSeparatorInstance.
+ *
+ * The power of each surface of \a surfaces is computed for each sun position. The rays are generated with
+ * \a rand and the light source area is computed with \a sunWidthDivisions x \a sunHeightDivisions cells.
+ */
+SunPositionSweep::SunPositionSweep( TSceneKit* coinScene, InstanceNode* rootSeparatorInstance, RandomDeviate& rand,
+		QVector< InstanceNode* > surfaces, int sunWidthDivisions, int sunHeightDivisions )
+:m_pCoinScene( coinScene ),
+ m_pRootSeparatorInstance( rootSeparatorInstance ),
+ m_pLightInstance( 0 ),
+ m_pLightKit( 0 ),
+ m_pRand( &rand ),
+ m_surfaces( surfaces ),
+ m_sunWidthDivisions( sunWidthDivisions ),
+ m_sunHeightDivisions( sunHeightDivisions ),
+ m_rayPacketMode( false ),
+ m_usedRandomStreams( 0 ),
+ m_isCompiled( false ),
+ m_surfacesCounter( surfaces )
+{
+	m_photonMap.SetBufferSize( sweepBufferPhotons );
+
+	if( m_pCoinScene )	m_pLightKit = static_cast< TLightKit* >( m_pCoinScene->getPart( "lightList[0]", false ) );
+
+	InstanceNode* sceneInstance = m_pRootSeparatorInstance ? m_pRootSeparatorInstance->GetParent() : 0;
+	if( sceneInstance && sceneInstance->children.count() > 0 )	m_pLightInstance = sceneInstance->children[0];
+}
+
+/*!
+ * Destroys the sweep.
+ */
+SunPositionSweep::~SunPositionSweep()
+{
+
+}
+
+/*!
+ * Returns the index of the next random stream that has not been used by the traced sun positions.
+ */
+unsigned long SunPositionSweep::GetUsedRandomStreams() const
+{
+	return m_usedRandomStreams;
+}
+
+/*!
+ * Sets the first random stream used by the sweep to \a stream.
+ */
+void SunPositionSweep::SetFirstRandomStream( unsigned long stream )
+{
+	m_usedRandomStreams = stream;
+}
+
+/*!
+ * Sets the first stage rays are traced as packets if \a enabled is true.
+ */
+void SunPositionSweep::SetRayPacketMode( bool enabled )
+{
+	m_rayPacketMode = enabled;
+}
+
+/*!
+ * Traces \a raysPerPosition rays for each sun position of \a sunPositions.
+ *
+ * After each position is traced, a line with the sun azimuth and elevation, the power of the sun that enters
+ * the scene and the power of each surface is written to \a results, so the results can be read while the sweep runs.
+ * Returns false if a sun position could not be traced.
+ */
+bool SunPositionSweep::Run( const QVector< QPair< double, double > >& sunPositions, unsigned long raysPerPosition, QTextStream& results )
+{
+	results<<"# azimuth\televation\tinput power";
+	for( int s = 0; s < m_surfaces.count(); ++s )
+		results<<"\t"<<m_surfaces[s]->GetNodeURL();
+	results<<endl;
+
+	QVector< double > surfacesPower;
+	for( int p = 0; p < sunPositions.count(); ++p )
+	{
+		double inputPower = 0.0;
+		if( !Trace( sunPositions[p].first, sunPositions[p].second, raysPerPosition, &inputPower, &surfacesPower ) )
+			return false;
+
+		results<<sunPositions[p].first<<"\t"<<sunPositions[p].second<<"\t"<<inputPower;
+		for( int s = 0; s < surfacesPower.count(); ++s )
+			results<<"\t"<<surfacesPower[s];
+		results<<endl;
+	}
+
+	return true;
+}
+
+/*!
+ * Moves the sun to \a azimuth and \a elevation, in degrees, and traces \a numberOfRays rays.
+ *
+ * The power of the sun that enters the scene is stored in \a inputPower and the power of each surface in \a surfacesPower.
+ * Returns false if the scene is not ready for ray tracing.
+ */
+bool SunPositionSweep::Trace( double azimuth, double elevation, unsigned long numberOfRays, double* inputPower, QVector< double >* surfacesPower )
+{
+	if( !m_pLightKit || !m_pLightInstance || !m_pRootSeparatorInstance )	return false;
+	if( m_surfaces.count() < 1 || numberOfRays < 1 )	return false;
+
+	TSunShape* sunShape = static_cast< TSunShape* >( m_pLightKit->getPart( "tsunshape", false ) );
+	TLightShape* raycastingSurface = static_cast< TLightShape* >( m_pLightKit->getPart( "icon", false ) );
+	SoTransform* lightTransform = static_cast< SoTransform* >( m_pLightKit->getPart( "transform", false ) );
+	if( !sunShape || !raycastingSurface || !lightTransform )	return false;
+
+	TTransmissivity* transmissivity = static_cast< TTransmissivity* >( m_pCoinScene->getPart( "transmissivity", false ) );
+
+	//The trackers are connected to the light angles, their transforms are evaluated when they are read
+	m_pLightKit->ChangePosition( azimuth * gc::Degree, ( 90 - elevation ) * gc::Degree );
+
+	if( !m_isCompiled )
+	{
+		trf::ComputeSceneTreeMap( m_pRootSeparatorInstance, Transform( new Matrix4x4 ), true );
+		m_traceScene.Compile( m_pRootSeparatorInstance );
+
+		QStringList disabledNodes = QString( m_pLightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
+		m_firstStageSurfaces.clear();
+		ComputeFirstStageSurfaces( m_pRootSeparatorInstance, disabledNodes );
+
+		m_trackerInstances.clear();
+		m_trackerAncestors.clear();
+		trf::ComputeTrackerInstances( m_pRootSeparatorInstance, &m_trackerInstances, &m_trackerAncestors );
+		m_isCompiled = true;
+	}
+	else
+	{
+		trf::UpdateTrackerInstances( m_pRootSeparatorInstance, m_trackerInstances, m_trackerAncestors );
+		m_traceScene.Refit();
+	}
+
+	m_pLightKit->Update( m_traceScene.GetBBox() );
+
+	QVector< QPair< TShapeKit*, Transform > > surfacesList;
+	for( int s = 0; s < m_firstStageSurfaces.count(); ++s )
+		surfacesList.push_back( QPair< TShapeKit*, Transform >( static_cast< TShapeKit* >( m_firstStageSurfaces[s]->GetNode() ),
+				m_firstStageSurfaces[s]->GetIntersectionTransform() ) );
+	if( surfacesList.count() < 1 )	return false;
+	m_pLightKit->ComputeLightSourceArea( m_sunWidthDivisions, m_sunHeightDivisions, surfacesList );
+
+	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
+	m_pLightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
+
+	//Setting the export mode again starts the counter from zero
+	if( !m_photonMap.SetExportMode( &m_surfacesCounter ) )	return false;
+
+	RayTracingScheduler scheduler( numberOfRays, m_usedRandomStreams, QThread::idealThreadCount() );
+	m_usedRandomStreams += scheduler.NumberOfBlocks();
+	QVector< int > workers = scheduler.Workers();
+
+	QMutex mutex;
+	m_photonMap.StartStore();
+	if( transmissivity )
+		QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracer >( &scheduler, RayTracer( &m_traceScene,
+						m_pLightInstance, raycastingSurface, sunShape, lightToWorld,
+						transmissivity,
+						*m_pRand,
+						&mutex, &m_photonMap,
+						m_surfaces,
+						m_rayPacketMode ) ) ).waitForFinished();
+	else
+		QtConcurrent::map( workers,
+				ScheduledRayTracer< RayTracerNoTr >( &scheduler, RayTracerNoTr( &m_traceScene,
+						m_pLightInstance, raycastingSurface, sunShape, lightToWorld,
+						*m_pRand,
+						&mutex, &m_photonMap,
+						m_surfaces,
+						m_rayPacketMode ) ) ).waitForFinished();
+
+	*inputPower = raycastingSurface->GetValidArea() * sunShape->GetIrradiance();
+	m_photonMap.EndStore( *inputPower / numberOfRays );
+
+	surfacesPower->resize( m_surfaces.count() );
+	for( int s = 0; s < m_surfaces.count(); ++s )
+		( *surfacesPower )[s] = m_surfacesCounter.GetPower( s );
+
+	return true;
+}
+
+/*!
+ * Returns the sun positions, as azimuth and elevation in degrees, at the middle of each hour of \a year for the
+ * location with \a latitude and \a longitude in degrees. The hours are ut time and the hours without sun are not included.
+ */
+QVector< QPair< double, double > > SunPositionSweep::HourlySunPositions( int year, double latitude, double longitude )
+{
+	QVector< QPair< double, double > > sunPositions;
+	cLocation location = { longitude, latitude };
+
+	for( QDate day( year, 1, 1 ); day.year() == year; day = day.addDays( 1 ) )
+	{
+		for( int hour = 0; hour < 24; ++hour )
+		{
+			cTime time = { year, day.month(), day.day(), double( hour ), 30.0, 0.0 };
+			cSunCoordinates sunCoordinates;
+			sunpos( time, location, &sunCoordinates );
+
+			double elevation = 90 - sunCoordinates.dZenithAngle;
+			if( elevation > 0.0 )
+				sunPositions.push_back( QPair< double, double >( sunCoordinates.dAzimuth, elevation ) );
+		}
+	}
+
+	return sunPositions;
+}
+
+/*!
+ * Reads the sun positions of the file \a fileName into \a sunPositions. Each line defines a sun position as
+ * "azimuth elevation" in degrees or as "year month day hours minutes seconds latitude longitude", with ut time and
+ * the location in degrees. Empty lines and lines starting with '#' are skipped.
+ *
+ * Returns false if the file cannot be read or a line is not valid.
+ */
+bool SunPositionSweep::ReadSunPositions( QString fileName, QVector< QPair< double, double > >* sunPositions )
+{
+	QFile positionsFile( fileName );
+	if( !positionsFile.open( QIODevice::ReadOnly | QIODevice::Text ) )	return false;
+
+	QTextStream in( &positionsFile );
+	while( !in.atEnd() )
+	{
+		QString line = in.readLine().trimmed();
+		if( line.isEmpty() || line.startsWith( QLatin1Char( '#' ) ) )	continue;
+
+		QStringList values = line.split( QRegExp( "[\\s,;]+" ), QString::SkipEmptyParts );
+		QVector< double > numbers;
+		for( int v = 0; v < values.count(); ++v )
+		{
+			bool ok = false;
+			numbers.push_back( values[v].toDouble( &ok ) );
+			if( !ok )	return false;
+		}
+
+		if( numbers.count() == 2 )
+			sunPositions->push_back( QPair< double, double >( numbers[0], numbers[1] ) );
+		else if( numbers.count() == 8 )
+		{
+			cTime time = { int( numbers[0] ), int( numbers[1] ), int( numbers[2] ), numbers[3], numbers[4], numbers[5] };
+			cLocation location = { numbers[7], numbers[6] };
+			cSunCoordinates sunCoordinates;
+			sunpos( time, location, &sunCoordinates );
+			sunPositions->push_back( QPair< double, double >( sunCoordinates.dAzimuth, 90 - sunCoordinates.dZenithAngle ) );
+		}
+		else
+			return false;
+	}
+
+	return true;
+}
+
+/*!
+ * Adds to the first stage surfaces the surfaces of the \a instanceNode subtree that are not in \a disabledNodesURL.
+ * The instances are stored, so the surfaces list can be updated for each sun position without walking the tree.
+ */
+void SunPositionSweep::ComputeFirstStageSurfaces( InstanceNode* instanceNode, const QStringList& disabledNodesURL )
+{
+	if( !instanceNode || !instanceNode->GetNode() )	return;
+	if( disabledNodesURL.contains( instanceNode->GetNodeURL() ) )	return;
+
+	if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TSeparatorKit::getClassTypeId() ) )
+	{
+		for( int index = 0; index < instanceNode->children.count(); ++index )
+			ComputeFirstStageSurfaces( instanceNode->children[index], disabledNodesURL );
+	}
+	else if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+		m_firstStageSurfaces.push_back( instanceNode );
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef SUNPOSITIONSWEEP_H_
+#define SUNPOSITIONSWEEP_H_
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "PhotonMapSurfaceCounter.h"
+#include "TPhotonMap.h"
+#include "TraceScene.h"
+
+class InstanceNode;
+class QTextStream;
+class RandomDeviate;
+class TLightKit;
+class TSceneKit;
+
+//!  SunPositionSweep class traces a scene for a list of sun positions.
+/*!
+  The scene is compiled for the first sun position only. For the next positions the light is moved, only the subtrees
+  of the trackers are updated to the new trackers transforms, and the TraceScene hierarchy is refitted to the new
+  surfaces transforms instead of being rebuilt. The first stage surfaces are also found only once.
+
+  For each sun position the power of the given surfaces is computed with a PhotonMapSurfaceCounter, so the photons
+  are not stored. The photon map and the counter are reused for all the positions. The sun positions are defined as azimuth and elevation pairs in degrees.
+*/
+
+class SunPositionSweep
+{
+
+public:
+	SunPositionSweep( TSceneKit* coinScene, InstanceNode* rootSeparatorInstance, RandomDeviate& rand,
+			QVector< InstanceNode* > surfaces, int sunWidthDivisions, int sunHeightDivisions );
+	~SunPositionSweep();
+
+	unsigned long GetUsedRandomStreams() const;
+	void SetFirstRandomStream( unsigned long stream );
+	void SetRayPacketMode( bool enabled );
+
+	bool Run( const QVector< QPair< double, double > >& sunPositions, unsigned long raysPerPosition, QTextStream& results );
+	bool Trace( double azimuth, double elevation, unsigned long numberOfRays, double* inputPower, QVector< double >* surfacesPower );
+
+	static QVector< QPair< double, double > > HourlySunPositions( int year, double latitude, double longitude );
+	static bool ReadSunPositions( QString fileName, QVector< QPair< double, double > >* sunPositions );
+
+private:
+	void ComputeFirstStageSurfaces( InstanceNode* instanceNode, const QStringList& disabledNodesURL );
+
+	TSceneKit* m_pCoinScene;
+	InstanceNode* m_pRootSeparatorInstance;
+	InstanceNode* m_pLightInstance;
+	TLightKit* m_pLightKit;
+	RandomDeviate* m_pRand;
+	QVector< InstanceNode* > m_surfaces;
+	int m_sunWidthDivisions;
+	int m_sunHeightDivisions;
+	bool m_rayPacketMode;
+	unsigned long m_usedRandomStreams;
+	bool m_isCompiled;
+	TraceScene m_traceScene;
+	QVector< InstanceNode* > m_firstStageSurfaces;
+	QVector< InstanceNode* > m_trackerInstances;
+	QVector< InstanceNode* > m_trackerAncestors;
+	PhotonMapSurfaceCounter m_surfacesCounter;
+	TPhotonMap m_photonMap;
+};
+
+#endif /* SUNPOSITIONSWEEP_H_ */
@@ -1,5 +1,6 @@
 
 #include "PhotonMapExport.h"
+#include "PhotonMapWriter.h"
 #include "TPhotonMap.h"
 
 /*!
@@ -10,7 +11,11 @@ TPhotonMap::TPhotonMap()
  m_pExportPhotonMap( 0 ),
  m_pSceneModel( 0 ),
  m_storedPhotonsInBuffer( 0 ),
- m_storedAllPhotons( 0 )
+ m_storedAllPhotons( 0 ),
+ m_pWriter( 0 ),
+ m_numberOfBuffers( 2 ),
+ m_fillingBuffer( -1 ),
+ m_finishStore( false )
 {
 
 }
@@ -20,16 +25,7 @@ TPhotonMap::TPhotonMap()
  */
 TPhotonMap::~TPhotonMap()
 {
-	unsigned int photonListSize = m_photonsInMemory.size();
-	for( unsigned int i = 0; i < photonListSize ;++i )
-	{
-		delete m_photonsInMemory[i];
-		m_photonsInMemory[i] = 0;
-	}
-
-	m_photonsInMemory.clear();
-	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
-	m_storedPhotonsInBuffer = 0;
+	FinishStore();
 }
 
 /*!
@@ -37,30 +33,42 @@ TPhotonMap::~TPhotonMap()
  */
 void TPhotonMap::EndStore( double wPhoton )
 {
-	if( m_storedPhotonsInBuffer  > 0 )
-	{
-		if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
+	FinishStore();
 
-		unsigned int photonListSize = m_photonsInMemory.size();
-		for( unsigned int i = 0; i < photonListSize ;++i )
-		{
-			delete m_photonsInMemory[i];
-			m_photonsInMemory[i] = 0;
-		}
+	if( m_storedPhotonsInBuffer  > 0 )	SaveStoredPhotons();
 
-		m_photonsInMemory.clear();
-    	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
-		m_storedPhotonsInBuffer = 0;
+	//The tracing has finished, the memory of the buffers is released.
+	std::vector< Photon >().swap( m_photonsInMemory );
+	std::vector< RaysBuffer >().swap( m_buffers );
 
-	}
 	if( m_pExportPhotonMap )	m_pExportPhotonMap->SetPowerPerPhoton( wPhoton );
 	if( m_pExportPhotonMap )	m_pExportPhotonMap->EndExport();
 }
 
 /*!
+ * Waits until the writer thread has saved the filled buffers and stops it. The photons of the buffer that was being
+ * filled are stored without saving them.
  *
+ * After this, StoreRays stores the photons in the calling thread again and the photons of the buffer can be read.
+ */
+void TPhotonMap::FinishStore()
+{
+	if( !m_pWriter )	return;
+
+	m_buffersMutex.lock();
+	m_finishStore = true;
+	m_bufferFilled.wakeAll();
+	m_buffersMutex.unlock();
+
+	m_pWriter->wait();
+	delete m_pWriter;
+	m_pWriter = 0;
+}
+
+/*!
+ * Returns the photons stored in the buffer. The photons are stored contiguously in the order they were stored.
  */
-std::vector< Photon* > TPhotonMap::GetAllPhotons() const
+const std::vector< Photon >& TPhotonMap::GetAllPhotons() const
 {
 	return ( m_photonsInMemory );
 }
@@ -105,27 +113,162 @@ bool TPhotonMap::SetExportMode( PhotonMapExport* pExportPhotonMap )
 	return 1;
 }
 
+/*!
+ * Sets the number of buffers of photons used while the writer thread runs to \a nBuffers. One buffer is filled while
+ * the writer thread saves the others, so the threads that store the photons only wait when all the other buffers are
+ * waiting to be saved. At least two buffers are used.
+ */
+void TPhotonMap::SetNumberOfBuffers( unsigned long nBuffers )
+{
+	m_numberOfBuffers = ( nBuffers < 2 ) ? 2 : nBuffers;
+}
+
+/*!
+ * Starts a writer thread that saves the buffers filled by StoreRays with the export mode, so the threads that trace
+ * the rays do not wait while a buffer is saved. FinishStore must be called before reading the buffer photons.
+ */
+void TPhotonMap::StartStore()
+{
+	if( m_pWriter )	return;
+
+	m_buffers.resize( m_numberOfBuffers );
+	m_fillingBuffer = 0;
+	m_filledBuffers.clear();
+	m_freeBuffers.clear();
+	for( int b = m_numberOfBuffers - 1; b > 0; --b )
+		m_freeBuffers.push_back( b );
+
+	m_finishStore = false;
+	m_pWriter = new PhotonMapWriter( this );
+	m_pWriter->start();
+}
+
+/*!
+ * Stores the photons of \a raysList. This function can be called from several threads.
+ *
+ * If the writer thread is running, \a raysList is swapped into the buffer that is being filled without copying the
+ * photons, and it is left empty with the memory of a list already saved. When the buffer has not enough space, it is
+ * passed to the writer thread and the next free buffer is filled. The calling thread only waits if there is no free
+ * buffer. Otherwise, the photons are copied to the buffer in the calling thread.
+ */
 void TPhotonMap::StoreRays( std::vector< Photon >& raysList )
 {
-	unsigned int raysListSize = raysList.size();
-	if( ( m_storedPhotonsInBuffer > 0 ) && ( ( m_storedPhotonsInBuffer + raysListSize )  > m_bufferSize ) )
+	if( !m_pWriter )
 	{
-		if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
+		QMutexLocker locker( &m_storeMutex );
+		StoreInBuffer( raysList );
+		return;
+	}
+
+	unsigned long raysListSize = raysList.size();
 
-		unsigned int photonListSize = m_photonsInMemory.size();
-		for( unsigned int i = 0; i < photonListSize ;++i )
+	QMutexLocker locker( &m_buffersMutex );
+	while( m_fillingBuffer < 0 )
+		m_bufferSaved.wait( &m_buffersMutex );
+
+	if( ( m_buffers[m_fillingBuffer].nPhotons > 0 ) &&
+			( ( m_buffers[m_fillingBuffer].nPhotons + raysListSize ) > m_bufferSize ) )
+	{
+		m_filledBuffers.push_back( m_fillingBuffer );
+		m_bufferFilled.wakeOne();
+
+		m_fillingBuffer = -1;
+		if( !m_freeBuffers.empty() )
 		{
-			delete m_photonsInMemory[i];
-			m_photonsInMemory[i] = 0;
+			m_fillingBuffer = m_freeBuffers.back();
+			m_freeBuffers.pop_back();
 		}
-		m_photonsInMemory.clear();
-    	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
-		m_storedPhotonsInBuffer = 0;
+		while( m_fillingBuffer < 0 )
+			m_bufferSaved.wait( &m_buffersMutex );
+	}
+
+	RaysBuffer& buffer = m_buffers[m_fillingBuffer];
+	if( buffer.nLists == buffer.raysLists.size() )
+		buffer.raysLists.push_back( std::vector< Photon >() );
+	buffer.raysLists[buffer.nLists++].swap( raysList );
+	buffer.nPhotons += raysListSize;
+}
+
+/*!
+ * Copies the photons of the lists of \a buffer to the buffer of the photon map and empties \a buffer. The lists keep
+ * their memory.
+ */
+void TPhotonMap::StoreBuffer( RaysBuffer& buffer )
+{
+	for( unsigned long l = 0; l < buffer.nLists; ++l )
+	{
+		StoreInBuffer( buffer.raysLists[l] );
+		buffer.raysLists[l].clear();
 	}
+	buffer.nLists = 0;
+	buffer.nPhotons = 0;
+}
+
+/*!
+ * Copies the photons of \a raysList to the buffer. If the buffer has not enough space, the stored photons are saved first.
+ *
+ * The buffer keeps its capacity after saving the photons, so once it has grown to the buffer size, storing does not allocate memory.
+ */
+void TPhotonMap::StoreInBuffer( std::vector< Photon >& raysList )
+{
+	unsigned int raysListSize = raysList.size();
+	if( ( m_storedPhotonsInBuffer > 0 ) && ( ( m_storedPhotonsInBuffer + raysListSize )  > m_bufferSize ) )
+		SaveStoredPhotons();
 
-	for( unsigned int photon = 0; photon < raysListSize; photon++ )
-		m_photonsInMemory.push_back( new Photon( raysList[photon] ) );
+	m_photonsInMemory.insert( m_photonsInMemory.end(), raysList.begin(), raysList.end() );
 
 	m_storedPhotonsInBuffer += raysListSize;
 	m_storedAllPhotons += raysListSize;
 }
+
+/*!
+ * Saves the filled buffers in the order they were filled until FinishStore is called and all of them are saved. The
+ * buffers are not locked while they are saved, so the ray tracing threads can continue filling another buffer. Each
+ * saved buffer becomes the buffer being filled if the ray tracing threads are waiting for one, or a free buffer.
+ */
+void TPhotonMap::SaveFilledBuffers()
+{
+	while( true )
+	{
+		m_buffersMutex.lock();
+		while( m_filledBuffers.empty() && !m_finishStore )
+			m_bufferFilled.wait( &m_buffersMutex );
+
+		if( m_filledBuffers.empty() )
+		{
+			m_buffersMutex.unlock();
+			if( m_fillingBuffer >= 0 )	StoreBuffer( m_buffers[m_fillingBuffer] );
+			return;
+		}
+
+		int filledBuffer = m_filledBuffers.front();
+		m_filledBuffers.pop_front();
+		m_buffersMutex.unlock();
+
+		StoreBuffer( m_buffers[filledBuffer] );
+		SaveStoredPhotons();
+
+		m_buffersMutex.lock();
+		if( m_fillingBuffer < 0 )
+		{
+			m_fillingBuffer = filledBuffer;
+			m_bufferSaved.wakeAll();
+		}
+		else
+			m_freeBuffers.push_back( filledBuffer );
+		m_buffersMutex.unlock();
+	}
+}
+
+/*!
+ * Saves the photons of the buffer with the export mode and empties the buffer without releasing its memory.
+ *
+ * If the writer thread is running, it is called from the writer thread.
+ */
+void TPhotonMap::SaveStoredPhotons()
+{
+	if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
+
+	m_photonsInMemory.clear();
+	m_storedPhotonsInBuffer = 0;
+}
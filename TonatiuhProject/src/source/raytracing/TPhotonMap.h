@@ -1,9 +1,16 @@
 #ifndef TPHOTONMAP_H_
 #define TPHOTONMAP_H_
 
+#include <deque>
+#include <vector>
+
+#include <QMutex>
+#include <QWaitCondition>
+
 #include "Photon.h"
 
 class PhotonMapExport;
+class PhotonMapWriter;
 
 class TPhotonMap
 {
@@ -12,23 +19,54 @@ public:
 	~TPhotonMap();
 
     void EndStore( double wPhoton );
-	std::vector< Photon* > GetAllPhotons() const;
+	void FinishStore();
+	const std::vector< Photon >& GetAllPhotons() const;
 	PhotonMapExport* GetExportMode( ) const;
 	void SetBufferSize( unsigned long nPhotons );
 	void SetConcentratorToWorld( Transform concentratorToWorld );
 	bool SetExportMode( PhotonMapExport* pExportPhotonMap );
+	void SetNumberOfBuffers( unsigned long nBuffers );
+	void StartStore();
 	void StoreRays( std::vector< Photon >& ray );
 
 
 private:
+	friend class PhotonMapWriter;
+
+	//! Photons lists stored while the writer thread runs. The lists keep their memory to be reused.
+	struct RaysBuffer
+	{
+		RaysBuffer() : nLists( 0 ), nPhotons( 0 ) {}
+
+		std::vector< std::vector< Photon > > raysLists;
+		unsigned long nLists;
+		unsigned long nPhotons;
+	};
+
+	void SaveFilledBuffers();
+	void SaveStoredPhotons();
+	void StoreBuffer( RaysBuffer& buffer );
+	void StoreInBuffer( std::vector< Photon >& raysList );
+
     unsigned long m_bufferSize;
     Transform m_concentratorToWorld;
     PhotonMapExport* m_pExportPhotonMap;
 	const SceneModel* m_pSceneModel;
     unsigned long m_storedPhotonsInBuffer;
     unsigned long m_storedAllPhotons;
-    std::vector< Photon* > m_photonsInMemory;
+    std::vector< Photon > m_photonsInMemory;
+    QMutex m_storeMutex;
 
+    PhotonMapWriter* m_pWriter;
+    unsigned long m_numberOfBuffers;
+    QMutex m_buffersMutex;
+    QWaitCondition m_bufferFilled;
+    QWaitCondition m_bufferSaved;
+    std::vector< RaysBuffer > m_buffers;
+    int m_fillingBuffer;
+    std::deque< int > m_filledBuffers;
+    std::vector< int > m_freeBuffers;
+    bool m_finishStore;
 
 };
 
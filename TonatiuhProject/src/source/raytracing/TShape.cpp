@@ -36,6 +36,10 @@ Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimen
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include "DifferentialGeometry.h"
+#include "InstancedShape.h"
+#include "Ray.h"
+#include "RayPacket.h"
 #include "TShape.h"
 
 SO_NODE_ABSTRACT_SOURCE(TShape);
@@ -54,3 +58,71 @@ TShape::~TShape()
 {
 
 }
+
+/*!
+ * Copies the fields values, and the constants derived from them, that the intersection uses into plain members of the shape.
+ * The scene calls it when it is compiled for tracing, so Intersect does not read the Coin fields for each ray.
+ *
+ * It is also called when the shape is read from a file, so it only copies values. Larger data that the intersection
+ * needs is built by PrepareTracing.
+ *
+ * The default implementation does nothing. Shapes that keep their parameters reimplement it and call it from their constructor.
+ */
+void TShape::CompileParameters()
+{
+
+}
+
+/*!
+ * Builds the data that the intersection would otherwise create on the first intersection, as meshes and hierarchies.
+ * The scene calls it after CompileParameters when it is compiled for tracing, before the tracing threads start.
+ *
+ * The default implementation does nothing.
+ */
+void TShape::PrepareTracing()
+{
+
+}
+
+/*!
+ * Reads the shape fields from \a in and compiles the parameters, so the parameters of a shape read from a file are
+ * the read values and not the constructor ones, also when the field sensors have not been processed yet.
+ * The data built by PrepareTracing is not built until the shape is traced.
+ */
+SbBool TShape::readInstance( SoInput* in, unsigned short flags )
+{
+	SbBool isRead = SoShape::readInstance( in, flags );
+	if( isRead )	CompileParameters();
+	return isRead;
+}
+
+/*!
+ * Returns true if TraceScene can intersect the shape with the InstancedShape kernels and stores the shape type and
+ * its compiled parameters in \a instancedShape. It is called after CompileParameters.
+ *
+ * The default implementation returns false. The shapes whose Intersect test is an InstancedShape type reimplement it.
+ */
+bool TShape::GetInstancedShape( InstancedShape* /*instancedShape*/ ) const
+{
+	return false;
+}
+
+/*!
+ * Intersects the rays of \a objectRays with a bit set in \a raysMask with the shape. Returns a mask with the bit
+ * of each intersected ray set and stores its intersection distance in \a tHits.
+ *
+ * The default implementation intersects the rays one by one with Intersect. Shapes with a packet kernel reimplement it.
+ */
+int TShape::IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const
+{
+	int hitMask = 0;
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		if( !( raysMask & ( 1 << i ) ) )	continue;
+
+		DifferentialGeometry dg;
+		if( Intersect( objectRays.GetRay( i ), &tHits[i], &dg ) )	hitMask |= ( 1 << i );
+	}
+
+	return hitMask;
+}
@@ -43,10 +43,12 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 struct BBox;
 struct DifferentialGeometry;
+struct InstancedShape;
 struct NormalVector;
 struct Point3D;
 class QString;
 class Ray;
+struct RayPacket;
 
 class TShape : public SoShape
 {
@@ -57,15 +59,20 @@ public:
 
 	virtual bool IntersectP( const Ray& objectRay ) const = 0;
 	virtual bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const = 0;
+	virtual int IntersectPacket( const RayPacket& objectRays, int raysMask, double* tHits ) const;
 	virtual double GetArea() const = 0;
 	virtual double GetVolume() const = 0;
 	virtual BBox GetBBox() const = 0;
 	virtual QString GetIcon() const = 0;
 	virtual Point3D Sample( double u, double v ) const = 0;
+	virtual void CompileParameters();
+	virtual void PrepareTracing();
+	virtual bool GetInstancedShape( InstancedShape* instancedShape ) const;
 
 protected:
 	virtual void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center) = 0;
 	virtual void generatePrimitives(SoAction *action) = 0;
+	virtual SbBool readInstance( SoInput* in, unsigned short flags );
 
     TShape();
     ~TShape();
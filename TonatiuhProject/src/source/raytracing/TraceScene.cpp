@@ -0,0 +1,393 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "DifferentialGeometry.h"
+#include "InstanceNode.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "TMaterial.h"
+#include "TraceScene.h"
+#include "TSeparatorKit.h"
+#include "TShape.h"
+#include "TShapeKit.h"
+
+/*!
+ * Creates an empty scene.
+ */
+TraceScene::TraceScene()
+{
+
+}
+
+/*!
+ * Destroys the scene. The InstanceNodes and the Coin nodes are not deleted.
+ */
+TraceScene::~TraceScene()
+{
+
+}
+
+/*!
+ * Compiles the surfaces of the subtree with top node \a rootNode and builds the acceleration structure.
+ * The shapes parameters are compiled too, the shapes fields must not change until the scene is compiled again.
+ *
+ * The world bounding boxes and transforms of the nodes must be computed before with trf::ComputeSceneTreeMap.
+ */
+void TraceScene::Compile( InstanceNode* rootNode )
+{
+	Clear();
+	CompileRecursive( rootNode );
+	m_bvh.Build( this );
+}
+
+/*!
+ * Updates the surfaces transforms and bounding boxes from their InstanceNodes and refits the hierarchy.
+ *
+ * trf::ComputeSceneTreeMap must be called before. The scene tree must be the one that was compiled, only the
+ * nodes transforms can change between Compile and Refit.
+ */
+void TraceScene::Refit()
+{
+	for( int s = 0; s < int( m_instances.size() ); ++s )
+	{
+		m_worldToObject[s] = m_instances[s]->GetIntersectionTransform();
+		m_objectToWorld[s] = m_worldToObject[s].GetInverse();
+		m_bboxes[s] = m_instances[s]->GetIntersectionBBox();
+
+		//A surface whose previous transform was projective is intersected with its group again
+		m_surfaceInstancedShape[s] = m_shapeInstancedShape.value( m_shapes[s], -1 );
+		SetInstanceMatrix( s );
+	}
+	m_bvh.Refit();
+}
+
+/*!
+ * Removes all the surfaces of the scene.
+ */
+void TraceScene::Clear()
+{
+	m_bvh.Clear();
+	m_shapes.clear();
+	m_materials.clear();
+	m_worldToObject.clear();
+	m_objectToWorld.clear();
+	m_bboxes.clear();
+	m_instances.clear();
+	m_instancedShapes.clear();
+	m_surfaceInstancedShape.clear();
+	m_shapeInstancedShape.clear();
+	m_instanceMatrices.clear();
+}
+
+/*!
+ * Returns the number of surfaces of the scene.
+ */
+int TraceScene::GetNumberOfSurfaces() const
+{
+	return m_shapes.size();
+}
+
+/*!
+ * Returns the world bounding box of the scene.
+ */
+BBox TraceScene::GetBBox() const
+{
+	return m_bvh.GetBBox();
+}
+
+/*!
+ * Returns the world bounding box of the surface with index \a surface.
+ */
+BBox TraceScene::GetSurfaceBBox( int surface ) const
+{
+	return m_bboxes[surface];
+}
+
+/*!
+ * Returns the InstanceNode of the surface with index \a surface.
+ */
+InstanceNode* TraceScene::GetSurfaceInstance( int surface ) const
+{
+	return m_instances[surface];
+}
+
+/*!
+ * Finds the nearest surface intersected by \a ray. The ray \a maxt is updated to the intersection distance.
+ *
+ * Returns true if the material of the intersected surface generates an output ray. In this case, \a outputRay
+ * is the ray in world coordinates. \a modelNode is the intersected surface and \a isShapeFront the side of
+ * the intersection.
+ */
+bool TraceScene::Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const
+{
+	int surface = -1;
+	DifferentialGeometry dg;
+	Ray objectRay;
+	if( !m_bvh.Intersect( ray, &surface, &dg, &objectRay ) )	return false;
+
+	return SurfaceOutputRay( surface, objectRay, &dg, rand, isShapeFront, modelNode, outputRay );
+}
+
+/*!
+ * Intersects \a ray with the surface with index \a surface and evaluates its material as Intersect does.
+ *
+ * It is used to complete the rays of a packet once IntersectPacket has found their nearest surface.
+ */
+bool TraceScene::IntersectSurface( int surface, const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const
+{
+	DifferentialGeometry dg;
+	Ray objectRay;
+	if( !IntersectSurface( surface, ray, &dg, &objectRay ) )	return false;
+
+	return SurfaceOutputRay( surface, objectRay, &dg, rand, isShapeFront, modelNode, outputRay );
+}
+
+/*!
+ * Returns true if \a ray intersects any surface of the scene before its maxt. The ray maxt is not changed.
+ *
+ * The search stops at the first intersection found and the shapes do not compute the intersection differential geometry.
+ */
+bool TraceScene::IntersectP( const Ray& ray ) const
+{
+	return m_bvh.IntersectP( ray );
+}
+
+/*!
+ * Returns true if \a ray intersects the shape of the surface with index \a surface before its maxt.
+ */
+bool TraceScene::IntersectSurfaceP( int surface, const Ray& ray ) const
+{
+	if( !m_bboxes[surface].IntersectP( ray ) )	return false;
+
+	int instancedShape = m_surfaceInstancedShape[surface];
+	if( instancedShape >= 0 )
+	{
+		double thit = 0.0;
+		return m_instancedShapes[instancedShape].Intersect( &m_instanceMatrices[InstancedShape::MatrixSize * surface], ray, &thit );
+	}
+
+	return m_shapes[surface]->IntersectP( m_worldToObject[surface]( ray ) );
+}
+
+/*!
+ * Finds the nearest surface intersected by each ray of \a rays. The rays maxt are updated to the intersection distances.
+ *
+ * Returns a mask with the bit of each ray that intersects a surface set and stores the index of the surface in \a surfaces.
+ * The materials are not evaluated, IntersectSurface completes each ray with its surface.
+ */
+int TraceScene::IntersectPacket( const RayPacket& rays, int* surfaces ) const
+{
+	return m_bvh.IntersectPacket( rays, surfaces );
+}
+
+/*!
+ * Intersects the rays of \a rays with a bit set in \a raysMask with the shape of the surface with index \a surface.
+ *
+ * For the rays that intersect the shape before their maxt, maxt is updated to the intersection distance and \a surface is
+ * stored in \a surfaces. Returns a mask with the bits of these rays set.
+ */
+int TraceScene::IntersectSurfacePacket( int surface, const RayPacket& rays, int raysMask, int* surfaces ) const
+{
+	raysMask &= m_bboxes[surface].IntersectP( rays );
+	if( raysMask == 0 )	return 0;
+
+	double tHits[RayPacket::Size];
+	int hitMask = 0;
+	int instancedShape = m_surfaceInstancedShape[surface];
+	if( instancedShape >= 0 )
+		hitMask = m_instancedShapes[instancedShape].IntersectPacket( &m_instanceMatrices[InstancedShape::MatrixSize * surface],
+				rays, raysMask, tHits );
+	else
+	{
+		RayPacket surfaceRays;
+		m_worldToObject[surface]( rays, surfaceRays );
+		hitMask = m_shapes[surface]->IntersectPacket( surfaceRays, raysMask, tHits );
+	}
+	for( int i = 0; i < RayPacket::Size; ++i )
+	{
+		if( !( hitMask & ( 1 << i ) ) )	continue;
+		rays.maxt[i] = tHits[i];
+		surfaces[i] = surface;
+	}
+
+	return hitMask;
+}
+
+/*!
+ * Evaluates the material of the surface with index \a surface for the intersection \a dg of \a objectRay.
+ */
+bool TraceScene::SurfaceOutputRay( int surface, const Ray& objectRay, DifferentialGeometry* dg, RandomDeviate& rand,
+		bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const
+{
+	*modelNode = m_instances[surface];
+	*isShapeFront = dg->shapeFrontSide;
+
+	const TMaterial* material = m_materials[surface];
+	if( !material )	return false;
+
+	Ray surfaceOutputRay;
+	if( !material->OutputRay( objectRay, dg, rand, &surfaceOutputRay ) )	return false;
+
+	*outputRay = m_objectToWorld[surface]( surfaceOutputRay );
+	return true;
+}
+
+/*!
+ * Intersects \a ray with the shape of the surface with index \a surface. The material is not evaluated.
+ *
+ * If the ray intersects the shape before its \a maxt, the ray \a maxt is updated to the intersection distance,
+ * \a dg is the intersection differential geometry, \a objectRay the ray in the surface coordinates and returns true.
+ */
+bool TraceScene::IntersectSurface( int surface, const Ray& ray, DifferentialGeometry* dg, Ray* objectRay ) const
+{
+	if( !m_bboxes[surface].IntersectP( ray ) )	return false;
+
+	//The instanced surfaces are intersected and their differential geometry computed without calling the shape
+	int instancedShape = m_surfaceInstancedShape[surface];
+	if( instancedShape >= 0 )
+	{
+		double instanceHit = 0.0;
+		if( !m_instancedShapes[instancedShape].Intersect( &m_instanceMatrices[InstancedShape::MatrixSize * surface], ray, &instanceHit ) )
+			return false;
+
+		*objectRay = m_worldToObject[surface]( ray );
+		m_instancedShapes[instancedShape].GetDifferentialGeometry( *objectRay, instanceHit, m_shapes[surface], dg );
+		ray.maxt = instanceHit;
+		return true;
+	}
+
+	Ray surfaceRay( m_worldToObject[surface]( ray ) );
+	double thit = 0.0;
+	DifferentialGeometry surfaceDg;
+	if( !m_shapes[surface]->Intersect( surfaceRay, &thit, &surfaceDg ) )	return false;
+
+	ray.maxt = thit;
+	*dg = surfaceDg;
+	*objectRay = surfaceRay;
+	return true;
+}
+
+/*!
+ * Appends to the scene the surfaces of the subtree with top node \a instanceNode.
+ */
+void TraceScene::CompileRecursive( InstanceNode* instanceNode )
+{
+	if( !instanceNode || !instanceNode->GetNode() )	return;
+
+	if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TSeparatorKit::getClassTypeId() ) )
+	{
+		for( int index = 0; index < instanceNode->children.count(); ++index )
+			CompileRecursive( instanceNode->children[index] );
+	}
+	else if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		if( instanceNode->children.count() < 1 )	return;
+
+		TShape* shape = 0;
+		const TMaterial* material = 0;
+		if( instanceNode->children[0]->GetNode()->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )
+		{
+			shape = static_cast< TShape* >( instanceNode->children[0]->GetNode() );
+			if( instanceNode->children.count() > 1 )	material = static_cast< TMaterial* > ( instanceNode->children[1]->GetNode() );
+		}
+		else if( instanceNode->children.count() > 1 )
+		{
+			material = static_cast< TMaterial* > ( instanceNode->children[0]->GetNode() );
+			shape = static_cast< TShape* >( instanceNode->children[1]->GetNode() );
+		}
+
+		BBox surfaceBBox = instanceNode->GetIntersectionBBox();
+		if( !shape || surfaceBBox.pMin.x > surfaceBBox.pMax.x )	return;
+
+		Transform worldToObject = instanceNode->GetIntersectionTransform();
+		m_shapes.push_back( shape );
+		m_materials.push_back( material );
+		m_worldToObject.push_back( worldToObject );
+		m_objectToWorld.push_back( worldToObject.GetInverse() );
+		m_bboxes.push_back( surfaceBBox );
+		m_instances.push_back( instanceNode );
+
+		//Each shape is compiled once, the surfaces with the same shape parameters share one InstancedShape
+		QHash< const TShape*, int >::const_iterator compiledShape = m_shapeInstancedShape.constFind( shape );
+		int instancedShapeIndex = -1;
+		if( compiledShape != m_shapeInstancedShape.constEnd() )
+			instancedShapeIndex = compiledShape.value();
+		else
+		{
+			shape->CompileParameters();
+			shape->PrepareTracing();
+
+			InstancedShape instancedShape;
+			if( shape->GetInstancedShape( &instancedShape ) )
+			{
+				for( int i = 0; i < int( m_instancedShapes.size() ) && instancedShapeIndex < 0; ++i )
+					if( m_instancedShapes[i] == instancedShape )	instancedShapeIndex = i;
+
+				if( instancedShapeIndex < 0 )
+				{
+					instancedShapeIndex = m_instancedShapes.size();
+					m_instancedShapes.push_back( instancedShape );
+				}
+			}
+			m_shapeInstancedShape.insert( shape, instancedShapeIndex );
+		}
+		m_surfaceInstancedShape.push_back( instancedShapeIndex );
+		m_instanceMatrices.resize( m_instanceMatrices.size() + InstancedShape::MatrixSize );
+		SetInstanceMatrix( m_shapes.size() - 1 );
+	}
+}
+
+/*!
+ * Packs the first three rows of the world to object transform of the surface with index \a surface into the instance matrices.
+ *
+ * The InstancedShape kernels do not divide by the homogeneous coordinate, so the surfaces with a projective transform
+ * are intersected by their shape.
+ */
+void TraceScene::SetInstanceMatrix( int surface )
+{
+	const Transform& worldToObject = m_worldToObject[surface];
+	double* instanceMatrix = &m_instanceMatrices[InstancedShape::MatrixSize * surface];
+	for( int row = 0; row < 3; ++row )
+		for( int column = 0; column < 4; ++column )
+			instanceMatrix[4 * row + column] = worldToObject.GetMatrixValue( row, column );
+
+	if( worldToObject.GetMatrixValue( 3, 0 ) != 0.0 || worldToObject.GetMatrixValue( 3, 1 ) != 0.0 ||
+			worldToObject.GetMatrixValue( 3, 2 ) != 0.0 || worldToObject.GetMatrixValue( 3, 3 ) != 1.0 )
+		m_surfaceInstancedShape[surface] = -1;
+}
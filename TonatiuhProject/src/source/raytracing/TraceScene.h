@@ -0,0 +1,117 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef TRACESCENE_H_
+#define TRACESCENE_H_
+
+#include <vector>
+
+#include <QHash>
+
+#include "BBox.h"
+#include "InstancedShape.h"
+#include "SceneBVH.h"
+#include "Transform.h"
+
+struct DifferentialGeometry;
+class InstanceNode;
+class RandomDeviate;
+class Ray;
+struct RayPacket;
+class TMaterial;
+class TShape;
+
+//!  TraceScene class is the flattened scene used by the ray tracers.
+/*!
+  TraceScene is compiled from the InstanceNode tree after trf::ComputeSceneTreeMap. Each surface
+  (TShapeKit instance) is stored as an index into parallel arrays with its shape, material, transforms
+  and world bounding box, so the tracing loop does not walk the InstanceNode tree nor check Coin node types.
+  The surfaces are indexed by a SceneBVH and the material of a surface is only evaluated for the nearest intersection.
+  IntersectP is the occlusion query, it only finds if a ray is blocked and neither materials nor derivatives are evaluated.
+
+  The surfaces whose shape returns an InstancedShape, such as the facets of a heliostat field, are grouped by their
+  shape parameters. They are intersected with the non virtual InstancedShape kernels, with the group parameters and
+  the surface world to object transform packed as a 3x4 matrix, and the shape is only called for the hits.
+*/
+
+class TraceScene
+{
+
+public:
+	TraceScene();
+	~TraceScene();
+
+	void Compile( InstanceNode* rootNode );
+	void Clear();
+	void Refit();
+
+	int GetNumberOfSurfaces() const;
+	BBox GetBBox() const;
+	BBox GetSurfaceBBox( int surface ) const;
+	InstanceNode* GetSurfaceInstance( int surface ) const;
+
+	bool Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const;
+	bool IntersectSurface( int surface, const Ray& ray, DifferentialGeometry* dg, Ray* objectRay ) const;
+	bool IntersectSurface( int surface, const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const;
+	bool IntersectP( const Ray& ray ) const;
+	bool IntersectSurfaceP( int surface, const Ray& ray ) const;
+
+	int IntersectPacket( const RayPacket& rays, int* surfaces ) const;
+	int IntersectSurfacePacket( int surface, const RayPacket& rays, int raysMask, int* surfaces ) const;
+
+private:
+	void CompileRecursive( InstanceNode* instanceNode );
+	void SetInstanceMatrix( int surface );
+	bool SurfaceOutputRay( int surface, const Ray& objectRay, DifferentialGeometry* dg, RandomDeviate& rand,
+			bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay ) const;
+
+	std::vector< const TShape* > m_shapes;
+	std::vector< const TMaterial* > m_materials;
+	std::vector< Transform > m_worldToObject;
+	std::vector< Transform > m_objectToWorld;
+	std::vector< BBox > m_bboxes;
+	std::vector< InstanceNode* > m_instances;
+	std::vector< InstancedShape > m_instancedShapes;
+	std::vector< int > m_surfaceInstancedShape; //!< Index in m_instancedShapes of each surface, or -1.
+	QHash< const TShape*, int > m_shapeInstancedShape; //!< Index in m_instancedShapes of each compiled shape, or -1.
+	std::vector< double > m_instanceMatrices; //!< InstancedShape::MatrixSize world to object values for each surface.
+	SceneBVH m_bvh;
+};
+
+#endif /* TRACESCENE_H_ */
@@ -66,12 +66,12 @@ SoSeparator* trf::DrawPhotonMapPoints( const TPhotonMap& map )
 
 	SoSeparator* drawpoints = new SoSeparator;
 	SoCoordinate3* points = new SoCoordinate3;
-	std::vector< Photon* > photonsList = map.GetAllPhotons();
+	const std::vector< Photon >& photonsList = map.GetAllPhotons();
     unsigned int numRays=0;
 
 	for( unsigned int i = 0; i < photonsList.size(); i++)
 	{
-		Point3D photon = photonsList[i]->pos;
+		Point3D photon = photonsList[i].pos;
 		points->point.set1Value( numRays, photon.x, photon.y, photon.z );
 		numRays++;
 	}
@@ -99,7 +99,7 @@ SoSeparator* trf::DrawPhotonMapRays( const TPhotonMap& map, unsigned long /*numb
 	SoCoordinate3* points = new SoCoordinate3;
 
 	QVector< int >	rayLengths;
-	std::vector< Photon* > allRaysLists = map.GetAllPhotons();
+	const std::vector< Photon >& allRaysLists = map.GetAllPhotons();
 
 
 	int nRay = 0;
@@ -109,12 +109,12 @@ SoSeparator* trf::DrawPhotonMapRays( const TPhotonMap& map, unsigned long /*numb
 		unsigned long rayLength = 0;
 		do
 		{
-			Photon* photon = allRaysLists[photonIndex];
-			Point3D photonPosistion = photon->pos;
+			const Photon& photon = allRaysLists[photonIndex];
+			Point3D photonPosistion = photon.pos;
 			points->point.set1Value( photonIndex, photonPosistion.x, photonPosistion.y, photonPosistion.z );
 			photonIndex++;
 			rayLength++;
-		}while( photonIndex < allRaysLists.size() && allRaysLists[photonIndex]->id > 0 );
+		}while( photonIndex < allRaysLists.size() && allRaysLists[photonIndex].id > 0 );
 
 
 		rayLengths.push_back( rayLength );
@@ -42,12 +42,14 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QMap>
 #include <QPair>
 #include <QStringList>
+#include <QVector>
 
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
 #include <Inventor/actions/SoGetMatrixAction.h>
 #include <Inventor/nodes/SoTransform.h>
 #include <Inventor/nodes/SoNode.h>
 
+#include "Matrix4x4.h"
 #include "Photon.h"
 #include "TPhotonMap.h"
 #include "Ray.h"
@@ -67,6 +69,8 @@ class TPhotonMap;
 namespace trf
 {
 	void ComputeSceneTreeMap( InstanceNode* instanceNode, Transform parentWTO, bool insertInSurfaceList );
+	bool ComputeTrackerInstances( InstanceNode* instanceNode, QVector< InstanceNode* >* trackerInstances, QVector< InstanceNode* >* trackerAncestors );
+	void UpdateTrackerInstances( InstanceNode* rootInstance, const QVector< InstanceNode* >& trackerInstances, const QVector< InstanceNode* >& trackerAncestors );
 	void ComputeFistStageSurfaceList( InstanceNode* instanceNode, QStringList disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList);
 	void CreatePhotonMap( TPhotonMap*& photonMap, QPair< TPhotonMap* ,  std::vector < Photon  > > photonsList );
 
@@ -151,6 +155,61 @@ inline void trf::ComputeSceneTreeMap( InstanceNode* instanceNode, Transform pare
 	}
 }
 
+/*!
+ * Adds to \a trackerInstances the separators of the \a instanceNode subtree that have a tracker. The subtree of a
+ * tracker is not searched, it is updated with its tracker. The separators above the trackers are added to
+ * \a trackerAncestors, each one after its children, so their bounding boxes can be updated bottom up.
+ *
+ * Returns true if the \a instanceNode subtree has a tracker.
+ */
+inline bool trf::ComputeTrackerInstances( InstanceNode* instanceNode, QVector< InstanceNode* >* trackerInstances, QVector< InstanceNode* >* trackerAncestors )
+{
+	if( !instanceNode || !instanceNode->GetNode() )	return false;
+	if( !instanceNode->GetNode()->getTypeId().isDerivedFrom( TSeparatorKit::getClassTypeId() ) )	return false;
+
+	SoBaseKit* separatorKit = static_cast< SoBaseKit* >( instanceNode->GetNode() );
+	if( separatorKit->getPart( "tracker", false ) )
+	{
+		trackerInstances->push_back( instanceNode );
+		return true;
+	}
+
+	bool hasTracker = false;
+	for( int index = 0; index < instanceNode->children.count(); ++index )
+		if( ComputeTrackerInstances( instanceNode->children[index], trackerInstances, trackerAncestors ) )	hasTracker = true;
+
+	if( hasTracker )	trackerAncestors->push_back( instanceNode );
+	return hasTracker;
+}
+
+/*!
+ * Updates the transforms and bounding boxes of the \a trackerInstances subtrees for the current sun position and the
+ * bounding boxes of the \a trackerAncestors, as computed by ComputeTrackerInstances for the tree of \a rootInstance.
+ * The rest of the scene tree does not move with the sun and is not visited. ComputeSceneTreeMap must be called before
+ * for the whole tree.
+ */
+inline void trf::UpdateTrackerInstances( InstanceNode* rootInstance, const QVector< InstanceNode* >& trackerInstances, const QVector< InstanceNode* >& trackerAncestors )
+{
+	for( int t = 0; t < trackerInstances.count(); ++t )
+	{
+		InstanceNode* trackerInstance = trackerInstances[t];
+		if( trackerInstance == rootInstance )
+			ComputeSceneTreeMap( trackerInstance, Transform( new Matrix4x4 ), true );
+		else
+			ComputeSceneTreeMap( trackerInstance, trackerInstance->GetParent()->GetIntersectionTransform(), true );
+	}
+
+	for( int a = 0; a < trackerAncestors.count(); ++a )
+	{
+		InstanceNode* ancestor = trackerAncestors[a];
+
+		BBox nodeBB;
+		for( int index = 0; index < ancestor->children.count(); ++index )
+			nodeBB = Union( nodeBB, ancestor->children[index]->GetIntersectionBBox() );
+		ancestor->SetIntersectionBBox( nodeBB );
+	}
+}
+
 inline void trf::ComputeFistStageSurfaceList( InstanceNode* instanceNode, QStringList disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList)
 {
 	if( !instanceNode ) return;
@@ -42,18 +42,45 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 ParallelRandomDeviate::ParallelRandomDeviate( RandomDeviate* rand,  QMutex* mutex, unsigned long arraySize, QObject* parent )
 :QObject( parent ),RandomDeviate( arraySize ),
 m_pRand( rand ),
+m_pStream( 0 ),
 m_mutex( mutex )
 {
 
 }
-ParallelRandomDeviate::~ParallelRandomDeviate( )
+
+/*!
+ * Creates a generator that takes the numbers from the stream \a streamIndex of \a rand.
+ * The stream is owned by this generator and it is filled without locking \a mutex.
+ *
+ * If \a rand does not support streams, the numbers are taken from \a rand locking \a mutex.
+ *
+ * The stream index goes before the mutex, so this constructor can not be called by mistake with
+ * the arguments of the constructor that shares \a rand.
+ */
+ParallelRandomDeviate::ParallelRandomDeviate( RandomDeviate* rand, unsigned long streamIndex, QMutex* mutex, unsigned long arraySize, QObject* parent )
+:QObject( parent ),RandomDeviate( arraySize ),
+m_pRand( rand ),
+m_pStream( 0 ),
+m_mutex( mutex )
 {
+	//The stream only fills the array of this generator, it does not need its own array.
+	m_pStream = m_pRand->CreateStream( streamIndex, 1 );
+}
 
+ParallelRandomDeviate::~ParallelRandomDeviate( )
+{
+	delete m_pStream;
 }
 
 
 void ParallelRandomDeviate::FillArray( double* array, const unsigned long arraySize )
 {
+	if( m_pStream )
+	{
+		m_pStream->FillArray( array, arraySize );
+		return;
+	}
+
 	m_mutex->lock();
 	m_pRand->FillArray( array, arraySize );
 	m_mutex->unlock();
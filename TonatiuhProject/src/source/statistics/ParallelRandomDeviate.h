@@ -52,11 +52,13 @@ class ParallelRandomDeviate :  public QObject, public RandomDeviate
 
 public:
 	ParallelRandomDeviate( RandomDeviate* rand, QMutex* mutex, unsigned long arraySize = 100000, QObject* parent = 0 );
+	ParallelRandomDeviate( RandomDeviate* rand, unsigned long streamIndex, QMutex* mutex, unsigned long arraySize, QObject* parent = 0 );
 	virtual ~ParallelRandomDeviate( );
     void FillArray( double* array, const unsigned long arraySize );
 
 private:
     RandomDeviate* m_pRand;
+    RandomDeviate* m_pStream;
 
     QMutex* m_mutex;
 
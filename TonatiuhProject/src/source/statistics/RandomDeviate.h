@@ -42,6 +42,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 //!  RandomDeviate is the base class for random generators.
 /*!
   A random generator class can be written based on this class.
+  Generators that can be split in independent streams reimplement CreateStream, so each ray tracing
+  thread can generate its own numbers without sharing the generator.
 */
 
 class RandomDeviate
@@ -50,6 +52,7 @@ public:
 	explicit RandomDeviate( const unsigned long arraySize = 100000 );
     virtual ~RandomDeviate( );
     virtual void FillArray( double* array, const unsigned long arraySize )=0;
+    virtual RandomDeviate* CreateStream( unsigned long streamIndex, const unsigned long arraySize ) const;
     unsigned long NumbersGenerated( ) const;
     unsigned long NumbersProvided( ) const;
     double RandomDouble( );
@@ -72,6 +75,17 @@ inline RandomDeviate::~RandomDeviate( )
 	if( m_randomNumber ) delete [] m_randomNumber;
 }
 
+/*!
+ * Returns a new generator for the independent stream \a streamIndex of this generator, with a numbers array of \a arraySize.
+ * The same \a streamIndex always creates the same sequence of numbers and the caller takes the ownership of the generator.
+ *
+ * Returns null if the generator does not support streams.
+ */
+inline RandomDeviate* RandomDeviate::CreateStream( unsigned long /*streamIndex*/, const unsigned long /*arraySize*/ ) const
+{
+	return 0;
+}
+
 inline double RandomDeviate::RandomDouble( )
 {
 	if( m_nextRandomNumber >= m_arraySize  )
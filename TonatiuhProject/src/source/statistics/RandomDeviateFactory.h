@@ -49,6 +49,8 @@ class RandomDeviate;
 //!  RandomDeviateFactory is the interface for random generators plugins.
 /*!
   A random generator plugin must implement the following interface to load as a valid plugin for Toantiuh.
+  CreateRandomDeviate without arguments seeds the generator from the clock, the \a seed version creates
+  a generator that always gives the same numbers for the same seed.
 */
 
 class RandomDeviateFactory
@@ -57,6 +59,7 @@ public:
     virtual QString RandomDeviateName() const  = 0;
     virtual QIcon RandomDeviateIcon() const = 0;
     virtual RandomDeviate* CreateRandomDeviate( ) const = 0;
+    virtual RandomDeviate* CreateRandomDeviate( unsigned long seed ) const = 0;
 };
 
 Q_DECLARE_INTERFACE( RandomDeviateFactory, "tonatiuh.RandomDeviateFactory")
@@ -46,6 +46,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "BBox.h"
 #include "gc.h"
 #include "Ray.h"
+#include "RayPacket.h"
 
 #include "TestsAuxiliaryFunctions.h"
 
@@ -237,6 +238,30 @@ TEST( BBoxTests, Volume )
   }
 }
 
+TEST( BBoxTests, SurfaceArea )
+{
+  /* initialize random seed: */
+  srand ( time(NULL) );
+
+  // Extension of the testing space
+  double b = maximumCoordinate;
+  double a = -b;
+
+  BBox boundingBox;
+
+  for( unsigned long int i = 0; i < maximumNumberOfTests; i++ )
+  {
+ 	  boundingBox = taf::randomBox( a, b );
+
+	  double xLength = boundingBox.pMax.x - boundingBox.pMin.x;
+	  double yLength = boundingBox.pMax.y - boundingBox.pMin.y;
+	  double zLength = boundingBox.pMax.z - boundingBox.pMin.z;
+	  double area = 2.0 * ( xLength * yLength + xLength * zLength + yLength * zLength );
+
+	  EXPECT_DOUBLE_EQ( area, boundingBox.SurfaceArea() );
+  }
+}
+
 TEST( BBoxTests, MaximumExtent )
 {
   /* initialize random seed: */
@@ -395,6 +420,37 @@ TEST( BBoxTests, IntersectP )
    }
 }
 
+TEST( BBoxTests, IntersectPRayPacket )
+{
+   // initialize random seed:
+   srand ( time(NULL) );
+
+   // Extension of the testing space
+   double b = maximumCoordinate;
+   double a = -b;
+
+   for( unsigned long int i = 0; i < maximumNumberOfTests; i++ )
+   {
+      BBox boundingBox = taf::randomBox( a, b );
+
+      RayPacket rays;
+      Ray raysList[RayPacket::Size];
+      int nRays = 1 + rand() % RayPacket::Size;
+      for( int r = 0; r < nRays; ++r )
+      {
+         raysList[r] = taf::randomRay( a, b );
+         rays.SetRay( r, raysList[r] );
+      }
+      rays.nRays = nRays;
+
+      int expectedMask = 0;
+      for( int r = 0; r < nRays; ++r )
+         if( boundingBox.IntersectP( raysList[r] ) ) expectedMask |= ( 1 << r );
+
+      EXPECT_EQ( expectedMask, boundingBox.IntersectP( rays ) );
+   }
+}
+
 TEST( BBoxTests, UnionBBoxPoint3D )
 {
    // initialize random seed:
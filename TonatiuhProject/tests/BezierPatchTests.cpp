@@ -0,0 +1,337 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BezierPatch.h"
+#include "DifferentialGeometry.h"
+#include "Ray.h"
+
+namespace
+{
+	const int nSamples = 128;
+
+	double RandomValue( double minValue, double maxValue )
+	{
+		return minValue + ( maxValue - minValue ) * rand() / RAND_MAX;
+	}
+
+	//Boundary control points of the patch with control points x[i], y[j] and z[i][j], i along u and j along v,
+	//in the order that BezierPatch::SetControlPoints expects
+	void SetPatch( const double x[4], const double y[4], const double z[4][4], BezierPatch* patch )
+	{
+		const int boundary[12][2] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 3, 2 },
+				{ 3, 3 }, { 2, 3 }, { 1, 3 }, { 0, 3 }, { 0, 2 }, { 0, 1 } };
+
+		std::vector< Point3D > boundedPoints;
+		for( int p = 0; p < 12; ++p )
+		{
+			int i = boundary[p][0];
+			int j = boundary[p][1];
+			boundedPoints.push_back( Point3D( x[i], y[j], z[i][j] ) );
+		}
+		patch->SetControlPoints( boundedPoints );
+	}
+
+	//Patch with the section of a letter C in the plane xz, extruded along y. Rays along z cross it twice.
+	void SetFoldedPatch( BezierPatch* patch )
+	{
+		const double x[4] = { 0.0, 3.0, 3.0, 0.0 };
+		const double y[4] = { 0.0, 1.0, 2.0, 3.0 };
+		const double z[4][4] = { { 0.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0, 0.0 }, { 2.0, 2.0, 2.0, 2.0 }, { 2.0, 2.0, 2.0, 2.0 } };
+		SetPatch( x, y, z, patch );
+	}
+
+	void SetWavyPatch( BezierPatch* patch )
+	{
+		const double x[4] = { -2.0, -0.5, 0.5, 2.0 };
+		const double y[4] = { -2.0, -0.7, 0.7, 2.0 };
+		const double z[4][4] = { { 0.0, 1.5, -1.0, 0.5 }, { 1.0, -2.0, 2.0, 0.0 }, { -0.5, 2.0, -2.0, 1.0 }, { 0.5, -1.0, 1.5, 0.0 } };
+		SetPatch( x, y, z, patch );
+	}
+
+	struct Sample
+	{
+		Point3D point;
+		double u;
+		double v;
+	};
+
+	//Nearest intersection of the ray with the triangles of a dense grid of patch points. Returns the parameters of
+	//the hit and whether it is far from the patch border and from the patch silhouette, where the grid differs most.
+	bool DenseSamplingIntersect( const std::vector< Sample >& samples, const BezierPatch& patch, const Ray& objectRay,
+			double* tHit, double* uHit, double* vHit, bool* isReliable )
+	{
+		bool isHit = false;
+		*tHit = objectRay.maxt;
+		for( int i = 0; i < nSamples; ++i )
+		{
+			for( int j = 0; j < nSamples; ++j )
+			{
+				const Sample* corners[2][3] = { { &samples[i * ( nSamples + 1 ) + j], &samples[( i + 1 ) * ( nSamples + 1 ) + j], &samples[( i + 1 ) * ( nSamples + 1 ) + j + 1] },
+						{ &samples[i * ( nSamples + 1 ) + j], &samples[( i + 1 ) * ( nSamples + 1 ) + j + 1], &samples[i * ( nSamples + 1 ) + j + 1] } };
+				for( int t = 0; t < 2; ++t )
+				{
+					Vector3D e1 = corners[t][1]->point - corners[t][0]->point;
+					Vector3D e2 = corners[t][2]->point - corners[t][0]->point;
+					Vector3D s1 = CrossProduct( objectRay.direction(), e2 );
+					double divisor = DotProduct( s1, e1 );
+					if( divisor == 0.0 )	continue;
+
+					Vector3D d = objectRay.origin - corners[t][0]->point;
+					double b1 = DotProduct( d, s1 ) / divisor;
+					if( b1 < 0.0 || b1 > 1.0 )	continue;
+					Vector3D s2 = CrossProduct( d, e1 );
+					double b2 = DotProduct( objectRay.direction(), s2 ) / divisor;
+					if( b2 < 0.0 || b1 + b2 > 1.0 )	continue;
+
+					double tTriangle = DotProduct( e2, s2 ) / divisor;
+					if( tTriangle <= objectRay.mint || tTriangle >= *tHit )	continue;
+
+					*tHit = tTriangle;
+					*uHit = ( 1 - b1 - b2 ) * corners[t][0]->u + b1 * corners[t][1]->u + b2 * corners[t][2]->u;
+					*vHit = ( 1 - b1 - b2 ) * corners[t][0]->v + b1 * corners[t][1]->v + b2 * corners[t][2]->v;
+					isHit = true;
+				}
+			}
+		}
+
+		if( isHit )
+		{
+			const double margin = 0.02;
+			NormalVector normal = patch.GetNormal( *uHit, *vHit );
+			*isReliable = ( *uHit > margin ) && ( *uHit < 1.0 - margin ) && ( *vHit > margin ) && ( *vHit < 1.0 - margin )
+					&& ( fabs( DotProduct( normal, objectRay.direction() ) ) > 0.1 );
+		}
+		return ( isHit );
+	}
+
+	std::vector< Sample > DenseSamples( const BezierPatch& patch )
+	{
+		std::vector< Sample > samples;
+		for( int i = 0; i <= nSamples; ++i )
+		{
+			for( int j = 0; j <= nSamples; ++j )
+			{
+				Sample sample;
+				sample.u = double( i ) / nSamples;
+				sample.v = double( j ) / nSamples;
+				sample.point = patch.GetPoint3D( sample.u, sample.v );
+				samples.push_back( sample );
+			}
+		}
+		return ( samples );
+	}
+
+	//Compares the patch intersection with the dense sampling one. Returns true if the patch is hit.
+	bool ExpectSameIntersection( const BezierPatch& patch, const std::vector< Sample >& samples, const Ray& objectRay )
+	{
+		const double bezierTol = 0.000001;
+
+		double tHit = objectRay.maxt;
+		DifferentialGeometry dg;
+		bool isHit = patch.Intersect( objectRay, &tHit, &dg, bezierTol );
+
+		//Every hit is a point of the patch
+		if( isHit )
+		{
+			EXPECT_GT( tHit, bezierTol );
+			Point3D point = patch.GetPoint3D( dg.u, dg.v );
+			EXPECT_NEAR( 0.0, Distance( point, objectRay( tHit ) ), 1.0e-6 );
+			EXPECT_NEAR( 0.0, Distance( dg.point, objectRay( tHit ) ), 1.0e-9 );
+		}
+
+		double referenceTHit;
+		double referenceU;
+		double referenceV;
+		bool isReliable = false;
+		bool isReferenceHit = DenseSamplingIntersect( samples, patch, objectRay, &referenceTHit, &referenceU, &referenceV, &isReliable );
+		if( isReferenceHit && isReliable )
+		{
+			EXPECT_TRUE( isHit ) << "Missed intersection at u = " << referenceU << ", v = " << referenceV;
+			if( isHit )
+			{
+				EXPECT_NEAR( referenceTHit, tHit, 0.005 );
+				EXPECT_NEAR( referenceU, dg.u, 0.005 );
+				EXPECT_NEAR( referenceV, dg.v, 0.005 );
+			}
+		}
+		else if( !isReferenceHit && isHit )
+		{
+			//Only the rays that touch the patch border can hit it between the samples
+			bool isBorder = ( dg.u < 0.01 ) || ( dg.u > 0.99 ) || ( dg.v < 0.01 ) || ( dg.v > 0.99 );
+			EXPECT_TRUE( isBorder ) << "Intersection not found by sampling at u = " << dg.u << ", v = " << dg.v;
+		}
+
+		return ( isHit );
+	}
+}
+
+TEST( BezierPatchTests, InterpolatesTheBoundary )
+{
+	BezierPatch patch;
+	SetWavyPatch( &patch );
+
+	const double x[4] = { -2.0, -0.5, 0.5, 2.0 };
+	const double y[4] = { -2.0, -0.7, 0.7, 2.0 };
+	EXPECT_NEAR( 0.0, Distance( Point3D( x[0], y[0], 0.0 ), patch.GetPoint3D( 0.0, 0.0 ) ), 1.0e-12 );
+	EXPECT_NEAR( 0.0, Distance( Point3D( x[3], y[0], 0.5 ), patch.GetPoint3D( 1.0, 0.0 ) ), 1.0e-12 );
+	EXPECT_NEAR( 0.0, Distance( Point3D( x[0], y[3], 0.5 ), patch.GetPoint3D( 0.0, 1.0 ) ), 1.0e-12 );
+	EXPECT_NEAR( 0.0, Distance( Point3D( x[3], y[3], 0.0 ), patch.GetPoint3D( 1.0, 1.0 ) ), 1.0e-12 );
+
+	//The patch box contains the samples of the patch
+	BBox bbox = patch.GetBBox();
+	std::vector< Sample > samples = DenseSamples( patch );
+	for( unsigned int s = 0; s < samples.size(); ++s )
+		EXPECT_TRUE( bbox.Inside( samples[s].point ) );
+}
+
+TEST( BezierPatchTests, RandomRaysMatchDenseSampling )
+{
+	BezierPatch patch;
+	SetWavyPatch( &patch );
+	std::vector< Sample > samples = DenseSamples( patch );
+
+	for( int depth = 0; depth <= 4; depth += 2 )
+	{
+		srand( 43 );
+		patch.SetSubPatchesDepth( depth );
+
+		int nHits = 0;
+		for( int r = 0; r < 300; ++r )
+		{
+			Point3D origin( RandomValue( -4.0, 4.0 ), RandomValue( -4.0, 4.0 ), RandomValue( 3.0, 5.0 ) );
+			if( r % 3 == 0 )	origin.z = -origin.z;
+			Point3D target = patch.GetPoint3D( RandomValue( -0.1, 1.1 ), RandomValue( -0.1, 1.1 ) );
+			Ray objectRay( origin, Normalize( target - origin ) );
+			if( ExpectSameIntersection( patch, samples, objectRay ) )	++nHits;
+		}
+		EXPECT_GT( nHits, 150 );
+	}
+}
+
+TEST( BezierPatchTests, GrazingRaysMatchDenseSampling )
+{
+	BezierPatch patch;
+	SetWavyPatch( &patch );
+	std::vector< Sample > samples = DenseSamples( patch );
+
+	//Nearly horizontal rays cross the waves of the patch several times
+	srand( 47 );
+	for( int r = 0; r < 300; ++r )
+	{
+		Point3D origin( -5.0, RandomValue( -2.0, 2.0 ), RandomValue( -0.5, 0.5 ) );
+		Vector3D direction( 1.0, RandomValue( -0.2, 0.2 ), RandomValue( -0.2, 0.2 ) );
+		ExpectSameIntersection( patch, samples, Ray( origin, Normalize( direction ) ) );
+	}
+}
+
+TEST( BezierPatchTests, FoldedPatchHitInFrontOfTheOrigin )
+{
+	BezierPatch patch;
+	SetFoldedPatch( &patch );
+	std::vector< Sample > samples = DenseSamples( patch );
+
+	//From inside the fold the patch is behind and in front of the ray origin. The Newton iterations of a sub-patch
+	//that covers both parts may converge to the intersection behind the origin.
+	for( int depth = 0; depth <= 2; ++depth )
+	{
+		patch.SetSubPatchesDepth( depth );
+		for( int i = 1; i < 20; ++i )
+		{
+			for( int j = 1; j < 10; ++j )
+			{
+				Point3D origin( 0.1 * i, 0.3 * j, 1.0 );
+				Ray up( origin, Vector3D( 0.0, 0.0, 1.0 ) );
+				Ray down( origin, Vector3D( 0.0, 0.0, -1.0 ) );
+				EXPECT_TRUE( ExpectSameIntersection( patch, samples, up ) ) << "depth " << depth << ", origin " << origin;
+				EXPECT_TRUE( ExpectSameIntersection( patch, samples, down ) ) << "depth " << depth << ", origin " << origin;
+			}
+		}
+
+		//Rays in every direction from inside the fold
+		srand( 53 );
+		for( int r = 0; r < 300; ++r )
+		{
+			Point3D origin( RandomValue( 0.2, 1.8 ), RandomValue( 0.5, 2.5 ), RandomValue( 0.6, 1.4 ) );
+			Vector3D direction( RandomValue( -1.0, 1.0 ), RandomValue( -0.3, 0.3 ), RandomValue( -1.0, 1.0 ) );
+			ExpectSameIntersection( patch, samples, Ray( origin, Normalize( direction ) ) );
+		}
+
+		//From below, only the nearest part is hit
+		for( int i = 1; i < 20; ++i )
+		{
+			Ray objectRay( Point3D( 0.1 * i, 1.5, -1.0 ), Vector3D( 0.0, 0.0, 1.0 ) );
+			double tHit = objectRay.maxt;
+			DifferentialGeometry dg;
+			ASSERT_TRUE( patch.Intersect( objectRay, &tHit, &dg, 0.000001 ) );
+			EXPECT_LT( dg.point.z, 1.0 );
+			ExpectSameIntersection( patch, samples, objectRay );
+		}
+	}
+}
+
+TEST( BezierPatchTests, IntersectionBeyondTHitIsIgnored )
+{
+	BezierPatch patch;
+	SetFoldedPatch( &patch );
+
+	Ray objectRay( Point3D( 1.0, 1.5, -1.0 ), Vector3D( 0.0, 0.0, 1.0 ) );
+	double tHit = objectRay.maxt;
+	DifferentialGeometry dg;
+	ASSERT_TRUE( patch.Intersect( objectRay, &tHit, &dg, 0.000001 ) );
+
+	//A nearer intersection found before
+	double nearerTHit = 0.5 * tHit;
+	EXPECT_FALSE( patch.Intersect( objectRay, &nearerTHit, &dg, 0.000001 ) );
+	EXPECT_EQ( 0.5 * tHit, nearerTHit );
+
+	//A ray that ends between both parts of the fold
+	objectRay.maxt = 2.0;
+	double rayTHit = objectRay.maxt;
+	ASSERT_TRUE( patch.Intersect( objectRay, &rayTHit, &dg, 0.000001 ) );
+	EXPECT_NEAR( tHit, rayTHit, 1.0e-9 );
+	objectRay.maxt = 0.5 * tHit;
+	rayTHit = objectRay.maxt;
+	EXPECT_FALSE( patch.Intersect( objectRay, &rayTHit, &dg, 0.000001 ) );
+}
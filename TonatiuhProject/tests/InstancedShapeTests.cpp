@@ -0,0 +1,141 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "DifferentialGeometry.h"
+#include "InstancedShape.h"
+#include "Ray.h"
+#include "RayPacket.h"
+
+namespace
+{
+	//World to object transform of a surface translated to y = 5
+	const double translatedMatrix[InstancedShape::MatrixSize] = { 1.0, 0.0, 0.0, 0.0,
+			0.0, 1.0, 0.0, -5.0,
+			0.0, 0.0, 1.0, 0.0 };
+
+	InstancedShape CreateInstancedShape( int type, double p0, double p1, double p2 )
+	{
+		InstancedShape instancedShape;
+		instancedShape.type = type;
+		instancedShape.parameters[0] = p0;
+		instancedShape.parameters[1] = p1;
+		instancedShape.parameters[2] = p2;
+		return instancedShape;
+	}
+}
+
+TEST( InstancedShapeTests, FlatRectangleClipsToHalfLengths )
+{
+	InstancedShape rectangle = CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.0, 0.0 );
+
+	double tHit = 0.0;
+	EXPECT_TRUE( rectangle.Intersect( translatedMatrix, Ray( Point3D( 0.5, 10.0, 1.5 ), Vector3D( 0.0, -1.0, 0.0 ) ), &tHit ) );
+	EXPECT_DOUBLE_EQ( 5.0, tHit );
+
+	EXPECT_FALSE( rectangle.Intersect( translatedMatrix, Ray( Point3D( 1.5, 10.0, 0.0 ), Vector3D( 0.0, -1.0, 0.0 ) ), &tHit ) );
+	EXPECT_FALSE( rectangle.Intersect( translatedMatrix, Ray( Point3D( 0.0, 10.0, 0.0 ), Vector3D( 0.0, -1.0, 0.0 ), gc::Epsilon, 4.0 ), &tHit ) );
+}
+
+TEST( InstancedShapeTests, ParabolicRectangleHitsNearestRoot )
+{
+	InstancedShape parabola = CreateInstancedShape( InstancedShape::ParabolicRectangle, 2.0, 2.0, 2.0 );
+
+	//y = ( x * x + z * z ) / ( 4 * focus )
+	double tHit = 0.0;
+	EXPECT_TRUE( parabola.Intersect( translatedMatrix, Ray( Point3D( 0.5, 10.0, 0.5 ), Vector3D( 0.0, -1.0, 0.0 ) ), &tHit ) );
+	EXPECT_DOUBLE_EQ( 5.0 - 0.5 / 8.0, tHit );
+
+	EXPECT_FALSE( parabola.Intersect( translatedMatrix, Ray( Point3D( 1.5, 10.0, 0.0 ), Vector3D( 0.0, -1.0, 0.0 ) ), &tHit ) );
+}
+
+TEST( InstancedShapeTests, PacketMatchesSingleRays )
+{
+	InstancedShape shapes[2] = { CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.0, 0.0 ),
+			CreateInstancedShape( InstancedShape::ParabolicRectangle, 2.0, 2.0, 2.0 ) };
+
+	RayPacket rays;
+	for( int i = 0; i < RayPacket::Size; ++i )
+		rays.SetRay( i, Ray( Point3D( -1.4 + 0.4 * i, 10.0, 0.3 * i - 1.0 ), Vector3D( 0.05 * i, -1.0, 0.02 ) ) );
+
+	for( int s = 0; s < 2; ++s )
+	{
+		double tHits[RayPacket::Size];
+		int hitMask = shapes[s].IntersectPacket( translatedMatrix, rays, rays.ActiveMask(), tHits );
+		for( int i = 0; i < RayPacket::Size; ++i )
+		{
+			double tHit = 0.0;
+			bool isHit = shapes[s].Intersect( translatedMatrix, rays.GetRay( i ), &tHit );
+			EXPECT_EQ( isHit, ( hitMask & ( 1 << i ) ) != 0 );
+			if( isHit )	EXPECT_DOUBLE_EQ( tHit, tHits[i] );
+		}
+	}
+}
+
+TEST( InstancedShapeTests, DifferentialGeometryAtHit )
+{
+	InstancedShape rectangle = CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.0, 0.0 );
+
+	DifferentialGeometry dg;
+	rectangle.GetDifferentialGeometry( Ray( Point3D( 0.5, 5.0, 1.5 ), Vector3D( 0.0, -1.0, 0.0 ) ), 5.0, 0, &dg );
+	EXPECT_DOUBLE_EQ( 0.75, dg.u );
+	EXPECT_DOUBLE_EQ( 0.875, dg.v );
+	EXPECT_DOUBLE_EQ( 1.0, dg.normal.y );
+	EXPECT_TRUE( dg.shapeFrontSide );
+
+	InstancedShape parabola = CreateInstancedShape( InstancedShape::ParabolicRectangle, 2.0, 2.0, 2.0 );
+	parabola.GetDifferentialGeometry( Ray( Point3D( 0.5, 5.0, 0.5 ), Vector3D( 0.0, -1.0, 0.0 ) ), 5.0 - 0.5 / 8.0, 0, &dg );
+	EXPECT_DOUBLE_EQ( 0.5 / 8.0, dg.point.y );
+	EXPECT_DOUBLE_EQ( 0.75, dg.u );
+	EXPECT_DOUBLE_EQ( 0.75, dg.v );
+
+	//The normal is parallel to ( -x / ( 2 * focus ), 1, -z / ( 2 * focus ) )
+	EXPECT_DOUBLE_EQ( dg.normal.x, dg.normal.z );
+	EXPECT_NEAR( -0.125 * dg.normal.y, dg.normal.x, 1.0e-12 );
+}
+
+TEST( InstancedShapeTests, SharedOnlyWithSameParameters )
+{
+	InstancedShape rectangle = CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.0, 0.0 );
+
+	EXPECT_TRUE( rectangle == CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.0, 0.0 ) );
+	EXPECT_FALSE( rectangle == CreateInstancedShape( InstancedShape::FlatRectangle, 1.0, 2.5, 0.0 ) );
+	EXPECT_FALSE( rectangle == CreateInstancedShape( InstancedShape::ParabolicRectangle, 1.0, 2.0, 0.0 ) );
+}
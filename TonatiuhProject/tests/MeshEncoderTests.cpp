@@ -0,0 +1,340 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstdlib>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+
+#include <gtest/gtest.h>
+
+#include "BVH.h"
+#include "DifferentialGeometry.h"
+#include "MeshEncoder.h"
+#include "Ray.h"
+#include "TriangleMesh.h"
+
+namespace
+{
+	double RandomValue( double minValue, double maxValue )
+	{
+		return minValue + ( maxValue - minValue ) * rand() / RAND_MAX;
+	}
+
+	//Random triangles sharing the vertices of a list of random points
+	void RandomMesh( int nVertices, int nTriangles, bool floatVertices, std::vector< Point3D >* vertices, std::vector< int >* indices )
+	{
+		for( int v = 0; v < nVertices; ++v )
+		{
+			Point3D vertex( RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ) );
+			if( floatVertices )	vertex = Point3D( float( vertex.x ), float( vertex.y ), float( vertex.z ) );
+			vertices->push_back( vertex );
+		}
+
+		for( int t = 0; t < nTriangles; ++t )
+		{
+			int first = rand() % nVertices;
+			indices->push_back( first );
+			indices->push_back( ( first + 1 + rand() % 8 ) % nVertices );
+			indices->push_back( ( first + 9 + rand() % 8 ) % nVertices );
+		}
+	}
+
+	void BuildMesh( const std::vector< Point3D >& vertices, const std::vector< int >& indices, TriangleMesh* mesh )
+	{
+		for( unsigned int i = 0; i < indices.size(); i += 3 )
+			mesh->AddTriangle( vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] );
+	}
+
+	//Encodes the mesh as ShapeCAD saves it: the triangles in the hierarchy order, with the hierarchy nodes
+	QByteArray EncodeWithHierarchy( const std::vector< Point3D >& vertices, const std::vector< int >& indices, int leafSize,
+			std::vector< BVHNode >* nodes )
+	{
+		TriangleMesh mesh;
+		BuildMesh( vertices, indices, &mesh );
+		std::vector< int > triangleOrder;
+		BVH bvh( &mesh, leafSize, &triangleOrder );
+		*nodes = bvh.GetNodes();
+
+		std::vector< int > orderedIndices( indices.size() );
+		for( unsigned int t = 0; t < triangleOrder.size(); ++t )
+			for( int v = 0; v < 3; ++v )
+				orderedIndices[3 * t + v] = indices[3 * triangleOrder[t] + v];
+
+		return ( MeshEncoder::Encode( vertices, orderedIndices, *nodes ) );
+	}
+
+	void ExpectSameNodes( const std::vector< BVHNode >& expected, const std::vector< BVHNode >& nodes )
+	{
+		ASSERT_EQ( expected.size(), nodes.size() );
+		for( unsigned int n = 0; n < nodes.size(); ++n )
+		{
+			for( int c = 0; c < 3; ++c )
+			{
+				EXPECT_EQ( expected[n].bounds[0][c], nodes[n].bounds[0][c] );
+				EXPECT_EQ( expected[n].bounds[1][c], nodes[n].bounds[1][c] );
+			}
+			EXPECT_EQ( expected[n].offset, nodes[n].offset );
+			EXPECT_EQ( expected[n].nTriangles, nodes[n].nTriangles );
+			EXPECT_EQ( expected[n].axis, nodes[n].axis );
+		}
+	}
+
+	//Checks that the hierarchy finds the same intersections as the hierarchy built for the mesh
+	void ExpectSameIntersections( const BVH& bvh, const BVH& reference )
+	{
+		int nHits = 0;
+		for( int r = 0; r < 1000; ++r )
+		{
+			Point3D origin( RandomValue( -15.0, 15.0 ), RandomValue( -15.0, 15.0 ), RandomValue( -15.0, 15.0 ) );
+			Point3D target( RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ) );
+			Ray objectRay( origin, Normalize( target - origin ) );
+
+			double tHit = objectRay.maxt;
+			DifferentialGeometry dg;
+			double referenceTHit = objectRay.maxt;
+			DifferentialGeometry referenceDg;
+			bool isReferenceHit = reference.Intersect( objectRay, &referenceTHit, &referenceDg );
+			ASSERT_EQ( isReferenceHit, bvh.Intersect( objectRay, &tHit, &dg ) );
+			if( isReferenceHit )
+			{
+				EXPECT_DOUBLE_EQ( referenceTHit, tHit );
+				++nHits;
+			}
+		}
+		EXPECT_GT( nHits, 100 );
+	}
+
+	//Encoded data with the given header and no vertices, triangles or nodes
+	QByteArray EncodeHeader( quint32 magic, quint32 version, quint32 flags )
+	{
+		QByteArray data;
+		QDataStream out( &data, QIODevice::WriteOnly );
+		out.setByteOrder( QDataStream::LittleEndian );
+		out << magic << version << flags << quint32( 0 ) << quint32( 0 ) << quint32( 0 );
+		return ( qCompress( data ).toBase64() );
+	}
+}
+
+TEST( MeshEncoderTests, SinglePrecisionVerticesRoundTrip )
+{
+	srand( 23 );
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	RandomMesh( 300, 500, true, &vertices, &indices );
+
+	QByteArray data = MeshEncoder::Encode( vertices, indices, std::vector< BVHNode >() );
+
+	//Header, three floats per vertex and three indices per triangle
+	EXPECT_EQ( 24 + 12 * 300 + 12 * 500, qUncompress( QByteArray::fromBase64( data ) ).size() );
+
+	std::vector< Point3D > decodedVertices;
+	std::vector< int > decodedIndices;
+	std::vector< BVHNode > decodedNodes;
+	ASSERT_TRUE( MeshEncoder::Decode( data, &decodedVertices, &decodedIndices, &decodedNodes ) );
+	ASSERT_EQ( vertices.size(), decodedVertices.size() );
+	for( unsigned int v = 0; v < vertices.size(); ++v )
+	{
+		EXPECT_EQ( vertices[v].x, decodedVertices[v].x );
+		EXPECT_EQ( vertices[v].y, decodedVertices[v].y );
+		EXPECT_EQ( vertices[v].z, decodedVertices[v].z );
+	}
+	EXPECT_EQ( indices, decodedIndices );
+	EXPECT_TRUE( decodedNodes.empty() );
+}
+
+TEST( MeshEncoderTests, DoublePrecisionVerticesRoundTrip )
+{
+	srand( 29 );
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	RandomMesh( 300, 500, true, &vertices, &indices );
+
+	//A single vertex that is not a float stores all of them in double precision
+	vertices[150].y = 0.1;
+
+	QByteArray data = MeshEncoder::Encode( vertices, indices, std::vector< BVHNode >() );
+	EXPECT_EQ( 24 + 24 * 300 + 12 * 500, qUncompress( QByteArray::fromBase64( data ) ).size() );
+
+	std::vector< Point3D > decodedVertices;
+	std::vector< int > decodedIndices;
+	std::vector< BVHNode > decodedNodes;
+	ASSERT_TRUE( MeshEncoder::Decode( data, &decodedVertices, &decodedIndices, &decodedNodes ) );
+	ASSERT_EQ( vertices.size(), decodedVertices.size() );
+	for( unsigned int v = 0; v < vertices.size(); ++v )
+	{
+		EXPECT_EQ( vertices[v].x, decodedVertices[v].x );
+		EXPECT_EQ( vertices[v].y, decodedVertices[v].y );
+		EXPECT_EQ( vertices[v].z, decodedVertices[v].z );
+	}
+	EXPECT_EQ( indices, decodedIndices );
+}
+
+TEST( MeshEncoderTests, EmptyMeshRoundTrip )
+{
+	QByteArray data = MeshEncoder::Encode( std::vector< Point3D >(), std::vector< int >(), std::vector< BVHNode >() );
+
+	std::vector< Point3D > vertices( 1 );
+	std::vector< int > indices( 3 );
+	std::vector< BVHNode > nodes( 1 );
+	ASSERT_TRUE( MeshEncoder::Decode( data, &vertices, &indices, &nodes ) );
+	EXPECT_TRUE( vertices.empty() );
+	EXPECT_TRUE( indices.empty() );
+	EXPECT_TRUE( nodes.empty() );
+}
+
+TEST( MeshEncoderTests, SavedHierarchyIsUsed )
+{
+	srand( 31 );
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	RandomMesh( 1000, 2000, false, &vertices, &indices );
+
+	//Leaves of one triangle, so the saved hierarchy is not the one that would be built for the mesh
+	std::vector< BVHNode > nodes;
+	QByteArray data = EncodeWithHierarchy( vertices, indices, 1, &nodes );
+
+	std::vector< Point3D > decodedVertices;
+	std::vector< int > decodedIndices;
+	std::vector< BVHNode > decodedNodes;
+	ASSERT_TRUE( MeshEncoder::Decode( data, &decodedVertices, &decodedIndices, &decodedNodes ) );
+	ExpectSameNodes( nodes, decodedNodes );
+
+	TriangleMesh mesh;
+	BuildMesh( decodedVertices, decodedIndices, &mesh );
+	BVH bvh( &mesh, decodedNodes );
+	ExpectSameNodes( nodes, bvh.GetNodes() );
+
+	TriangleMesh referenceMesh;
+	BuildMesh( vertices, indices, &referenceMesh );
+	BVH reference( &referenceMesh );
+	EXPECT_NE( reference.GetNumberOfNodes(), bvh.GetNumberOfNodes() );
+	ExpectSameIntersections( bvh, reference );
+}
+
+TEST( MeshEncoderTests, InvalidHierarchyIsRebuilt )
+{
+	srand( 37 );
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	RandomMesh( 1000, 2000, false, &vertices, &indices );
+
+	std::vector< BVHNode > nodes;
+	EncodeWithHierarchy( vertices, indices, 1, &nodes );
+	ASSERT_GT( nodes.size(), 3u );
+
+	TriangleMesh referenceMesh;
+	BuildMesh( vertices, indices, &referenceMesh );
+	BVH reference( &referenceMesh );
+
+	std::vector< std::vector< BVHNode > > invalidNodes;
+
+	//A leaf with triangles beyond the end of the mesh
+	invalidNodes.push_back( nodes );
+	for( unsigned int n = 0; n < nodes.size(); ++n )
+		if( invalidNodes.back()[n].nTriangles > 0 )	invalidNodes.back()[n].offset = 2000;
+
+	//An interior node whose second child is before the first one
+	invalidNodes.push_back( nodes );
+	invalidNodes.back()[0].offset = 1;
+
+	//An interior node with an invalid split axis
+	invalidNodes.push_back( nodes );
+	invalidNodes.back()[0].axis = 3;
+
+	//The last node is an interior node without children
+	invalidNodes.push_back( nodes );
+	invalidNodes.back().back().nTriangles = 0;
+
+	//Nodes of an empty hierarchy
+	invalidNodes.push_back( std::vector< BVHNode >() );
+
+	for( unsigned int i = 0; i < invalidNodes.size(); ++i )
+	{
+		QByteArray data = MeshEncoder::Encode( vertices, indices, invalidNodes[i] );
+
+		std::vector< Point3D > decodedVertices;
+		std::vector< int > decodedIndices;
+		std::vector< BVHNode > decodedNodes;
+		ASSERT_TRUE( MeshEncoder::Decode( data, &decodedVertices, &decodedIndices, &decodedNodes ) );
+		EXPECT_EQ( invalidNodes[i].size(), decodedNodes.size() );
+
+		TriangleMesh mesh;
+		BuildMesh( decodedVertices, decodedIndices, &mesh );
+		BVH bvh( &mesh, decodedNodes );
+		ExpectSameNodes( reference.GetNodes(), bvh.GetNodes() );
+		ExpectSameIntersections( bvh, reference );
+	}
+}
+
+TEST( MeshEncoderTests, InvalidDataIsNotDecoded )
+{
+	srand( 41 );
+	std::vector< Point3D > vertices;
+	std::vector< int > indices;
+	RandomMesh( 100, 200, true, &vertices, &indices );
+	QByteArray valid = MeshEncoder::Encode( vertices, indices, std::vector< BVHNode >() );
+
+	std::vector< Point3D > decodedVertices;
+	std::vector< int > decodedIndices;
+	std::vector< BVHNode > decodedNodes;
+	ASSERT_TRUE( MeshEncoder::Decode( valid, &decodedVertices, &decodedIndices, &decodedNodes ) );
+
+	EXPECT_FALSE( MeshEncoder::Decode( QByteArray(), &decodedVertices, &decodedIndices, &decodedNodes ) );
+	EXPECT_FALSE( MeshEncoder::Decode( QByteArray( "not a mesh" ), &decodedVertices, &decodedIndices, &decodedNodes ) );
+	EXPECT_FALSE( MeshEncoder::Decode( valid.left( valid.size() / 2 ), &decodedVertices, &decodedIndices, &decodedNodes ) );
+
+	//Uncompressed data shorter and longer than the sizes of the header
+	QByteArray meshData = qUncompress( QByteArray::fromBase64( valid ) );
+	QByteArray truncated = meshData.left( meshData.size() - 4 );
+	EXPECT_FALSE( MeshEncoder::Decode( qCompress( truncated ).toBase64(), &decodedVertices, &decodedIndices, &decodedNodes ) );
+	QByteArray extended = meshData;
+	extended.append( QByteArray( 4, '\0' ) );
+	EXPECT_FALSE( MeshEncoder::Decode( qCompress( extended ).toBase64(), &decodedVertices, &decodedIndices, &decodedNodes ) );
+
+	EXPECT_TRUE( MeshEncoder::Decode( EncodeHeader( 0x48534d54, 1, 0 ), &decodedVertices, &decodedIndices, &decodedNodes ) );
+	EXPECT_FALSE( MeshEncoder::Decode( EncodeHeader( 0x48534d55, 1, 0 ), &decodedVertices, &decodedIndices, &decodedNodes ) );
+	EXPECT_FALSE( MeshEncoder::Decode( EncodeHeader( 0x48534d54, 2, 0 ), &decodedVertices, &decodedIndices, &decodedNodes ) );
+
+	//A triangle with a vertex index out of the vertices list
+	indices[5] = 100;
+	EXPECT_FALSE( MeshEncoder::Decode( MeshEncoder::Encode( vertices, indices, std::vector< BVHNode >() ),
+			&decodedVertices, &decodedIndices, &decodedNodes ) );
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <QBuffer>
+
+#include <gtest/gtest.h>
+
+#include "PhotonMapColumns.h"
+#include "PhotonMapColumnsReader.h"
+#include "PhotonMapColumnsWriter.h"
+
+namespace
+{
+	const unsigned int AllColumns = ( 1 << PhotonMapColumns::NumberOfColumns ) - 1;
+
+	void PhotonValues( unsigned long photon, double* values )
+	{
+		values[PhotonMapColumns::Id] = photon + 1;
+		values[PhotonMapColumns::X] = 0.25 * photon;
+		values[PhotonMapColumns::Y] = -1.5 * photon;
+		values[PhotonMapColumns::Z] = 1000.0 + photon;
+		values[PhotonMapColumns::Side] = photon % 2;
+		//Rays of three photons
+		values[PhotonMapColumns::PreviousId] = ( photon % 3 == 0 ) ? 0.0 : double( photon );
+		values[PhotonMapColumns::NextId] = ( photon % 3 == 2 ) ? 0.0 : double( photon + 2 );
+		values[PhotonMapColumns::SurfaceId] = photon % 7;
+	}
+
+	void WritePhotons( QBuffer* buffer, unsigned int columns, unsigned long nPhotons, unsigned long chunkSize,
+			bool floatCoordinates, bool compress )
+	{
+		PhotonMapColumnsWriter writer( buffer, columns, chunkSize, floatCoordinates, compress );
+		writer.WriteHeader();
+
+		double values[PhotonMapColumns::NumberOfColumns];
+		for( unsigned long p = 0; p < nPhotons; ++p )
+		{
+			PhotonValues( p, values );
+			writer.AddPhoton( values );
+		}
+		writer.Flush();
+	}
+}
+
+TEST( PhotonMapColumnsTests, ReadsWrittenColumns )
+{
+	QBuffer buffer;
+	buffer.open( QIODevice::ReadWrite );
+	WritePhotons( &buffer, AllColumns, 2500, 1000, false, true );
+
+	PhotonMapColumnsReader reader( &buffer );
+	ASSERT_TRUE( reader.Open() );
+	ASSERT_EQ( 3, reader.GetNumberOfChunks() );
+	EXPECT_EQ( 2500u, reader.GetNumberOfPhotons() );
+	EXPECT_EQ( 500u, reader.GetChunkNumberOfPhotons( 2 ) );
+
+	double values[PhotonMapColumns::NumberOfColumns];
+	for( int chunk = 0; chunk < reader.GetNumberOfChunks(); ++chunk )
+	{
+		for( int column = 0; column < PhotonMapColumns::NumberOfColumns; ++column )
+		{
+			std::vector< double > columnValues;
+			ASSERT_TRUE( reader.ReadColumn( chunk, column, &columnValues ) );
+			ASSERT_EQ( reader.GetChunkNumberOfPhotons( chunk ), columnValues.size() );
+
+			for( unsigned long p = 0; p < columnValues.size(); ++p )
+			{
+				PhotonValues( 1000 * chunk + p, values );
+				EXPECT_DOUBLE_EQ( values[column], columnValues[p] );
+			}
+		}
+	}
+}
+
+TEST( PhotonMapColumnsTests, StoresColumnRanges )
+{
+	QBuffer buffer;
+	buffer.open( QIODevice::ReadWrite );
+	WritePhotons( &buffer, AllColumns, 2000, 1000, false, false );
+
+	PhotonMapColumnsReader reader( &buffer );
+	ASSERT_TRUE( reader.Open() );
+
+	double minValue = 0.0;
+	double maxValue = 0.0;
+	ASSERT_TRUE( reader.GetColumnRange( 1, PhotonMapColumns::Id, &minValue, &maxValue ) );
+	EXPECT_DOUBLE_EQ( 1001.0, minValue );
+	EXPECT_DOUBLE_EQ( 2000.0, maxValue );
+
+	ASSERT_TRUE( reader.GetColumnRange( 0, PhotonMapColumns::Y, &minValue, &maxValue ) );
+	EXPECT_DOUBLE_EQ( -1.5 * 999, minValue );
+	EXPECT_DOUBLE_EQ( 0.0, maxValue );
+}
+
+TEST( PhotonMapColumnsTests, SkipsColumnsNotStored )
+{
+	QBuffer buffer;
+	buffer.open( QIODevice::ReadWrite );
+	unsigned int columns = ( 1 << PhotonMapColumns::X ) | ( 1 << PhotonMapColumns::Y ) | ( 1 << PhotonMapColumns::Z ) |
+			( 1 << PhotonMapColumns::SurfaceId );
+	WritePhotons( &buffer, columns, 1500, 1000, true, true );
+
+	PhotonMapColumnsReader reader( &buffer );
+	ASSERT_TRUE( reader.Open() );
+	EXPECT_TRUE( reader.HasColumn( PhotonMapColumns::Id ) );
+	EXPECT_TRUE( reader.HasColumn( PhotonMapColumns::SurfaceId ) );
+	EXPECT_FALSE( reader.HasColumn( PhotonMapColumns::Side ) );
+
+	std::vector< double > sides;
+	EXPECT_FALSE( reader.ReadColumn( 0, PhotonMapColumns::Side, &sides ) );
+
+	std::vector< double > z;
+	ASSERT_TRUE( reader.ReadColumn( 1, PhotonMapColumns::Z, &z ) );
+	ASSERT_EQ( 500u, z.size() );
+	EXPECT_FLOAT_EQ( 2000.0f, float( z[0] ) );
+}
+
+TEST( PhotonMapColumnsTests, IgnoresIncompleteChunk )
+{
+	QBuffer buffer;
+	buffer.open( QIODevice::ReadWrite );
+	WritePhotons( &buffer, AllColumns, 1500, 1000, false, false );
+	buffer.buffer().chop( 10 );
+
+	PhotonMapColumnsReader reader( &buffer );
+	ASSERT_TRUE( reader.Open() );
+	EXPECT_EQ( 1, reader.GetNumberOfChunks() );
+}
@@ -0,0 +1,248 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <string>
+#include <vector>
+
+#include <QDir>
+#include <QString>
+
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <sqlite3.h>
+
+#include <gtest/gtest.h>
+
+#include "InstanceNode.h"
+#include "Photon.h"
+#include "PhotonMapExportDB.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+namespace
+{
+	//Rays of three photons, the first photon of each ray has the identifier 0
+	std::vector< Photon > RaysPhotons( unsigned long nPhotons, InstanceNode* surface1, InstanceNode* surface2 )
+	{
+		std::vector< Photon > photons;
+		for( unsigned long p = 0; p < nPhotons; ++p )
+		{
+			InstanceNode* surface = 0;
+			if( p % 3 == 1 )	surface = surface1;
+			else if( p % 3 == 2 )	surface = surface2;
+
+			Point3D pos( 0.1 * p, -1.5 * p, 1000.0 + p / 3.0 );
+			photons.push_back( Photon( pos, p % 2, p % 3, surface ) );
+		}
+		return ( photons );
+	}
+}
+
+class PhotonMapExportDBTest : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		QDir::temp().mkdir( QLatin1String( "PhotonMapExportDBTest" ) );
+		m_directory = QDir( QDir::temp().filePath( QLatin1String( "PhotonMapExportDBTest" ) ) );
+
+		m_surfaceNode1 = new SoSeparator;
+		m_surfaceNode1->ref();
+		m_surfaceNode1->setName( "Surface1" );
+		m_surfaceNode2 = new SoSeparator;
+		m_surfaceNode2->ref();
+		m_surfaceNode2->setName( "Surface2" );
+
+		m_surface1 = new InstanceNode( m_surfaceNode1 );
+		m_surface1->SetIntersectionTransform( Translate( Vector3D( 1.0, 2.0, 3.0 ) ) );
+		m_surface2 = new InstanceNode( m_surfaceNode2 );
+		m_surface2->SetIntersectionTransform( Translate( Vector3D( 0.0, 0.0, -1000.0 ) ) );
+	}
+
+	virtual void TearDown()
+	{
+		QStringList files = m_directory.entryList( QDir::Files );
+		for( int f = 0; f < files.count(); ++f )
+			m_directory.remove( files[f] );
+		QDir::temp().rmdir( QLatin1String( "PhotonMapExportDBTest" ) );
+
+		delete m_surface1;
+		delete m_surface2;
+		m_surfaceNode1->unref();
+		m_surfaceNode2->unref();
+	}
+
+	//Exports the photons with all the data in the surfaces local coordinates
+	void ExportDB( const std::vector< std::vector< Photon > >& raysLists, QString transactionSize )
+	{
+		PhotonMapExportDB exporter;
+		exporter.SetSaveParameterValue( QLatin1String( "ExportDirectory" ), m_directory.absolutePath() );
+		exporter.SetSaveParameterValue( QLatin1String( "DBFilename" ), QLatin1String( "PhotonMap" ) );
+		exporter.SetSaveParameterValue( QLatin1String( "TransactionSize" ), transactionSize );
+		exporter.SetSaveAllPhotonsEnabled();
+		exporter.SetSaveCoordinatesEnabled( true );
+		exporter.SetSaveCoordinatesInGlobalSystemEnabled( false );
+		exporter.SetSaveSideEnabled( true );
+		exporter.SetSavePreviousNextPhotonsID( true );
+		exporter.SetSaveSurfacesIDEnabled( true );
+
+		ASSERT_TRUE( exporter.StartExport() );
+		for( unsigned int l = 0; l < raysLists.size(); ++l )
+			exporter.SavePhotonMap( raysLists[l] );
+		exporter.SetPowerPerPhoton( 0.25 );
+		exporter.EndExport();
+	}
+
+	//Checks the photons table against the photons of \a raysLists
+	void ExpectPhotons( sqlite3* db, const std::vector< std::vector< Photon > >& raysLists ) const
+	{
+		sqlite3_stmt* stmt = 0;
+		ASSERT_EQ( SQLITE_OK, sqlite3_prepare_v2( db,
+				"SELECT id, x, y, z, side, previousID, nextID, surfaceID FROM Photons ORDER BY id", -1, &stmt, 0 ) );
+
+		sqlite3_int64 photonID = 0;
+		for( unsigned int l = 0; l < raysLists.size(); ++l )
+		{
+			const std::vector< Photon >& photons = raysLists[l];
+			for( unsigned long p = 0; p < photons.size(); ++p )
+			{
+				ASSERT_EQ( SQLITE_ROW, sqlite3_step( stmt ) );
+				const Photon& photon = photons[p];
+				EXPECT_EQ( ++photonID, sqlite3_column_int64( stmt, 0 ) );
+
+				//Coordinates in the surface system with full precision
+				Point3D localPos = photon.pos;
+				if( photon.intersectedSurface )
+					localPos = photon.intersectedSurface->GetIntersectionTransform()( photon.pos );
+				EXPECT_EQ( localPos.x, sqlite3_column_double( stmt, 1 ) );
+				EXPECT_EQ( localPos.y, sqlite3_column_double( stmt, 2 ) );
+				EXPECT_EQ( localPos.z, sqlite3_column_double( stmt, 3 ) );
+
+				EXPECT_EQ( photon.side, sqlite3_column_int( stmt, 4 ) );
+
+				//Previous and next photons of the same ray in the same list
+				bool hasPrevious = ( photon.id > 0 );
+				bool hasNext = ( p < photons.size() - 1 ) && ( photons[p + 1].id > 0 );
+				EXPECT_EQ( hasPrevious ? photonID - 1 : 0, sqlite3_column_int64( stmt, 5 ) );
+				EXPECT_EQ( hasNext ? photonID + 1 : 0, sqlite3_column_int64( stmt, 6 ) );
+
+				//Surfaces are numbered in the order they are found
+				sqlite3_int64 surfaceID = 0;
+				if( photon.intersectedSurface == m_surface1 )	surfaceID = 1;
+				else if( photon.intersectedSurface == m_surface2 )	surfaceID = 2;
+				EXPECT_EQ( surfaceID, sqlite3_column_int64( stmt, 7 ) );
+			}
+		}
+		EXPECT_EQ( SQLITE_DONE, sqlite3_step( stmt ) );
+		sqlite3_finalize( stmt );
+	}
+
+	sqlite3* OpenDB() const
+	{
+		std::string filename = m_directory.filePath( QLatin1String( "PhotonMap.db" ) ).toStdString();
+		sqlite3* db = 0;
+		if( sqlite3_open_v2( filename.c_str(), &db, SQLITE_OPEN_READONLY, 0 ) != SQLITE_OK )
+		{
+			sqlite3_close( db );
+			return ( 0 );
+		}
+		return ( db );
+	}
+
+	QDir m_directory;
+	SoSeparator* m_surfaceNode1;
+	SoSeparator* m_surfaceNode2;
+	InstanceNode* m_surface1;
+	InstanceNode* m_surface2;
+};
+
+TEST_F( PhotonMapExportDBTest, PhotonsRoundTrip )
+{
+	//Several transactions, the last one is committed when the export ends
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 30, m_surface1, m_surface2 ) );
+	raysLists.push_back( RaysPhotons( 13, m_surface1, m_surface2 ) );
+	ExportDB( raysLists, QLatin1String( "10" ) );
+
+	sqlite3* db = OpenDB();
+	ASSERT_TRUE( db != 0 );
+	ExpectPhotons( db, raysLists );
+	sqlite3_close( db );
+}
+
+TEST_F( PhotonMapExportDBTest, PhotonsRoundTripInOneTransaction )
+{
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 30, m_surface1, m_surface2 ) );
+	ExportDB( raysLists, QLatin1String( "0" ) );
+
+	sqlite3* db = OpenDB();
+	ASSERT_TRUE( db != 0 );
+	ExpectPhotons( db, raysLists );
+	sqlite3_close( db );
+}
+
+TEST_F( PhotonMapExportDBTest, SurfacesAndPowerAreSaved )
+{
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 6, m_surface1, m_surface2 ) );
+	ExportDB( raysLists, QLatin1String( "10" ) );
+
+	sqlite3* db = OpenDB();
+	ASSERT_TRUE( db != 0 );
+
+	sqlite3_stmt* stmt = 0;
+	ASSERT_EQ( SQLITE_OK, sqlite3_prepare_v2( db, "SELECT id, Path FROM Surfaces ORDER BY id", -1, &stmt, 0 ) );
+	ASSERT_EQ( SQLITE_ROW, sqlite3_step( stmt ) );
+	EXPECT_EQ( 1, sqlite3_column_int64( stmt, 0 ) );
+	EXPECT_STREQ( " /Surface1", reinterpret_cast< const char* >( sqlite3_column_text( stmt, 1 ) ) );
+	ASSERT_EQ( SQLITE_ROW, sqlite3_step( stmt ) );
+	EXPECT_EQ( 2, sqlite3_column_int64( stmt, 0 ) );
+	EXPECT_STREQ( " /Surface2", reinterpret_cast< const char* >( sqlite3_column_text( stmt, 1 ) ) );
+	EXPECT_EQ( SQLITE_DONE, sqlite3_step( stmt ) );
+	sqlite3_finalize( stmt );
+
+	ASSERT_EQ( SQLITE_OK, sqlite3_prepare_v2( db, "SELECT power FROM wphoton", -1, &stmt, 0 ) );
+	ASSERT_EQ( SQLITE_ROW, sqlite3_step( stmt ) );
+	EXPECT_DOUBLE_EQ( 0.25, sqlite3_column_double( stmt, 0 ) );
+	EXPECT_EQ( SQLITE_DONE, sqlite3_step( stmt ) );
+	sqlite3_finalize( stmt );
+
+	sqlite3_close( db );
+}
@@ -0,0 +1,289 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstring>
+#include <vector>
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <Inventor/nodes/SoSeparator.h>
+
+#include <gtest/gtest.h>
+
+#include "InstanceNode.h"
+#include "Photon.h"
+#include "PhotonMapExportFile.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+namespace
+{
+	//Rays of three photons, the first photon of each ray has the identifier 0
+	std::vector< Photon > RaysPhotons( unsigned long nPhotons, InstanceNode* surface1, InstanceNode* surface2 )
+	{
+		std::vector< Photon > photons;
+		for( unsigned long p = 0; p < nPhotons; ++p )
+		{
+			InstanceNode* surface = 0;
+			if( p % 3 == 1 )	surface = surface1;
+			else if( p % 3 == 2 )	surface = surface2;
+
+			Point3D pos( 0.1 * p, -1.5 * p, 1000.0 + p );
+			photons.push_back( Photon( pos, p % 2, p % 3, surface ) );
+		}
+		return ( photons );
+	}
+
+	quint64 ReadLittleEndian( const QByteArray& data, int offset, int size )
+	{
+		quint64 value = 0;
+		for( int b = size - 1; b >= 0; --b )
+			value = ( value << 8 ) | quint64( uchar( data[offset + b] ) );
+		return ( value );
+	}
+
+	double ReadCoordinate( const QByteArray& data, int offset, bool floatCoordinates )
+	{
+		if( floatCoordinates )
+		{
+			quint32 bits = quint32( ReadLittleEndian( data, offset, 4 ) );
+			float value;
+			memcpy( &value, &bits, 4 );
+			return ( value );
+		}
+
+		quint64 bits = ReadLittleEndian( data, offset, 8 );
+		double value;
+		memcpy( &value, &bits, 8 );
+		return ( value );
+	}
+}
+
+class PhotonMapExportFileTest : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		QDir::temp().mkdir( QLatin1String( "PhotonMapExportFileTest" ) );
+		m_directory = QDir( QDir::temp().filePath( QLatin1String( "PhotonMapExportFileTest" ) ) );
+
+		m_surfaceNode1 = new SoSeparator;
+		m_surfaceNode1->ref();
+		m_surfaceNode1->setName( "Surface1" );
+		m_surfaceNode2 = new SoSeparator;
+		m_surfaceNode2->ref();
+		m_surfaceNode2->setName( "Surface2" );
+
+		m_surface1 = new InstanceNode( m_surfaceNode1 );
+		m_surface1->SetIntersectionTransform( Translate( Vector3D( 1.0, 2.0, 3.0 ) ) );
+		m_surface2 = new InstanceNode( m_surfaceNode2 );
+		m_surface2->SetIntersectionTransform( Translate( Vector3D( 0.0, 0.0, -1000.0 ) ) );
+	}
+
+	virtual void TearDown()
+	{
+		QStringList files = m_directory.entryList( QDir::Files );
+		for( int f = 0; f < files.count(); ++f )
+			m_directory.remove( files[f] );
+		QDir::temp().rmdir( QLatin1String( "PhotonMapExportFileTest" ) );
+
+		delete m_surface1;
+		delete m_surface2;
+		m_surfaceNode1->unref();
+		m_surfaceNode2->unref();
+	}
+
+	//Exports the photons in compact format with all the data in the surfaces local coordinates
+	void ExportCompact( const std::vector< std::vector< Photon > >& raysLists, bool floatCoordinates, QString fileSize )
+	{
+		PhotonMapExportFile exporter;
+		exporter.SetSaveParameterValue( QLatin1String( "ExportDirectory" ), m_directory.absolutePath() );
+		exporter.SetSaveParameterValue( QLatin1String( "ExportFile" ), QLatin1String( "PhotonMap" ) );
+		exporter.SetSaveParameterValue( QLatin1String( "FileSize" ), fileSize );
+		exporter.SetSaveParameterValue( QLatin1String( "FileFormat" ), QLatin1String( "Compact" ) );
+		exporter.SetSaveParameterValue( QLatin1String( "CoordinatesPrecision" ),
+				floatCoordinates ? QLatin1String( "Float" ) : QLatin1String( "Double" ) );
+		exporter.SetSaveAllPhotonsEnabled();
+		exporter.SetSaveCoordinatesEnabled( true );
+		exporter.SetSaveCoordinatesInGlobalSystemEnabled( false );
+		exporter.SetSaveSideEnabled( true );
+		exporter.SetSavePreviousNextPhotonsID( true );
+		exporter.SetSaveSurfacesIDEnabled( true );
+
+		ASSERT_TRUE( exporter.StartExport() );
+		for( unsigned int l = 0; l < raysLists.size(); ++l )
+			exporter.SavePhotonMap( raysLists[l] );
+		exporter.EndExport();
+	}
+
+	QByteArray ReadFile( QString filename ) const
+	{
+		QFile file( m_directory.filePath( filename ) );
+		if( !file.open( QIODevice::ReadOnly ) )	return ( QByteArray() );
+		return ( file.readAll() );
+	}
+
+	//Checks the records of \a data against the photons of \a raysLists, starting from the photon \a firstPhoton
+	void ExpectRecords( const QByteArray& data, const std::vector< std::vector< Photon > >& raysLists,
+			unsigned long firstPhoton, unsigned long nPhotons, bool floatCoordinates ) const
+	{
+		int coordinateSize = floatCoordinates ? 4 : 8;
+		int recordSize = 8 + 3 * coordinateSize + 1 + 2 * 8 + 4;
+		ASSERT_EQ( int( nPhotons ) * recordSize, data.size() );
+
+		unsigned long photonID = 0;
+		for( unsigned int l = 0; l < raysLists.size(); ++l )
+		{
+			const std::vector< Photon >& photons = raysLists[l];
+			for( unsigned long p = 0; p < photons.size(); ++p )
+			{
+				++photonID;
+				if( ( photonID <= firstPhoton ) || ( photonID > firstPhoton + nPhotons ) )	continue;
+
+				const Photon& photon = photons[p];
+				int offset = int( photonID - firstPhoton - 1 ) * recordSize;
+
+				//Identifier
+				EXPECT_EQ( photonID, ReadLittleEndian( data, offset, 8 ) );
+				offset += 8;
+
+				//Coordinates in the surface system
+				Point3D localPos = photon.pos;
+				if( photon.intersectedSurface )
+					localPos = photon.intersectedSurface->GetIntersectionTransform()( photon.pos );
+				double expected[3] = { localPos.x, localPos.y, localPos.z };
+				for( int c = 0; c < 3; ++c )
+				{
+					double coordinate = ReadCoordinate( data, offset, floatCoordinates );
+					if( floatCoordinates )	EXPECT_EQ( float( expected[c] ), float( coordinate ) );
+					else	EXPECT_EQ( expected[c], coordinate );
+					offset += coordinateSize;
+				}
+
+				//Side
+				EXPECT_EQ( photon.side, int( uchar( data[offset] ) ) );
+				offset += 1;
+
+				//Previous and next photons of the same ray in the same list
+				bool hasPrevious = ( photon.id > 0 );
+				bool hasNext = ( p < photons.size() - 1 ) && ( photons[p + 1].id > 0 );
+				EXPECT_EQ( hasPrevious ? photonID - 1 : 0, ReadLittleEndian( data, offset, 8 ) );
+				EXPECT_EQ( hasNext ? photonID + 1 : 0, ReadLittleEndian( data, offset + 8, 8 ) );
+				offset += 16;
+
+				//Surfaces are numbered in the order they are found
+				quint64 surfaceID = 0;
+				if( photon.intersectedSurface == m_surface1 )	surfaceID = 1;
+				else if( photon.intersectedSurface == m_surface2 )	surfaceID = 2;
+				EXPECT_EQ( surfaceID, ReadLittleEndian( data, offset, 4 ) );
+			}
+		}
+	}
+
+	QDir m_directory;
+	SoSeparator* m_surfaceNode1;
+	SoSeparator* m_surfaceNode2;
+	InstanceNode* m_surface1;
+	InstanceNode* m_surface2;
+};
+
+TEST_F( PhotonMapExportFileTest, CompactDoubleRecordsRoundTrip )
+{
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 30, m_surface1, m_surface2 ) );
+	raysLists.push_back( RaysPhotons( 12, m_surface1, m_surface2 ) );
+	ExportCompact( raysLists, false, QLatin1String( "-1" ) );
+
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap.dat" ) ), raysLists, 0, 42, false );
+}
+
+TEST_F( PhotonMapExportFileTest, CompactFloatRecordsRoundTrip )
+{
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 30, m_surface1, m_surface2 ) );
+	raysLists.push_back( RaysPhotons( 12, m_surface1, m_surface2 ) );
+	ExportCompact( raysLists, true, QLatin1String( "-1" ) );
+
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap.dat" ) ), raysLists, 0, 42, true );
+}
+
+TEST_F( PhotonMapExportFileTest, CompactRecordsAreSplitIntoFiles )
+{
+	//The rays of the first list are split between the files
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 25, m_surface1, m_surface2 ) );
+	raysLists.push_back( RaysPhotons( 12, m_surface1, m_surface2 ) );
+	ExportCompact( raysLists, true, QLatin1String( "10" ) );
+
+	EXPECT_FALSE( QFile::exists( m_directory.filePath( QLatin1String( "PhotonMap.dat" ) ) ) );
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap_1.dat" ) ), raysLists, 0, 10, true );
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap_2.dat" ) ), raysLists, 10, 10, true );
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap_3.dat" ) ), raysLists, 20, 10, true );
+	ExpectRecords( ReadFile( QLatin1String( "PhotonMap_4.dat" ) ), raysLists, 30, 7, true );
+	EXPECT_FALSE( QFile::exists( m_directory.filePath( QLatin1String( "PhotonMap_5.dat" ) ) ) );
+}
+
+TEST_F( PhotonMapExportFileTest, CompactParametersDescribeTheRecords )
+{
+	std::vector< std::vector< Photon > > raysLists;
+	raysLists.push_back( RaysPhotons( 6, m_surface1, m_surface2 ) );
+	ExportCompact( raysLists, true, QLatin1String( "-1" ) );
+
+	QByteArray data = ReadFile( QLatin1String( "PhotonMap_parameters.txt" ) );
+	QString parameters = QString::fromLatin1( data.constData(), data.size() );
+	QString expected = QLatin1String( "FORMAT compact little-endian\n"
+			"START PARAMETERS\n"
+			"id uint64\n"
+			"x float32\n"
+			"y float32\n"
+			"z float32\n"
+			"side uint8\n"
+			"previous ID uint64\n"
+			"next ID uint64\n"
+			"surface ID uint32\n"
+			"END PARAMETERS\n"
+			"START SURFACES\n"
+			"1 /Surface1\n"
+			"2 /Surface2\n"
+			"END SURFACES\n" );
+	EXPECT_TRUE( parameters.startsWith( expected ) ) << parameters.toStdString();
+}
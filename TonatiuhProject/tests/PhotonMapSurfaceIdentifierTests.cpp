@@ -0,0 +1,92 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "InstanceNode.h"
+#include "PhotonMapSurfaceIdentifier.h"
+#include "Point3D.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+TEST( PhotonMapSurfaceIdentifierTests, SurfacesAreNumberedInOrder )
+{
+	InstanceNode surface1( 0 );
+	InstanceNode surface2( 0 );
+
+	PhotonMapSurfaceIdentifier identifier;
+	EXPECT_EQ( 0u, identifier.GetSurfaceID( 0 ) );
+
+	bool isNewSurface = false;
+	EXPECT_EQ( 1u, identifier.GetSurfaceID( &surface1, &isNewSurface ) );
+	EXPECT_TRUE( isNewSurface );
+	EXPECT_EQ( 2u, identifier.GetSurfaceID( &surface2, &isNewSurface ) );
+	EXPECT_TRUE( isNewSurface );
+	EXPECT_EQ( 1u, identifier.GetSurfaceID( &surface1, &isNewSurface ) );
+	EXPECT_FALSE( isNewSurface );
+	EXPECT_EQ( 1u, identifier.GetSurfaceID( &surface1, &isNewSurface ) );
+	EXPECT_FALSE( isNewSurface );
+
+	EXPECT_EQ( 2, identifier.GetNumberOfSurfaces() );
+	EXPECT_EQ( &surface1, identifier.GetSurface( 1 ) );
+	EXPECT_EQ( &surface2, identifier.GetSurface( 2 ) );
+	EXPECT_EQ( 0, identifier.GetSurface( 3 ) );
+
+	identifier.Clear();
+	EXPECT_EQ( 1u, identifier.GetSurfaceID( &surface2 ) );
+}
+
+TEST( PhotonMapSurfaceIdentifierTests, KeepsSurfacesWorldToObject )
+{
+	InstanceNode surface( 0 );
+	surface.SetIntersectionTransform( Translate( Vector3D( 1.0, 2.0, 3.0 ) ) );
+
+	PhotonMapSurfaceIdentifier identifier;
+	unsigned long surfaceID = identifier.GetSurfaceID( &surface );
+
+	Point3D localPoint = identifier.GetWorldToObject( surfaceID )( Point3D( 0.0, 0.0, 0.0 ) );
+	EXPECT_DOUBLE_EQ( 1.0, localPoint.x );
+	EXPECT_DOUBLE_EQ( 2.0, localPoint.y );
+	EXPECT_DOUBLE_EQ( 3.0, localPoint.z );
+
+	Point3D point = identifier.GetWorldToObject( 0 )( Point3D( 4.0, 5.0, 6.0 ) );
+	EXPECT_DOUBLE_EQ( 4.0, point.x );
+	EXPECT_DOUBLE_EQ( 5.0, point.y );
+	EXPECT_DOUBLE_EQ( 6.0, point.z );
+}
@@ -0,0 +1,168 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QMutex>
+
+#include "ParallelRandomDeviate.h"
+#include "RandomDeviate.h"
+#include "RandomMersenneTwister.h"
+#include "RandomRngStream.h"
+
+namespace
+{
+	//A generator without streams that counts up, so the numbers show the order they were taken in
+	class CountingRandomDeviate : public RandomDeviate
+	{
+	public:
+		CountingRandomDeviate() : RandomDeviate( 10 ), m_next( 0.0 ) {}
+		void FillArray( double* array, const unsigned long arraySize )
+		{
+			for( unsigned long i = 0; i < arraySize; ++i )	array[i] = m_next++;
+		}
+
+	private:
+		double m_next;
+	};
+
+	std::vector< double > Draw( RandomDeviate& rand, int nNumbers )
+	{
+		std::vector< double > numbers( nNumbers );
+		for( int i = 0; i < nNumbers; ++i )	numbers[i] = rand.RandomDouble();
+		return numbers;
+	}
+
+	std::vector< double > DrawStream( RandomDeviate& rand, unsigned long streamIndex, unsigned long arraySize, int nNumbers )
+	{
+		QMutex mutex;
+		ParallelRandomDeviate stream( &rand, streamIndex, &mutex, arraySize );
+		return Draw( stream, nNumbers );
+	}
+}
+
+TEST( RandomStreamTests, RngStreamSameIndexRepeatsSequence )
+{
+	RandomRngStream rand( 3, 1000 );
+
+	std::vector< double > first = DrawStream( rand, 7, 100, 2500 );
+	std::vector< double > second = DrawStream( rand, 7, 100, 2500 );
+	EXPECT_EQ( first, second );
+
+	//The streams are created from the seed, not from the numbers already drawn
+	Draw( rand, 1500 );
+	EXPECT_EQ( first, DrawStream( rand, 7, 100, 2500 ) );
+
+	RandomRngStream sameSeed( 3, 10 );
+	EXPECT_EQ( first, DrawStream( sameSeed, 7, 100, 2500 ) );
+}
+
+TEST( RandomStreamTests, RngStreamIndexesGiveDifferentSequences )
+{
+	RandomRngStream rand( 3, 1000 );
+
+	std::vector< double > stream0 = DrawStream( rand, 0, 100, 1000 );
+	std::vector< double > stream1 = DrawStream( rand, 1, 100, 1000 );
+	std::vector< double > stream2 = DrawStream( rand, 2, 100, 1000 );
+	EXPECT_NE( stream0, stream1 );
+	EXPECT_NE( stream1, stream2 );
+	EXPECT_NE( stream0, stream2 );
+
+	RandomRngStream otherSeed( 4, 1000 );
+	EXPECT_NE( stream1, DrawStream( otherSeed, 1, 100, 1000 ) );
+}
+
+TEST( RandomStreamTests, StreamDoesNotDependOnArraySize )
+{
+	RandomRngStream rngStream( 3, 1000 );
+	EXPECT_EQ( DrawStream( rngStream, 5, 100000, 1000 ), DrawStream( rngStream, 5, 7, 1000 ) );
+
+	RandomMersenneTwister mersenneTwister( 5489UL, 1000 );
+	EXPECT_EQ( DrawStream( mersenneTwister, 5, 100000, 1000 ), DrawStream( mersenneTwister, 5, 7, 1000 ) );
+}
+
+TEST( RandomStreamTests, RngStreamPackageSeed )
+{
+	//First number of the first stream of the default package seed, as given by L'Ecuyer's RngStreams
+	RandomRngStream rand( 0UL, 10 );
+	EXPECT_NEAR( 0.1270111220, rand.RandomDouble(), 1.0e-10 );
+}
+
+TEST( RandomStreamTests, MersenneTwisterInitByArray )
+{
+	//Reference output of init_by_array( { 0x123, 0x234, 0x345, 0x456 } ) in the original mt19937ar.c
+	const unsigned long seedArray[4] = { 0x123UL, 0x234UL, 0x345UL, 0x456UL };
+	RandomMersenneTwister reference( seedArray, 4, 10 );
+	EXPECT_EQ( 1067595299UL, reference.RandomUInt() );
+	EXPECT_EQ( 955945823UL, reference.RandomUInt() );
+	EXPECT_EQ( 477289528UL, reference.RandomUInt() );
+}
+
+TEST( RandomStreamTests, MersenneTwisterStreamSeedsWithSeedAndIndex )
+{
+	RandomMersenneTwister rand( 2011UL, 1000 );
+
+	for( unsigned long streamIndex = 0; streamIndex < 3; ++streamIndex )
+	{
+		const unsigned long streamSeed[2] = { 2011UL, streamIndex };
+		RandomMersenneTwister expected( streamSeed, 2, 100 );
+		EXPECT_EQ( Draw( expected, 1000 ), DrawStream( rand, streamIndex, 100, 1000 ) );
+	}
+
+	EXPECT_EQ( DrawStream( rand, 1, 100, 1000 ), DrawStream( rand, 1, 100, 1000 ) );
+	EXPECT_NE( DrawStream( rand, 1, 100, 1000 ), DrawStream( rand, 2, 100, 1000 ) );
+}
+
+TEST( RandomStreamTests, GeneratorWithoutStreamsIsShared )
+{
+	CountingRandomDeviate rand;
+	QMutex mutex;
+
+	//Each generator takes its arrays from the shared generator in turn
+	ParallelRandomDeviate first( &rand, 0, &mutex, 5 );
+	ParallelRandomDeviate second( &rand, 1, &mutex, 5 );
+	EXPECT_EQ( 0.0, first.RandomDouble() );
+	EXPECT_EQ( 5.0, second.RandomDouble() );
+	EXPECT_EQ( 1.0, first.RandomDouble() );
+
+	ParallelRandomDeviate shared( &rand, &mutex, 5 );
+	EXPECT_EQ( 10.0, shared.RandomDouble() );
+}
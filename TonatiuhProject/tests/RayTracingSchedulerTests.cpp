@@ -0,0 +1,103 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "RayTracingScheduler.h"
+
+TEST( RayTracingSchedulerTests, BlocksCoverAllRays )
+{
+	unsigned long numberOfRays = 1234567;
+	RayTracingScheduler scheduler( numberOfRays, 10, 4 );
+
+	unsigned long rays = 0;
+	for( unsigned long b = 0; b < scheduler.NumberOfBlocks(); ++b )
+	{
+		QPair< unsigned long, unsigned long > block = scheduler.Block( b );
+		EXPECT_EQ( 10 + b, block.first );
+		EXPECT_GT( block.second, 0u );
+		rays += block.second;
+	}
+	EXPECT_EQ( numberOfRays, rays );
+}
+
+TEST( RayTracingSchedulerTests, BlocksDoNotDependOnWorkers )
+{
+	RayTracingScheduler scheduler1( 1000000, 0, 1 );
+	RayTracingScheduler scheduler64( 1000000, 0, 64 );
+
+	ASSERT_EQ( scheduler1.NumberOfBlocks(), scheduler64.NumberOfBlocks() );
+	for( unsigned long b = 0; b < scheduler1.NumberOfBlocks(); ++b )
+		EXPECT_EQ( scheduler1.Block( b ).second, scheduler64.Block( b ).second );
+}
+
+TEST( RayTracingSchedulerTests, WorkersStealRemainingBlocks )
+{
+	RayTracingScheduler scheduler( 100000, 0, 8 );
+	std::vector< int > tracedBlocks( scheduler.NumberOfBlocks(), 0 );
+
+	//Only the first worker asks for chunks, it has to steal the blocks of the others
+	unsigned long firstBlock = 0;
+	unsigned long nBlocks = 0;
+	while( scheduler.NextChunk( 0, &firstBlock, &nBlocks ) )
+	{
+		ASSERT_GT( nBlocks, 0u );
+		for( unsigned long b = firstBlock; b < firstBlock + nBlocks; ++b )
+			tracedBlocks[b]++;
+		scheduler.ChunkFinished( 0, nBlocks, 10 );
+	}
+
+	for( unsigned long b = 0; b < tracedBlocks.size(); ++b )
+		EXPECT_EQ( 1, tracedBlocks[b] );
+}
+
+TEST( RayTracingSchedulerTests, CancelStopsWorkers )
+{
+	RayTracingScheduler scheduler( 100000, 0, 2 );
+
+	unsigned long firstBlock = 0;
+	unsigned long nBlocks = 0;
+	EXPECT_TRUE( scheduler.NextChunk( 1, &firstBlock, &nBlocks ) );
+
+	scheduler.Cancel();
+	EXPECT_FALSE( scheduler.NextChunk( 0, &firstBlock, &nBlocks ) );
+	EXPECT_FALSE( scheduler.NextChunk( 1, &firstBlock, &nBlocks ) );
+}
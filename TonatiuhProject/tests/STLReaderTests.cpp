@@ -0,0 +1,357 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <gtest/gtest.h>
+
+#include "Point3D.h"
+#include "STLReader.h"
+
+namespace
+{
+	struct Vertex
+	{
+		Vertex( float vx, float vy, float vz ) : x( vx ), y( vy ), z( vz ) {}
+		bool operator<( const Vertex& v ) const
+		{
+			if( x != v.x )	return ( x < v.x );
+			if( y != v.y )	return ( y < v.y );
+			return ( z < v.z );
+		}
+
+		float x;
+		float y;
+		float z;
+	};
+
+	//Height field of size x size cells with two facets per cell. The coordinates are exact in binary and decimal.
+	std::vector< Vertex > HeightFieldFacets( int size )
+	{
+		std::vector< Vertex > facets;
+		for( int i = 0; i < size; ++i )
+		{
+			for( int j = 0; j < size; ++j )
+			{
+				Vertex v00( 0.25f * i, 0.5f * j, 0.125f * ( ( i * j ) % 5 ) );
+				Vertex v10( 0.25f * ( i + 1 ), 0.5f * j, 0.125f * ( ( ( i + 1 ) * j ) % 5 ) );
+				Vertex v01( 0.25f * i, 0.5f * ( j + 1 ), 0.125f * ( ( i * ( j + 1 ) ) % 5 ) );
+				Vertex v11( 0.25f * ( i + 1 ), 0.5f * ( j + 1 ), 0.125f * ( ( ( i + 1 ) * ( j + 1 ) ) % 5 ) );
+
+				facets.push_back( v00 );
+				facets.push_back( v10 );
+				facets.push_back( v11 );
+				facets.push_back( v00 );
+				facets.push_back( v11 );
+				facets.push_back( v01 );
+			}
+		}
+		return ( facets );
+	}
+
+	//Vertices and indices that the reader should give for the facets: each distinct vertex in order of appearance
+	void ExpectedMesh( const std::vector< Vertex >& facets, std::vector< Vertex >* vertices, std::vector< int >* indices )
+	{
+		std::map< Vertex, int > vertexIndex;
+		for( unsigned int v = 0; v < facets.size(); ++v )
+		{
+			Vertex vertex( facets[v].x + 0.0f, facets[v].y + 0.0f, facets[v].z + 0.0f );
+			std::map< Vertex, int >::const_iterator found = vertexIndex.find( vertex );
+			if( found == vertexIndex.end() )
+			{
+				found = vertexIndex.insert( std::make_pair( vertex, int( vertices->size() ) ) ).first;
+				vertices->push_back( vertex );
+			}
+			indices->push_back( found->second );
+		}
+	}
+
+	void AppendLittleEndian( quint32 value, QByteArray* data )
+	{
+		for( int b = 0; b < 4; ++b )
+			data->append( char( ( value >> ( 8 * b ) ) & 0xff ) );
+	}
+
+	void AppendFloat( float value, QByteArray* data )
+	{
+		quint32 bits;
+		memcpy( &bits, &value, 4 );
+		AppendLittleEndian( bits, data );
+	}
+
+	QByteArray BinarySTL( const std::vector< Vertex >& facets, const char* header = "binary" )
+	{
+		QByteArray data( 80, ' ' );
+		data.replace( 0, int( strlen( header ) ), header );
+		AppendLittleEndian( quint32( facets.size() / 3 ), &data );
+		for( unsigned int f = 0; f < facets.size(); f += 3 )
+		{
+			//The reader does not use the normal
+			AppendFloat( 0.0f, &data );
+			AppendFloat( 0.0f, &data );
+			AppendFloat( 1.0f, &data );
+			for( int v = 0; v < 3; ++v )
+			{
+				AppendFloat( facets[f + v].x, &data );
+				AppendFloat( facets[f + v].y, &data );
+				AppendFloat( facets[f + v].z, &data );
+			}
+			data.append( QByteArray( 2, '\0' ) );
+		}
+		return ( data );
+	}
+
+	QByteArray ASCIISTL( const std::vector< Vertex >& facets )
+	{
+		QByteArray data( "solid test\n" );
+		char line[128];
+		for( unsigned int f = 0; f < facets.size(); f += 3 )
+		{
+			data.append( "  facet normal 0 0 1\n    outer loop\n" );
+			for( int v = 0; v < 3; ++v )
+			{
+				//Mixes plain and exponent notation
+				const char* format = ( v == 1 ) ? "      vertex %e %e %e\n" : "      vertex %g %g %g\r\n";
+				sprintf( line, format, facets[f + v].x, facets[f + v].y, facets[f + v].z );
+				data.append( line );
+			}
+			data.append( "    endloop\n  endfacet\n" );
+		}
+		data.append( "endsolid test\n" );
+		return ( data );
+	}
+
+	void ExpectMesh( const STLReader& reader, const std::vector< Vertex >& facets )
+	{
+		std::vector< Vertex > expectedVertices;
+		std::vector< int > expectedIndices;
+		ExpectedMesh( facets, &expectedVertices, &expectedIndices );
+
+		const std::vector< Point3D >& vertices = reader.GetVertices();
+		ASSERT_EQ( expectedVertices.size(), vertices.size() );
+		for( unsigned int v = 0; v < vertices.size(); ++v )
+		{
+			EXPECT_EQ( expectedVertices[v].x, vertices[v].x );
+			EXPECT_EQ( expectedVertices[v].y, vertices[v].y );
+			EXPECT_EQ( expectedVertices[v].z, vertices[v].z );
+		}
+		EXPECT_EQ( expectedIndices, reader.GetIndices() );
+	}
+}
+
+class STLReaderTest : public ::testing::Test
+{
+protected:
+	virtual void TearDown()
+	{
+		for( int f = 0; f < int( m_files.size() ); ++f )
+			QFile::remove( m_files[f] );
+	}
+
+	QString WriteFile( const QByteArray& data )
+	{
+		QString fileName = QDir::temp().filePath( QString( "STLReaderTest%1.stl" ).arg( int( m_files.size() ) ) );
+		QFile file( fileName );
+		if( !file.open( QIODevice::WriteOnly ) )	return ( QString() );
+		file.write( data );
+		file.close();
+
+		m_files.push_back( fileName );
+		return ( fileName );
+	}
+
+	std::vector< QString > m_files;
+};
+
+TEST_F( STLReaderTest, ReadsBinaryFile )
+{
+	std::vector< Vertex > facets = HeightFieldFacets( 4 );
+
+	STLReader reader;
+	ASSERT_TRUE( reader.Read( WriteFile( BinarySTL( facets ) ) ) ) << reader.GetError().toStdString();
+	ExpectMesh( reader, facets );
+	EXPECT_EQ( 25u, reader.GetVertices().size() );
+}
+
+TEST_F( STLReaderTest, ReadsASCIIFile )
+{
+	std::vector< Vertex > facets = HeightFieldFacets( 4 );
+
+	STLReader reader;
+	ASSERT_TRUE( reader.Read( WriteFile( ASCIISTL( facets ) ) ) ) << reader.GetError().toStdString();
+	ExpectMesh( reader, facets );
+}
+
+TEST_F( STLReaderTest, ReadsLargeASCIIFileInChunks )
+{
+	//Larger than the chunk size, so the facets are read in parallel
+	std::vector< Vertex > facets = HeightFieldFacets( 80 );
+	QByteArray data = ASCIISTL( facets );
+	ASSERT_GT( data.size(), 1 << 20 );
+
+	STLReader asciiReader;
+	ASSERT_TRUE( asciiReader.Read( WriteFile( data ) ) ) << asciiReader.GetError().toStdString();
+	ExpectMesh( asciiReader, facets );
+
+	STLReader binaryReader;
+	ASSERT_TRUE( binaryReader.Read( WriteFile( BinarySTL( facets ) ) ) );
+	EXPECT_EQ( binaryReader.GetIndices(), asciiReader.GetIndices() );
+}
+
+TEST_F( STLReaderTest, MergesNegativeZero )
+{
+	std::vector< Vertex > facets;
+	facets.push_back( Vertex( 0.0f, 0.0f, 0.0f ) );
+	facets.push_back( Vertex( 1.0f, 0.0f, 0.0f ) );
+	facets.push_back( Vertex( 0.0f, 1.0f, 0.0f ) );
+	facets.push_back( Vertex( -0.0f, -0.0f, -0.0f ) );
+	facets.push_back( Vertex( 0.0f, 1.0f, -0.0f ) );
+	facets.push_back( Vertex( -1.0f, 0.0f, 0.0f ) );
+
+	STLReader reader;
+	ASSERT_TRUE( reader.Read( WriteFile( BinarySTL( facets ) ) ) );
+	EXPECT_EQ( 4u, reader.GetVertices().size() );
+
+	const int expectedIndices[] = { 0, 1, 2, 0, 2, 3 };
+	EXPECT_EQ( std::vector< int >( expectedIndices, expectedIndices + 6 ), reader.GetIndices() );
+}
+
+TEST_F( STLReaderTest, BinaryHeaderMayStartWithSolid )
+{
+	std::vector< Vertex > facets = HeightFieldFacets( 2 );
+
+	STLReader reader;
+	ASSERT_TRUE( reader.Read( WriteFile( BinarySTL( facets, "solid exported as binary" ) ) ) );
+	ExpectMesh( reader, facets );
+}
+
+TEST_F( STLReaderTest, TruncatedBinaryFileFails )
+{
+	QByteArray data = BinarySTL( HeightFieldFacets( 3 ) );
+	data.chop( 10 );
+
+	STLReader reader;
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+	EXPECT_FALSE( reader.GetError().isEmpty() );
+	EXPECT_TRUE( reader.GetVertices().empty() );
+	EXPECT_TRUE( reader.GetIndices().empty() );
+
+	//A truncated binary file whose header starts with "solid" is not a valid ASCII file either
+	data = BinarySTL( HeightFieldFacets( 3 ), "solid" );
+	data.chop( 10 );
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+	EXPECT_TRUE( reader.GetIndices().empty() );
+}
+
+TEST_F( STLReaderTest, BinaryFileWithoutFacetsFails )
+{
+	STLReader reader;
+	EXPECT_FALSE( reader.Read( WriteFile( BinarySTL( std::vector< Vertex >() ) ) ) );
+	EXPECT_EQ( QString( "The file has no facets." ), reader.GetError() );
+}
+
+TEST_F( STLReaderTest, MalformedASCIIFileFails )
+{
+	QByteArray valid = ASCIISTL( HeightFieldFacets( 2 ) );
+	STLReader reader;
+
+	//A coordinate that is not a number
+	QByteArray data = valid;
+	data.replace( "vertex 0.25", "vertex 0.2x" );
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+	EXPECT_TRUE( reader.GetIndices().empty() );
+
+	//An exponent without digits
+	data = valid;
+	data.replace( "vertex 0.25", "vertex 0.25e+" );
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+
+	//A vertex with two coordinates
+	data = "solid test\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nvertex 0 1\nendloop\nendfacet\nendsolid test\n";
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+
+	//A facet with two vertices
+	data = "solid test\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nendloop\nendfacet\nendsolid test\n";
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+	EXPECT_TRUE( reader.GetVertices().empty() );
+
+	//Valid facets followed by a truncated one
+	data = valid;
+	data.chop( 60 );
+	EXPECT_FALSE( reader.Read( WriteFile( data ) ) );
+}
+
+TEST_F( STLReaderTest, ASCIIFileWithoutFacetsFails )
+{
+	STLReader reader;
+	EXPECT_FALSE( reader.Read( WriteFile( "solid empty\nendsolid empty\n" ) ) );
+	EXPECT_EQ( QString( "The file has no facets." ), reader.GetError() );
+}
+
+TEST_F( STLReaderTest, InvalidFilesFail )
+{
+	STLReader reader;
+	EXPECT_FALSE( reader.Read( WriteFile( "soli" ) ) );
+	EXPECT_FALSE( reader.GetError().isEmpty() );
+
+	EXPECT_FALSE( reader.Read( WriteFile( "This is not a stereolithography file.\n" ) ) );
+	EXPECT_FALSE( reader.GetError().isEmpty() );
+
+	EXPECT_FALSE( reader.Read( QDir::temp().filePath( "STLReaderTestMissingFile.stl" ) ) );
+	EXPECT_FALSE( reader.GetError().isEmpty() );
+}
+
+TEST_F( STLReaderTest, ReadingAgainReplacesTheMesh )
+{
+	STLReader reader;
+	ASSERT_TRUE( reader.Read( WriteFile( BinarySTL( HeightFieldFacets( 4 ) ) ) ) );
+
+	std::vector< Vertex > facets = HeightFieldFacets( 1 );
+	ASSERT_TRUE( reader.Read( WriteFile( ASCIISTL( facets ) ) ) );
+	ExpectMesh( reader, facets );
+	EXPECT_TRUE( reader.GetError().isEmpty() );
+}
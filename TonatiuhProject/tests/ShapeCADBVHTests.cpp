@@ -0,0 +1,230 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BVH.h"
+#include "DifferentialGeometry.h"
+#include "Ray.h"
+#include "TriangleMesh.h"
+
+namespace
+{
+	double RandomValue( double minValue, double maxValue )
+	{
+		return minValue + ( maxValue - minValue ) * rand() / RAND_MAX;
+	}
+
+	//Adds to each mesh a height field over [0, size] x [0, size] with two triangles per unit cell
+	void AddHeightField( int size, TriangleMesh* mesh, TriangleMesh* reference )
+	{
+		for( int i = 0; i < size; ++i )
+		{
+			for( int j = 0; j < size; ++j )
+			{
+				Point3D p00( i, j, std::sin( 0.7 * i ) * std::cos( 0.3 * j ) );
+				Point3D p10( i + 1, j, std::sin( 0.7 * ( i + 1 ) ) * std::cos( 0.3 * j ) );
+				Point3D p01( i, j + 1, std::sin( 0.7 * i ) * std::cos( 0.3 * ( j + 1 ) ) );
+				Point3D p11( i + 1, j + 1, std::sin( 0.7 * ( i + 1 ) ) * std::cos( 0.3 * ( j + 1 ) ) );
+
+				mesh->AddTriangle( p00, p10, p11 );
+				mesh->AddTriangle( p00, p11, p01 );
+				reference->AddTriangle( p00, p10, p11 );
+				reference->AddTriangle( p00, p11, p01 );
+			}
+		}
+	}
+
+	//Adds the same random triangles to each mesh
+	void AddRandomTriangles( int nTriangles, TriangleMesh* mesh, TriangleMesh* reference )
+	{
+		for( int t = 0; t < nTriangles; ++t )
+		{
+			Point3D v1( RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ) );
+			Point3D v2 = v1 + Vector3D( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) );
+			Point3D v3 = v1 + Vector3D( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) );
+			mesh->AddTriangle( v1, v2, v3 );
+			reference->AddTriangle( v1, v2, v3 );
+		}
+	}
+
+	//Nearest intersection testing every triangle of the mesh one by one
+	bool BruteForceIntersect( const TriangleMesh& mesh, const Ray& objectRay, double* tHit, DifferentialGeometry* dg )
+	{
+		double u = 0.0;
+		double v = 0.0;
+		int hitTriangle = -1;
+		for( int t = 0; t < mesh.GetNumberOfTriangles(); ++t )
+			if( mesh.IntersectTriangles( t, 1, objectRay, tHit, &u, &v ) >= 0 )	hitTriangle = t;
+
+		if( hitTriangle < 0 )	return false;
+		mesh.GetDifferentialGeometry( hitTriangle, objectRay, *tHit, u, v, dg );
+		return true;
+	}
+
+	void ExpectSameIntersection( const BVH& bvh, const TriangleMesh& reference, const Ray& objectRay )
+	{
+		double bvhTHit = objectRay.maxt;
+		DifferentialGeometry bvhDg;
+		bool isBVHHit = bvh.Intersect( objectRay, &bvhTHit, &bvhDg );
+
+		double referenceTHit = objectRay.maxt;
+		DifferentialGeometry referenceDg;
+		bool isReferenceHit = BruteForceIntersect( reference, objectRay, &referenceTHit, &referenceDg );
+
+		ASSERT_EQ( isReferenceHit, isBVHHit );
+		EXPECT_EQ( isReferenceHit, bvh.IntersectP( objectRay ) );
+		if( !isReferenceHit )	return;
+
+		//Triangles sharing the intersected edge give the same distance, so only the hit point is compared
+		EXPECT_DOUBLE_EQ( referenceTHit, bvhTHit );
+		EXPECT_NEAR( referenceDg.point.x, bvhDg.point.x, 1.0e-12 );
+		EXPECT_NEAR( referenceDg.point.y, bvhDg.point.y, 1.0e-12 );
+		EXPECT_NEAR( referenceDg.point.z, bvhDg.point.z, 1.0e-12 );
+	}
+}
+
+TEST( ShapeCADBVHTests, RandomRaysMatchBruteForce )
+{
+	srand( 11 );
+
+	for( int leafSize = 1; leafSize <= 8; leafSize *= 2 )
+	{
+		TriangleMesh mesh;
+		TriangleMesh reference;
+		AddRandomTriangles( 2000, &mesh, &reference );
+		BVH bvh( &mesh, leafSize );
+		ASSERT_GT( bvh.GetNumberOfNodes(), 1 );
+
+		int nHits = 0;
+		for( int r = 0; r < 2000; ++r )
+		{
+			Point3D origin( RandomValue( -15.0, 15.0 ), RandomValue( -15.0, 15.0 ), RandomValue( -15.0, 15.0 ) );
+			Point3D target( RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ), RandomValue( -10.0, 10.0 ) );
+			Ray objectRay( origin, Normalize( target - origin ) );
+			ExpectSameIntersection( bvh, reference, objectRay );
+
+			double tHit = objectRay.maxt;
+			DifferentialGeometry dg;
+			if( bvh.Intersect( objectRay, &tHit, &dg ) )	++nHits;
+		}
+		EXPECT_GT( nHits, 200 );
+	}
+}
+
+TEST( ShapeCADBVHTests, IntersectionBeyondTHitIsIgnored )
+{
+	srand( 13 );
+
+	TriangleMesh mesh;
+	TriangleMesh reference;
+	AddRandomTriangles( 500, &mesh, &reference );
+	BVH bvh( &mesh );
+
+	for( int r = 0; r < 1000; ++r )
+	{
+		Point3D origin( RandomValue( -15.0, 15.0 ), RandomValue( -15.0, 15.0 ), -20.0 );
+		Ray objectRay( origin, Normalize( Vector3D( RandomValue( -0.5, 0.5 ), RandomValue( -0.5, 0.5 ), 1.0 ) ) );
+		objectRay.maxt = RandomValue( 5.0, 30.0 );
+		ExpectSameIntersection( bvh, reference, objectRay );
+	}
+}
+
+TEST( ShapeCADBVHTests, GrazingRaysHitSharedEdges )
+{
+	const int size = 16;
+	TriangleMesh mesh;
+	TriangleMesh reference;
+	AddHeightField( size, &mesh, &reference );
+	BVH bvh( &mesh, 4 );
+
+	//Vertical rays through the grid vertices, the cell edges and the cell diagonals, including the field border.
+	//They are parallel to the node faces and many of them start on a face plane.
+	for( int i = 0; i <= 2 * size; ++i )
+	{
+		for( int j = 0; j <= 2 * size; ++j )
+		{
+			Ray objectRay( Point3D( 0.5 * i, 0.5 * j, 5.0 ), Vector3D( 0.0, 0.0, -1.0 ) );
+			ExpectSameIntersection( bvh, reference, objectRay );
+
+			//The field has no holes, so the rays that go through the shared edges and vertices must hit it
+			double tHit = objectRay.maxt;
+			DifferentialGeometry dg;
+			EXPECT_TRUE( bvh.Intersect( objectRay, &tHit, &dg ) ) << "x = " << 0.5 * i << ", y = " << 0.5 * j;
+		}
+	}
+
+	//Slanted rays in the planes of the grid lines
+	srand( 17 );
+	for( int r = 0; r < 2000; ++r )
+	{
+		int line = rand() % ( size + 1 );
+		Vector3D direction = Normalize( Vector3D( 0.0, RandomValue( -1.0, 1.0 ), -1.0 ) );
+		Ray xLineRay( Point3D( line, RandomValue( 0.0, size ), 5.0 ), direction );
+		ExpectSameIntersection( bvh, reference, xLineRay );
+
+		direction = Normalize( Vector3D( RandomValue( -1.0, 1.0 ), 0.0, -1.0 ) );
+		Ray yLineRay( Point3D( RandomValue( 0.0, size ), line, 5.0 ), direction );
+		ExpectSameIntersection( bvh, reference, yLineRay );
+	}
+
+	//Rays along the border of the field, in the plane of the root node faces
+	for( int j = 0; j <= size; ++j )
+	{
+		ExpectSameIntersection( bvh, reference, Ray( Point3D( -1.0, j, 0.0 ), Vector3D( 1.0, 0.0, 0.0 ) ) );
+		ExpectSameIntersection( bvh, reference, Ray( Point3D( size, -1.0, std::sin( 0.7 * size ) ), Vector3D( 0.0, 1.0, 0.0 ) ) );
+	}
+}
+
+TEST( ShapeCADBVHTests, EmptyMeshHasNoIntersections )
+{
+	TriangleMesh mesh;
+	BVH bvh( &mesh );
+	EXPECT_EQ( 0, bvh.GetNumberOfNodes() );
+
+	Ray objectRay( Point3D( 0.0, 0.0, 5.0 ), Vector3D( 0.0, 0.0, -1.0 ) );
+	double tHit = objectRay.maxt;
+	DifferentialGeometry dg;
+	EXPECT_FALSE( bvh.Intersect( objectRay, &tHit, &dg ) );
+	EXPECT_FALSE( bvh.IntersectP( objectRay ) );
+}
@@ -0,0 +1,325 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "Photon.h"
+#include "PhotonMapExport.h"
+#include "TPhotonMap.h"
+
+class SavedPhotonsExport : public PhotonMapExport
+{
+public:
+	void EndExport(){}
+	void SavePhotonMap( const std::vector< Photon >& raysLists )
+	{
+		bufferSizes.push_back( raysLists.size() );
+		for( unsigned int p = 0; p < raysLists.size(); ++p )
+		{
+			savedPositions.push_back( raysLists[p].pos.x );
+			savedIds.push_back( raysLists[p].id );
+		}
+	}
+	void SetPowerPerPhoton( double /*wPhoton*/ ){}
+	void SetSaveParameterValue( QString /*parameterName*/, QString /*parameterValue*/ ){}
+	bool StartExport(){ return true; }
+
+	std::vector< unsigned long > bufferSizes;
+	std::vector< double > savedPositions;
+	std::vector< double > savedIds;
+};
+
+class StoreRaysThread : public QThread
+{
+public:
+	StoreRaysThread( TPhotonMap* photonMap, int thread )
+	:QThread( 0 ), m_pPhotonMap( photonMap ), m_thread( thread )
+	{
+	}
+
+protected:
+	void run()
+	{
+		std::vector< Photon > raysList;
+		for( int r = 0; r < 200; ++r )
+		{
+			for( int i = 0; i < 10; ++i )
+				raysList.push_back( Photon( Point3D( 1000 * m_thread + r, 0.0, 0.0 ), 1, i ) );
+			m_pPhotonMap->StoreRays( raysList );
+		}
+	}
+
+private:
+	TPhotonMap* m_pPhotonMap;
+	int m_thread;
+};
+
+//Export that holds each SavePhotonMap call until the test releases it
+class BlockingExport : public SavedPhotonsExport
+{
+public:
+	BlockingExport() : m_isReleased( false ), m_savingCalls( 0 ) {}
+
+	void SavePhotonMap( const std::vector< Photon >& raysLists )
+	{
+		QMutexLocker locker( &m_mutex );
+		++m_savingCalls;
+		m_saving.wakeAll();
+		while( !m_isReleased )
+			m_released.wait( &m_mutex );
+		SavedPhotonsExport::SavePhotonMap( raysLists );
+	}
+
+	void Release()
+	{
+		QMutexLocker locker( &m_mutex );
+		m_isReleased = true;
+		m_released.wakeAll();
+	}
+
+	void WaitForSaving()
+	{
+		QMutexLocker locker( &m_mutex );
+		while( m_savingCalls < 1 )
+			m_saving.wait( &m_mutex );
+	}
+
+private:
+	QMutex m_mutex;
+	QWaitCondition m_saving;
+	QWaitCondition m_released;
+	bool m_isReleased;
+	int m_savingCalls;
+};
+
+class StoreRaysListThread : public QThread
+{
+public:
+	StoreRaysListThread( TPhotonMap* photonMap, std::vector< Photon >* raysList )
+	:QThread( 0 ), m_pPhotonMap( photonMap ), m_pRaysList( raysList )
+	{
+	}
+
+protected:
+	void run()
+	{
+		m_pPhotonMap->StoreRays( *m_pRaysList );
+	}
+
+private:
+	TPhotonMap* m_pPhotonMap;
+	std::vector< Photon >* m_pRaysList;
+};
+
+TEST( TPhotonMapTests, StoreRaysKeepsPhotonsInOrder )
+{
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 100 );
+
+	std::vector< Photon > raysList;
+	for( int i = 0; i < 10; ++i )
+		raysList.push_back( Photon( Point3D( i, 2.0 * i, 3.0 * i ), 1, i ) );
+
+	photonMap.StoreRays( raysList );
+	photonMap.StoreRays( raysList );
+
+	const std::vector< Photon >& storedPhotons = photonMap.GetAllPhotons();
+	ASSERT_EQ( storedPhotons.size(), 20u );
+	for( unsigned int p = 0; p < storedPhotons.size(); ++p )
+	{
+		EXPECT_DOUBLE_EQ( storedPhotons[p].id, p % 10 );
+		EXPECT_DOUBLE_EQ( storedPhotons[p].pos.x, p % 10 );
+		EXPECT_DOUBLE_EQ( storedPhotons[p].pos.y, 2.0 * ( p % 10 ) );
+		EXPECT_DOUBLE_EQ( storedPhotons[p].pos.z, 3.0 * ( p % 10 ) );
+	}
+}
+
+TEST( TPhotonMapTests, StoreRaysEmptiesFullBuffer )
+{
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 15 );
+
+	std::vector< Photon > firstRaysList( 10, Photon( Point3D( 1.0, 1.0, 1.0 ), 1, 0 ) );
+	std::vector< Photon > secondRaysList( 10, Photon( Point3D( 2.0, 2.0, 2.0 ), 1, 0 ) );
+
+	photonMap.StoreRays( firstRaysList );
+	const Photon* bufferData = &photonMap.GetAllPhotons()[0];
+	photonMap.StoreRays( secondRaysList );
+
+	const std::vector< Photon >& storedPhotons = photonMap.GetAllPhotons();
+	ASSERT_EQ( storedPhotons.size(), 10u );
+	EXPECT_DOUBLE_EQ( storedPhotons[0].pos.x, 2.0 );
+	EXPECT_DOUBLE_EQ( storedPhotons[9].pos.x, 2.0 );
+
+	//The buffer memory is reused after saving the photons.
+	EXPECT_EQ( &storedPhotons[0], bufferData );
+}
+
+TEST( TPhotonMapTests, StoreRaysWithWriterThread )
+{
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 1000 );
+	photonMap.StartStore();
+
+	for( int r = 0; r < 50; ++r )
+	{
+		std::vector< Photon > raysList;
+		for( int i = 0; i < 10; ++i )
+			raysList.push_back( Photon( Point3D( r, i, 0.0 ), 1, i ) );
+		photonMap.StoreRays( raysList );
+		EXPECT_TRUE( raysList.empty() );
+	}
+
+	photonMap.FinishStore();
+
+	const std::vector< Photon >& storedPhotons = photonMap.GetAllPhotons();
+	ASSERT_EQ( storedPhotons.size(), 500u );
+	for( unsigned int p = 0; p < storedPhotons.size(); ++p )
+	{
+		EXPECT_DOUBLE_EQ( storedPhotons[p].pos.x, p / 10 );
+		EXPECT_DOUBLE_EQ( storedPhotons[p].id, p % 10 );
+	}
+}
+
+TEST( TPhotonMapTests, WriterThreadSavesRotatingBuffersInOrder )
+{
+	SavedPhotonsExport exportMode;
+
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 100 );
+	photonMap.SetNumberOfBuffers( 3 );
+	photonMap.SetExportMode( &exportMode );
+	photonMap.StartStore();
+
+	for( int r = 0; r < 50; ++r )
+	{
+		std::vector< Photon > raysList;
+		for( int i = 0; i < 30; ++i )
+			raysList.push_back( Photon( Point3D( 30 * r + i, 0.0, 0.0 ), 1, i ) );
+		photonMap.StoreRays( raysList );
+	}
+
+	photonMap.EndStore( 1.0 );
+
+	ASSERT_EQ( exportMode.savedPositions.size(), 1500u );
+	for( unsigned int p = 0; p < exportMode.savedPositions.size(); ++p )
+		EXPECT_DOUBLE_EQ( exportMode.savedPositions[p], p );
+
+	for( unsigned int b = 0; b < exportMode.bufferSizes.size(); ++b )
+		EXPECT_LE( exportMode.bufferSizes[b], 100u );
+}
+
+TEST( TPhotonMapTests, WriterThreadKeepsEachThreadRaysListTogether )
+{
+	SavedPhotonsExport exportMode;
+
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 50 );
+	photonMap.SetExportMode( &exportMode );
+	photonMap.StartStore();
+
+	StoreRaysThread* threads[4];
+	for( int t = 0; t < 4; ++t )
+	{
+		threads[t] = new StoreRaysThread( &photonMap, t );
+		threads[t]->start();
+	}
+	for( int t = 0; t < 4; ++t )
+	{
+		threads[t]->wait();
+		delete threads[t];
+	}
+
+	photonMap.EndStore( 1.0 );
+
+	ASSERT_EQ( exportMode.savedPositions.size(), 8000u );
+	for( unsigned int p = 0; p < exportMode.savedPositions.size(); ++p )
+	{
+		EXPECT_DOUBLE_EQ( exportMode.savedIds[p], p % 10 );
+		EXPECT_DOUBLE_EQ( exportMode.savedPositions[p], exportMode.savedPositions[p - p % 10] );
+	}
+
+	for( unsigned int b = 0; b < exportMode.bufferSizes.size(); ++b )
+		EXPECT_LE( exportMode.bufferSizes[b], 50u );
+}
+
+TEST( TPhotonMapTests, WriterThreadSavesOneBufferWhileAnotherFills )
+{
+	BlockingExport exportMode;
+
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 10 );
+	photonMap.SetNumberOfBuffers( 2 );
+	photonMap.SetExportMode( &exportMode );
+	photonMap.StartStore();
+
+	std::vector< Photon > raysLists[3];
+	for( int r = 0; r < 3; ++r )
+		for( int i = 0; i < 10; ++i )
+			raysLists[r].push_back( Photon( Point3D( 10 * r + i, 0.0, 0.0 ), 1, i ) );
+
+	//The first buffer is saved while the second one takes the photons
+	photonMap.StoreRays( raysLists[0] );
+	photonMap.StoreRays( raysLists[1] );
+	exportMode.WaitForSaving();
+
+	//Both buffers are in use, so the next photons wait until the first buffer is saved
+	StoreRaysListThread storeThread( &photonMap, &raysLists[2] );
+	storeThread.start();
+	EXPECT_FALSE( storeThread.wait( 100 ) );
+	EXPECT_TRUE( exportMode.savedPositions.empty() );
+
+	exportMode.Release();
+	storeThread.wait();
+	photonMap.EndStore( 1.0 );
+
+	ASSERT_EQ( exportMode.savedPositions.size(), 30u );
+	for( unsigned int p = 0; p < exportMode.savedPositions.size(); ++p )
+		EXPECT_DOUBLE_EQ( exportMode.savedPositions[p], p );
+
+	ASSERT_EQ( exportMode.bufferSizes.size(), 3u );
+	for( unsigned int b = 0; b < exportMode.bufferSizes.size(); ++b )
+		EXPECT_EQ( exportMode.bufferSizes[b], 10u );
+}
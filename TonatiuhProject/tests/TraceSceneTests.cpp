@@ -0,0 +1,395 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Inventor/nodekits/SoNodeKitListPart.h>
+#include <Inventor/nodes/SoTransform.h>
+
+#include "DifferentialGeometry.h"
+#include "gc.h"
+#include "InstanceNode.h"
+#include "Matrix4x4.h"
+#include "MaterialStandardSpecular.h"
+#include "RandomDeviate.h"
+#include "Ray.h"
+#include "ShapeFlatDisk.h"
+#include "ShapeFlatRectangle.h"
+#include "ShapeParabolicRectangle.h"
+#include "TMaterial.h"
+#include "TraceScene.h"
+#include "trf.h"
+#include "TSeparatorKit.h"
+#include "TShape.h"
+#include "TShapeKit.h"
+
+namespace
+{
+	//Fills the numbers array with a fixed sequence, so two generators created alike give the same numbers.
+	class SequenceRandomDeviate : public RandomDeviate
+	{
+	public:
+		SequenceRandomDeviate() : RandomDeviate( 1000 ), m_state( 1 ) {}
+		void FillArray( double* array, const unsigned long arraySize )
+		{
+			for( unsigned long i = 0; i < arraySize; ++i )
+			{
+				m_state = ( 1103515245UL * m_state + 12345UL ) % 2147483648UL;
+				array[i] = m_state / 2147483648.0;
+			}
+		}
+
+	private:
+		unsigned long m_state;
+	};
+
+	//Reference intersection that visits the whole instance tree recursively, testing each child whose box the ray meets
+	bool InstanceTreeIntersect( InstanceNode* instanceNode, const Ray& ray, RandomDeviate& rand, bool* isShapeFront,
+			InstanceNode** modelNode, Ray* outputRay )
+	{
+		if( !instanceNode->GetIntersectionBBox().IntersectP( ray ) )	return false;
+
+		if( !instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+		{
+			bool isOutputRay = false;
+			for( int index = 0; index < instanceNode->children.size(); ++index )
+			{
+				double tBefore = ray.maxt;
+				bool childFront = true;
+				InstanceNode* childSurface = 0;
+				Ray childOutputRay;
+				bool isChildOutputRay = InstanceTreeIntersect( instanceNode->children[index], ray, rand, &childFront, &childSurface, &childOutputRay );
+				if( ray.maxt < tBefore )
+				{
+					*modelNode = childSurface;
+					*isShapeFront = childFront;
+					*outputRay = childOutputRay;
+					isOutputRay = isChildOutputRay;
+				}
+			}
+			return isOutputRay;
+		}
+
+		TShape* shape = 0;
+		TMaterial* material = 0;
+		for( int index = 0; index < instanceNode->children.size(); ++index )
+		{
+			SoNode* node = instanceNode->children[index]->GetNode();
+			if( node->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )	shape = static_cast< TShape* >( node );
+			else	material = static_cast< TMaterial* >( node );
+		}
+		if( !shape )	return false;
+
+		Transform worldToObject = instanceNode->GetIntersectionTransform();
+		Ray objectRay( worldToObject( ray ) );
+		double tHit = 0.0;
+		DifferentialGeometry dg;
+		if( !shape->Intersect( objectRay, &tHit, &dg ) )	return false;
+
+		ray.maxt = tHit;
+		*modelNode = instanceNode;
+		*isShapeFront = dg.shapeFrontSide;
+
+		Ray surfaceOutputRay;
+		if( !material || !material->OutputRay( objectRay, &dg, rand, &surfaceOutputRay ) )	return false;
+		*outputRay = worldToObject.GetInverse()( surfaceOutputRay );
+		return true;
+	}
+
+	//Builds a small heliostat field: a flat receiver disk and two heliostats with flat and parabolic facets.
+	class TraceSceneTests : public ::testing::Test
+	{
+	protected:
+		void SetUp()
+		{
+			m_rootKit = new TSeparatorKit;
+			m_rootKit->ref();
+			m_root = new InstanceNode( m_rootKit );
+
+			MaterialStandardSpecular* mirror = new MaterialStandardSpecular;
+			mirror->m_reflectivity.setValue( 1.0 );
+			mirror->m_sigmaSlope.setValue( 0.0 );
+
+			ShapeFlatDisk* disk = new ShapeFlatDisk;
+			disk->radius.setValue( 2.0 );
+			InstanceNode* tower = AddSeparator( m_root, SbVec3f( 0.0, 20.0, 0.0 ), SbRotation( SbVec3f( 1.0, 0.0, 0.0 ), 1.2 ) );
+			AddSurface( tower, disk, 0 );
+
+			//The facets of both heliostats share the shape nodes, so the flat facets form one instanced group
+			ShapeFlatRectangle* flatFacet = new ShapeFlatRectangle;
+			flatFacet->width.setValue( 2.0 );
+			flatFacet->height.setValue( 1.5 );
+			ShapeParabolicRectangle* parabolicFacet = new ShapeParabolicRectangle;
+			parabolicFacet->focusLength.setValue( 15.0 );
+			parabolicFacet->widthX.setValue( 2.0 );
+			parabolicFacet->widthZ.setValue( 1.5 );
+
+			for( int h = 0; h < 2; ++h )
+			{
+				m_heliostats[h] = AddSeparator( m_root, SbVec3f( -6.0 + 12.0 * h, 2.0, 10.0 ), SbRotation( SbVec3f( 1.0, 0.0, 0.0 ), 0.3 ) );
+				for( int f = 0; f < 3; ++f )
+				{
+					InstanceNode* facet = AddSeparator( m_heliostats[h], SbVec3f( -2.1 + 2.1 * f, 0.05 * f, 0.0 ), SbRotation( SbVec3f( 0.0, 0.0, 1.0 ), 0.02 * ( f - 1 ) ) );
+					AddSurface( facet, flatFacet, mirror );
+				}
+				InstanceNode* topFacet = AddSeparator( m_heliostats[h], SbVec3f( 0.0, 0.1, -1.6 ), SbRotation() );
+				AddSurface( topFacet, parabolicFacet, mirror );
+			}
+
+			trf::ComputeSceneTreeMap( m_root, Transform( new Matrix4x4 ), true );
+		}
+
+		void TearDown()
+		{
+			delete m_root;
+			m_rootKit->unref();
+		}
+
+		InstanceNode* AddSeparator( InstanceNode* parent, const SbVec3f& translation, const SbRotation& rotation )
+		{
+			TSeparatorKit* separatorKit = new TSeparatorKit;
+			SoTransform* nodeTransform = static_cast< SoTransform* >( separatorKit->getPart( "transform", true ) );
+			nodeTransform->translation.setValue( translation );
+			nodeTransform->rotation.setValue( rotation );
+
+			static_cast< SoNodeKitListPart* >( static_cast< SoBaseKit* >( parent->GetNode() )->getPart( "childList", true ) )->addChild( separatorKit );
+			InstanceNode* separatorInstance = new InstanceNode( separatorKit );
+			parent->AddChild( separatorInstance );
+			return separatorInstance;
+		}
+
+		InstanceNode* AddSurface( InstanceNode* parent, TShape* shape, TMaterial* material )
+		{
+			TShapeKit* surfaceKit = new TShapeKit;
+			surfaceKit->setPart( "shape", shape );
+			if( material )	surfaceKit->setPart( "appearance.material", material );
+
+			static_cast< SoNodeKitListPart* >( static_cast< SoBaseKit* >( parent->GetNode() )->getPart( "childList", true ) )->addChild( surfaceKit );
+			InstanceNode* surfaceInstance = new InstanceNode( surfaceKit );
+			parent->AddChild( surfaceInstance );
+			surfaceInstance->AddChild( new InstanceNode( shape ) );
+			if( material )	surfaceInstance->AddChild( new InstanceNode( material ) );
+			m_surfaces.push_back( surfaceInstance );
+			return surfaceInstance;
+		}
+
+		//Rays from above the field towards random points of the surface bounding boxes
+		Ray RandomRay() const
+		{
+			BBox surfaceBBox = m_surfaces[rand() % m_surfaces.size()]->GetIntersectionBBox();
+			Point3D target( surfaceBBox.pMin.x + ( surfaceBBox.pMax.x - surfaceBBox.pMin.x ) * rand() / RAND_MAX,
+					surfaceBBox.pMin.y + ( surfaceBBox.pMax.y - surfaceBBox.pMin.y ) * rand() / RAND_MAX,
+					surfaceBBox.pMin.z + ( surfaceBBox.pMax.z - surfaceBBox.pMin.z ) * rand() / RAND_MAX );
+			Point3D origin( 30.0 * rand() / RAND_MAX - 15.0, 40.0, 30.0 * rand() / RAND_MAX - 15.0 );
+			return Ray( origin, Normalize( target - origin ) );
+		}
+
+		//Traces the same rays through the scene tree and \a traceScene and compares the results.
+		void ExpectSameIntersections( const TraceScene& traceScene, int nRays )
+		{
+			SequenceRandomDeviate treeRand;
+			SequenceRandomDeviate sceneRand;
+
+			int nHits = 0;
+			for( int r = 0; r < nRays; ++r )
+			{
+				Ray treeRay = RandomRay();
+				Ray sceneRay = treeRay;
+				Ray occlusionRay = treeRay;
+
+				bool treeFront = false;
+				InstanceNode* treeSurface = 0;
+				Ray treeOutputRay;
+				bool isTreeOutput = InstanceTreeIntersect( m_root, treeRay, treeRand, &treeFront, &treeSurface, &treeOutputRay );
+
+				bool sceneFront = false;
+				InstanceNode* sceneSurface = 0;
+				Ray sceneOutputRay;
+				bool isSceneOutput = traceScene.Intersect( sceneRay, sceneRand, &sceneFront, &sceneSurface, &sceneOutputRay );
+
+				ASSERT_EQ( treeSurface, sceneSurface );
+				EXPECT_EQ( treeSurface != 0, traceScene.IntersectP( occlusionRay ) );
+				EXPECT_EQ( occlusionRay.maxt, gc::Infinity );
+				if( !treeSurface )	continue;
+
+				++nHits;
+				EXPECT_NEAR( treeRay.maxt, sceneRay.maxt, 1.0e-9 * treeRay.maxt );
+				EXPECT_EQ( treeFront, sceneFront );
+				ASSERT_EQ( isTreeOutput, isSceneOutput );
+				if( isTreeOutput )
+				{
+					EXPECT_NEAR( treeOutputRay.origin.x, sceneOutputRay.origin.x, 1.0e-8 );
+					EXPECT_NEAR( treeOutputRay.origin.y, sceneOutputRay.origin.y, 1.0e-8 );
+					EXPECT_NEAR( treeOutputRay.origin.z, sceneOutputRay.origin.z, 1.0e-8 );
+					EXPECT_NEAR( treeOutputRay.direction().x, sceneOutputRay.direction().x, 1.0e-9 );
+					EXPECT_NEAR( treeOutputRay.direction().y, sceneOutputRay.direction().y, 1.0e-9 );
+					EXPECT_NEAR( treeOutputRay.direction().z, sceneOutputRay.direction().z, 1.0e-9 );
+				}
+			}
+
+			//The rays are aimed at the surfaces, many of them must find one
+			EXPECT_GT( nHits, nRays / 4 );
+		}
+
+		TSeparatorKit* m_rootKit;
+		InstanceNode* m_root;
+		InstanceNode* m_heliostats[2];
+		std::vector< InstanceNode* > m_surfaces;
+	};
+}
+
+TEST_F( TraceSceneTests, CompilesEachSurface )
+{
+	TraceScene traceScene;
+	traceScene.Compile( m_root );
+
+	ASSERT_EQ( 9, traceScene.GetNumberOfSurfaces() );
+	BBox sceneBBox = traceScene.GetBBox();
+	BBox rootBBox = m_root->GetIntersectionBBox();
+	EXPECT_DOUBLE_EQ( rootBBox.pMin.x, sceneBBox.pMin.x );
+	EXPECT_DOUBLE_EQ( rootBBox.pMin.y, sceneBBox.pMin.y );
+	EXPECT_DOUBLE_EQ( rootBBox.pMin.z, sceneBBox.pMin.z );
+	EXPECT_DOUBLE_EQ( rootBBox.pMax.x, sceneBBox.pMax.x );
+	EXPECT_DOUBLE_EQ( rootBBox.pMax.y, sceneBBox.pMax.y );
+	EXPECT_DOUBLE_EQ( rootBBox.pMax.z, sceneBBox.pMax.z );
+
+	for( int s = 0; s < traceScene.GetNumberOfSurfaces(); ++s )
+	{
+		InstanceNode* surface = traceScene.GetSurfaceInstance( s );
+		EXPECT_TRUE( surface->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) );
+		EXPECT_EQ( surface->GetIntersectionBBox().pMin.x, traceScene.GetSurfaceBBox( s ).pMin.x );
+		EXPECT_EQ( surface->GetIntersectionBBox().pMax.z, traceScene.GetSurfaceBBox( s ).pMax.z );
+	}
+}
+
+TEST_F( TraceSceneTests, IntersectMatchesInstanceTree )
+{
+	srand( 17 );
+
+	TraceScene traceScene;
+	traceScene.Compile( m_root );
+	ExpectSameIntersections( traceScene, 5000 );
+}
+
+TEST_F( TraceSceneTests, IntersectSurfaceMatchesIntersect )
+{
+	srand( 23 );
+
+	TraceScene traceScene;
+	traceScene.Compile( m_root );
+
+	SequenceRandomDeviate rand;
+	for( int r = 0; r < 2000; ++r )
+	{
+		Ray sceneRay = RandomRay();
+		Ray surfaceRay = sceneRay;
+
+		bool isFront = false;
+		InstanceNode* hitSurface = 0;
+		Ray outputRay;
+		traceScene.Intersect( sceneRay, rand, &isFront, &hitSurface, &outputRay );
+
+		//IntersectSurface reduces the ray maxt, so the nearest surface is the last one intersected
+		int nearestSurface = -1;
+		for( int s = 0; s < traceScene.GetNumberOfSurfaces(); ++s )
+		{
+			Ray singleSurfaceRay = surfaceRay;
+			singleSurfaceRay.maxt = gc::Infinity;
+			DifferentialGeometry dg;
+			Ray objectRay;
+			bool isSurfaceHit = traceScene.IntersectSurface( s, singleSurfaceRay, &dg, &objectRay );
+			EXPECT_EQ( isSurfaceHit, traceScene.IntersectSurfaceP( s, Ray( surfaceRay.origin, surfaceRay.direction() ) ) );
+
+			if( traceScene.IntersectSurface( s, surfaceRay, &dg, &objectRay ) )	nearestSurface = s;
+		}
+
+		if( !hitSurface )
+		{
+			EXPECT_EQ( -1, nearestSurface );
+			continue;
+		}
+		ASSERT_GE( nearestSurface, 0 );
+		EXPECT_EQ( hitSurface, traceScene.GetSurfaceInstance( nearestSurface ) );
+		EXPECT_DOUBLE_EQ( sceneRay.maxt, surfaceRay.maxt );
+	}
+}
+
+TEST_F( TraceSceneTests, RefitAfterMovingHeliostat )
+{
+	srand( 31 );
+
+	TraceScene traceScene;
+	traceScene.Compile( m_root );
+
+	//Turn the heliostat as its tracker would and update the scene tree
+	SoTransform* heliostatTransform = static_cast< SoTransform* >( static_cast< SoBaseKit* >( m_heliostats[1]->GetNode() )->getPart( "transform", true ) );
+	heliostatTransform->rotation.setValue( SbVec3f( 1.0, 0.0, 0.0 ), 0.9 );
+	trf::ComputeSceneTreeMap( m_root, Transform( new Matrix4x4 ), true );
+
+	traceScene.Refit();
+	EXPECT_DOUBLE_EQ( m_root->GetIntersectionBBox().pMax.y, traceScene.GetBBox().pMax.y );
+	ExpectSameIntersections( traceScene, 5000 );
+}
+
+TEST_F( TraceSceneTests, ProjectiveTransformIsNotInstanced )
+{
+	srand( 43 );
+
+	//A world to object transform with a perspective row, the instanced kernels would ignore it
+	InstanceNode* facet = m_heliostats[0]->children[0]->children[0];
+	Transform affineTransform = facet->GetIntersectionTransform();
+	Transform perspective( 1.0, 0.0, 0.0, 0.0,
+			0.0, 1.0, 0.0, 0.0,
+			0.0, 0.0, 1.0, 0.0,
+			0.0, 0.02, 0.0, 1.0 );
+	facet->SetIntersectionTransform( perspective * affineTransform );
+
+	TraceScene traceScene;
+	traceScene.Compile( m_root );
+	ExpectSameIntersections( traceScene, 5000 );
+
+	//Refit with the affine transform intersects the facet with its group again
+	facet->SetIntersectionTransform( affineTransform );
+	traceScene.Refit();
+	ExpectSameIntersections( traceScene, 5000 );
+}
@@ -15,6 +15,7 @@
 #include "BBox.h"
 #include "NormalVector.h"
 #include "Ray.h"
+#include "RayPacket.h"
 #include "Transform.h"
 
 const double maximumCoordinate = 5000000.0;
@@ -24,8 +25,14 @@ TEST( TransformTests, ConstructorDefault)
 {
 	Transform	t;
 
-	EXPECT_TRUE( t.GetMatrix() == 0);
-	//EXPECT_TRUE( t.m_minv == 0);
+	for( int i = 0; i < 4; ++i )
+		for( int j = 0; j < 4; ++j )
+		{
+			if( i == j ) EXPECT_DOUBLE_EQ( t.GetMatrix()->m[i][j], 1.0 );
+			else EXPECT_DOUBLE_EQ( t.GetMatrix()->m[i][j], 0.0 );
+		}
+
+	EXPECT_TRUE( t.GetInverse() == t );
 }
 
 TEST( TransformTests, ConstructorBidimensionalArray)
@@ -827,3 +834,83 @@ TEST( TransformTests, FunctionSwapsHandedness)
 
 		}
 }
+
+TEST( TransformTests, FunctionOrthonormalBasis)
+{
+	/* initialize random seed: */
+	srand ( time(NULL) );
+
+	for( unsigned long int i = 0; i < maximumNumberOfTests; i++ )
+	{
+		double angle = taf::randomNumber( -gc::Pi, gc::Pi );
+		Vector3D axis( taf::randomNumber( -1.0, 1.0 ), taf::randomNumber( -1.0, 1.0 ), 1.0 );
+		Transform rotation = Rotate( angle, axis );
+
+		Vector3D s = rotation( Vector3D( 1.0, 0.0, 0.0 ) );
+		Vector3D r = rotation( Vector3D( 0.0, 1.0, 0.0 ) );
+		Vector3D t = rotation( Vector3D( 0.0, 0.0, 1.0 ) );
+
+		Transform basis = OrthonormalBasis( s, r, t );
+		Transform general( s.x, s.y, s.z, 0.0,
+		                   r.x, r.y, r.z, 0.0,
+		                   t.x, t.y, t.z, 0.0,
+		                   0.0, 0.0, 0.0, 1.0 );
+		Ptr<Matrix4x4> basisInverse = basis.GetInverse().GetMatrix();
+		Ptr<Matrix4x4> generalInverse = general.GetInverse().GetMatrix();
+		for( int row = 0; row < 4; ++row )
+			for( int column = 0; column < 4; ++column )
+				EXPECT_NEAR( basisInverse->m[row][column], generalInverse->m[row][column], 1.0e-10 );
+
+		NormalVector normal( taf::randomNumber( -1.0, 1.0 ), taf::randomNumber( -1.0, 1.0 ), taf::randomNumber( -1.0, 1.0 ) );
+		NormalVector basisNormal = basis.GetInverse()( normal );
+		NormalVector generalNormal = general.GetInverse()( normal );
+		EXPECT_NEAR( basisNormal.x, generalNormal.x, 1.0e-10 );
+		EXPECT_NEAR( basisNormal.y, generalNormal.y, 1.0e-10 );
+		EXPECT_NEAR( basisNormal.z, generalNormal.z, 1.0e-10 );
+	}
+}
+
+TEST( TransformTests, TransformRayPacket)
+{
+	/* initialize random seed: */
+	srand ( time(NULL) );
+
+	// Extension of the testing space
+	double b = maximumCoordinate;
+	double a = -b;
+
+	for( unsigned long int i = 0; i < maximumNumberOfTests; i++ )
+	{
+		Transform t( taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ),
+					 taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ),
+					 taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ), taf::randomNumber( a, b ),
+					 0.0, 0.0, 0.0, 1.0 );
+
+		RayPacket rays;
+		Ray raysList[RayPacket::Size];
+		for( int r = 0; r < RayPacket::Size; ++r )
+		{
+			raysList[r] = taf::randomRay( a, b );
+			rays.SetRay( r, raysList[r] );
+		}
+		rays.nRays = RayPacket::Size;
+
+		RayPacket transformedRays;
+		t( rays, transformedRays );
+		EXPECT_EQ( rays.nRays, transformedRays.nRays );
+
+		for( int r = 0; r < RayPacket::Size; ++r )
+		{
+			Ray expectedRay = t( raysList[r] );
+			Ray transformedRay = transformedRays.GetRay( r );
+			EXPECT_DOUBLE_EQ( expectedRay.origin.x, transformedRay.origin.x );
+			EXPECT_DOUBLE_EQ( expectedRay.origin.y, transformedRay.origin.y );
+			EXPECT_DOUBLE_EQ( expectedRay.origin.z, transformedRay.origin.z );
+			EXPECT_DOUBLE_EQ( expectedRay.direction().x, transformedRay.direction().x );
+			EXPECT_DOUBLE_EQ( expectedRay.direction().y, transformedRay.direction().y );
+			EXPECT_DOUBLE_EQ( expectedRay.direction().z, transformedRay.direction().z );
+			EXPECT_DOUBLE_EQ( expectedRay.mint, transformedRay.mint );
+			EXPECT_DOUBLE_EQ( expectedRay.maxt, transformedRay.maxt );
+		}
+	}
+}
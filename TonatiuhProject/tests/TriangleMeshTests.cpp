@@ -0,0 +1,263 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel Blanco,
+at the time Chair of the Department of Engineering of the University of Texas
+at Brownsville. From May 2004 to August 2008 Tonatiuh's development was
+supported by the Department of Energy (DOE) and the National Renewable
+Energy Laboratory (NREL) under the Minority Research Associate (MURA)
+Program Subcontract ACQ-4-33623-06. During 2007, NREL also contributed to
+the validation of Tonatiuh under the framework of the Memorandum of
+Understanding signed with the Spanish National Renewable Energy Centre (CENER)
+on February, 20, 2007 (MOU#NREL-07-117). Since June 2006, the development of
+Tonatiuh is being led by CENER, under the direction of Dr. Blanco, now
+Manager of the Solar Thermal Energy Department of CENER.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DifferentialGeometry.h"
+#include "gc.h"
+#include "Ray.h"
+#include "TriangleMesh.h"
+
+namespace
+{
+	double RandomValue( double minValue, double maxValue )
+	{
+		return minValue + ( maxValue - minValue ) * rand() / RAND_MAX;
+	}
+
+	void ExpectSamePoint( const Point3D& expected, const Point3D& actual )
+	{
+		EXPECT_DOUBLE_EQ( expected.x, actual.x );
+		EXPECT_DOUBLE_EQ( expected.y, actual.y );
+		EXPECT_DOUBLE_EQ( expected.z, actual.z );
+	}
+}
+
+TEST( TriangleMeshTests, StoresTheTriangleVertices )
+{
+	TriangleMesh mesh;
+	EXPECT_EQ( 0, mesh.GetNumberOfTriangles() );
+
+	mesh.AddTriangle( Point3D( 1.0, 2.0, 3.0 ), Point3D( 4.0, 2.5, 3.0 ), Point3D( 1.5, 6.0, -1.0 ) );
+	mesh.AddTriangle( Point3D( 0.1, 0.2, 0.3 ), Point3D( -0.7, 0.2, 0.3 ), Point3D( 0.1, 1.9, 0.3 ) );
+	ASSERT_EQ( 2, mesh.GetNumberOfTriangles() );
+
+	Point3D v1;
+	Point3D v2;
+	Point3D v3;
+	mesh.GetTriangleVertices( 0, &v1, &v2, &v3 );
+	ExpectSamePoint( Point3D( 1.0, 2.0, 3.0 ), v1 );
+	ExpectSamePoint( Point3D( 4.0, 2.5, 3.0 ), v2 );
+	ExpectSamePoint( Point3D( 1.5, 6.0, -1.0 ), v3 );
+
+	mesh.GetTriangleVertices( 1, &v1, &v2, &v3 );
+	ExpectSamePoint( Point3D( 0.1, 0.2, 0.3 ), v1 );
+	ExpectSamePoint( Point3D( -0.7, 0.2, 0.3 ), v2 );
+	ExpectSamePoint( Point3D( 0.1, 1.9, 0.3 ), v3 );
+
+	BBox bbox = mesh.GetTriangleBBox( 0 );
+	ExpectSamePoint( Point3D( 1.0, 2.0, -1.0 ), bbox.pMin );
+	ExpectSamePoint( Point3D( 4.0, 6.0, 3.0 ), bbox.pMax );
+	ExpectSamePoint( Point3D( 6.5 / 3.0, 3.5, 5.0 / 3.0 ), mesh.GetTriangleCentroid( 0 ) );
+
+	mesh.Clear();
+	EXPECT_EQ( 0, mesh.GetNumberOfTriangles() );
+}
+
+TEST( TriangleMeshTests, ReorderMovesEveryComponent )
+{
+	TriangleMesh mesh;
+	for( int t = 0; t < 5; ++t )
+		mesh.AddTriangle( Point3D( t, 0.0, 0.0 ), Point3D( t + 1.0, 0.0, 0.5 * t ), Point3D( t, 1.0 + t, 0.0 ) );
+
+	std::vector< int > order;
+	order.push_back( 3 );
+	order.push_back( 0 );
+	order.push_back( 4 );
+	order.push_back( 1 );
+	order.push_back( 2 );
+	mesh.Reorder( order );
+	ASSERT_EQ( 5, mesh.GetNumberOfTriangles() );
+
+	for( int t = 0; t < 5; ++t )
+	{
+		int original = order[t];
+		Point3D v1;
+		Point3D v2;
+		Point3D v3;
+		mesh.GetTriangleVertices( t, &v1, &v2, &v3 );
+		ExpectSamePoint( Point3D( original, 0.0, 0.0 ), v1 );
+		ExpectSamePoint( Point3D( original + 1.0, 0.0, 0.5 * original ), v2 );
+		ExpectSamePoint( Point3D( original, 1.0 + original, 0.0 ), v3 );
+
+		//The intersection data is moved with the vertices
+		Ray objectRay( Point3D( original + 0.25, 0.25, 5.0 ), Vector3D( 0.0, 0.0, -1.0 ) );
+		double tHit = objectRay.maxt;
+		double u = 0.0;
+		double v = 0.0;
+		EXPECT_EQ( t, mesh.IntersectTriangles( t, 1, objectRay, &tHit, &u, &v ) );
+	}
+}
+
+TEST( TriangleMeshTests, IntersectsTheNearestTriangle )
+{
+	TriangleMesh mesh;
+	mesh.AddTriangle( Point3D( 0.0, 0.0, 1.0 ), Point3D( 2.0, 0.0, 1.0 ), Point3D( 0.0, 2.0, 1.0 ) );
+	mesh.AddTriangle( Point3D( 0.0, 0.0, 3.0 ), Point3D( 2.0, 0.0, 3.0 ), Point3D( 0.0, 2.0, 3.0 ) );
+	mesh.AddTriangle( Point3D( 0.0, 0.0, 2.0 ), Point3D( 0.0, 2.0, 2.0 ), Point3D( 2.0, 0.0, 2.0 ) );
+
+	Ray objectRay( Point3D( 0.5, 0.25, 5.0 ), Vector3D( 0.0, 0.0, -1.0 ) );
+	double tHit = objectRay.maxt;
+	double u = 0.0;
+	double v = 0.0;
+	EXPECT_EQ( 1, mesh.IntersectTriangles( 0, 3, objectRay, &tHit, &u, &v ) );
+	EXPECT_DOUBLE_EQ( 2.0, tHit );
+	EXPECT_DOUBLE_EQ( 0.25, u );
+	EXPECT_DOUBLE_EQ( 0.125, v );
+
+	DifferentialGeometry dg;
+	mesh.GetDifferentialGeometry( 1, objectRay, tHit, u, v, &dg );
+	ExpectSamePoint( Point3D( 0.5, 0.25, 3.0 ), dg.point );
+	EXPECT_TRUE( dg.shapeFrontSide );
+
+	//Only the intersections nearer than tHit are accepted
+	tHit = 1.5;
+	EXPECT_EQ( -1, mesh.IntersectTriangles( 0, 3, objectRay, &tHit, &u, &v ) );
+	EXPECT_EQ( 1.5, tHit );
+	tHit = 3.5;
+	EXPECT_EQ( 2, mesh.IntersectTriangles( 2, 1, objectRay, &tHit, &u, &v ) );
+	EXPECT_DOUBLE_EQ( 3.0, tHit );
+
+	//The third triangle vertices are clockwise seen from the ray
+	mesh.GetDifferentialGeometry( 2, objectRay, 3.0, 0.25, 0.125, &dg );
+	EXPECT_FALSE( dg.shapeFrontSide );
+}
+
+TEST( TriangleMeshTests, DegenerateAndParallelTrianglesAreMissed )
+{
+	TriangleMesh mesh;
+	mesh.AddTriangle( Point3D( 0.0, 0.0, 0.0 ), Point3D( 1.0, 1.0, 0.0 ), Point3D( 2.0, 2.0, 0.0 ) );
+	mesh.AddTriangle( Point3D( 0.0, 0.0, 0.0 ), Point3D( 2.0, 0.0, 0.0 ), Point3D( 0.0, 0.0, 2.0 ) );
+
+	double u = 0.0;
+	double v = 0.0;
+	Ray throughDegenerate( Point3D( 1.0, 1.0, 5.0 ), Vector3D( 0.0, 0.0, -1.0 ) );
+	double tHit = throughDegenerate.maxt;
+	EXPECT_EQ( -1, mesh.IntersectTriangles( 0, 1, throughDegenerate, &tHit, &u, &v ) );
+
+	Ray inPlane( Point3D( -1.0, 0.0, 0.5 ), Vector3D( 1.0, 0.0, 0.0 ) );
+	tHit = inPlane.maxt;
+	EXPECT_EQ( -1, mesh.IntersectTriangles( 1, 1, inPlane, &tHit, &u, &v ) );
+}
+
+TEST( TriangleMeshTests, KernelsMatchScalarKernel )
+{
+	srand( 19 );
+
+	//A fan of triangles sharing the vertex (0,0,0) and its edges, and random triangles
+	const int nFanTriangles = 12;
+	TriangleMesh mesh;
+	for( int t = 0; t < nFanTriangles; ++t )
+	{
+		double angle0 = 2.0 * gc::Pi * t / nFanTriangles;
+		double angle1 = 2.0 * gc::Pi * ( t + 1 ) / nFanTriangles;
+		mesh.AddTriangle( Point3D( 0.0, 0.0, 0.0 ), Point3D( std::cos( angle0 ), std::sin( angle0 ), 0.1 * t ),
+				Point3D( std::cos( angle1 ), std::sin( angle1 ), 0.1 * ( t + 1 ) ) );
+	}
+	for( int t = 0; t < 200; ++t )
+	{
+		Point3D v1( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) );
+		mesh.AddTriangle( v1, v1 + Vector3D( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) ),
+				v1 + Vector3D( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) ) );
+	}
+	EXPECT_TRUE( TriangleMesh::IsKernelSupported( TriangleMesh::ScalarKernel ) );
+
+	for( int k = TriangleMesh::SSE2Kernel; k < TriangleMesh::NumberOfKernels; ++k )
+	{
+		TriangleMesh::Kernel kernel = TriangleMesh::Kernel( k );
+		if( !TriangleMesh::IsKernelSupported( kernel ) )	continue;
+
+		int nHits = 0;
+		for( int r = 0; r < 3000; ++r )
+		{
+			//Rays through the fan vertex and edges, and random rays
+			Point3D origin( RandomValue( -2.0, 2.0 ), RandomValue( -2.0, 2.0 ), 3.0 );
+			Point3D target( 0.0, 0.0, 0.0 );
+			if( r % 3 == 1 )
+			{
+				int edge = rand() % nFanTriangles;
+				double angle = 2.0 * gc::Pi * edge / nFanTriangles;
+				double distance = RandomValue( 0.0, 1.0 );
+				target = Point3D( distance * std::cos( angle ), distance * std::sin( angle ), 0.1 * edge * distance );
+			}
+			else if( r % 3 == 2 )
+				target = Point3D( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) );
+			Ray objectRay( origin, Normalize( target - origin ) );
+			if( r % 5 == 0 )	objectRay.maxt = RandomValue( 1.0, 4.0 );
+
+			//Every range length, so the packed kernels also test partial groups
+			int firstTriangle = rand() % mesh.GetNumberOfTriangles();
+			int nTriangles = 1 + rand() % ( mesh.GetNumberOfTriangles() - firstTriangle );
+			if( r % 4 == 0 )
+			{
+				firstTriangle = 0;
+				nTriangles = mesh.GetNumberOfTriangles();
+			}
+
+			double scalarTHit = objectRay.maxt;
+			double scalarU = 0.0;
+			double scalarV = 0.0;
+			int scalarHit = mesh.IntersectTriangles( TriangleMesh::ScalarKernel, firstTriangle, nTriangles, objectRay, &scalarTHit, &scalarU, &scalarV );
+
+			double kernelTHit = objectRay.maxt;
+			double kernelU = 0.0;
+			double kernelV = 0.0;
+			int kernelHit = mesh.IntersectTriangles( kernel, firstTriangle, nTriangles, objectRay, &kernelTHit, &kernelU, &kernelV );
+
+			ASSERT_EQ( scalarHit < 0, kernelHit < 0 ) << "kernel " << k;
+			EXPECT_EQ( scalarTHit, kernelTHit );
+			if( scalarHit < 0 )	continue;
+			++nHits;
+
+			//Triangles sharing an edge can give the same distance, then only the hit point must be the same
+			if( scalarHit == kernelHit )
+			{
+				EXPECT_EQ( scalarU, kernelU );
+				EXPECT_EQ( scalarV, kernelV );
+			}
+			EXPECT_GE( kernelHit, firstTriangle );
+			EXPECT_LT( kernelHit, firstTriangle + nTriangles );
+		}
+		EXPECT_GT( nHits, 500 );
+	}
+}
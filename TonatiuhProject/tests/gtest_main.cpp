@@ -35,6 +35,10 @@
 
 #include <gtest/gtest.h>
 
+#include "MaterialStandardSpecular.h"
+#include "ShapeFlatDisk.h"
+#include "ShapeFlatRectangle.h"
+#include "ShapeParabolicRectangle.h"
 #include "TDefaultMaterial.h"
 #include "TDefaultSunShape.h"
 #include "TDefaultTracker.h"
@@ -75,6 +79,11 @@ int main(int argc, char **argv )
 	TTrackerForAiming::initClass();
 	TTransmissivity::initClass();
 
+	MaterialStandardSpecular::initClass();
+	ShapeFlatDisk::initClass();
+	ShapeFlatRectangle::initClass();
+	ShapeParabolicRectangle::initClass();
+
 
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
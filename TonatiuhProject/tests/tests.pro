@@ -7,27 +7,48 @@ QT += xml opengl svg  script network
 DEFINES += TEST_DIR=\\\"PWD/../tests\\\"
 
 SOURCES += *.cpp 
+
+INCLUDEPATH += ../plugins/MaterialStandardSpecular/src \
+               ../plugins/PhotonMapExportDB/src \
+               ../plugins/PhotonMapExportFile/src \
+               ../plugins/RandomMersenneTwister/src \
+               ../plugins/RandomRngStream/src \
+               ../plugins/ShapeBezierSurface/src \
+               ../plugins/ShapeCAD/src \
+               ../plugins/ShapeFlatDisk/src \
+               ../plugins/ShapeFlatRectangle/src \
+               ../plugins/ShapeParabolicRectangle/src
            
 CONFIG(debug, debug|release) {
     OBJECTS       +=    $$(TONATIUH_ROOT)/debug/BBox.o \
                         $$(TONATIUH_ROOT)/debug/DifferentialGeometry.o \
                         $$(TONATIUH_ROOT)/debug/Document.o \
                         $$(TONATIUH_ROOT)/debug/InstanceNode.o \
+                        $$(TONATIUH_ROOT)/debug/InstancedShape.o \
                         $$(TONATIUH_ROOT)/debug/Matrix4x4.o \
                         $$(TONATIUH_ROOT)/debug/moc_Document.o \
                         $$(TONATIUH_ROOT)/debug/moc_ParallelRandomDeviate.o \
+                        $$(TONATIUH_ROOT)/debug/moc_RayTracingScheduler.o \
                         $$(TONATIUH_ROOT)/debug/moc_SceneModel.o \
                         $$(TONATIUH_ROOT)/debug/moc_ScriptRayTracer.o \
                         $$(TONATIUH_ROOT)/debug/NormalVector.o \
                         $$(TONATIUH_ROOT)/debug/ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/debug/PathWrapper.o \
                         $$(TONATIUH_ROOT)/debug/Photon.o \
+                        $$(TONATIUH_ROOT)/debug/PhotonMapColumns.o \
+                        $$(TONATIUH_ROOT)/debug/PhotonMapColumnsReader.o \
+                        $$(TONATIUH_ROOT)/debug/PhotonMapColumnsWriter.o \
                         $$(TONATIUH_ROOT)/debug/PhotonMapExport.o \
+                        $$(TONATIUH_ROOT)/debug/PhotonMapSurfaceIdentifier.o \
+                        $$(TONATIUH_ROOT)/debug/PhotonMapWriter.o \
                         $$(TONATIUH_ROOT)/debug/Point3D.o \
                         $$(TONATIUH_ROOT)/debug/PluginManager.o \
+                        $$(TONATIUH_ROOT)/debug/PrimitiveRayGenerator.o \
                         $$(TONATIUH_ROOT)/debug/RayTracer.o \
                         $$(TONATIUH_ROOT)/debug/RayTracerNoTr.o \
+                        $$(TONATIUH_ROOT)/debug/RayTracingScheduler.o \
                         $$(TONATIUH_ROOT)/debug/RefCount.o \
+                        $$(TONATIUH_ROOT)/debug/SceneBVH.o \
                         $$(TONATIUH_ROOT)/debug/SceneModel.o \
                         $$(TONATIUH_ROOT)/debug/ScriptRayTracer.o \
                         $$(TONATIUH_ROOT)/debug/sunpos.o \
@@ -42,6 +63,7 @@ CONFIG(debug, debug|release) {
                         $$(TONATIUH_ROOT)/debug/TMaterial.o \
                         $$(TONATIUH_ROOT)/debug/tonatiuh_script.o \
                         $$(TONATIUH_ROOT)/debug/TPhotonMap.o \
+                        $$(TONATIUH_ROOT)/debug/TraceScene.o \
                         $$(TONATIUH_ROOT)/debug/Transform.o \
                         $$(TONATIUH_ROOT)/debug/trf.o \
                         $$(TONATIUH_ROOT)/debug/TSceneTracker.o \
@@ -54,28 +76,51 @@ CONFIG(debug, debug|release) {
                         $$(TONATIUH_ROOT)/debug/TTracker.o \
                         $$(TONATIUH_ROOT)/debug/TTrackerForAiming.o \
                         $$(TONATIUH_ROOT)/debug/TTransmissivity.o \
-                        $$(TONATIUH_ROOT)/debug/Vector3D.o
+                        $$(TONATIUH_ROOT)/debug/Vector3D.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/BezierPatch.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/BVH.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/MaterialStandardSpecular.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/MeshEncoder.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/PhotonMapExportDB.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/PhotonMapExportFile.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/RandomMersenneTwister.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/RandomRngStream.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeFlatDisk.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeFlatRectangle.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeParabolicRectangle.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/STLReader.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/TriangleMesh.o
 }                     
 else { 
     OBJECTS       +=    $$(TONATIUH_ROOT)/release/BBox.o \
                         $$(TONATIUH_ROOT)/release/DifferentialGeometry.o \
                         $$(TONATIUH_ROOT)/release/Document.o \
                         $$(TONATIUH_ROOT)/release/InstanceNode.o \
+                        $$(TONATIUH_ROOT)/release/InstancedShape.o \
                         $$(TONATIUH_ROOT)/release/Matrix4x4.o \
                         $$(TONATIUH_ROOT)/release/moc_Document.o \
                         $$(TONATIUH_ROOT)/release/moc_ParallelRandomDeviate.o \
+                        $$(TONATIUH_ROOT)/release/moc_RayTracingScheduler.o \
                         $$(TONATIUH_ROOT)/release/moc_SceneModel.o \
                         $$(TONATIUH_ROOT)/release/moc_ScriptRayTracer.o \
                         $$(TONATIUH_ROOT)/release/NormalVector.o \
                         $$(TONATIUH_ROOT)/release/ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/release/PathWrapper.o \
                         $$(TONATIUH_ROOT)/release/Photon.o \
+                        $$(TONATIUH_ROOT)/release/PhotonMapColumns.o \
+                        $$(TONATIUH_ROOT)/release/PhotonMapColumnsReader.o \
+                        $$(TONATIUH_ROOT)/release/PhotonMapColumnsWriter.o \
                         $$(TONATIUH_ROOT)/release/PhotonMapExport.o \
+                        $$(TONATIUH_ROOT)/release/PhotonMapSurfaceIdentifier.o \
+                        $$(TONATIUH_ROOT)/release/PhotonMapWriter.o \
                         $$(TONATIUH_ROOT)/release/Point3D.o \
                         $$(TONATIUH_ROOT)/release/PluginManager.o \
+                        $$(TONATIUH_ROOT)/release/PrimitiveRayGenerator.o \
                         $$(TONATIUH_ROOT)/release/RayTracer.o \
                         $$(TONATIUH_ROOT)/release/RayTracerNoTr.o \
+                        $$(TONATIUH_ROOT)/release/RayTracingScheduler.o \
                         $$(TONATIUH_ROOT)/release/RefCount.o \
+                        $$(TONATIUH_ROOT)/release/SceneBVH.o \
                         $$(TONATIUH_ROOT)/release/SceneModel.o \
                         $$(TONATIUH_ROOT)/release/ScriptRayTracer.o \
                         $$(TONATIUH_ROOT)/release/sunpos.o \
@@ -90,6 +135,7 @@ else {
                         $$(TONATIUH_ROOT)/release/TMaterial.o \
                         $$(TONATIUH_ROOT)/release/tonatiuh_script.o \
                         $$(TONATIUH_ROOT)/release/TPhotonMap.o \
+                        $$(TONATIUH_ROOT)/release/TraceScene.o \
                         $$(TONATIUH_ROOT)/release/Transform.o \
                         $$(TONATIUH_ROOT)/release/trf.o \
                         $$(TONATIUH_ROOT)/release/TSeparatorKit.o \
@@ -102,10 +148,23 @@ else {
                         $$(TONATIUH_ROOT)/release/TTracker.o \
                         $$(TONATIUH_ROOT)/release/TTrackerForAiming.o \
                         $$(TONATIUH_ROOT)/release/TTransmissivity.o \
-                        $$(TONATIUH_ROOT)/release/Vector3D.o
+                        $$(TONATIUH_ROOT)/release/Vector3D.o \
+                        $$(TONATIUH_ROOT)/release/plugins/BezierPatch.o \
+                        $$(TONATIUH_ROOT)/release/plugins/BVH.o \
+                        $$(TONATIUH_ROOT)/release/plugins/MaterialStandardSpecular.o \
+                        $$(TONATIUH_ROOT)/release/plugins/MeshEncoder.o \
+                        $$(TONATIUH_ROOT)/release/plugins/PhotonMapExportDB.o \
+                        $$(TONATIUH_ROOT)/release/plugins/PhotonMapExportFile.o \
+                        $$(TONATIUH_ROOT)/release/plugins/RandomMersenneTwister.o \
+                        $$(TONATIUH_ROOT)/release/plugins/RandomRngStream.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeFlatDisk.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeFlatRectangle.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeParabolicRectangle.o \
+                        $$(TONATIUH_ROOT)/release/plugins/STLReader.o \
+                        $$(TONATIUH_ROOT)/release/plugins/TriangleMesh.o
 }
 
-LIBS += -L$$(TDE_ROOT)/local/lib -lgtest
+LIBS += -L$$(TDE_ROOT)/local/lib -lgtest -lsqlite3
 
 TARGET = TonatiuhTests
 